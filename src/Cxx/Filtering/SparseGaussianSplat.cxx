@@ -0,0 +1,576 @@
+#include <vtkActor.h>
+#include <vtkAppendPolyData.h>
+#include <vtkCamera.h>
+#include <vtkCleanPolyData.h>
+#include <vtkFloatArray.h>
+#include <vtkFlyingEdges3D.h>
+#include <vtkGaussianSplatter.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkPolyDataNormals.h>
+#include <vtkProperty.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPThreadLocalObject.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+/**
+ * Make clustered points: a few dense clouds of different sizes.
+ *
+ * @param numberOfPoints The number of points.
+ * @return The points.
+ */
+vtkSmartPointer<vtkPoints> MakeClusters(vtkIdType numberOfPoints);
+
+/**
+ * A Gaussian splatter that stores the volume in bricks of 16^3 samples,
+ * allocated only where a splat reaches.
+ *
+ * It computes the same volume as vtkGaussianSplatter with scalar warping
+ * off and the maximum accumulation mode: each point splats
+ * exp(exponentFactor * (r / radius)^2) out to the radius. The model bounds
+ * and the radius follow vtkGaussianSplatter too.
+ */
+class SparseGaussianSplatter
+{
+public:
+  /**
+   * @param points The points to splat.
+   * @param resolution The number of samples along each axis.
+   * @param radius The radius of a splat, as a fraction of the longest side
+   * of the bounds of the points.
+   */
+  SparseGaussianSplatter(vtkPoints* points, int resolution, double radius);
+
+  /**
+   * Splat the points in parallel. Each thread splats into its own bricks,
+   * which are merged at the end.
+   */
+  void Splat();
+
+  /**
+   * Contour the occupied bricks in parallel.
+   *
+   * @param value The value of the contour.
+   * @return The contour.
+   */
+  vtkSmartPointer<vtkPolyData> Contour(double value);
+
+  size_t GetNumberOfBricks() const
+  {
+    return this->Keys.size();
+  }
+
+  /**
+   * @return The size of the bricks in bytes.
+   */
+  size_t GetMemorySize() const
+  {
+    return this->Keys.size() * BrickSamples * sizeof(float);
+  }
+
+private:
+  static const int BrickSize = 16;
+  static const int BrickSamples = BrickSize * BrickSize * BrickSize;
+
+  std::uint64_t BrickKey(int bx, int by, int bz) const
+  {
+    return static_cast<std::uint64_t>(bx) |
+        (static_cast<std::uint64_t>(by) << 21) |
+        (static_cast<std::uint64_t>(bz) << 42);
+  }
+  const float* FindBrick(std::uint64_t key) const;
+  float GetSample(const int ijk[3], std::uint64_t& lastKey,
+                  const float*& lastBrick) const;
+
+  vtkPoints* Points;
+  int Resolution;
+  double Origin[3];
+  double Spacing[3];
+  double Radius;
+  double ExponentFactor = -5.0;
+  // The occupied bricks, sorted by key.
+  std::vector<std::uint64_t> Keys;
+  std::vector<std::vector<float>> Bricks;
+};
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  vtkIdType numberOfPoints = 200000;
+  auto resolution = 256;
+  auto compare = false;
+  auto position = 0;
+  for (auto i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "-c")
+    {
+      compare = true;
+    }
+    else if (position == 0)
+    {
+      numberOfPoints = std::atoll(argv[i]);
+      ++position;
+    }
+    else if (position == 1)
+    {
+      resolution = std::atoi(argv[i]);
+      ++position;
+    }
+    else
+    {
+      std::cout << "Usage: " << argv[0]
+                << " [numberOfPoints] [resolution] [-c]" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (numberOfPoints < 1 || resolution < 2)
+  {
+    std::cout << "numberOfPoints must be positive and resolution at least 2."
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkNew<vtkNamedColors> colors;
+
+  auto points = MakeClusters(numberOfPoints);
+  auto radius = 0.01;
+  auto value = 0.5;
+
+  vtkNew<vtkTimerLog> timer;
+  SparseGaussianSplatter splatter(points, resolution, radius);
+  timer->StartTimer();
+  splatter.Splat();
+  timer->StopTimer();
+  auto splatTime = timer->GetElapsedTime();
+
+  timer->StartTimer();
+  auto surface = splatter.Contour(value);
+  timer->StopTimer();
+
+  auto dense = static_cast<double>(resolution) * resolution * resolution;
+  std::cout << "Points: " << numberOfPoints << ", resolution: " << resolution
+            << "^3" << std::endl;
+  std::cout << "Sparse" << std::endl;
+  std::cout << "  Splat:     " << splatTime << " s" << std::endl;
+  std::cout << "  Contour:   " << timer->GetElapsedTime() << " s, "
+            << surface->GetNumberOfCells() << " triangles" << std::endl;
+  std::cout << "  Bricks:    " << splatter.GetNumberOfBricks() << ", "
+            << splatter.GetMemorySize() / (1024.0 * 1024.0) << " MiB, "
+            << 100.0 * splatter.GetNumberOfBricks() * 4096.0 / dense
+            << "% of the volume" << std::endl;
+
+  if (compare)
+  {
+    vtkNew<vtkPolyData> polyData;
+    polyData->SetPoints(points);
+
+    vtkNew<vtkGaussianSplatter> gaussian;
+    gaussian->SetInputData(polyData);
+    gaussian->SetSampleDimensions(resolution, resolution, resolution);
+    gaussian->SetRadius(radius);
+    gaussian->ScalarWarpingOff();
+    timer->StartTimer();
+    gaussian->Update();
+    timer->StopTimer();
+    std::cout << "vtkGaussianSplatter" << std::endl;
+    std::cout << "  Splat:     " << timer->GetElapsedTime() << " s, "
+              << gaussian->GetOutput()->GetActualMemorySize() / 1024.0
+              << " MiB" << std::endl;
+
+    vtkNew<vtkFlyingEdges3D> contour;
+    contour->SetInputConnection(gaussian->GetOutputPort());
+    contour->SetValue(0, value);
+    timer->StartTimer();
+    contour->Update();
+    timer->StopTimer();
+    std::cout << "  Contour:   " << timer->GetElapsedTime() << " s, "
+              << contour->GetOutput()->GetNumberOfCells() << " triangles"
+              << std::endl;
+  }
+
+  vtkNew<vtkPolyDataNormals> normals;
+  normals->SetInputData(surface);
+
+  vtkNew<vtkPolyDataMapper> mapper;
+  mapper->SetInputConnection(normals->GetOutputPort());
+
+  vtkNew<vtkActor> actor;
+  actor->SetMapper(mapper);
+  actor->GetProperty()->SetColor(colors->GetColor3d("Gold").GetData());
+
+  vtkNew<vtkRenderer> renderer;
+  renderer->AddActor(actor);
+  renderer->SetBackground(colors->GetColor3d("SteelBlue").GetData());
+
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->AddRenderer(renderer);
+  renderWindow->SetSize(640, 480);
+  renderWindow->SetWindowName("SparseGaussianSplat");
+
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  renderWindowInteractor->SetRenderWindow(renderWindow);
+
+  renderer->ResetCamera();
+  renderer->GetActiveCamera()->Azimuth(30);
+  renderer->GetActiveCamera()->Elevation(20);
+  renderer->ResetCameraClippingRange();
+
+  renderWindow->Render();
+  renderWindowInteractor->Start();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+vtkSmartPointer<vtkPoints> MakeClusters(vtkIdType numberOfPoints)
+{
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  random->SetSeed(8775070);
+
+  // Centers and spreads of the clusters.
+  const double clusters[][4]{{0.2, 0.3, 0.2, 0.02}, {0.7, 0.6, 0.3, 0.04},
+                             {0.4, 0.8, 0.7, 0.01}, {0.8, 0.2, 0.8, 0.03},
+                             {0.3, 0.5, 0.6, 0.05}};
+  const int numberOfClusters = 5;
+
+  auto points = vtkSmartPointer<vtkPoints>::New();
+  points->SetNumberOfPoints(numberOfPoints);
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    auto const& cluster = clusters[i % numberOfClusters];
+    double x[3];
+    for (auto j = 0; j < 3; ++j)
+    {
+      // Box-Muller.
+      auto u = std::max(random->GetValue(), 1e-12);
+      random->Next();
+      auto v = random->GetValue();
+      random->Next();
+      x[j] = cluster[j] +
+          cluster[3] * std::sqrt(-2.0 * std::log(u)) *
+              std::cos(2.0 * vtkMath::Pi() * v);
+    }
+    points->SetPoint(i, x);
+  }
+  return points;
+}
+
+SparseGaussianSplatter::SparseGaussianSplatter(vtkPoints* points,
+                                               int resolution, double radius)
+  : Points(points), Resolution(resolution)
+{
+  // Grow the bounds by the radius so that the splats fit inside, as
+  // vtkGaussianSplatter does.
+  double bounds[6];
+  points->GetBounds(bounds);
+  auto maxDist = std::max(
+      {bounds[1] - bounds[0], bounds[3] - bounds[2], bounds[5] - bounds[4]});
+  this->Radius = radius * maxDist;
+  for (auto j = 0; j < 3; ++j)
+  {
+    this->Origin[j] = bounds[2 * j] - this->Radius;
+    this->Spacing[j] =
+        (bounds[2 * j + 1] - bounds[2 * j] + 2.0 * this->Radius) /
+        (resolution - 1);
+    if (this->Spacing[j] <= 0.0)
+    {
+      this->Spacing[j] = 1.0;
+    }
+  }
+}
+
+void SparseGaussianSplatter::Splat()
+{
+  auto numberOfPoints = this->Points->GetNumberOfPoints();
+  auto brickLength = BrickSize;
+
+  // Visit the points brick by brick, so that the points of a thread touch
+  // few bricks.
+  std::vector<std::pair<std::uint64_t, vtkIdType>> order(numberOfPoints);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+    for (auto i = begin; i < end; ++i)
+    {
+      double x[3];
+      this->Points->GetPoint(i, x);
+      int b[3];
+      for (auto j = 0; j < 3; ++j)
+      {
+        b[j] = static_cast<int>((x[j] - this->Origin[j]) / this->Spacing[j]) /
+            brickLength;
+      }
+      order[i] = {this->BrickKey(b[0], b[1], b[2]), i};
+    }
+  });
+  vtkSMPTools::Sort(order.begin(), order.end());
+
+  using BrickMap = std::unordered_map<std::uint64_t, std::vector<float>>;
+  vtkSMPThreadLocal<BrickMap> localBricks;
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+    auto& bricks = localBricks.Local();
+    for (auto p = begin; p < end; ++p)
+    {
+      double x[3];
+      this->Points->GetPoint(order[p].second, x);
+
+      // The samples within the radius. One more sample on the low side, so
+      // that every cell with a corner in the splat has its brick.
+      int low[3], high[3];
+      for (auto j = 0; j < 3; ++j)
+      {
+        low[j] = std::max(
+            0,
+            static_cast<int>(std::ceil(
+                (x[j] - this->Radius - this->Origin[j]) / this->Spacing[j])) -
+                1);
+        high[j] = std::min(
+            this->Resolution - 1,
+            static_cast<int>(std::floor(
+                (x[j] + this->Radius - this->Origin[j]) / this->Spacing[j])));
+      }
+
+      for (auto bz = low[2] / brickLength; bz <= high[2] / brickLength; ++bz)
+      {
+        for (auto by = low[1] / brickLength; by <= high[1] / brickLength;
+             ++by)
+        {
+          for (auto bx = low[0] / brickLength; bx <= high[0] / brickLength;
+               ++bx)
+          {
+            auto& brick = bricks[this->BrickKey(bx, by, bz)];
+            if (brick.empty())
+            {
+              brick.assign(BrickSamples, 0.0f);
+            }
+            int b[3]{bx, by, bz};
+            int first[3], last[3];
+            for (auto j = 0; j < 3; ++j)
+            {
+              first[j] = std::max(low[j], b[j] * brickLength);
+              last[j] = std::min(high[j], (b[j] + 1) * brickLength - 1);
+            }
+            for (auto k = first[2]; k <= last[2]; ++k)
+            {
+              auto dz = this->Origin[2] + k * this->Spacing[2] - x[2];
+              for (auto j = first[1]; j <= last[1]; ++j)
+              {
+                auto dy = this->Origin[1] + j * this->Spacing[1] - x[1];
+                auto row = brick.data() +
+                    ((k - b[2] * brickLength) * brickLength +
+                     (j - b[1] * brickLength)) *
+                        brickLength;
+                for (auto i = first[0]; i <= last[0]; ++i)
+                {
+                  auto dx = this->Origin[0] + i * this->Spacing[0] - x[0];
+                  auto r2 = (dx * dx + dy * dy + dz * dz) /
+                      (this->Radius * this->Radius);
+                  if (r2 <= 1.0)
+                  {
+                    auto splat =
+                        static_cast<float>(std::exp(this->ExponentFactor * r2));
+                    auto& sample = row[i - b[0] * brickLength];
+                    sample = std::max(sample, splat);
+                  }
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  });
+
+  // Merge the bricks of the threads, one merged brick per task.
+  std::vector<std::pair<std::uint64_t, std::vector<float>*>> all;
+  for (auto& bricks : localBricks)
+  {
+    for (auto& brick : bricks)
+    {
+      all.emplace_back(brick.first, &brick.second);
+    }
+  }
+  std::sort(all.begin(), all.end(),
+            [](std::pair<std::uint64_t, std::vector<float>*> const& a,
+               std::pair<std::uint64_t, std::vector<float>*> const& b) {
+              return a.first < b.first;
+            });
+  std::vector<size_t> groups;
+  this->Keys.clear();
+  for (size_t i = 0; i < all.size(); ++i)
+  {
+    if (i == 0 || all[i].first != all[i - 1].first)
+    {
+      groups.push_back(i);
+      this->Keys.push_back(all[i].first);
+    }
+  }
+  groups.push_back(all.size());
+  this->Bricks.clear();
+  this->Bricks.resize(this->Keys.size());
+  vtkSMPTools::For(0, static_cast<vtkIdType>(this->Keys.size()),
+                   [&](vtkIdType begin, vtkIdType end) {
+                     for (auto g = begin; g < end; ++g)
+                     {
+                       auto& merged = this->Bricks[g];
+                       merged = std::move(*all[groups[g]].second);
+                       for (auto i = groups[g] + 1; i < groups[g + 1]; ++i)
+                       {
+                         auto const& other = *all[i].second;
+                         for (auto s = 0; s < BrickSamples; ++s)
+                         {
+                           merged[s] = std::max(merged[s], other[s]);
+                         }
+                       }
+                     }
+                   });
+}
+
+const float* SparseGaussianSplatter::FindBrick(std::uint64_t key) const
+{
+  auto found = std::lower_bound(this->Keys.begin(), this->Keys.end(), key);
+  if (found == this->Keys.end() || *found != key)
+  {
+    return nullptr;
+  }
+  return this->Bricks[found - this->Keys.begin()].data();
+}
+
+float SparseGaussianSplatter::GetSample(const int ijk[3],
+                                        std::uint64_t& lastKey,
+                                        const float*& lastBrick) const
+{
+  auto key = this->BrickKey(ijk[0] / BrickSize, ijk[1] / BrickSize,
+                            ijk[2] / BrickSize);
+  if (key != lastKey)
+  {
+    lastKey = key;
+    lastBrick = this->FindBrick(key);
+  }
+  if (!lastBrick)
+  {
+    return 0.0f;
+  }
+  return lastBrick[((ijk[2] % BrickSize) * BrickSize + ijk[1] % BrickSize) *
+                       BrickSize +
+                   ijk[0] % BrickSize];
+}
+
+vtkSmartPointer<vtkPolyData> SparseGaussianSplatter::Contour(double value)
+{
+  // Each brick contours the cells whose lowest corner it holds, so it also
+  // needs the first samples of the bricks above it.
+  auto numberOfBricks = static_cast<vtkIdType>(this->Keys.size());
+  std::vector<vtkSmartPointer<vtkPolyData>> pieces(numberOfBricks);
+  vtkSMPThreadLocalObject<vtkFlyingEdges3D> contours;
+  vtkSMPTools::For(0, numberOfBricks, [&](vtkIdType begin, vtkIdType end) {
+    auto contour = contours.Local();
+    contour->ComputeNormalsOff();
+    contour->ComputeGradientsOff();
+    contour->ComputeScalarsOff();
+    contour->SetValue(0, value);
+    for (auto b = begin; b < end; ++b)
+    {
+      auto key = this->Keys[b];
+      int first[3]{static_cast<int>(key & 0x1FFFFF) * BrickSize,
+                   static_cast<int>((key >> 21) & 0x1FFFFF) * BrickSize,
+                   static_cast<int>((key >> 42) & 0x1FFFFF) * BrickSize};
+      int dimensions[3];
+      for (auto j = 0; j < 3; ++j)
+      {
+        dimensions[j] = std::min(BrickSize + 1, this->Resolution - first[j]);
+      }
+      if (dimensions[0] < 2 || dimensions[1] < 2 || dimensions[2] < 2)
+      {
+        continue;
+      }
+
+      vtkNew<vtkFloatArray> samples;
+      samples->SetNumberOfTuples(dimensions[0] * dimensions[1] *
+                                 dimensions[2]);
+      auto sample = samples->GetPointer(0);
+      auto crosses = false;
+      std::uint64_t lastKey = ~std::uint64_t(0);
+      const float* lastBrick = nullptr;
+      int ijk[3];
+      for (auto k = 0; k < dimensions[2]; ++k)
+      {
+        ijk[2] = first[2] + k;
+        for (auto j = 0; j < dimensions[1]; ++j)
+        {
+          ijk[1] = first[1] + j;
+          for (auto i = 0; i < dimensions[0]; ++i)
+          {
+            ijk[0] = first[0] + i;
+            *sample = this->GetSample(ijk, lastKey, lastBrick);
+            crosses = crosses || *sample >= value;
+            ++sample;
+          }
+        }
+      }
+      if (!crosses)
+      {
+        continue;
+      }
+
+      vtkNew<vtkImageData> image;
+      image->SetDimensions(dimensions);
+      image->SetSpacing(this->Spacing);
+      image->SetOrigin(this->Origin[0] + first[0] * this->Spacing[0],
+                       this->Origin[1] + first[1] * this->Spacing[1],
+                       this->Origin[2] + first[2] * this->Spacing[2]);
+      image->GetPointData()->SetScalars(samples);
+      contour->SetInputData(image);
+      contour->Update();
+      pieces[b] = vtkSmartPointer<vtkPolyData>::New();
+      pieces[b]->DeepCopy(contour->GetOutput());
+    }
+  });
+
+  vtkNew<vtkAppendPolyData> append;
+  for (auto const& piece : pieces)
+  {
+    if (piece && piece->GetNumberOfCells() > 0)
+    {
+      append->AddInputData(piece);
+    }
+  }
+  if (append->GetNumberOfInputConnections(0) == 0)
+  {
+    return vtkSmartPointer<vtkPolyData>::New();
+  }
+
+  // The pieces share their points on the faces of the bricks, up to
+  // round off in the origins of the bricks.
+  vtkNew<vtkCleanPolyData> clean;
+  clean->SetInputConnection(append->GetOutputPort());
+  clean->SetTolerance(1e-7);
+  clean->ConvertPolysToLinesOff();
+  clean->Update();
+  vtkSmartPointer<vtkPolyData> surface = clean->GetOutput();
+  return surface;
+}
+} // namespace
@@ -0,0 +1,813 @@
+#include <vtkActor.h>
+#include <vtkCamera.h>
+#include <vtkCellArray.h>
+#include <vtkCellArrayIterator.h>
+#include <vtkDelaunay2D.h>
+#include <vtkDoubleArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSMPThreadLocalObject.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+/**
+ * Make a terrain survey: random sample points with the heights of a smooth
+ * landscape.
+ *
+ * @param numberOfPoints The number of samples.
+ * @return The samples, with their heights as point scalars.
+ */
+vtkSmartPointer<vtkPolyData> MakeTerrain(vtkIdType numberOfPoints);
+
+/**
+ * Canonical, sorted (smallest id first) triangles of a cell array.
+ *
+ * @param triangles The cells.
+ * @param ids Maps the point ids of the cells to other ids, may be nullptr.
+ * @return The sorted triangles.
+ */
+std::vector<std::array<vtkIdType, 3>>
+SortedTriangles(vtkCellArray* triangles, std::vector<vtkIdType> const* ids);
+
+/**
+ * The 2D Delaunay triangulation of points projected on the xy plane.
+ *
+ * The bounds of the points are split into tiles that are triangulated in
+ * parallel, each with its own vtkDelaunay2D. A tile triangulates the points
+ * inside it and inside a halo around it. A triangle of that local
+ * triangulation is kept only if its circumcircle holds none of the points
+ * outside the halo, as it is then a triangle of the global triangulation
+ * too. A tile owns the kept triangles whose centroid lies inside it. When
+ * the kept triangles do not cover the part of the convex hull inside the
+ * tile, the halo is doubled and the tile triangulated again.
+ *
+ * Points are inserted in BRIO order: rounds of doubling size, each sorted
+ * along a Hilbert curve, so that the point location walk of vtkDelaunay2D
+ * starts next to where the previous point went.
+ */
+class TiledDelaunay2D
+{
+public:
+  TiledDelaunay2D(vtkPoints* points);
+
+  /**
+   * Triangulate the points.
+   *
+   * @param tilesX The number of tiles along x.
+   * @param tilesY The number of tiles along y.
+   * @return The triangles.
+   */
+  vtkSmartPointer<vtkCellArray> Execute(int tilesX, int tilesY);
+
+  /**
+   * @return The number of times a tile had to grow its halo.
+   */
+  int GetNumberOfRetries() const
+  {
+    return this->Retries;
+  }
+
+  /**
+   * @return The point ids in insertion order.
+   */
+  std::vector<vtkIdType> const& GetInsertionOrder() const
+  {
+    return this->Order;
+  }
+
+private:
+  void Triangulate(int tile, vtkDelaunay2D* delaunay,
+                   std::vector<vtkIdType>& triangles);
+  void GatherPoints(const double region[4], std::vector<vtkIdType>& ids) const;
+  bool IsEmpty(const double center[2], double radius2,
+               const double region[4]) const;
+  void BuildHull();
+
+  vtkIdType NumberOfPoints = 0;
+  std::vector<double> XY;
+  double Bounds[4];
+  // The insertion order, and the position of each point in it.
+  std::vector<vtkIdType> Order;
+  std::vector<vtkIdType> Rank;
+  // The points bucketed in a uniform grid, in insertion order in each bin.
+  int Bins[2];
+  double BinSize[2];
+  std::vector<vtkIdType> BinStart;
+  std::vector<vtkIdType> BinPoints;
+  // The convex hull, counterclockwise.
+  std::vector<std::array<double, 2>> Hull;
+  int Tiles[2];
+  double TileSize[2];
+  std::atomic<int> Retries{0};
+};
+
+/**
+ * The area of a polygon clipped by a rectangle.
+ *
+ * @param polygon The polygon, convex.
+ * @param rectangle xmin, xmax, ymin, ymax.
+ * @return The area of the clipped polygon.
+ */
+double ClippedArea(std::vector<std::array<double, 2>> polygon,
+                   const double rectangle[4]);
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  vtkIdType numberOfPoints = 500000;
+  auto tiles = 8;
+  auto compare = false;
+  auto position = 0;
+  for (auto i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "-c")
+    {
+      compare = true;
+    }
+    else if (position == 0)
+    {
+      numberOfPoints = std::atoll(argv[i]);
+      ++position;
+    }
+    else if (position == 1)
+    {
+      tiles = std::atoi(argv[i]);
+      ++position;
+    }
+    else
+    {
+      std::cout << "Usage: " << argv[0] << " [numberOfPoints] [tiles] [-c]"
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (numberOfPoints < 3 || tiles < 1)
+  {
+    std::cout << "numberOfPoints must be at least 3 and tiles positive."
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkNew<vtkNamedColors> colors;
+
+  auto terrain = MakeTerrain(numberOfPoints);
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  TiledDelaunay2D triangulator(terrain->GetPoints());
+  timer->StopTimer();
+  auto sortTime = timer->GetElapsedTime();
+
+  timer->StartTimer();
+  auto triangles = triangulator.Execute(tiles, tiles);
+  timer->StopTimer();
+
+  std::cout << "Points: " << numberOfPoints << ", tiles: " << tiles << "x"
+            << tiles << std::endl;
+  std::cout << "Tiled" << std::endl;
+  std::cout << "  Sort and bin:  " << sortTime << " s" << std::endl;
+  std::cout << "  Triangulation: " << timer->GetElapsedTime() << " s"
+            << std::endl;
+  std::cout << "  Triangles:     " << triangles->GetNumberOfCells()
+            << std::endl;
+  std::cout << "  Halo retries:  " << triangulator.GetNumberOfRetries()
+            << std::endl;
+
+  if (compare)
+  {
+    auto tiled = SortedTriangles(triangles, nullptr);
+
+    // The whole survey on one thread, in the order of the input.
+    vtkNew<vtkDelaunay2D> delaunay;
+    delaunay->SetInputData(terrain);
+    timer->StartTimer();
+    delaunay->Update();
+    timer->StopTimer();
+    auto serial = SortedTriangles(delaunay->GetOutput()->GetPolys(), nullptr);
+    std::vector<std::array<vtkIdType, 3>> common;
+    std::set_intersection(tiled.begin(), tiled.end(), serial.begin(),
+                          serial.end(), std::back_inserter(common));
+    std::cout << "vtkDelaunay2D" << std::endl;
+    std::cout << "  Triangulation: " << timer->GetElapsedTime() << " s"
+              << std::endl;
+    std::cout << "  Triangles:     " << serial.size() << ", " << common.size()
+              << " of them also tiled" << std::endl;
+
+    // The same, with the points in insertion order.
+    auto const& order = triangulator.GetInsertionOrder();
+    vtkNew<vtkPoints> sortedPoints;
+    sortedPoints->SetNumberOfPoints(numberOfPoints);
+    for (vtkIdType i = 0; i < numberOfPoints; ++i)
+    {
+      sortedPoints->SetPoint(i, terrain->GetPoint(order[i]));
+    }
+    vtkNew<vtkPolyData> sorted;
+    sorted->SetPoints(sortedPoints);
+    delaunay->SetInputData(sorted);
+    timer->StartTimer();
+    delaunay->Update();
+    timer->StopTimer();
+    std::cout << "vtkDelaunay2D, points in BRIO order" << std::endl;
+    std::cout << "  Triangulation: " << timer->GetElapsedTime() << " s"
+              << std::endl;
+    std::cout << "  Triangles:     "
+              << SortedTriangles(delaunay->GetOutput()->GetPolys(), &order)
+                     .size()
+              << std::endl;
+  }
+
+  vtkNew<vtkPolyData> mesh;
+  mesh->SetPoints(terrain->GetPoints());
+  mesh->SetPolys(triangles);
+  mesh->GetPointData()->SetScalars(terrain->GetPointData()->GetScalars());
+
+  vtkNew<vtkPolyDataMapper> mapper;
+  mapper->SetInputData(mesh);
+  mapper->SetScalarRange(mesh->GetScalarRange());
+
+  vtkNew<vtkActor> actor;
+  actor->SetMapper(mapper);
+
+  vtkNew<vtkRenderer> renderer;
+  renderer->AddActor(actor);
+  renderer->SetBackground(colors->GetColor3d("SlateGray").GetData());
+
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->AddRenderer(renderer);
+  renderWindow->SetSize(640, 480);
+  renderWindow->SetWindowName("TiledDelaunay2D");
+
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  renderWindowInteractor->SetRenderWindow(renderWindow);
+
+  renderer->ResetCamera();
+  renderer->GetActiveCamera()->Elevation(-50);
+  renderer->GetActiveCamera()->Azimuth(20);
+  renderer->ResetCameraClippingRange();
+
+  renderWindow->Render();
+  renderWindowInteractor->Start();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+vtkSmartPointer<vtkPolyData> MakeTerrain(vtkIdType numberOfPoints)
+{
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  random->SetSeed(8775070);
+
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(numberOfPoints);
+
+  vtkNew<vtkDoubleArray> heights;
+  heights->SetName("Elevation");
+  heights->SetNumberOfTuples(numberOfPoints);
+
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    auto x = random->GetRangeValue(0.0, 1000.0);
+    random->Next();
+    auto y = random->GetRangeValue(0.0, 1000.0);
+    random->Next();
+    // Rolling hills with a ridge across them.
+    auto ridge = (x - y) / 150.0;
+    auto z = 40.0 * std::sin(x / 130.0) * std::cos(y / 170.0) +
+        60.0 * std::exp(-ridge * ridge);
+    points->SetPoint(i, x, y, z);
+    heights->SetValue(i, z);
+  }
+
+  auto terrain = vtkSmartPointer<vtkPolyData>::New();
+  terrain->SetPoints(points);
+  terrain->GetPointData()->SetScalars(heights);
+  return terrain;
+}
+
+std::vector<std::array<vtkIdType, 3>>
+SortedTriangles(vtkCellArray* triangles, std::vector<vtkIdType> const* ids)
+{
+  std::vector<std::array<vtkIdType, 3>> sorted;
+  sorted.reserve(triangles->GetNumberOfCells());
+  auto iter = vtk::TakeSmartPointer(triangles->NewIterator());
+  for (iter->GoToFirstCell(); !iter->IsDoneWithTraversal();
+       iter->GoToNextCell())
+  {
+    vtkIdType npts;
+    const vtkIdType* pts;
+    iter->GetCurrentCell(npts, pts);
+    if (npts != 3)
+    {
+      continue;
+    }
+    std::array<vtkIdType, 3> triangle;
+    for (auto i = 0; i < 3; ++i)
+    {
+      triangle[i] = ids ? (*ids)[pts[i]] : pts[i];
+    }
+    std::sort(triangle.begin(), triangle.end());
+    sorted.push_back(triangle);
+  }
+  std::sort(sorted.begin(), sorted.end());
+  return sorted;
+}
+
+/**
+ * The distance of a point along a Hilbert curve through a 2^16 x 2^16 grid.
+ */
+std::uint64_t HilbertIndex(std::uint32_t x, std::uint32_t y)
+{
+  const std::uint32_t n = 1u << 16;
+  std::uint64_t d = 0;
+  for (auto s = n / 2; s > 0; s /= 2)
+  {
+    std::uint32_t rx = (x & s) > 0;
+    std::uint32_t ry = (y & s) > 0;
+    d += static_cast<std::uint64_t>(s) * s * ((3 * rx) ^ ry);
+    if (ry == 0)
+    {
+      if (rx == 1)
+      {
+        x = n - 1 - x;
+        y = n - 1 - y;
+      }
+      std::swap(x, y);
+    }
+  }
+  return d;
+}
+
+TiledDelaunay2D::TiledDelaunay2D(vtkPoints* points)
+{
+  this->NumberOfPoints = points->GetNumberOfPoints();
+  auto n = this->NumberOfPoints;
+  this->XY.resize(2 * n);
+  vtkSMPTools::For(0, n, [&](vtkIdType begin, vtkIdType end) {
+    for (auto i = begin; i < end; ++i)
+    {
+      double x[3];
+      points->GetPoint(i, x);
+      this->XY[2 * i] = x[0];
+      this->XY[2 * i + 1] = x[1];
+    }
+  });
+  double bounds[6];
+  points->GetBounds(bounds);
+  this->Bounds[0] = bounds[0];
+  this->Bounds[1] = bounds[1];
+  this->Bounds[2] = bounds[2];
+  this->Bounds[3] = bounds[3];
+  auto width = std::max(this->Bounds[1] - this->Bounds[0], 1e-300);
+  auto height = std::max(this->Bounds[3] - this->Bounds[2], 1e-300);
+
+  // BRIO: a point goes in round k with probability 2^-(k+1), the rounds are
+  // inserted from the smallest to the largest. A hash of the id replaces the
+  // coin flips so that the keys can be made in parallel.
+  const int rounds = 20;
+  std::vector<std::pair<std::uint64_t, vtkIdType>> keys(n);
+  vtkSMPTools::For(0, n, [&](vtkIdType begin, vtkIdType end) {
+    for (auto i = begin; i < end; ++i)
+    {
+      auto hash = static_cast<std::uint64_t>(i) * 0x9E3779B97F4A7C15ull;
+      hash ^= hash >> 29;
+      hash *= 0xBF58476D1CE4E5B9ull;
+      hash ^= hash >> 32;
+      auto round = 0;
+      while (round < rounds && (hash & 1))
+      {
+        hash >>= 1;
+        ++round;
+      }
+      auto qx = static_cast<std::uint32_t>((this->XY[2 * i] - this->Bounds[0]) /
+                                           width * 65535.0);
+      auto qy = static_cast<std::uint32_t>(
+          (this->XY[2 * i + 1] - this->Bounds[2]) / height * 65535.0);
+      keys[i].first = (static_cast<std::uint64_t>(rounds - round) << 32) |
+          HilbertIndex(qx, qy);
+      keys[i].second = i;
+    }
+  });
+  vtkSMPTools::Sort(keys.begin(), keys.end());
+  this->Order.resize(n);
+  this->Rank.resize(n);
+  vtkSMPTools::For(0, n, [&](vtkIdType begin, vtkIdType end) {
+    for (auto i = begin; i < end; ++i)
+    {
+      this->Order[i] = keys[i].second;
+      this->Rank[keys[i].second] = i;
+    }
+  });
+
+  // About four points per bin.
+  auto cells = std::max(static_cast<double>(n) / 4.0, 1.0);
+  this->Bins[0] = std::max(
+      1, std::min(65536, static_cast<int>(std::sqrt(cells * width / height))));
+  this->Bins[1] = std::max(
+      1, std::min(65536, static_cast<int>(cells / this->Bins[0])));
+  this->BinSize[0] = width / this->Bins[0];
+  this->BinSize[1] = height / this->Bins[1];
+  this->BinStart.assign(
+      static_cast<size_t>(this->Bins[0]) * this->Bins[1] + 1, 0);
+  std::vector<vtkIdType> bin(n);
+  vtkSMPTools::For(0, n, [&](vtkIdType begin, vtkIdType end) {
+    for (auto i = begin; i < end; ++i)
+    {
+      auto bx = std::min(
+          static_cast<int>((this->XY[2 * i] - this->Bounds[0]) /
+                           this->BinSize[0]),
+          this->Bins[0] - 1);
+      auto by = std::min(
+          static_cast<int>((this->XY[2 * i + 1] - this->Bounds[2]) /
+                           this->BinSize[1]),
+          this->Bins[1] - 1);
+      bin[i] = static_cast<vtkIdType>(by) * this->Bins[0] + bx;
+    }
+  });
+  for (vtkIdType i = 0; i < n; ++i)
+  {
+    ++this->BinStart[bin[i] + 1];
+  }
+  for (size_t i = 1; i < this->BinStart.size(); ++i)
+  {
+    this->BinStart[i] += this->BinStart[i - 1];
+  }
+  this->BinPoints.resize(n);
+  std::vector<vtkIdType> next(this->BinStart.begin(), this->BinStart.end() - 1);
+  for (auto id : this->Order)
+  {
+    this->BinPoints[next[bin[id]]++] = id;
+  }
+
+  this->BuildHull();
+}
+
+void TiledDelaunay2D::BuildHull()
+{
+  // Andrew's monotone chain.
+  std::vector<vtkIdType> ids(this->Order);
+  auto const& xy = this->XY;
+  vtkSMPTools::Sort(ids.begin(), ids.end(), [&xy](vtkIdType a, vtkIdType b) {
+    return xy[2 * a] < xy[2 * b] ||
+        (xy[2 * a] == xy[2 * b] && xy[2 * a + 1] < xy[2 * b + 1]);
+  });
+  auto cross = [&xy](vtkIdType o, vtkIdType a, vtkIdType b) {
+    return (xy[2 * a] - xy[2 * o]) * (xy[2 * b + 1] - xy[2 * o + 1]) -
+        (xy[2 * a + 1] - xy[2 * o + 1]) * (xy[2 * b] - xy[2 * o]);
+  };
+  std::vector<vtkIdType> hull(2 * ids.size());
+  size_t k = 0;
+  for (size_t i = 0; i < ids.size(); ++i)
+  {
+    while (k >= 2 && cross(hull[k - 2], hull[k - 1], ids[i]) <= 0)
+    {
+      --k;
+    }
+    hull[k++] = ids[i];
+  }
+  for (size_t i = ids.size() - 1, lower = k + 1; i > 0; --i)
+  {
+    while (k >= lower && cross(hull[k - 2], hull[k - 1], ids[i - 1]) <= 0)
+    {
+      --k;
+    }
+    hull[k++] = ids[i - 1];
+  }
+  this->Hull.clear();
+  for (size_t i = 0; i + 1 < k; ++i)
+  {
+    this->Hull.push_back({xy[2 * hull[i]], xy[2 * hull[i] + 1]});
+  }
+}
+
+vtkSmartPointer<vtkCellArray> TiledDelaunay2D::Execute(int tilesX, int tilesY)
+{
+  this->Tiles[0] = tilesX;
+  this->Tiles[1] = tilesY;
+  this->TileSize[0] = (this->Bounds[1] - this->Bounds[0]) / tilesX;
+  this->TileSize[1] = (this->Bounds[3] - this->Bounds[2]) / tilesY;
+  this->Retries = 0;
+
+  // One task per tile, the tiles vary a lot in cost.
+  auto numberOfTiles = tilesX * tilesY;
+  std::vector<std::vector<vtkIdType>> tileTriangles(numberOfTiles);
+  vtkSMPThreadLocalObject<vtkDelaunay2D> delaunays;
+  vtkSMPTools::For(0, numberOfTiles, 1, [&](vtkIdType begin, vtkIdType end) {
+    auto delaunay = delaunays.Local();
+    for (auto tile = begin; tile < end; ++tile)
+    {
+      this->Triangulate(tile, delaunay, tileTriangles[tile]);
+    }
+  });
+
+  std::vector<vtkIdType> start(numberOfTiles + 1, 0);
+  for (auto tile = 0; tile < numberOfTiles; ++tile)
+  {
+    start[tile + 1] =
+        start[tile] + static_cast<vtkIdType>(tileTriangles[tile].size());
+  }
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfValues(start[numberOfTiles]);
+  vtkNew<vtkIdTypeArray> offsets;
+  offsets->SetNumberOfValues(start[numberOfTiles] / 3 + 1);
+  offsets->SetValue(0, 0);
+  vtkSMPTools::For(0, numberOfTiles, [&](vtkIdType begin, vtkIdType end) {
+    for (auto tile = begin; tile < end; ++tile)
+    {
+      auto const& triangles = tileTriangles[tile];
+      std::copy(triangles.begin(), triangles.end(),
+                connectivity->GetPointer(start[tile]));
+      for (vtkIdType i = 3; i <= static_cast<vtkIdType>(triangles.size());
+           i += 3)
+      {
+        offsets->SetValue((start[tile] + i) / 3, start[tile] + i);
+      }
+    }
+  });
+
+  auto cells = vtkSmartPointer<vtkCellArray>::New();
+  cells->SetData(offsets, connectivity);
+  return cells;
+}
+
+void TiledDelaunay2D::Triangulate(int tile, vtkDelaunay2D* delaunay,
+                                  std::vector<vtkIdType>& triangles)
+{
+  auto tx = tile % this->Tiles[0];
+  auto ty = tile / this->Tiles[0];
+  double core[4]{this->Bounds[0] + tx * this->TileSize[0],
+                 this->Bounds[0] + (tx + 1) * this->TileSize[0],
+                 this->Bounds[2] + ty * this->TileSize[1],
+                 this->Bounds[2] + (ty + 1) * this->TileSize[1]};
+  auto coreArea = this->TileSize[0] * this->TileSize[1];
+  auto hullArea = ClippedArea(this->Hull, core);
+
+  std::vector<vtkIdType> ids;
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToDouble();
+  vtkNew<vtkPolyData> polyData;
+  polyData->SetPoints(points);
+  auto halo = 0.25 * std::max(this->TileSize[0], this->TileSize[1]);
+  for (;;)
+  {
+    triangles.clear();
+    double region[4]{core[0] - halo, core[1] + halo, core[2] - halo,
+                     core[3] + halo};
+    auto whole = region[0] <= this->Bounds[0] &&
+        region[1] >= this->Bounds[1] && region[2] <= this->Bounds[2] &&
+        region[3] >= this->Bounds[3];
+
+    this->GatherPoints(region, ids);
+    points->SetNumberOfPoints(static_cast<vtkIdType>(ids.size()));
+    for (size_t i = 0; i < ids.size(); ++i)
+    {
+      points->SetPoint(static_cast<vtkIdType>(i), this->XY[2 * ids[i]],
+                       this->XY[2 * ids[i] + 1], 0.0);
+    }
+    points->Modified();
+    delaunay->SetInputData(polyData);
+    delaunay->Update();
+
+    auto covered = 0.0;
+    auto iter =
+        vtk::TakeSmartPointer(delaunay->GetOutput()->GetPolys()->NewIterator());
+    for (iter->GoToFirstCell(); !iter->IsDoneWithTraversal();
+         iter->GoToNextCell())
+    {
+      vtkIdType npts;
+      const vtkIdType* pts;
+      iter->GetCurrentCell(npts, pts);
+      if (npts != 3)
+      {
+        continue;
+      }
+      std::vector<std::array<double, 2>> corners(3);
+      for (auto i = 0; i < 3; ++i)
+      {
+        corners[i] = {this->XY[2 * ids[pts[i]]], this->XY[2 * ids[pts[i]] + 1]};
+      }
+      auto xmin = std::min({corners[0][0], corners[1][0], corners[2][0]});
+      auto xmax = std::max({corners[0][0], corners[1][0], corners[2][0]});
+      auto ymin = std::min({corners[0][1], corners[1][1], corners[2][1]});
+      auto ymax = std::max({corners[0][1], corners[1][1], corners[2][1]});
+      if (xmax < core[0] || xmin > core[1] || ymax < core[2] || ymin > core[3])
+      {
+        continue;
+      }
+
+      // The circumcircle, relative to the first corner.
+      auto bx = corners[1][0] - corners[0][0];
+      auto by = corners[1][1] - corners[0][1];
+      auto cx = corners[2][0] - corners[0][0];
+      auto cy = corners[2][1] - corners[0][1];
+      auto d = 2.0 * (bx * cy - by * cx);
+      if (d == 0.0)
+      {
+        continue;
+      }
+      auto b2 = bx * bx + by * by;
+      auto c2 = cx * cx + cy * cy;
+      auto ux = (cy * b2 - by * c2) / d;
+      auto uy = (bx * c2 - cx * b2) / d;
+      double center[2]{corners[0][0] + ux, corners[0][1] + uy};
+      if (!whole && !this->IsEmpty(center, ux * ux + uy * uy, region))
+      {
+        continue;
+      }
+
+      covered += ClippedArea(corners, core);
+      auto centroidX = (corners[0][0] + corners[1][0] + corners[2][0]) / 3.0;
+      auto centroidY = (corners[0][1] + corners[1][1] + corners[2][1]) / 3.0;
+      auto ownerX = std::min(
+          std::max(static_cast<int>((centroidX - this->Bounds[0]) /
+                                    this->TileSize[0]),
+                   0),
+          this->Tiles[0] - 1);
+      auto ownerY = std::min(
+          std::max(static_cast<int>((centroidY - this->Bounds[2]) /
+                                    this->TileSize[1]),
+                   0),
+          this->Tiles[1] - 1);
+      if (ownerX == tx && ownerY == ty)
+      {
+        triangles.insert(triangles.end(),
+                         {ids[pts[0]], ids[pts[1]], ids[pts[2]]});
+      }
+    }
+
+    // Points exactly on the hull may be dropped as slivers, hence the
+    // tolerance.
+    if (whole || std::abs(covered - hullArea) <= 1e-6 * coreArea)
+    {
+      break;
+    }
+    halo *= 2.0;
+    ++this->Retries;
+  }
+}
+
+void TiledDelaunay2D::GatherPoints(const double region[4],
+                                   std::vector<vtkIdType>& ids) const
+{
+  ids.clear();
+  auto bx0 = std::max(
+      0, static_cast<int>((region[0] - this->Bounds[0]) / this->BinSize[0]));
+  auto bx1 = std::min(
+      this->Bins[0] - 1,
+      static_cast<int>((region[1] - this->Bounds[0]) / this->BinSize[0]));
+  auto by0 = std::max(
+      0, static_cast<int>((region[2] - this->Bounds[2]) / this->BinSize[1]));
+  auto by1 = std::min(
+      this->Bins[1] - 1,
+      static_cast<int>((region[3] - this->Bounds[2]) / this->BinSize[1]));
+  for (auto by = by0; by <= by1; ++by)
+  {
+    for (auto bx = bx0; bx <= bx1; ++bx)
+    {
+      auto bin = static_cast<vtkIdType>(by) * this->Bins[0] + bx;
+      for (auto i = this->BinStart[bin]; i < this->BinStart[bin + 1]; ++i)
+      {
+        auto id = this->BinPoints[i];
+        auto x = this->XY[2 * id];
+        auto y = this->XY[2 * id + 1];
+        if (x >= region[0] && x <= region[1] && y >= region[2] &&
+            y <= region[3])
+        {
+          ids.push_back(id);
+        }
+      }
+    }
+  }
+  // Keep the insertion order.
+  auto const& rank = this->Rank;
+  std::sort(ids.begin(), ids.end(),
+            [&rank](vtkIdType a, vtkIdType b) { return rank[a] < rank[b]; });
+}
+
+bool TiledDelaunay2D::IsEmpty(const double center[2], double radius2,
+                              const double region[4]) const
+{
+  auto radius = std::sqrt(radius2);
+  if (center[0] - radius >= region[0] && center[0] + radius <= region[1] &&
+      center[1] - radius >= region[2] && center[1] + radius <= region[3])
+  {
+    return true;
+  }
+  // Points on the circle do not count.
+  auto inside = radius2 * (1.0 - 1e-9);
+  auto by0 = std::max(0.0, (center[1] - radius - this->Bounds[2]) /
+                               this->BinSize[1]);
+  auto by1 = std::min(static_cast<double>(this->Bins[1] - 1),
+                      (center[1] + radius - this->Bounds[2]) /
+                          this->BinSize[1]);
+  for (auto by = static_cast<int>(by0); by <= static_cast<int>(by1); ++by)
+  {
+    // Only the bins of this row that the circle reaches.
+    auto y0 = this->Bounds[2] + by * this->BinSize[1];
+    auto y1 = y0 + this->BinSize[1];
+    auto dy = std::min(std::max(center[1], y0), y1) - center[1];
+    if (dy * dy > radius2)
+    {
+      continue;
+    }
+    auto half = std::sqrt(radius2 - dy * dy);
+    auto bx0 = std::max(0.0, (center[0] - half - this->Bounds[0]) /
+                                 this->BinSize[0]);
+    auto bx1 = std::min(static_cast<double>(this->Bins[0] - 1),
+                        (center[0] + half - this->Bounds[0]) /
+                            this->BinSize[0]);
+    for (auto bx = static_cast<int>(bx0); bx <= static_cast<int>(bx1); ++bx)
+    {
+      auto x0 = this->Bounds[0] + bx * this->BinSize[0];
+      auto x1 = x0 + this->BinSize[0];
+      if (x0 >= region[0] && x1 <= region[1] && y0 >= region[2] &&
+          y1 <= region[3])
+      {
+        continue;
+      }
+      auto bin = static_cast<vtkIdType>(by) * this->Bins[0] + bx;
+      for (auto i = this->BinStart[bin]; i < this->BinStart[bin + 1]; ++i)
+      {
+        auto id = this->BinPoints[i];
+        auto x = this->XY[2 * id];
+        auto y = this->XY[2 * id + 1];
+        if (x >= region[0] && x <= region[1] && y >= region[2] &&
+            y <= region[3])
+        {
+          continue;
+        }
+        auto ex = x - center[0];
+        auto ey = y - center[1];
+        if (ex * ex + ey * ey < inside)
+        {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+double ClippedArea(std::vector<std::array<double, 2>> polygon,
+                   const double rectangle[4])
+{
+  // Sutherland-Hodgman, one side of the rectangle at a time.
+  std::vector<std::array<double, 2>> clipped;
+  for (auto side = 0; side < 4 && !polygon.empty(); ++side)
+  {
+    auto axis = side / 2;
+    auto sign = side % 2 == 0 ? 1.0 : -1.0;
+    auto value = rectangle[side];
+    clipped.clear();
+    for (size_t i = 0; i < polygon.size(); ++i)
+    {
+      auto const& p = polygon[i];
+      auto const& q = polygon[(i + 1) % polygon.size()];
+      auto dp = sign * (p[axis] - value);
+      auto dq = sign * (q[axis] - value);
+      if (dp >= 0.0)
+      {
+        clipped.push_back(p);
+      }
+      if ((dp >= 0.0) != (dq >= 0.0))
+      {
+        auto t = dp / (dp - dq);
+        clipped.push_back({p[0] + t * (q[0] - p[0]), p[1] + t * (q[1] - p[1])});
+      }
+    }
+    polygon.swap(clipped);
+  }
+  auto area = 0.0;
+  for (size_t i = 0; i < polygon.size(); ++i)
+  {
+    auto const& p = polygon[i];
+    auto const& q = polygon[(i + 1) % polygon.size()];
+    area += p[0] * q[1] - q[0] * p[1];
+  }
+  return 0.5 * std::abs(area);
+}
+} // namespace
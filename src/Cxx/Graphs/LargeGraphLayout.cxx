@@ -0,0 +1,572 @@
+#include <vtkCommand.h>
+#include <vtkDoubleArray.h>
+#include <vtkEdgeListIterator.h>
+#include <vtkGraphLayout.h>
+#include <vtkGraphLayoutStrategy.h>
+#include <vtkGraphLayoutView.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkMutableGraphHelper.h>
+#include <vtkMutableUndirectedGraph.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPoints.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Add numberOfVertices vertices to the graph, each one joined to a randomly
+// chosen existing vertex, plus numberOfExtraEdges random edges.
+void GrowGraph(vtkMutableGraphHelper* helper, vtkIdType numberOfVertices,
+               vtkIdType numberOfExtraEdges,
+               vtkMinimalStandardRandomSequence* rng);
+
+// A Fruchterman-Reingold force directed layout whose repulsion is
+// approximated with a Barnes-Hut quadtree, so each iteration is O(V log V)
+// instead of O(V^2). The quadtree is built serially, then the forces on the
+// vertices and their moves are computed in parallel with vtkSMPTools.
+//
+// The ideal edge length is one, and the vertices start spread over a square
+// of side sqrt(V). If the graph already has positions, as when vertices are
+// added, the layout starts from them.
+class BarnesHutLayoutStrategy : public vtkGraphLayoutStrategy
+{
+public:
+  static BarnesHutLayoutStrategy* New();
+  vtkTypeMacro(BarnesHutLayoutStrategy, vtkGraphLayoutStrategy);
+
+  void Initialize() override;
+  void Layout() override;
+  int IsLayoutComplete() override
+  {
+    return this->Iteration >= this->MaxNumberOfIterations;
+  }
+
+  vtkSetMacro(MaxNumberOfIterations, int);
+  vtkSetMacro(IterationsPerLayout, int);
+  // The largest move in the first iteration, in tenths of the side of the
+  // square. It falls linearly to zero over the iterations.
+  vtkSetMacro(InitialTemperature, double);
+  // A cell of the quadtree acts as a single body on the vertices further
+  // from it than its size divided by Theta.
+  vtkSetMacro(Theta, double);
+  vtkSetMacro(RandomSeed, int);
+
+private:
+  // Coincident vertices stop the subdivision here and share a leaf.
+  static constexpr int MaxDepth = 32;
+
+  struct Node
+  {
+    double Center[2] = {0.0, 0.0};
+    double HalfSize = 0.0;
+    // The number of vertices in the cell and the sum of their positions,
+    // then their centre of mass once the tree is built.
+    double Mass = 0.0;
+    double CenterOfMass[2] = {0.0, 0.0};
+    // The vertex of a leaf, -1 for the other cells.
+    vtkIdType Body = -1;
+    int Children[4] = {-1, -1, -1, -1};
+  };
+
+  void BuildTree(const double* coordinates, vtkIdType numberOfVertices);
+  void Insert(const double* coordinates, vtkIdType vertex);
+  // The child of the cell on the side of p, created if need be.
+  int Child(int index, const double* p);
+  void AddRepulsion(const double* coordinates, vtkIdType vertex,
+                    double force[2]) const;
+
+  int MaxNumberOfIterations = 200;
+  int IterationsPerLayout = 5;
+  double InitialTemperature = 1.0;
+  double Theta = 0.8;
+  int RandomSeed = 1;
+
+  int Iteration = 0;
+  double Width = 1.0;
+  vtkSmartPointer<vtkDoubleArray> Coordinates;
+  // The neighbours of each vertex, in compressed row storage.
+  std::vector<vtkIdType> NeighbourOffsets;
+  std::vector<vtkIdType> Neighbours;
+  std::vector<Node> Tree;
+  std::vector<double> Moves;
+};
+
+// Run layout iterations until either the layout converges or the time budget
+// (in seconds) for this frame is used up.
+class LayoutCallback : public vtkCommand
+{
+public:
+  static LayoutCallback* New()
+  {
+    return new LayoutCallback;
+  }
+
+  void Execute(vtkObject* caller, unsigned long eventId,
+               void* vtkNotUsed(callData)) override
+  {
+    auto iren = static_cast<vtkRenderWindowInteractor*>(caller);
+    if (eventId == vtkCommand::KeyPressEvent)
+    {
+      std::string key = iren->GetKeySym();
+      if (key == "a")
+      {
+        this->AddVertices();
+      }
+      return;
+    }
+    if (this->Layout->IsLayoutComplete())
+    {
+      return;
+    }
+
+    auto start = vtkTimerLog::GetUniversalTime();
+    auto elapsed = 0.0;
+    auto steps = 0;
+    do
+    {
+      // Each update runs another IterationsPerLayout iterations, starting
+      // from the positions reached by the previous update.
+      this->Layout->Modified();
+      this->Layout->Update();
+      ++steps;
+      elapsed = vtkTimerLog::GetUniversalTime() - start;
+    } while (!this->Layout->IsLayoutComplete() && elapsed < this->TimeBudget);
+    this->LayoutTime += elapsed;
+
+    if (this->Layout->IsLayoutComplete())
+    {
+      std::cout << "Layout of "
+                << this->Helper->GetGraph()->GetNumberOfVertices()
+                << " vertices completed in " << this->LayoutTime << " s."
+                << std::endl;
+    }
+    else if (steps > 1 && this->FirstFrame)
+    {
+      std::cout << "Running " << steps << " layout steps per frame."
+                << std::endl;
+    }
+    this->FirstFrame = false;
+    this->View->ResetCamera();
+    this->View->Render();
+  }
+
+  // Grow the graph and warm start the layout from the current positions,
+  // placing each new vertex on top of the vertex it is attached to.
+  void AddVertices()
+  {
+    auto graph = this->Helper->GetGraph();
+    auto numberOfOldVertices = graph->GetNumberOfVertices();
+
+    vtkNew<vtkPoints> points;
+    points->DeepCopy(this->Layout->GetOutput()->GetPoints());
+
+    GrowGraph(this->Helper, this->GrowBy, this->GrowBy / 2, this->Rng);
+
+    for (vtkIdType v = numberOfOldVertices; v < graph->GetNumberOfVertices();
+         ++v)
+    {
+      double p[3];
+      points->GetPoint(graph->GetOutEdge(v, 0).Target, p);
+      points->InsertNextPoint(p);
+    }
+    graph->SetPoints(points);
+
+    // The existing vertices are already close to equilibrium so start
+    // cooler than a layout from scratch.
+    this->Strategy->SetInitialTemperature(this->WarmStartTemperature);
+
+    // The new input restarts the layout, so the timer resumes stepping it.
+    this->Layout->Update();
+    this->LayoutTime = 0.0;
+    this->FirstFrame = true;
+    std::cout << "Added " << graph->GetNumberOfVertices() - numberOfOldVertices
+              << " vertices, relaying out." << std::endl;
+  }
+
+  vtkGraphLayout* Layout = nullptr;
+  BarnesHutLayoutStrategy* Strategy = nullptr;
+  vtkGraphLayoutView* View = nullptr;
+  vtkMutableGraphHelper* Helper = nullptr;
+  vtkMinimalStandardRandomSequence* Rng = nullptr;
+  double TimeBudget = 0.03;
+  double WarmStartTemperature = 0.2;
+  vtkIdType GrowBy = 1000;
+
+private:
+  double LayoutTime = 0.0;
+  bool FirstFrame = true;
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  vtkIdType numberOfVertices = 20000;
+  auto timeBudget = 30.0;
+  if (argc > 1)
+  {
+    numberOfVertices = std::atoi(argv[1]);
+  }
+  if (argc > 2)
+  {
+    timeBudget = std::atof(argv[2]);
+  }
+  if (numberOfVertices < 2 || timeBudget <= 0.0)
+  {
+    std::cout << "Usage: " << argv[0]
+              << " [numberOfVertices] [timeBudgetInMilliseconds]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkNew<vtkNamedColors> colors;
+
+  vtkNew<vtkMinimalStandardRandomSequence> rng;
+  // This ensures repeatable results for testing. Turn this off for real use.
+  rng->SetSeed(8775070);
+
+  vtkNew<vtkMutableUndirectedGraph> graph;
+  vtkNew<vtkMutableGraphHelper> helper;
+  helper->SetGraph(graph);
+  helper->AddVertex();
+  GrowGraph(helper, numberOfVertices - 1, numberOfVertices / 2, rng);
+  std::cout << "Graph has " << graph->GetNumberOfVertices() << " vertices and "
+            << graph->GetNumberOfEdges() << " edges." << std::endl;
+
+  // Unlike vtkForceDirectedLayoutStrategy, which sums the repulsion between
+  // every pair of vertices on one thread, the strategy approximates it with
+  // a quadtree and computes the forces on the vertices in parallel.
+  vtkNew<BarnesHutLayoutStrategy> strategy;
+  strategy->SetMaxNumberOfIterations(200);
+  strategy->SetIterationsPerLayout(5);
+
+  // Drive the layout ourselves so that it can be advanced a few iterations
+  // at a time, the view just draws whatever positions have been reached.
+  vtkNew<vtkGraphLayout> layout;
+  layout->SetInputData(graph);
+  layout->SetLayoutStrategy(strategy);
+  layout->Update();
+
+  vtkNew<vtkGraphLayoutView> graphLayoutView;
+  graphLayoutView->AddRepresentationFromInputConnection(
+      layout->GetOutputPort());
+  graphLayoutView->SetLayoutStrategyToPassThrough();
+  graphLayoutView->SetEdgeLayoutStrategyToPassThrough();
+  graphLayoutView->GetRenderer()->SetBackground(
+      colors->GetColor3d("Navy").GetData());
+  graphLayoutView->GetRenderer()->SetBackground2(
+      colors->GetColor3d("MidnightBlue").GetData());
+  graphLayoutView->GetRenderWindow()->SetWindowName("LargeGraphLayout");
+  graphLayoutView->ResetCamera();
+  graphLayoutView->Render();
+
+  vtkNew<LayoutCallback> callback;
+  callback->Layout = layout;
+  callback->Strategy = strategy;
+  callback->View = graphLayoutView;
+  callback->Helper = helper;
+  callback->Rng = rng;
+  callback->TimeBudget = timeBudget / 1000.0;
+  callback->GrowBy = std::max<vtkIdType>(numberOfVertices / 20, 1);
+
+  auto iren = graphLayoutView->GetInteractor();
+  iren->Initialize();
+  iren->AddObserver(vtkCommand::TimerEvent, callback);
+  iren->AddObserver(vtkCommand::KeyPressEvent, callback);
+  iren->CreateRepeatingTimer(static_cast<unsigned long>(timeBudget) + 10);
+
+  std::cout << "Press 'a' to add vertices to the graph." << std::endl;
+  iren->Start();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+
+vtkStandardNewMacro(BarnesHutLayoutStrategy);
+
+void BarnesHutLayoutStrategy::Initialize()
+{
+  this->Iteration = 0;
+  auto numberOfVertices = this->Graph->GetNumberOfVertices();
+  this->Width = std::max(std::sqrt(static_cast<double>(numberOfVertices)), 1.0);
+
+  // A new graph has all its points at the origin, scatter them. Otherwise
+  // jitter them a little so that coincident vertices, such as ones just
+  // placed on their neighbour, are pushed apart.
+  auto input = this->Graph->GetPoints();
+  double bounds[6];
+  input->GetBounds(bounds);
+  auto placed = bounds[1] > bounds[0] || bounds[3] > bounds[2];
+  auto spread = placed ? 0.1 : this->Width;
+  vtkNew<vtkMinimalStandardRandomSequence> rng;
+  rng->SetSeed(this->RandomSeed);
+  this->Coordinates = vtkSmartPointer<vtkDoubleArray>::New();
+  this->Coordinates->SetNumberOfComponents(3);
+  this->Coordinates->SetNumberOfTuples(numberOfVertices);
+  auto coordinates = this->Coordinates->GetPointer(0);
+  for (vtkIdType v = 0; v < numberOfVertices; ++v)
+  {
+    double p[3];
+    input->GetPoint(v, p);
+    for (auto i = 0; i < 2; ++i)
+    {
+      coordinates[3 * v + i] =
+          (placed ? p[i] : 0.0) + spread * (rng->GetValue() - 0.5);
+      rng->Next();
+    }
+    coordinates[3 * v + 2] = 0.0;
+  }
+  vtkNew<vtkPoints> points;
+  points->SetData(this->Coordinates);
+  this->Graph->SetPoints(points);
+
+  // Gather the neighbours of each vertex so that the attraction along the
+  // edges can be summed per vertex, in parallel, without races.
+  this->NeighbourOffsets.assign(numberOfVertices + 1, 0);
+  vtkNew<vtkEdgeListIterator> edges;
+  this->Graph->GetEdges(edges);
+  while (edges->HasNext())
+  {
+    auto edge = edges->Next();
+    if (edge.Source != edge.Target)
+    {
+      ++this->NeighbourOffsets[edge.Source + 1];
+      ++this->NeighbourOffsets[edge.Target + 1];
+    }
+  }
+  for (vtkIdType v = 0; v < numberOfVertices; ++v)
+  {
+    this->NeighbourOffsets[v + 1] += this->NeighbourOffsets[v];
+  }
+  this->Neighbours.resize(this->NeighbourOffsets[numberOfVertices]);
+  std::vector<vtkIdType> next(this->NeighbourOffsets.begin(),
+                              this->NeighbourOffsets.end() - 1);
+  this->Graph->GetEdges(edges);
+  while (edges->HasNext())
+  {
+    auto edge = edges->Next();
+    if (edge.Source != edge.Target)
+    {
+      this->Neighbours[next[edge.Source]++] = edge.Target;
+      this->Neighbours[next[edge.Target]++] = edge.Source;
+    }
+  }
+  this->Moves.assign(2 * numberOfVertices, 0.0);
+}
+
+void BarnesHutLayoutStrategy::Layout()
+{
+  auto numberOfVertices = this->Graph->GetNumberOfVertices();
+  auto coordinates = this->Coordinates->GetPointer(0);
+  for (auto i = 0; i < this->IterationsPerLayout && !this->IsLayoutComplete();
+       ++i, ++this->Iteration)
+  {
+    this->BuildTree(coordinates, numberOfVertices);
+    auto maxMove = this->InitialTemperature * this->Width / 10.0 *
+        (1.0 - static_cast<double>(this->Iteration) /
+             this->MaxNumberOfIterations);
+
+    vtkSMPTools::For(0, numberOfVertices, [&](vtkIdType begin, vtkIdType end) {
+      for (auto v = begin; v < end; ++v)
+      {
+        double force[2] = {0.0, 0.0};
+        this->AddRepulsion(coordinates, v, force);
+        // The attraction along an edge is the square of its length.
+        auto p = coordinates + 3 * v;
+        for (auto j = this->NeighbourOffsets[v];
+             j < this->NeighbourOffsets[v + 1]; ++j)
+        {
+          auto q = coordinates + 3 * this->Neighbours[j];
+          auto dx = q[0] - p[0];
+          auto dy = q[1] - p[1];
+          auto d = std::sqrt(dx * dx + dy * dy);
+          force[0] += dx * d;
+          force[1] += dy * d;
+        }
+        auto length = std::sqrt(force[0] * force[0] + force[1] * force[1]);
+        auto scale = length > maxMove ? maxMove / length : 1.0;
+        this->Moves[2 * v] = scale * force[0];
+        this->Moves[2 * v + 1] = scale * force[1];
+      }
+    });
+
+    // Move the vertices once all the forces are known.
+    vtkSMPTools::For(0, numberOfVertices, [&](vtkIdType begin, vtkIdType end) {
+      for (auto v = begin; v < end; ++v)
+      {
+        coordinates[3 * v] += this->Moves[2 * v];
+        coordinates[3 * v + 1] += this->Moves[2 * v + 1];
+      }
+    });
+  }
+  this->Coordinates->Modified();
+  this->Graph->GetPoints()->Modified();
+}
+
+void BarnesHutLayoutStrategy::BuildTree(const double* coordinates,
+                                        vtkIdType numberOfVertices)
+{
+  double bounds[4] = {VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX,
+                      VTK_DOUBLE_MIN};
+  for (vtkIdType v = 0; v < numberOfVertices; ++v)
+  {
+    for (auto i = 0; i < 2; ++i)
+    {
+      bounds[2 * i] = std::min(bounds[2 * i], coordinates[3 * v + i]);
+      bounds[2 * i + 1] = std::max(bounds[2 * i + 1], coordinates[3 * v + i]);
+    }
+  }
+  Node root;
+  root.Center[0] = (bounds[0] + bounds[1]) / 2.0;
+  root.Center[1] = (bounds[2] + bounds[3]) / 2.0;
+  root.HalfSize =
+      std::max(bounds[1] - bounds[0], bounds[3] - bounds[2]) / 2.0 + 1e-6;
+  this->Tree.clear();
+  this->Tree.push_back(root);
+  for (vtkIdType v = 0; v < numberOfVertices; ++v)
+  {
+    this->Insert(coordinates, v);
+  }
+  for (auto& node : this->Tree)
+  {
+    node.CenterOfMass[0] /= node.Mass;
+    node.CenterOfMass[1] /= node.Mass;
+  }
+}
+
+void BarnesHutLayoutStrategy::Insert(const double* coordinates,
+                                     vtkIdType vertex)
+{
+  auto p = coordinates + 3 * vertex;
+  auto index = 0;
+  for (auto depth = 0;; ++depth)
+  {
+    auto mass = this->Tree[index].Mass;
+    this->Tree[index].Mass += 1.0;
+    this->Tree[index].CenterOfMass[0] += p[0];
+    this->Tree[index].CenterOfMass[1] += p[1];
+    if (mass == 0.0)
+    {
+      this->Tree[index].Body = vertex;
+      return;
+    }
+    if (depth == MaxDepth)
+    {
+      return;
+    }
+    auto body = this->Tree[index].Body;
+    if (body >= 0)
+    {
+      // The leaf becomes a cell, its vertex moves down into a child.
+      this->Tree[index].Body = -1;
+      auto q = coordinates + 3 * body;
+      auto child = this->Child(index, q);
+      this->Tree[child].Mass = 1.0;
+      this->Tree[child].CenterOfMass[0] = q[0];
+      this->Tree[child].CenterOfMass[1] = q[1];
+      this->Tree[child].Body = body;
+    }
+    index = this->Child(index, p);
+  }
+}
+
+int BarnesHutLayoutStrategy::Child(int index, const double* p)
+{
+  auto parent = this->Tree[index];
+  auto quadrant =
+      (p[0] >= parent.Center[0] ? 1 : 0) + (p[1] >= parent.Center[1] ? 2 : 0);
+  if (parent.Children[quadrant] < 0)
+  {
+    Node child;
+    child.HalfSize = parent.HalfSize / 2.0;
+    child.Center[0] =
+        parent.Center[0] + (quadrant & 1 ? child.HalfSize : -child.HalfSize);
+    child.Center[1] =
+        parent.Center[1] + (quadrant & 2 ? child.HalfSize : -child.HalfSize);
+    this->Tree[index].Children[quadrant] = static_cast<int>(this->Tree.size());
+    this->Tree.push_back(child);
+  }
+  return this->Tree[index].Children[quadrant];
+}
+
+void BarnesHutLayoutStrategy::AddRepulsion(const double* coordinates,
+                                           vtkIdType vertex,
+                                           double force[2]) const
+{
+  auto p = coordinates + 3 * vertex;
+  // Depth first, a cell pushes at most four children.
+  std::array<int, 4 * MaxDepth + 4> stack;
+  auto top = 0;
+  stack[top++] = 0;
+  while (top > 0)
+  {
+    auto& node = this->Tree[stack[--top]];
+    auto dx = p[0] - node.CenterOfMass[0];
+    auto dy = p[1] - node.CenterOfMass[1];
+    auto d2 = dx * dx + dy * dy;
+    auto size = 2.0 * node.HalfSize;
+    if (node.Body >= 0 || size * size < this->Theta * this->Theta * d2)
+    {
+      // The repulsion is the inverse of the distance. A leaf holding only
+      // this vertex is at distance zero and is skipped.
+      if (d2 > 1e-12)
+      {
+        force[0] += node.Mass * dx / d2;
+        force[1] += node.Mass * dy / d2;
+      }
+      continue;
+    }
+    for (auto child : node.Children)
+    {
+      if (child >= 0)
+      {
+        stack[top++] = child;
+      }
+    }
+  }
+}
+
+void GrowGraph(vtkMutableGraphHelper* helper, vtkIdType numberOfVertices,
+               vtkIdType numberOfExtraEdges,
+               vtkMinimalStandardRandomSequence* rng)
+{
+  auto graph = helper->GetGraph();
+  for (vtkIdType i = 0; i < numberOfVertices; ++i)
+  {
+    auto n = graph->GetNumberOfVertices();
+    auto u = static_cast<vtkIdType>(rng->GetRangeValue(0, n));
+    rng->Next();
+    auto v = helper->AddVertex();
+    helper->AddEdge(std::min(u, n - 1), v);
+  }
+  auto n = graph->GetNumberOfVertices();
+  for (vtkIdType i = 0; i < numberOfExtraEdges; ++i)
+  {
+    auto u = static_cast<vtkIdType>(rng->GetRangeValue(0, n));
+    rng->Next();
+    auto v = static_cast<vtkIdType>(rng->GetRangeValue(0, n));
+    rng->Next();
+    u = std::min(u, n - 1);
+    v = std::min(v, n - 1);
+    if (u != v)
+    {
+      helper->AddEdge(u, v);
+    }
+  }
+}
+
+} // namespace
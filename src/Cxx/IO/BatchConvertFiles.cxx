@@ -0,0 +1,376 @@
+#include <vtkNew.h>
+#include <vtkOBJReader.h>
+#include <vtkPLYReader.h>
+#include <vtkPLYWriter.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataReader.h>
+#include <vtkPolyDataWriter.h>
+#include <vtkSTLReader.h>
+#include <vtkSTLWriter.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtkXMLPolyDataReader.h>
+#include <vtkXMLPolyDataWriter.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+std::string LowerCaseExtension(fs::path const& path);
+
+// Gather the files to convert. Each argument is either a file, a directory
+// whose readable files are all converted or, if it ends in .txt, a manifest
+// listing one file per line.
+std::vector<fs::path> CollectInputs(std::vector<std::string> const& args);
+
+// One converter per thread, the readers and writers are created once and
+// reused for every file the thread converts.
+class Converter
+{
+public:
+  // Returns false if the file could not be read or written.
+  bool Convert(fs::path const& input, fs::path const& output);
+
+private:
+  vtkSmartPointer<vtkPolyData> Read(fs::path const& input);
+  bool Write(vtkPolyData* polyData, fs::path const& output);
+
+  vtkNew<vtkXMLPolyDataReader> VTPReader;
+  vtkNew<vtkPLYReader> PLYReader;
+  vtkNew<vtkSTLReader> STLReader;
+  vtkNew<vtkOBJReader> OBJReader;
+  vtkNew<vtkPolyDataReader> VTKReader;
+
+  vtkNew<vtkXMLPolyDataWriter> VTPWriter;
+  vtkNew<vtkPLYWriter> PLYWriter;
+  vtkNew<vtkSTLWriter> STLWriter;
+  vtkNew<vtkPolyDataWriter> VTKWriter;
+};
+
+const std::set<std::string> inputExtensions{".obj", ".ply", ".stl", ".vtk",
+                                            ".vtp"};
+const std::set<std::string> outputExtensions{".ply", ".stl", ".vtk", ".vtp"};
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  std::vector<std::string> args(argv + 1, argv + argc);
+  auto numberOfThreads =
+      std::max(1u, std::thread::hardware_concurrency());
+  if (args.size() > 1 && args[0] == "-j")
+  {
+    numberOfThreads = std::max(1, std::atoi(args[1].c_str()));
+    args.erase(args.begin(), args.begin() + 2);
+  }
+  if (args.size() < 3)
+  {
+    std::cerr << "Required arguments: [-j threads] outputDirectory "
+                 "outputExtension input1 [input2 ...] e.g. /tmp ply "
+                 "Bunny.vtp cow.vtp"
+              << std::endl;
+    std::cerr << "An input can be a file, a directory or a manifest (.txt) "
+                 "listing one file per line."
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  fs::path outputDirectory = args[0];
+  std::string outputExtension = args[1];
+  if (outputExtension[0] != '.')
+  {
+    outputExtension = "." + outputExtension;
+  }
+  std::transform(outputExtension.begin(), outputExtension.end(),
+                 outputExtension.begin(), ::tolower);
+  if (outputExtensions.find(outputExtension) == outputExtensions.end())
+  {
+    std::cerr << "Unsupported output extension: " << outputExtension
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::error_code ec;
+  fs::create_directories(outputDirectory, ec);
+
+  auto inputs = CollectInputs({args.begin() + 2, args.end()});
+  if (inputs.empty())
+  {
+    std::cerr << "No files to convert." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Each output is named after its input, so two inputs with the same name
+  // in different directories would be written to the same file.
+  std::map<fs::path, fs::path> outputs;
+  for (auto const& input : inputs)
+  {
+    auto output = outputDirectory / input.stem();
+    output += outputExtension;
+    auto inserted = outputs.emplace(output, input);
+    if (!inserted.second)
+    {
+      std::cerr << "Both " << inserted.first->second << " and " << input
+                << " would be converted to " << output << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  numberOfThreads = std::min(numberOfThreads,
+                             static_cast<unsigned int>(inputs.size()));
+
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> failures{0};
+  std::atomic<std::uintmax_t> bytes{0};
+  std::mutex outputMutex;
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+
+  // A fixed number of workers take the next unconverted file until there
+  // are none left, so at most numberOfThreads meshes are in memory at once.
+  auto worker = [&]() {
+    Converter converter;
+    for (auto i = next++; i < inputs.size(); i = next++)
+    {
+      auto const& input = inputs[i];
+      auto output = outputDirectory / input.stem();
+      output += outputExtension;
+      if (converter.Convert(input, output))
+      {
+        std::error_code sizeError;
+        bytes += fs::file_size(input, sizeError);
+      }
+      else
+      {
+        ++failures;
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::cerr << "Failed to convert: " << input << std::endl;
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (unsigned int i = 0; i < numberOfThreads; ++i)
+  {
+    threads.emplace_back(worker);
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  timer->StopTimer();
+  auto elapsed = timer->GetElapsedTime();
+  auto megabytes = static_cast<double>(bytes) / (1024.0 * 1024.0);
+  std::cout << "Converted " << inputs.size() - failures << " of "
+            << inputs.size() << " files (" << megabytes << " MB) in "
+            << elapsed << " s using " << numberOfThreads << " threads."
+            << std::endl;
+  std::cout << "Throughput: " << megabytes / elapsed << " MB/s, "
+            << (inputs.size() - failures) / elapsed << " files/s."
+            << std::endl;
+
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+namespace {
+
+std::string LowerCaseExtension(fs::path const& path)
+{
+  auto extension = path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 ::tolower);
+  return extension;
+}
+
+std::vector<fs::path> CollectInputs(std::vector<std::string> const& args)
+{
+  std::vector<fs::path> inputs;
+  for (auto const& arg : args)
+  {
+    fs::path path = arg;
+    if (fs::is_directory(path))
+    {
+      for (auto const& entry : fs::directory_iterator(path))
+      {
+        if (entry.is_regular_file() &&
+            inputExtensions.find(LowerCaseExtension(entry.path())) !=
+                inputExtensions.end())
+        {
+          inputs.push_back(entry.path());
+        }
+      }
+    }
+    else if (LowerCaseExtension(path) == ".txt")
+    {
+      std::ifstream manifest(path);
+      std::string line;
+      while (std::getline(manifest, line))
+      {
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (!line.empty())
+        {
+          inputs.push_back(line);
+        }
+      }
+    }
+    else
+    {
+      inputs.push_back(path);
+    }
+  }
+  // A file listed twice is converted once.
+  std::set<fs::path> seen;
+  std::vector<fs::path> unique;
+  for (auto const& input : inputs)
+  {
+    std::error_code ec;
+    auto canonical = fs::weakly_canonical(input, ec);
+    if (seen.insert(ec ? input : canonical).second)
+    {
+      unique.push_back(input);
+    }
+  }
+  inputs.swap(unique);
+
+  // Convert the largest files first, so that one big file started last
+  // doesn't leave the other threads idle at the end.
+  std::vector<std::pair<std::uintmax_t, fs::path>> sized;
+  for (auto const& input : inputs)
+  {
+    std::error_code ec;
+    auto size = fs::file_size(input, ec);
+    sized.emplace_back(ec ? 0 : size, input);
+  }
+  std::stable_sort(
+      sized.begin(), sized.end(),
+      [](auto const& a, auto const& b) { return a.first > b.first; });
+  for (size_t i = 0; i < sized.size(); ++i)
+  {
+    inputs[i] = sized[i].second;
+  }
+  return inputs;
+}
+
+bool Converter::Convert(fs::path const& input, fs::path const& output)
+{
+  auto polyData = this->Read(input);
+  if (!polyData || polyData->GetNumberOfPoints() == 0)
+  {
+    return false;
+  }
+
+  // Write to a temporary file and rename it when complete, so that a
+  // partially written file is never seen under the final name.
+  auto temporary = output;
+  temporary += ".tmp";
+  if (!this->Write(polyData, temporary))
+  {
+    std::error_code ec;
+    fs::remove(temporary, ec);
+    return false;
+  }
+  std::error_code ec;
+  fs::rename(temporary, output, ec);
+  return !ec;
+}
+
+vtkSmartPointer<vtkPolyData> Converter::Read(fs::path const& input)
+{
+  auto extension = LowerCaseExtension(input);
+  auto fileName = input.string();
+  vtkAlgorithm* reader = nullptr;
+  if (extension == ".vtp")
+  {
+    this->VTPReader->SetFileName(fileName.c_str());
+    reader = this->VTPReader.GetPointer();
+  }
+  else if (extension == ".ply")
+  {
+    this->PLYReader->SetFileName(fileName.c_str());
+    reader = this->PLYReader.GetPointer();
+  }
+  else if (extension == ".stl")
+  {
+    this->STLReader->SetFileName(fileName.c_str());
+    reader = this->STLReader.GetPointer();
+  }
+  else if (extension == ".obj")
+  {
+    this->OBJReader->SetFileName(fileName.c_str());
+    reader = this->OBJReader.GetPointer();
+  }
+  else if (extension == ".vtk")
+  {
+    this->VTKReader->SetFileName(fileName.c_str());
+    reader = this->VTKReader.GetPointer();
+  }
+  else
+  {
+    return nullptr;
+  }
+  // The output of the previous file was emptied below, so read again even
+  // if the file name is the same.
+  reader->Modified();
+  reader->Update();
+
+  // Take the output away from the reader so that the reader doesn't hold on
+  // to it until the next file.
+  auto polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->ShallowCopy(reader->GetOutputDataObject(0));
+  reader->GetOutputDataObject(0)->Initialize();
+  return polyData;
+}
+
+bool Converter::Write(vtkPolyData* polyData, fs::path const& output)
+{
+  // The final extension selects the writer, the temporary name ends in .tmp.
+  auto extension = LowerCaseExtension(output.stem());
+  auto fileName = output.string();
+  int success = 0;
+  if (extension == ".vtp")
+  {
+    this->VTPWriter->SetFileName(fileName.c_str());
+    this->VTPWriter->SetInputData(polyData);
+    success = this->VTPWriter->Write();
+    this->VTPWriter->SetInputData(nullptr);
+  }
+  else if (extension == ".ply")
+  {
+    this->PLYWriter->SetFileName(fileName.c_str());
+    this->PLYWriter->SetInputData(polyData);
+    success = this->PLYWriter->Write();
+    this->PLYWriter->SetInputData(nullptr);
+  }
+  else if (extension == ".stl")
+  {
+    this->STLWriter->SetFileName(fileName.c_str());
+    this->STLWriter->SetInputData(polyData);
+    success = this->STLWriter->Write();
+    this->STLWriter->SetInputData(nullptr);
+  }
+  else if (extension == ".vtk")
+  {
+    this->VTKWriter->SetFileName(fileName.c_str());
+    this->VTKWriter->SetInputData(polyData);
+    success = this->VTKWriter->Write();
+    this->VTKWriter->SetInputData(nullptr);
+  }
+  return success == 1;
+}
+
+} // namespace
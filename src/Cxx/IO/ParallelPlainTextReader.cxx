@@ -0,0 +1,613 @@
+#include <vtkActor.h>
+#include <vtkCellArray.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProperty.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtkXMLPolyDataWriter.h>
+
+#include <vtksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Reads either
+//  - an "xyz" file, one point per line, as vtkSimplePointsReader does, or
+//  - the triangle format of the ReadPlainTextTriangles example: the number
+//    of points and triangles followed by one point and then one triangle
+//    per line.
+// The file is read in large blocks. Each block is cut at line boundaries
+// into chunks, the records in each chunk are counted and then parsed in
+// parallel straight into the point coordinates and the cell array
+// connectivity.
+class ParallelPlainTextReader
+{
+public:
+  explicit ParallelPlainTextReader(std::string const& fileName)
+    : FileName(fileName)
+  {
+  }
+
+  // Returns nullptr if the file can't be read.
+  vtkSmartPointer<vtkPolyData> Read();
+
+private:
+  void ParseBlock(const char* begin, const char* end);
+  void Reserve(vtkIdType numberOfRecords);
+
+  std::string FileName;
+  // True for the triangle format, false for xyz points.
+  bool HaveTriangles = false;
+  vtkIdType NumberOfPoints = 0;
+  vtkIdType NumberOfTriangles = 0;
+  // The number of records, points or triangles, parsed so far.
+  vtkIdType NumberOfRecords = 0;
+  // The first record with fewer than three numbers, or -1.
+  vtkIdType FirstShortRecord = -1;
+  vtkNew<vtkFloatArray> Coordinates;
+  vtkNew<vtkIdTypeArray> Connectivity;
+
+  static constexpr std::streamsize BlockSize = 64 << 20;
+};
+
+// Locale independent number parsing. Both skip leading blanks, but not line
+// ends, and return the position after the number or p if there is none.
+const char* ParseInteger(const char* p, vtkIdType& value);
+const char* ParseReal(const char* p, double& value);
+
+bool IsBlankLine(const char* begin, const char* end);
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cout << "Usage: " << argv[0]
+              << " filename [output.vtp] e.g. coords.txt" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkNew<vtkNamedColors> colors;
+
+  std::string inputFilename = argv[1];
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  ParallelPlainTextReader reader(inputFilename);
+  auto polydata = reader.Read();
+  timer->StopTimer();
+  if (!polydata)
+  {
+    return EXIT_FAILURE;
+  }
+
+  auto megabytes = static_cast<double>(vtksys::SystemTools::FileLength(
+                       inputFilename)) /
+      (1024.0 * 1024.0);
+  std::cout << "Read " << polydata->GetNumberOfPoints() << " points and "
+            << polydata->GetNumberOfCells() << " cells in "
+            << timer->GetElapsedTime() << " s ("
+            << megabytes / timer->GetElapsedTime() << " MB/s) using "
+            << vtkSMPTools::GetEstimatedNumberOfThreads() << " threads."
+            << std::endl;
+
+  if (argc > 2)
+  {
+    vtkNew<vtkXMLPolyDataWriter> writer;
+    writer->SetInputData(polydata);
+    writer->SetFileName(argv[2]);
+    writer->Write();
+  }
+
+  // Visualize
+  vtkNew<vtkPolyDataMapper> mapper;
+  mapper->SetInputData(polydata);
+
+  vtkNew<vtkActor> actor;
+  actor->SetMapper(mapper);
+  actor->GetProperty()->SetPointSize(6);
+  actor->GetProperty()->SetColor(colors->GetColor3d("Gold").GetData());
+
+  vtkNew<vtkRenderer> renderer;
+  renderer->AddActor(actor);
+  renderer->SetBackground(colors->GetColor3d("DarkGreen").GetData());
+
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->AddRenderer(renderer);
+  renderWindow->SetWindowName("ParallelPlainTextReader");
+
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  renderWindowInteractor->SetRenderWindow(renderWindow);
+
+  renderWindow->Render();
+  renderWindowInteractor->Start();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+
+vtkSmartPointer<vtkPolyData> ParallelPlainTextReader::Read()
+{
+  std::ifstream ifs(this->FileName, std::ios::binary);
+  if (!ifs)
+  {
+    std::cerr << "Unable to open: " << this->FileName << std::endl;
+    return nullptr;
+  }
+
+  this->Coordinates->SetNumberOfComponents(3);
+
+  // The first line decides the format, three numbers are a point, otherwise
+  // it is the header of the triangle format.
+  std::string line;
+  std::getline(ifs, line);
+  std::vector<double> header;
+  auto p = line.c_str();
+  while (true)
+  {
+    double value;
+    auto next = ParseReal(p, value);
+    if (next == p)
+    {
+      break;
+    }
+    header.push_back(value);
+    p = next;
+  }
+  if (header.size() == 3)
+  {
+    // Re-read the first line with the data.
+    ifs.clear();
+    ifs.seekg(0);
+  }
+  else if (header.size() == 1 || header.size() == 2)
+  {
+    this->HaveTriangles = true;
+    if (header.size() == 1)
+    {
+      std::getline(ifs, line);
+      double value = 0.0;
+      ParseReal(line.c_str(), value);
+      header.push_back(value);
+    }
+    this->NumberOfPoints = static_cast<vtkIdType>(header[0]);
+    this->NumberOfTriangles = static_cast<vtkIdType>(header[1]);
+    this->Reserve(this->NumberOfPoints + this->NumberOfTriangles);
+  }
+  else
+  {
+    std::cerr << "Unrecognised format: " << this->FileName << std::endl;
+    return nullptr;
+  }
+
+  std::vector<char> buffer;
+  std::string leftover;
+  while (ifs)
+  {
+    buffer.assign(leftover.begin(), leftover.end());
+    auto leftoverSize = buffer.size();
+    buffer.resize(leftoverSize + BlockSize);
+    ifs.read(buffer.data() + leftoverSize, BlockSize);
+    buffer.resize(leftoverSize + static_cast<size_t>(ifs.gcount()));
+
+    size_t length = buffer.size();
+    if (ifs)
+    {
+      // Hold back the partial line, it is completed by the next block.
+      while (length > 0 && buffer[length - 1] != '\n')
+      {
+        --length;
+      }
+      leftover.assign(buffer.begin() + length, buffer.end());
+    }
+    else
+    {
+      leftover.clear();
+    }
+    // Terminate the text so that the parsers can't run past the end.
+    buffer.resize(length);
+    buffer.push_back('\0');
+    this->ParseBlock(buffer.data(), buffer.data() + length);
+  }
+  if (this->FirstShortRecord >= 0)
+  {
+    std::cerr << "Fewer than three numbers on data line "
+              << this->FirstShortRecord + 1 << " of " << this->FileName
+              << std::endl;
+    return nullptr;
+  }
+
+  auto numberOfPoints = this->HaveTriangles
+      ? std::min(this->NumberOfPoints, this->NumberOfRecords)
+      : this->NumberOfRecords;
+  auto numberOfCells = this->HaveTriangles
+      ? std::max<vtkIdType>(this->NumberOfRecords - this->NumberOfPoints, 0)
+      : this->NumberOfRecords;
+  if (this->HaveTriangles && numberOfCells != this->NumberOfTriangles)
+  {
+    std::cerr << "Expected " << this->NumberOfPoints << " points and "
+              << this->NumberOfTriangles << " triangles but found "
+              << this->NumberOfRecords << " lines." << std::endl;
+  }
+  this->Coordinates->SetNumberOfTuples(numberOfPoints);
+  this->Connectivity->SetNumberOfValues(this->HaveTriangles ? 3 * numberOfCells
+                                                            : numberOfCells);
+
+  // Every cell has the same size, so the offsets are known up front.
+  auto cellSize = this->HaveTriangles ? 3 : 1;
+  vtkNew<vtkIdTypeArray> offsets;
+  offsets->SetNumberOfValues(numberOfCells + 1);
+  auto offsetsPtr = offsets->GetPointer(0);
+  vtkSMPTools::For(0, numberOfCells + 1, [&](vtkIdType first, vtkIdType last) {
+    for (auto i = first; i < last; ++i)
+    {
+      offsetsPtr[i] = cellSize * i;
+    }
+  });
+  if (!this->HaveTriangles)
+  {
+    // Like vtkSimplePointsReader, one vertex per point.
+    auto connectivityPtr = this->Connectivity->GetPointer(0);
+    vtkSMPTools::For(0, numberOfCells, [&](vtkIdType first, vtkIdType last) {
+      for (auto i = first; i < last; ++i)
+      {
+        connectivityPtr[i] = i;
+      }
+    });
+  }
+  vtkNew<vtkCellArray> cells;
+  cells->SetData(offsets, this->Connectivity);
+
+  vtkNew<vtkPoints> points;
+  points->SetData(this->Coordinates);
+
+  auto polydata = vtkSmartPointer<vtkPolyData>::New();
+  polydata->SetPoints(points);
+  if (this->HaveTriangles)
+  {
+    polydata->SetPolys(cells);
+  }
+  else
+  {
+    polydata->SetVerts(cells);
+  }
+  return polydata;
+}
+
+void ParallelPlainTextReader::Reserve(vtkIdType numberOfRecords)
+{
+  auto numberOfPoints = this->HaveTriangles
+      ? std::min(this->NumberOfPoints, numberOfRecords)
+      : numberOfRecords;
+  this->Coordinates->SetNumberOfComponents(3);
+  this->Coordinates->SetNumberOfTuples(numberOfPoints);
+  if (this->HaveTriangles)
+  {
+    this->Connectivity->SetNumberOfValues(
+        3 * std::max<vtkIdType>(numberOfRecords - this->NumberOfPoints, 0));
+  }
+}
+
+void ParallelPlainTextReader::ParseBlock(const char* begin, const char* end)
+{
+  if (begin == end)
+  {
+    return;
+  }
+
+  auto numberOfChunks = static_cast<vtkIdType>(
+      4 * vtkSMPTools::GetEstimatedNumberOfThreads());
+  std::vector<const char*> chunkBegin(numberOfChunks + 1, end);
+  chunkBegin[0] = begin;
+  for (vtkIdType i = 1; i < numberOfChunks; ++i)
+  {
+    auto p = std::max(chunkBegin[i - 1],
+                      begin + (end - begin) * i / numberOfChunks);
+    p = std::find(p, end, '\n');
+    chunkBegin[i] = p == end ? end : p + 1;
+  }
+
+  // Count the records, non blank lines, in each chunk.
+  std::vector<vtkIdType> chunkRecords(numberOfChunks + 1, 0);
+  vtkSMPTools::For(0, numberOfChunks, [&](vtkIdType first, vtkIdType last) {
+    for (auto i = first; i < last; ++i)
+    {
+      vtkIdType records = 0;
+      auto line = chunkBegin[i];
+      while (line < chunkBegin[i + 1])
+      {
+        auto lineEnd = std::find(line, chunkBegin[i + 1], '\n');
+        if (!IsBlankLine(line, lineEnd))
+        {
+          ++records;
+        }
+        line = lineEnd + 1;
+      }
+      chunkRecords[i + 1] = records;
+    }
+  });
+  chunkRecords[0] = this->NumberOfRecords;
+  for (vtkIdType i = 1; i <= numberOfChunks; ++i)
+  {
+    chunkRecords[i] += chunkRecords[i - 1];
+  }
+  this->NumberOfRecords = chunkRecords[numberOfChunks];
+
+  if (this->HaveTriangles)
+  {
+    if (this->NumberOfRecords > this->NumberOfPoints + this->NumberOfTriangles)
+    {
+      // More lines than the header said, keep them anyway.
+      this->Reserve(this->NumberOfRecords);
+    }
+  }
+  else if (this->NumberOfRecords > this->Coordinates->GetNumberOfTuples())
+  {
+    // Grow geometrically so that the copies are amortised over the blocks.
+    this->Reserve(std::max(this->NumberOfRecords,
+                           2 * this->Coordinates->GetNumberOfTuples()));
+  }
+
+  auto coordinates = this->Coordinates->GetPointer(0);
+  auto connectivity = this->Connectivity->GetPointer(0);
+  auto numberOfPoints = this->HaveTriangles
+      ? this->NumberOfPoints
+      : this->Coordinates->GetNumberOfTuples();
+  // The first short record in each chunk, so that the first in the file is
+  // reported whatever the order the chunks are parsed in.
+  std::vector<vtkIdType> chunkShortRecord(numberOfChunks, -1);
+  vtkSMPTools::For(0, numberOfChunks, [&](vtkIdType first, vtkIdType last) {
+    for (auto i = first; i < last; ++i)
+    {
+      auto record = chunkRecords[i];
+      auto line = chunkBegin[i];
+      while (line < chunkBegin[i + 1])
+      {
+        auto lineEnd = std::find(line, chunkBegin[i + 1], '\n');
+        if (IsBlankLine(line, lineEnd))
+        {
+          line = lineEnd + 1;
+          continue;
+        }
+        if (record < numberOfPoints)
+        {
+          auto p = line;
+          for (auto j = 0; j < 3; ++j)
+          {
+            double value = 0.0;
+            auto next = ParseReal(p, value);
+            if (next == p && chunkShortRecord[i] < 0)
+            {
+              chunkShortRecord[i] = record;
+            }
+            p = next;
+            coordinates[3 * record + j] = static_cast<float>(value);
+          }
+        }
+        else
+        {
+          auto p = line;
+          auto cell = record - numberOfPoints;
+          for (auto j = 0; j < 3; ++j)
+          {
+            vtkIdType value = 0;
+            auto next = ParseInteger(p, value);
+            if (next == p && chunkShortRecord[i] < 0)
+            {
+              chunkShortRecord[i] = record;
+            }
+            p = next;
+            connectivity[3 * cell + j] = value;
+          }
+        }
+        ++record;
+        line = lineEnd + 1;
+      }
+    }
+  });
+  if (this->FirstShortRecord < 0)
+  {
+    auto shortRecord =
+        std::find_if(chunkShortRecord.begin(), chunkShortRecord.end(),
+                     [](vtkIdType record) { return record >= 0; });
+    if (shortRecord != chunkShortRecord.end())
+    {
+      this->FirstShortRecord = *shortRecord;
+    }
+  }
+}
+
+bool IsBlankLine(const char* begin, const char* end)
+{
+  return std::all_of(begin, end, [](char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+  });
+}
+
+const char* SkipBlanks(const char* p)
+{
+  while (*p == ' ' || *p == '\t' || *p == ',')
+  {
+    ++p;
+  }
+  return p;
+}
+
+// Matches word, in lower or upper case, and returns the position after it, or
+// nullptr.
+const char* MatchWord(const char* p, const char* word)
+{
+  for (; *word; ++word, ++p)
+  {
+    if (*p != *word && *p != *word - 'a' + 'A')
+    {
+      return nullptr;
+    }
+  }
+  return p;
+}
+
+const char* ParseInteger(const char* p, vtkIdType& value)
+{
+  auto original = p;
+  p = SkipBlanks(p);
+  auto negative = *p == '-';
+  if (*p == '-' || *p == '+')
+  {
+    ++p;
+  }
+  if (*p < '0' || *p > '9')
+  {
+    return original;
+  }
+  vtkIdType v = 0;
+  while (*p >= '0' && *p <= '9')
+  {
+    v = 10 * v + (*p - '0');
+    ++p;
+  }
+  value = negative ? -v : v;
+  return p;
+}
+
+const char* ParseReal(const char* p, double& value)
+{
+  // Exactly representable powers of ten.
+  static const std::array<double, 23> powersOfTen{
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+  auto original = p;
+  auto start = SkipBlanks(p);
+  p = start;
+  auto negative = *p == '-';
+  if (*p == '-' || *p == '+')
+  {
+    ++p;
+  }
+  std::uint64_t mantissa = 0;
+  auto digits = 0;
+  auto exponent = 0;
+  auto haveDigits = false;
+  while (*p >= '0' && *p <= '9')
+  {
+    if (digits < 19)
+    {
+      mantissa = 10 * mantissa + (*p - '0');
+      if (mantissa != 0)
+      {
+        ++digits;
+      }
+    }
+    else
+    {
+      ++exponent;
+    }
+    haveDigits = true;
+    ++p;
+  }
+  if (*p == '.')
+  {
+    ++p;
+    while (*p >= '0' && *p <= '9')
+    {
+      if (digits < 19)
+      {
+        mantissa = 10 * mantissa + (*p - '0');
+        if (mantissa != 0)
+        {
+          ++digits;
+        }
+        --exponent;
+      }
+      haveDigits = true;
+      ++p;
+    }
+  }
+  if (!haveDigits)
+  {
+    // Not a number unless it is nan or inf. Only letters are matched, so a
+    // short line never takes a number from the next one.
+    if (auto q = MatchWord(p, "nan"))
+    {
+      value = std::numeric_limits<double>::quiet_NaN();
+      return q;
+    }
+    if (auto q = MatchWord(p, "inf"))
+    {
+      auto r = MatchWord(q, "inity");
+      value = negative ? -std::numeric_limits<double>::infinity()
+                       : std::numeric_limits<double>::infinity();
+      return r ? r : q;
+    }
+    return original;
+  }
+  if (*p == 'e' || *p == 'E')
+  {
+    // The digits of the exponent follow the optional sign directly, so 1e 5
+    // and 1e,5 stop at the e, as strtod does.
+    auto q = p + 1;
+    auto negativeExponent = *q == '-';
+    if (*q == '-' || *q == '+')
+    {
+      ++q;
+    }
+    if (*q >= '0' && *q <= '9')
+    {
+      auto e = 0;
+      while (*q >= '0' && *q <= '9')
+      {
+        // Large enough to leave the fast path, small enough not to overflow.
+        e = std::min(10 * e + (*q - '0'), 100000);
+        ++q;
+      }
+      exponent += negativeExponent ? -e : e;
+      p = q;
+    }
+  }
+
+  // Fast path: the mantissa and the power of ten are both exact doubles so
+  // the result is correctly rounded. Anything else is rare in practice.
+  if (mantissa < (std::uint64_t(1) << 53) && exponent >= -22 &&
+      exponent <= 22)
+  {
+    auto v = static_cast<double>(mantissa);
+    v = exponent < 0 ? v / powersOfTen[-exponent] : v * powersOfTen[exponent];
+    value = negative ? -v : v;
+    return p;
+  }
+  // Slow path, converted in the "C" locale whatever the global one is.
+  std::istringstream stream(std::string(start, p));
+  stream.imbue(std::locale::classic());
+  stream >> value;
+  if (stream.fail())
+  {
+    // Out of the range of a double.
+    value = exponent > 0 ? std::numeric_limits<double>::infinity() : 0.0;
+    value = negative ? -value : value;
+  }
+  return p;
+}
+
+} // namespace
@@ -0,0 +1,801 @@
+//
+// This example reads a series of DICOM images on a pool of threads,
+// decoding each slice straight into a volume that is allocated up front,
+// and shows the slices in a viewer as soon as they have been loaded.
+// Scroll with the mousewheel or the up/down keys through the slices.
+//
+#include <vtkActor2D.h>
+#include <vtkCallbackCommand.h>
+#include <vtkDICOMImageReader.h>
+#include <vtkImageData.h>
+#include <vtkImageViewer2.h>
+#include <vtkInteractorStyleImage.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkTextMapper.h>
+#include <vtkTextProperty.h>
+#include <vtkTimerLog.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// The tags of a DICOM file that give the order of the slices in a series.
+struct SliceInfo
+{
+  std::string FileName;
+  bool HasPosition = false;
+  double Position[3]{0.0, 0.0, 0.0};
+  double Orientation[6]{1.0, 0.0, 0.0, 0.0, 1.0, 0.0};
+  int InstanceNumber = 0;
+  double Location = 0.0;
+};
+
+/**
+ * Read the image position, orientation and instance number of a DICOM file.
+ *
+ * Only the start of the file is parsed, up to the end of group 0x0020, so
+ * the pixel data are never read.
+ *
+ * @param fileName The DICOM file.
+ * @param info The tags that were found.
+ * @return false if the file could not be parsed.
+ */
+bool ReadSliceInfo(std::string const& fileName, SliceInfo& info);
+
+/**
+ * Sort the slices along the normal of the image plane.
+ *
+ * Slices without an image position are sorted by instance number, then by
+ * file name.
+ *
+ * @param slices The slices of the series.
+ * @return The spacing between the first two slices, or zero if unknown.
+ */
+double SortSlices(std::vector<SliceInfo>& slices);
+
+// Decodes the slices of a series into a volume on a pool of threads.
+class SeriesLoader
+{
+public:
+  SeriesLoader(std::vector<std::string> const& fileNames, vtkImageData* volume,
+               std::vector<int> const& loadedSlices);
+  ~SeriesLoader();
+
+  void Start(unsigned int numberOfThreads);
+
+  // The threads load the slices nearest this one first.
+  void SetCurrentSlice(int slice);
+
+  bool IsLoaded(int slice);
+  int GetNumberOfLoadedSlices() const;
+  int GetNumberOfSlices() const;
+
+private:
+  enum State : char
+  {
+    Pending,
+    Loading,
+    Loaded
+  };
+
+  void Work();
+  int NextSlice();
+  void LoadSlice(vtkDICOMImageReader* reader, int slice);
+
+  std::vector<std::string> FileNames;
+  vtkImageData* Volume;
+  std::vector<char> States;
+  std::mutex Mutex;
+  int CurrentSlice = 0;
+  std::atomic<int> NumberOfLoadedSlices{0};
+  std::atomic<bool> Abort{false};
+  std::vector<std::thread> Threads;
+};
+
+// Helper class to format slice status message.
+class StatusMessage
+{
+public:
+  static std::string Format(int slice, int maxSlice, int loaded, bool ready)
+  {
+    std::stringstream tmp;
+    tmp << "Slice Number  " << slice + 1 << "/" << maxSlice + 1;
+    if (!ready)
+    {
+      tmp << " (loading)";
+    }
+    if (loaded <= maxSlice)
+    {
+      tmp << "\nLoaded " << loaded << "/" << maxSlice + 1;
+    }
+    return tmp.str();
+  }
+};
+
+// Scrolls through the slices and tells the loader which one is shown.
+class SliceInteractorStyle : public vtkInteractorStyleImage
+{
+public:
+  static SliceInteractorStyle* New();
+  vtkTypeMacro(SliceInteractorStyle, vtkInteractorStyleImage);
+
+  void SetImageViewer(vtkImageViewer2* imageViewer)
+  {
+    this->ImageViewer = imageViewer;
+    this->MinSlice = imageViewer->GetSliceMin();
+    this->MaxSlice = imageViewer->GetSliceMax();
+    this->Slice = imageViewer->GetSlice();
+  }
+
+  void SetStatusMapper(vtkTextMapper* statusMapper)
+  {
+    this->StatusMapper = statusMapper;
+  }
+
+  void SetLoader(SeriesLoader* loader)
+  {
+    this->Loader = loader;
+  }
+
+  // Show the slice again, with the number of slices loaded so far.
+  void UpdateSlice()
+  {
+    this->ImageViewer->GetInput()->Modified();
+    this->UpdateStatus();
+    this->ImageViewer->Render();
+  }
+
+  void OnKeyDown() override
+  {
+    std::string key = this->GetInteractor()->GetKeySym();
+    if (key == "Up")
+    {
+      this->MoveSlice(1);
+    }
+    else if (key == "Down")
+    {
+      this->MoveSlice(-1);
+    }
+    // Forward events.
+    vtkInteractorStyleImage::OnKeyDown();
+  }
+
+  void OnMouseWheelForward() override
+  {
+    this->MoveSlice(1);
+    // Don't forward events, otherwise the image will be zoomed
+    // in case another interactorstyle is used (e.g. trackballstyle, ...).
+  }
+
+  void OnMouseWheelBackward() override
+  {
+    this->MoveSlice(-1);
+  }
+
+private:
+  void MoveSlice(int step)
+  {
+    int slice = std::clamp(this->Slice + step, this->MinSlice, this->MaxSlice);
+    if (slice == this->Slice)
+    {
+      return;
+    }
+    this->Slice = slice;
+    this->Loader->SetCurrentSlice(slice);
+    this->ImageViewer->SetSlice(slice);
+    this->UpdateStatus();
+    this->ImageViewer->Render();
+  }
+
+  void UpdateStatus()
+  {
+    std::string msg = StatusMessage::Format(
+        this->Slice, this->MaxSlice, this->Loader->GetNumberOfLoadedSlices(),
+        this->Loader->IsLoaded(this->Slice));
+    this->StatusMapper->SetInput(msg.c_str());
+  }
+
+  vtkImageViewer2* ImageViewer = nullptr;
+  vtkTextMapper* StatusMapper = nullptr;
+  SeriesLoader* Loader = nullptr;
+  int Slice = 0;
+  int MinSlice = 0;
+  int MaxSlice = 0;
+};
+
+vtkStandardNewMacro(SliceInteractorStyle);
+
+// Redraws the viewer when more slices have been loaded.
+struct ProgressData
+{
+  SeriesLoader* Loader;
+  SliceInteractorStyle* Style;
+  vtkTimerLog* Timer;
+  int NumberOfLoadedSlices;
+};
+
+void ProgressCallback(vtkObject* caller, long unsigned int eventId,
+                      void* clientData, void* callData);
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  // Verify input arguments.
+  if (argc < 2)
+  {
+    std::cout << "Usage: " << argv[0] << " FolderName [numberOfThreads] [-c]"
+              << std::endl;
+    std::cout << "  -c also reads the series with vtkDICOMImageReader and "
+                 "prints the time taken."
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string folder = argv[1];
+  unsigned int numberOfThreads =
+      std::max(1u, std::thread::hardware_concurrency());
+  auto compare = false;
+  for (auto i = 2; i < argc; ++i)
+  {
+    if (std::string(argv[i]) == "-c")
+    {
+      compare = true;
+    }
+    else
+    {
+      numberOfThreads = std::max(1, std::atoi(argv[i]));
+    }
+  }
+
+  if (compare)
+  {
+    vtkNew<vtkTimerLog> referenceTimer;
+    referenceTimer->StartTimer();
+    vtkNew<vtkDICOMImageReader> referenceReader;
+    referenceReader->SetDirectoryName(folder.c_str());
+    referenceReader->Update();
+    referenceTimer->StopTimer();
+    std::cout << "vtkDICOMImageReader: first image after "
+              << referenceTimer->GetElapsedTime() << " s" << std::endl;
+  }
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+
+  // Read the tags that order the slices, in parallel.
+  std::vector<SliceInfo> slices;
+  std::error_code ec;
+  for (auto const& entry : fs::directory_iterator(folder, ec))
+  {
+    if (entry.is_regular_file())
+    {
+      SliceInfo slice;
+      slice.FileName = entry.path().string();
+      slices.push_back(slice);
+    }
+  }
+  if (ec)
+  {
+    std::cerr << "Cannot read the folder " << folder << ": " << ec.message()
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::vector<char> isDICOM(slices.size(), 0);
+  {
+    std::atomic<size_t> next{0};
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < numberOfThreads; ++t)
+    {
+      threads.emplace_back([&]() {
+        for (auto i = next++; i < slices.size(); i = next++)
+        {
+          isDICOM[i] = ReadSliceInfo(slices[i].FileName, slices[i]);
+        }
+      });
+    }
+    for (auto& thread : threads)
+    {
+      thread.join();
+    }
+  }
+  std::vector<SliceInfo> series;
+  for (size_t i = 0; i < slices.size(); ++i)
+  {
+    if (isDICOM[i])
+    {
+      series.push_back(slices[i]);
+    }
+  }
+  if (series.empty())
+  {
+    std::cerr << "No DICOM files in " << folder << std::endl;
+    return EXIT_FAILURE;
+  }
+  auto sliceSpacing = SortSlices(series);
+
+  // Decode the first slice to find the size and type of the volume.
+  auto middle = static_cast<int>(series.size() / 2);
+  vtkNew<vtkDICOMImageReader> firstReader;
+  firstReader->SetFileName(series[middle].FileName.c_str());
+  firstReader->Update();
+  auto first = firstReader->GetOutput();
+  int dims[3];
+  first->GetDimensions(dims);
+  if (dims[0] < 1 || dims[1] < 1 || first->GetNumberOfScalarComponents() != 1)
+  {
+    std::cerr << "Cannot decode " << series[middle].FileName << std::endl;
+    return EXIT_FAILURE;
+  }
+  double spacing[3];
+  first->GetSpacing(spacing);
+  if (sliceSpacing > 0.0)
+  {
+    spacing[2] = sliceSpacing;
+  }
+
+  vtkNew<vtkImageData> volume;
+  volume->SetDimensions(dims[0], dims[1], static_cast<int>(series.size()));
+  volume->SetSpacing(spacing);
+  volume->AllocateScalars(first->GetScalarType(), 1);
+  auto sliceBytes = static_cast<size_t>(dims[0]) * dims[1] *
+      first->GetPointData()->GetScalars()->GetDataTypeSize();
+  std::memset(volume->GetScalarPointer(), 0, sliceBytes * series.size());
+  std::memcpy(static_cast<char*>(volume->GetScalarPointer()) +
+                  sliceBytes * middle,
+              first->GetScalarPointer(), sliceBytes);
+  auto range = first->GetPointData()->GetScalars()->GetRange();
+
+  std::vector<std::string> fileNames;
+  for (auto const& slice : series)
+  {
+    fileNames.push_back(slice.FileName);
+  }
+  SeriesLoader loader(fileNames, volume, {middle});
+  loader.SetCurrentSlice(middle);
+  loader.Start(numberOfThreads);
+
+  vtkNew<vtkNamedColors> colors;
+
+  // Visualize.
+  vtkNew<vtkImageViewer2> imageViewer;
+  imageViewer->SetInputData(volume);
+  imageViewer->SetColorWindow(range[1] - range[0]);
+  imageViewer->SetColorLevel(0.5 * (range[0] + range[1]));
+
+  // Slice status message.
+  vtkNew<vtkTextProperty> sliceTextProp;
+  sliceTextProp->SetFontFamilyToCourier();
+  sliceTextProp->SetFontSize(20);
+  sliceTextProp->SetVerticalJustificationToBottom();
+  sliceTextProp->SetJustificationToLeft();
+
+  vtkNew<vtkTextMapper> sliceTextMapper;
+  sliceTextMapper->SetTextProperty(sliceTextProp);
+
+  vtkNew<vtkActor2D> sliceTextActor;
+  sliceTextActor->SetMapper(sliceTextMapper);
+  sliceTextActor->SetPosition(15, 10);
+
+  // Usage hint message.
+  vtkNew<vtkTextProperty> usageTextProp;
+  usageTextProp->SetFontFamilyToCourier();
+  usageTextProp->SetFontSize(14);
+  usageTextProp->SetVerticalJustificationToTop();
+  usageTextProp->SetJustificationToLeft();
+
+  vtkNew<vtkTextMapper> usageTextMapper;
+  usageTextMapper->SetInput(
+      "- Slice with mouse wheel\n  or Up/Down-Key\n- Zoom with pressed right\n "
+      " mouse button while dragging");
+  usageTextMapper->SetTextProperty(usageTextProp);
+
+  vtkNew<vtkActor2D> usageTextActor;
+  usageTextActor->SetMapper(usageTextMapper);
+  usageTextActor->GetPositionCoordinate()
+      ->SetCoordinateSystemToNormalizedDisplay();
+  usageTextActor->GetPositionCoordinate()->SetValue(0.05, 0.95);
+
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+
+  vtkNew<SliceInteractorStyle> style;
+  style->SetStatusMapper(sliceTextMapper);
+  style->SetLoader(&loader);
+
+  imageViewer->SetupInteractor(renderWindowInteractor);
+  renderWindowInteractor->SetInteractorStyle(style);
+
+  imageViewer->GetRenderer()->AddActor2D(sliceTextActor);
+  imageViewer->GetRenderer()->AddActor2D(usageTextActor);
+
+  imageViewer->SetSlice(middle);
+  style->SetImageViewer(imageViewer);
+  imageViewer->Render();
+  imageViewer->GetRenderer()->ResetCamera();
+  imageViewer->GetRenderer()->SetBackground(
+      colors->GetColor3d("SlateGray").GetData());
+  imageViewer->GetRenderWindow()->SetSize(800, 800);
+  imageViewer->GetRenderWindow()->SetWindowName("ReadDICOMSeriesStreaming");
+  style->UpdateSlice();
+
+  timer->StopTimer();
+  std::cout << "Streaming loader: first image after "
+            << timer->GetElapsedTime() << " s" << std::endl;
+
+  // Poll the loader and redraw while the slices arrive.
+  ProgressData progress{&loader, style, timer, 1};
+  vtkNew<vtkCallbackCommand> progressCallback;
+  progressCallback->SetCallback(ProgressCallback);
+  progressCallback->SetClientData(&progress);
+  renderWindowInteractor->AddObserver(vtkCommand::TimerEvent,
+                                      progressCallback);
+  renderWindowInteractor->Initialize();
+  renderWindowInteractor->CreateRepeatingTimer(100);
+
+  renderWindowInteractor->Start();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+
+uint16_t ReadUInt16(std::istream& is)
+{
+  unsigned char b[2]{0, 0};
+  is.read(reinterpret_cast<char*>(b), 2);
+  return static_cast<uint16_t>(b[0] | (b[1] << 8));
+}
+
+uint32_t ReadUInt32(std::istream& is)
+{
+  unsigned char b[4]{0, 0, 0, 0};
+  is.read(reinterpret_cast<char*>(b), 4);
+  return static_cast<uint32_t>(b[0]) | (static_cast<uint32_t>(b[1]) << 8) |
+      (static_cast<uint32_t>(b[2]) << 16) | (static_cast<uint32_t>(b[3]) << 24);
+}
+
+constexpr uint32_t undefinedLength = 0xFFFFFFFF;
+
+// Reads the tag and the value length of the next element. The file meta
+// information (group 0x0002) always has explicit value representations.
+bool ReadElementHeader(std::istream& is, bool explicitVR, uint16_t& group,
+                       uint16_t& element, uint32_t& length)
+{
+  group = ReadUInt16(is);
+  element = ReadUInt16(is);
+  if (group == 0xFFFE)
+  {
+    // Items and delimiters have no value representation.
+    length = ReadUInt32(is);
+  }
+  else if (explicitVR || group == 0x0002)
+  {
+    char vr[2]{0, 0};
+    is.read(vr, 2);
+    std::string const longVRs = "OBODOFOLOVOWSQSVUCUNURUTUV";
+    auto isLong = false;
+    for (size_t i = 0; i < longVRs.size(); i += 2)
+    {
+      isLong |= longVRs[i] == vr[0] && longVRs[i + 1] == vr[1];
+    }
+    if (isLong)
+    {
+      is.ignore(2);
+      length = ReadUInt32(is);
+    }
+    else
+    {
+      length = ReadUInt16(is);
+    }
+  }
+  else
+  {
+    length = ReadUInt32(is);
+  }
+  return static_cast<bool>(is);
+}
+
+// Skips the value of an element, including sequences of undefined length.
+bool SkipValue(std::istream& is, bool explicitVR, uint32_t length)
+{
+  if (length != undefinedLength)
+  {
+    is.ignore(length);
+    return static_cast<bool>(is);
+  }
+  uint16_t group;
+  uint16_t element;
+  while (ReadElementHeader(is, explicitVR, group, element, length))
+  {
+    if (group == 0xFFFE && element == 0xE0DD)
+    {
+      // End of the sequence.
+      return true;
+    }
+    if (group != 0xFFFE || element != 0xE000)
+    {
+      return false;
+    }
+    if (length != undefinedLength)
+    {
+      is.ignore(length);
+      continue;
+    }
+    // An item of undefined length ends with an item delimiter.
+    while (ReadElementHeader(is, explicitVR, group, element, length) &&
+           !(group == 0xFFFE && element == 0xE00D))
+    {
+      if (!SkipValue(is, explicitVR, length))
+      {
+        return false;
+      }
+    }
+  }
+  return false;
+}
+
+// Parses up to n backslash separated decimal strings.
+int ReadDecimals(std::string const& value, double* values, int n)
+{
+  std::stringstream ss(value);
+  std::string item;
+  auto count = 0;
+  while (count < n && std::getline(ss, item, '\\'))
+  {
+    values[count++] = std::atof(item.c_str());
+  }
+  return count;
+}
+
+bool ReadSliceInfo(std::string const& fileName, SliceInfo& info)
+{
+  std::ifstream is(fileName, std::ios::binary);
+  char preamble[132];
+  is.read(preamble, 132);
+  auto explicitVR = true;
+  if (!is || std::strncmp(preamble + 128, "DICM", 4) != 0)
+  {
+    // Older files have no preamble and start with an implicit VR data set.
+    is.clear();
+    is.seekg(0);
+    auto firstGroup = ReadUInt16(is);
+    if (!is || (firstGroup != 0x0000 && firstGroup != 0x0008))
+    {
+      return false;
+    }
+    is.seekg(0);
+    explicitVR = false;
+  }
+  uint16_t group;
+  uint16_t element;
+  uint32_t length;
+  while (ReadElementHeader(is, explicitVR, group, element, length))
+  {
+    if (group > 0x0020)
+    {
+      return true;
+    }
+    auto const isTag = [&](uint16_t g, uint16_t e) {
+      return group == g && element == e && length != undefinedLength &&
+          length < 1024;
+    };
+    if (isTag(0x0002, 0x0010) || isTag(0x0020, 0x0013) ||
+        isTag(0x0020, 0x0032) || isTag(0x0020, 0x0037))
+    {
+      std::string value(length, '\0');
+      is.read(&value[0], length);
+      value.erase(value.find_last_not_of(std::string(" \0", 2)) + 1);
+      if (group == 0x0002)
+      {
+        // Big endian data sets are not supported.
+        if (value == "1.2.840.10008.1.2.2")
+        {
+          return false;
+        }
+        explicitVR = value != "1.2.840.10008.1.2";
+      }
+      else if (element == 0x0013)
+      {
+        info.InstanceNumber = std::atoi(value.c_str());
+      }
+      else if (element == 0x0032)
+      {
+        info.HasPosition = ReadDecimals(value, info.Position, 3) == 3;
+      }
+      else
+      {
+        ReadDecimals(value, info.Orientation, 6);
+      }
+    }
+    else if (!SkipValue(is, explicitVR, length))
+    {
+      return false;
+    }
+  }
+  return group > 0x0002;
+}
+
+double SortSlices(std::vector<SliceInfo>& slices)
+{
+  auto allHavePositions = true;
+  for (auto& slice : slices)
+  {
+    allHavePositions &= slice.HasPosition;
+    auto const* o = slice.Orientation;
+    double normal[3]{o[1] * o[5] - o[2] * o[4], o[2] * o[3] - o[0] * o[5],
+                     o[0] * o[4] - o[1] * o[3]};
+    slice.Location = normal[0] * slice.Position[0] +
+        normal[1] * slice.Position[1] + normal[2] * slice.Position[2];
+  }
+  std::sort(slices.begin(), slices.end(),
+            [allHavePositions](SliceInfo const& a, SliceInfo const& b) {
+              if (allHavePositions && a.Location != b.Location)
+              {
+                return a.Location < b.Location;
+              }
+              if (a.InstanceNumber != b.InstanceNumber)
+              {
+                return a.InstanceNumber < b.InstanceNumber;
+              }
+              return a.FileName < b.FileName;
+            });
+  if (!allHavePositions || slices.size() < 2)
+  {
+    return 0.0;
+  }
+  return std::abs(slices[1].Location - slices[0].Location);
+}
+
+SeriesLoader::SeriesLoader(std::vector<std::string> const& fileNames,
+                           vtkImageData* volume,
+                           std::vector<int> const& loadedSlices)
+  : FileNames(fileNames), Volume(volume), States(fileNames.size(), Pending)
+{
+  for (auto slice : loadedSlices)
+  {
+    this->States[slice] = Loaded;
+    ++this->NumberOfLoadedSlices;
+  }
+}
+
+SeriesLoader::~SeriesLoader()
+{
+  this->Abort = true;
+  for (auto& thread : this->Threads)
+  {
+    thread.join();
+  }
+}
+
+void SeriesLoader::Start(unsigned int numberOfThreads)
+{
+  for (unsigned int i = 0; i < numberOfThreads; ++i)
+  {
+    this->Threads.emplace_back(&SeriesLoader::Work, this);
+  }
+}
+
+void SeriesLoader::SetCurrentSlice(int slice)
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  this->CurrentSlice = slice;
+}
+
+bool SeriesLoader::IsLoaded(int slice)
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  return this->States[slice] == Loaded;
+}
+
+int SeriesLoader::GetNumberOfLoadedSlices() const
+{
+  return this->NumberOfLoadedSlices;
+}
+
+int SeriesLoader::GetNumberOfSlices() const
+{
+  return static_cast<int>(this->FileNames.size());
+}
+
+void SeriesLoader::Work()
+{
+  // Each thread has its own reader, the readers share no state.
+  vtkNew<vtkDICOMImageReader> reader;
+  for (auto slice = this->NextSlice(); slice >= 0 && !this->Abort;
+       slice = this->NextSlice())
+  {
+    this->LoadSlice(reader, slice);
+    {
+      std::lock_guard<std::mutex> lock(this->Mutex);
+      this->States[slice] = Loaded;
+    }
+    ++this->NumberOfLoadedSlices;
+  }
+}
+
+int SeriesLoader::NextSlice()
+{
+  // The pending slice nearest the one that is shown.
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  auto n = static_cast<int>(this->States.size());
+  for (auto d = 0; d < n; ++d)
+  {
+    for (auto slice : {this->CurrentSlice + d, this->CurrentSlice - d})
+    {
+      if (slice >= 0 && slice < n && this->States[slice] == Pending)
+      {
+        this->States[slice] = Loading;
+        return slice;
+      }
+    }
+  }
+  return -1;
+}
+
+void SeriesLoader::LoadSlice(vtkDICOMImageReader* reader, int slice)
+{
+  reader->SetFileName(this->FileNames[slice].c_str());
+  reader->Update();
+  auto image = reader->GetOutput();
+  int dims[3];
+  image->GetDimensions(dims);
+  int volumeDims[3];
+  this->Volume->GetDimensions(volumeDims);
+  if (dims[0] != volumeDims[0] || dims[1] != volumeDims[1] ||
+      image->GetScalarType() != this->Volume->GetScalarType() ||
+      image->GetNumberOfScalarComponents() != 1)
+  {
+    // The slice is left blank.
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    std::cerr << "Skipping " << this->FileNames[slice]
+              << ": it does not match the first slice." << std::endl;
+    return;
+  }
+  auto sliceBytes = static_cast<size_t>(dims[0]) * dims[1] *
+      image->GetPointData()->GetScalars()->GetDataTypeSize();
+  std::memcpy(static_cast<char*>(this->Volume->GetScalarPointer()) +
+                  sliceBytes * slice,
+              image->GetScalarPointer(), sliceBytes);
+}
+
+void ProgressCallback(vtkObject* vtkNotUsed(caller),
+                      long unsigned int vtkNotUsed(eventId), void* clientData,
+                      void* vtkNotUsed(callData))
+{
+  auto progress = static_cast<ProgressData*>(clientData);
+  auto loaded = progress->Loader->GetNumberOfLoadedSlices();
+  if (loaded == progress->NumberOfLoadedSlices)
+  {
+    return;
+  }
+  progress->NumberOfLoadedSlices = loaded;
+  progress->Style->UpdateSlice();
+  if (loaded == progress->Loader->GetNumberOfSlices())
+  {
+    progress->Timer->StopTimer();
+    std::cout << "Streaming loader: all " << loaded << " slices after "
+              << progress->Timer->GetElapsedTime() << " s" << std::endl;
+  }
+}
+
+} // namespace
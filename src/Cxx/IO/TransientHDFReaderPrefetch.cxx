@@ -0,0 +1,337 @@
+#include <vtkActor.h>
+#include <vtkCallbackCommand.h>
+#include <vtkCommand.h>
+#include <vtkDataArray.h>
+#include <vtkHDFReader.h>
+#include <vtkInteractorStyleTrackballCamera.h>
+#include <vtkLookupTable.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace {
+
+// Reads time steps ahead of the one being displayed on a background thread
+// and keeps them in a least recently used cache.
+//
+// A single loader thread is used because the HDF5 library built with VTK is
+// not thread safe, so reads can't run concurrently. This still takes all the
+// reading off the thread that renders.
+class StepPrefetcher
+{
+public:
+  StepPrefetcher(std::string const& fileName, int numberOfSteps,
+                 int prefetchSteps, size_t cacheSize);
+  ~StepPrefetcher();
+
+  // Returns the step if it is in the cache, nullptr otherwise. In either case
+  // the loader starts reading the steps that follow it.
+  vtkSmartPointer<vtkPolyData> Get(int step);
+
+  void Report();
+
+private:
+  void Load();
+  // The first step at or after Current that is not cached, or -1.
+  int NextStepToLoad();
+  // Whether the step is one of those read ahead of Current.
+  bool InPrefetchWindow(int step) const;
+  // Must be called with Mutex locked.
+  void Insert(int step, vtkSmartPointer<vtkPolyData> polyData);
+
+  std::string FileName;
+  int NumberOfSteps;
+  int PrefetchSteps;
+  size_t CacheSize;
+
+  std::mutex Mutex;
+  std::condition_variable Wake;
+  bool Stop = false;
+  int Current = 0;
+  // Most recently used at the front.
+  std::list<std::pair<int, vtkSmartPointer<vtkPolyData>>> Cache;
+  std::map<int, decltype(Cache)::iterator> Index;
+
+  size_t Hits = 0;
+  size_t Misses = 0;
+  size_t Reads = 0;
+  double ReadTime = 0.0;
+  double MaxReadTime = 0.0;
+
+  std::thread Loader;
+};
+
+struct PlaybackState
+{
+  StepPrefetcher* Prefetcher = nullptr;
+  vtkPolyDataMapper* Mapper = nullptr;
+  int Step = 0;
+  int NumberOfSteps = 0;
+};
+
+void Animate(vtkObject* caller, unsigned long eid, void* clientdata,
+             void* calldata);
+} // namespace
+
+int main(int ac, char** av)
+{
+  if (ac < 2)
+  {
+    std::cout << "Usage: " << av[0]
+              << " filename.vtkhdf [prefetchSteps] [cacheSize] eg. "
+                 "warping_spheres.vtkhdf 8 16"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  auto prefetchSteps = ac > 2 ? std::max(1, std::atoi(av[2])) : 8;
+  auto cacheSize = ac > 3 ? std::max(1, std::atoi(av[3])) : 2 * prefetchSteps;
+  // Leave room for the step shown besides the ones read ahead.
+  cacheSize = std::max(cacheSize, prefetchSteps + 1);
+
+  vtkNew<vtkNamedColors> colors;
+
+  // Read the first step here, before the loader thread starts reading.
+  vtkNew<vtkHDFReader> reader;
+  reader->SetFileName(av[1]);
+  reader->Update();
+  auto numberOfSteps = reader->GetNumberOfSteps();
+  std::cout << "number of steps: " << numberOfSteps << std::endl;
+  auto polydata = vtkPolyData::SafeDownCast(reader->GetOutput());
+  if (!polydata)
+  {
+    std::cout << "The file does not contain polydata." << std::endl;
+    return EXIT_FAILURE;
+  }
+  double range[2]{0.0, 1.0};
+  auto array = polydata->GetPointData()->GetArray("SpatioTemporalHarmonics");
+  if (array)
+  {
+    array->GetRange(range);
+  }
+
+  StepPrefetcher prefetcher(av[1], numberOfSteps, prefetchSteps,
+                            static_cast<size_t>(cacheSize));
+
+  vtkNew<vtkLookupTable> lut;
+  lut->SetHueRange(0.667, 0.0);
+  lut->Build();
+
+  vtkNew<vtkPolyDataMapper> mapper;
+  mapper->SetInputData(polydata);
+  mapper->SetLookupTable(lut);
+  mapper->SetScalarRange(range);
+  mapper->SetScalarModeToUsePointFieldData();
+  mapper->SelectColorArray("SpatioTemporalHarmonics");
+
+  vtkNew<vtkActor> actor;
+  actor->SetMapper(mapper);
+
+  vtkNew<vtkRenderer> renderer;
+  renderer->SetBackground(colors->GetColor3d("Wheat").GetData());
+  renderer->UseHiddenLineRemovalOn();
+  renderer->AddActor(actor);
+
+  vtkNew<vtkRenderWindow> renWin;
+  renWin->AddRenderer(renderer);
+  renWin->SetWindowName("TransientHDFReaderPrefetch");
+  renWin->SetSize(1024, 512);
+  renWin->Render();
+
+  PlaybackState state;
+  state.Prefetcher = &prefetcher;
+  state.Mapper = mapper;
+  state.NumberOfSteps = numberOfSteps;
+
+  // Add the animation callback.
+  vtkNew<vtkCallbackCommand> command;
+  command->SetCallback(&Animate);
+  command->SetClientData(&state);
+
+  // Add the interactor.
+  vtkNew<vtkRenderWindowInteractor> iren;
+  iren->SetRenderWindow(renWin);
+  iren->AddObserver(vtkCommand::TimerEvent, command);
+  iren->CreateRepeatingTimer(50);
+
+  vtkNew<vtkInteractorStyleTrackballCamera> istyle;
+  iren->SetInteractorStyle(istyle);
+
+  iren->Start();
+
+  prefetcher.Report();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+
+StepPrefetcher::StepPrefetcher(std::string const& fileName, int numberOfSteps,
+                               int prefetchSteps, size_t cacheSize)
+  : FileName(fileName), NumberOfSteps(numberOfSteps),
+    PrefetchSteps(std::min(prefetchSteps, numberOfSteps)),
+    CacheSize(cacheSize)
+{
+  this->Loader = std::thread(&StepPrefetcher::Load, this);
+}
+
+StepPrefetcher::~StepPrefetcher()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Stop = true;
+  }
+  this->Wake.notify_one();
+  this->Loader.join();
+}
+
+vtkSmartPointer<vtkPolyData> StepPrefetcher::Get(int step)
+{
+  vtkSmartPointer<vtkPolyData> polyData;
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Current = step;
+    auto it = this->Index.find(step);
+    if (it != this->Index.end())
+    {
+      // Move it to the front, it is now the most recently used.
+      this->Cache.splice(this->Cache.begin(), this->Cache, it->second);
+      polyData = it->second->second;
+      ++this->Hits;
+    }
+    else
+    {
+      ++this->Misses;
+    }
+  }
+  this->Wake.notify_one();
+  return polyData;
+}
+
+void StepPrefetcher::Report()
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  auto requests = this->Hits + this->Misses;
+  std::cout << "Cache hit rate: "
+            << (requests ? 100.0 * this->Hits / requests : 0.0) << "% ("
+            << this->Hits << " of " << requests << " frames)." << std::endl;
+  std::cout << "Read latency: mean "
+            << (this->Reads ? 1000.0 * this->ReadTime / this->Reads : 0.0)
+            << " ms, max " << 1000.0 * this->MaxReadTime << " ms over "
+            << this->Reads << " reads." << std::endl;
+}
+
+int StepPrefetcher::NextStepToLoad()
+{
+  for (auto i = 0; i < this->PrefetchSteps; ++i)
+  {
+    auto step = (this->Current + i) % this->NumberOfSteps;
+    if (this->Index.find(step) == this->Index.end())
+    {
+      return step;
+    }
+  }
+  return -1;
+}
+
+void StepPrefetcher::Insert(int step, vtkSmartPointer<vtkPolyData> polyData)
+{
+  this->Cache.emplace_front(step, polyData);
+  this->Index[step] = this->Cache.begin();
+  // Evict the least recently used step that is not about to be shown,
+  // otherwise the loader would read it again and evict the next one.
+  auto it = this->Cache.end();
+  while (this->Cache.size() > this->CacheSize && it != this->Cache.begin())
+  {
+    --it;
+    if (!this->InPrefetchWindow(it->first))
+    {
+      this->Index.erase(it->first);
+      it = this->Cache.erase(it);
+    }
+  }
+}
+
+bool StepPrefetcher::InPrefetchWindow(int step) const
+{
+  auto offset =
+      (step - this->Current + this->NumberOfSteps) % this->NumberOfSteps;
+  return offset < this->PrefetchSteps;
+}
+
+void StepPrefetcher::Load()
+{
+  vtkNew<vtkHDFReader> reader;
+  reader->SetFileName(this->FileName.c_str());
+  vtkNew<vtkTimerLog> timer;
+
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  while (true)
+  {
+    this->Wake.wait(lock, [this]() {
+      return this->Stop || this->NextStepToLoad() >= 0;
+    });
+    if (this->Stop)
+    {
+      return;
+    }
+    auto step = this->NextStepToLoad();
+
+    // Read without holding the lock so that the render thread never waits
+    // on a read.
+    lock.unlock();
+    timer->StartTimer();
+    reader->SetStep(step);
+    reader->Update();
+    auto polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->ShallowCopy(reader->GetOutput());
+    timer->StopTimer();
+    lock.lock();
+
+    auto elapsed = timer->GetElapsedTime();
+    ++this->Reads;
+    this->ReadTime += elapsed;
+    this->MaxReadTime = std::max(this->MaxReadTime, elapsed);
+    this->Insert(step, polyData);
+  }
+}
+
+void Animate(vtkObject* caller, unsigned long vtkNotUsed(eid),
+             void* clientdata, void* vtkNotUsed(calldata))
+{
+  vtkRenderWindowInteractor* interactor =
+      vtkRenderWindowInteractor::SafeDownCast(caller);
+  auto state = static_cast<PlaybackState*>(clientdata);
+  auto next = (state->Step + 1) % state->NumberOfSteps;
+  auto polyData = state->Prefetcher->Get(next);
+  if (!polyData)
+  {
+    // Not loaded yet, keep showing the current step rather than wait.
+    return;
+  }
+  state->Step = next;
+  state->Mapper->SetInputData(polyData);
+  interactor->Render();
+  if (next == 0)
+  {
+    state->Prefetcher->Report();
+  }
+}
+} // namespace
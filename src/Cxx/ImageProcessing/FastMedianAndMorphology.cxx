@@ -0,0 +1,585 @@
+#include <vtkCamera.h>
+#include <vtkDataArray.h>
+#include <vtkImageActor.h>
+#include <vtkImageContinuousDilate3D.h>
+#include <vtkImageContinuousErode3D.h>
+#include <vtkImageData.h>
+#include <vtkImageMapper3D.h>
+#include <vtkImageMedian3D.h>
+#include <vtkImageProperty.h>
+#include <vtkImageReader2.h>
+#include <vtkImageReader2Factory.h>
+#include <vtkInteractorStyleImage.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkTextActor.h>
+#include <vtkTextProperty.h>
+#include <vtkTimerLog.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The median of the kernelSize[0] x kernelSize[1] x kernelSize[2] box around
+// each voxel, clipped at the image boundary. A histogram of the voxels in the
+// box is slid along each row, so moving one voxel adds and removes one plane
+// of the box instead of sorting the whole box again: for a k x k x k box the
+// cost per voxel grows as k^2 rather than k^3. The rows of all the slices are
+// processed in parallel.
+void HistogramMedian(vtkImageData* input, int kernelSize[3],
+                     vtkImageData* output);
+
+// Grey scale dilation (the maximum) or erosion (the minimum) over a box,
+// done one axis at a time with the van Herk/Gil-Werman algorithm. The cost
+// per voxel is three comparisons per axis whatever the size of the box.
+void VanHerkMorphology(vtkImageData* input, int kernelSize[3], bool dilate,
+                       vtkImageData* output);
+
+// The number of voxels that differ.
+vtkIdType CountDifferences(vtkImageData* a, vtkImageData* b);
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  vtkNew<vtkNamedColors> colors;
+
+  // Verify input arguments.
+  if (argc < 2)
+  {
+    std::cout << "Usage: " << argv[0]
+              << " Filename [kernelSize] e.g. FullHead.mhd 5" << std::endl;
+    return EXIT_FAILURE;
+  }
+  auto size = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+  // Odd sizes only, so that the box is centred on the voxel.
+  size += 1 - size % 2;
+
+  // Read the image
+  vtkNew<vtkImageReader2Factory> readerFactory;
+  vtkSmartPointer<vtkImageReader2> reader;
+  reader.TakeReference(readerFactory->CreateImageReader2(argv[1]));
+  if (!reader)
+  {
+    std::cout << "Cannot read " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+  reader->SetFileName(argv[1]);
+  reader->Update();
+  auto image = reader->GetOutput();
+  if (image->GetNumberOfScalarComponents() != 1)
+  {
+    std::cout << "Only single component images are supported." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  int dims[3];
+  image->GetDimensions(dims);
+  int kernelSize[3];
+  for (auto i = 0; i < 3; ++i)
+  {
+    kernelSize[i] = dims[i] > 1 ? size : 1;
+  }
+  std::cout << "Image: " << dims[0] << " x " << dims[1] << " x " << dims[2]
+            << ", kernel: " << kernelSize[0] << " x " << kernelSize[1]
+            << " x " << kernelSize[2] << std::endl;
+
+  vtkNew<vtkTimerLog> timer;
+  std::vector<std::string> names;
+  std::vector<double> vtkTimes;
+  std::vector<double> fastTimes;
+
+  // Median
+  vtkNew<vtkImageMedian3D> median;
+  median->SetInputData(image);
+  median->SetKernelSize(kernelSize[0], kernelSize[1], kernelSize[2]);
+  timer->StartTimer();
+  median->Update();
+  timer->StopTimer();
+  vtkTimes.push_back(timer->GetElapsedTime());
+
+  vtkNew<vtkImageData> fastMedian;
+  timer->StartTimer();
+  HistogramMedian(image, kernelSize, fastMedian);
+  timer->StopTimer();
+  fastTimes.push_back(timer->GetElapsedTime());
+  names.push_back("Median");
+
+  // Dilation
+  vtkNew<vtkImageContinuousDilate3D> dilate;
+  dilate->SetInputData(image);
+  dilate->SetKernelSize(kernelSize[0], kernelSize[1], kernelSize[2]);
+  timer->StartTimer();
+  dilate->Update();
+  timer->StopTimer();
+  vtkTimes.push_back(timer->GetElapsedTime());
+
+  vtkNew<vtkImageData> fastDilate;
+  timer->StartTimer();
+  VanHerkMorphology(image, kernelSize, true, fastDilate);
+  timer->StopTimer();
+  fastTimes.push_back(timer->GetElapsedTime());
+  names.push_back("Dilate");
+
+  // Erosion
+  vtkNew<vtkImageContinuousErode3D> erode;
+  erode->SetInputData(image);
+  erode->SetKernelSize(kernelSize[0], kernelSize[1], kernelSize[2]);
+  timer->StartTimer();
+  erode->Update();
+  timer->StopTimer();
+  vtkTimes.push_back(timer->GetElapsedTime());
+
+  vtkNew<vtkImageData> fastErode;
+  timer->StartTimer();
+  VanHerkMorphology(image, kernelSize, false, fastErode);
+  timer->StopTimer();
+  fastTimes.push_back(timer->GetElapsedTime());
+  names.push_back("Erode");
+
+  std::cout << std::left << std::setw(10) << "Filter" << std::right
+            << std::setw(12) << "vtk (s)" << std::setw(12) << "fast (s)"
+            << std::setw(10) << "speedup" << std::endl;
+  for (size_t i = 0; i < names.size(); ++i)
+  {
+    std::cout << std::left << std::setw(10) << names[i] << std::right
+              << std::fixed << std::setprecision(3) << std::setw(12)
+              << vtkTimes[i] << std::setw(12) << fastTimes[i]
+              << std::setprecision(1) << std::setw(9)
+              << vtkTimes[i] / std::max(fastTimes[i], 1e-6) << "x"
+              << std::endl;
+  }
+  std::cout.unsetf(std::ios_base::floatfield);
+  std::cout << std::setprecision(6);
+  // The median only differs where the clipped box at the boundary holds an
+  // even number of voxels. vtkImageContinuousDilate3D and
+  // vtkImageContinuousErode3D use an ellipsoid, not a box, so they differ
+  // wherever the corners of the box matter.
+  auto voxels = static_cast<double>(image->GetNumberOfPoints());
+  std::cout << "Voxels that differ: median "
+            << 100.0 * CountDifferences(median->GetOutput(), fastMedian) /
+                voxels
+            << "%, dilate "
+            << 100.0 * CountDifferences(dilate->GetOutput(), fastDilate) /
+                voxels
+            << "%, erode "
+            << 100.0 * CountDifferences(erode->GetOutput(), fastErode) / voxels
+            << "%" << std::endl;
+
+  double scalarRange[2];
+  image->GetPointData()->GetScalars()->GetRange(scalarRange);
+  auto colorWindow = (scalarRange[1] - scalarRange[0]) * 0.8;
+  auto colorLevel = scalarRange[0] + colorWindow / 2.0;
+  int middleSlice = (image->GetExtent()[4] + image->GetExtent()[5]) / 2;
+
+  std::vector<vtkImageData*> images{median->GetOutput(), fastMedian,
+                                    dilate->GetOutput(), fastDilate};
+  std::vector<std::string> labels;
+  labels.push_back("vtkImageMedian3D\n" + std::to_string(vtkTimes[0]) + " s");
+  labels.push_back("Histogram median\n" + std::to_string(fastTimes[0]) +
+                   " s");
+  labels.push_back("vtkImageContinuousDilate3D\n" +
+                   std::to_string(vtkTimes[1]) + " s");
+  labels.push_back("van Herk dilate\n" + std::to_string(fastTimes[1]) + " s");
+
+  std::vector<vtkSmartPointer<vtkRenderer>> renderers;
+  for (size_t i = 0; i < images.size(); ++i)
+  {
+    vtkNew<vtkImageActor> actor;
+    actor->GetMapper()->SetInputData(images[i]);
+    actor->GetProperty()->SetColorWindow(colorWindow);
+    actor->GetProperty()->SetColorLevel(colorLevel);
+    actor->GetProperty()->SetInterpolationTypeToNearest();
+    actor->SetZSlice(middleSlice);
+
+    vtkNew<vtkTextActor> text;
+    text->SetInput(labels[i].c_str());
+    text->GetTextProperty()->SetFontSize(16);
+    text->GetTextProperty()->SetColor(colors->GetColor3d("Gold").GetData());
+    text->SetDisplayPosition(10, 10);
+
+    vtkNew<vtkRenderer> renderer;
+    renderer->AddActor(actor);
+    renderer->AddViewProp(text);
+    renderer->SetBackground(colors->GetColor3d("SlateGray").GetData());
+    renderers.push_back(renderer);
+  }
+
+  // Setup viewports for the renderers.
+  int rendererSize = 400;
+  unsigned int xGridDimensions = 2;
+  unsigned int yGridDimensions = 2;
+
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->SetSize(rendererSize * xGridDimensions,
+                        rendererSize * yGridDimensions);
+  for (int row = 0; row < static_cast<int>(yGridDimensions); row++)
+  {
+    for (int col = 0; col < static_cast<int>(xGridDimensions); col++)
+    {
+      int index = row * xGridDimensions + col;
+      // (xmin, ymin, xmax, ymax)
+      double viewport[4] = {
+          static_cast<double>(col) / xGridDimensions,
+          static_cast<double>(yGridDimensions - (row + 1)) / yGridDimensions,
+          static_cast<double>(col + 1) / xGridDimensions,
+          static_cast<double>(yGridDimensions - row) / yGridDimensions};
+      renderers[index]->SetViewport(viewport);
+      renderWindow->AddRenderer(renderers[index]);
+    }
+  }
+  renderWindow->SetWindowName("FastMedianAndMorphology");
+
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  vtkNew<vtkInteractorStyleImage> style;
+
+  renderWindowInteractor->SetInteractorStyle(style);
+  renderWindowInteractor->SetRenderWindow(renderWindow);
+
+  // Renderers share one camera.
+  renderWindow->Render();
+  renderers[0]->GetActiveCamera()->Dolly(1.5);
+  renderers[0]->ResetCameraClippingRange();
+  for (size_t r = 1; r < renderers.size(); ++r)
+  {
+    renderers[r]->SetActiveCamera(renderers[0]->GetActiveCamera());
+  }
+  renderWindowInteractor->Initialize();
+  renderWindowInteractor->Start();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+
+// Counts are kept for each distinct value and, level by level, for each block
+// of 256 counts of the level below, up to a level of at most 256 blocks. The
+// median is found by scanning at most 256 counts per level from the top down,
+// so the cost stays small however many distinct values a real valued image
+// has.
+struct Histogram
+{
+  // The counts of the distinct values first, the coarsest level last.
+  std::vector<std::vector<std::int32_t>> Levels;
+
+  void Allocate(size_t numberOfValues)
+  {
+    this->Levels.emplace_back(numberOfValues, 0);
+    while (this->Levels.back().size() > 256)
+    {
+      this->Levels.emplace_back((this->Levels.back().size() + 255) >> 8, 0);
+    }
+  }
+
+  void Add(std::uint32_t rank, std::int32_t count)
+  {
+    for (auto& level : this->Levels)
+    {
+      level[rank] += count;
+      rank >>= 8;
+    }
+  }
+
+  // The rank of the element at position n in sorted order.
+  std::uint32_t Select(std::int32_t n) const
+  {
+    size_t rank = 0;
+    for (auto level = this->Levels.rbegin(); level != this->Levels.rend();
+         ++level)
+    {
+      // The first of the 256 entries below the block found one level up.
+      rank <<= 8;
+      while (n >= (*level)[rank])
+      {
+        n -= (*level)[rank++];
+      }
+    }
+    return static_cast<std::uint32_t>(rank);
+  }
+};
+
+template <typename T>
+struct HistogramMedianWorker
+{
+  // The position of each voxel value in Values.
+  const std::uint32_t* Ranks;
+  // The distinct values in increasing order.
+  const T* Values;
+  size_t NumberOfValues;
+  T* Output;
+  int Dims[3];
+  int Radius[3];
+  vtkSMPThreadLocal<Histogram> Histograms;
+
+  // The rows of all the slices are split among the threads, so that a 2D
+  // image is also processed in parallel.
+  void operator()(vtkIdType beginRow, vtkIdType endRow)
+  {
+    auto& histogram = this->Histograms.Local();
+    if (histogram.Levels.empty())
+    {
+      histogram.Allocate(this->NumberOfValues);
+    }
+    const int nx = this->Dims[0];
+    const int ny = this->Dims[1];
+    const int nz = this->Dims[2];
+    const int rx = this->Radius[0];
+    for (auto row = beginRow; row < endRow; ++row)
+    {
+      auto z = static_cast<int>(row / ny);
+      auto y = static_cast<int>(row % ny);
+      auto z0 = std::max(z - this->Radius[2], 0);
+      auto z1 = std::min(z + this->Radius[2], nz - 1);
+      auto y0 = std::max(y - this->Radius[1], 0);
+      auto y1 = std::min(y + this->Radius[1], ny - 1);
+      auto planeSize = (y1 - y0 + 1) * (z1 - z0 + 1);
+      // Add or remove the voxels of the box in the plane x.
+      auto addPlane = [&](int x, std::int32_t count) {
+        for (auto zz = z0; zz <= z1; ++zz)
+        {
+          auto ranks = this->Ranks + (static_cast<size_t>(zz) * ny) * nx;
+          for (auto yy = y0; yy <= y1; ++yy)
+          {
+            histogram.Add(ranks[static_cast<size_t>(yy) * nx + x], count);
+          }
+        }
+      };
+
+      for (auto x = 0; x <= std::min(rx, nx - 1); ++x)
+      {
+        addPlane(x, 1);
+      }
+      auto output = this->Output + (static_cast<size_t>(z) * ny + y) * nx;
+      for (int x = 0; x < nx; ++x)
+      {
+        if (x > 0)
+        {
+          if (x + rx < nx)
+          {
+            addPlane(x + rx, 1);
+          }
+          if (x - rx - 1 >= 0)
+          {
+            addPlane(x - rx - 1, -1);
+          }
+        }
+        auto count =
+            (std::min(x + rx, nx - 1) - std::max(x - rx, 0) + 1) * planeSize;
+        output[x] = this->Values[histogram.Select(count / 2)];
+      }
+
+      // Empty the histogram for the next row.
+      for (auto x = std::max(nx - 1 - rx, 0); x < nx; ++x)
+      {
+        addPlane(x, -1);
+      }
+    }
+  }
+};
+
+struct HistogramMedianDispatch
+{
+  template <typename T>
+  void Execute(const T* input, T* output, int dims[3], int kernelSize[3])
+  {
+    auto numberOfVoxels = static_cast<size_t>(dims[0]) * dims[1] * dims[2];
+
+    // Work with the ranks of the values rather than the values themselves,
+    // this works for any scalar type and keeps the histogram as small as the
+    // number of distinct values.
+    std::vector<T> values(input, input + numberOfVoxels);
+    vtkSMPTools::Sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    std::vector<std::uint32_t> ranks(numberOfVoxels);
+    vtkSMPTools::For(0, static_cast<vtkIdType>(numberOfVoxels),
+                     [&](vtkIdType begin, vtkIdType end) {
+                       for (auto i = begin; i < end; ++i)
+                       {
+                         ranks[i] = static_cast<std::uint32_t>(
+                             std::lower_bound(values.begin(), values.end(),
+                                              input[i]) -
+                             values.begin());
+                       }
+                     });
+
+    HistogramMedianWorker<T> worker;
+    worker.Ranks = ranks.data();
+    worker.Values = values.data();
+    worker.NumberOfValues = values.size();
+    worker.Output = output;
+    for (auto i = 0; i < 3; ++i)
+    {
+      worker.Dims[i] = dims[i];
+      worker.Radius[i] = kernelSize[i] / 2;
+    }
+    vtkSMPTools::For(0, static_cast<vtkIdType>(dims[1]) * dims[2], worker);
+  }
+};
+
+void HistogramMedian(vtkImageData* input, int kernelSize[3],
+                     vtkImageData* output)
+{
+  output->DeepCopy(input);
+  int dims[3];
+  input->GetDimensions(dims);
+  HistogramMedianDispatch dispatch;
+  auto in = input->GetScalarPointer();
+  auto out = output->GetScalarPointer();
+  switch (input->GetScalarType())
+  {
+    vtkTemplateMacro(dispatch.Execute(static_cast<const VTK_TT*>(in),
+                                      static_cast<VTK_TT*>(out), dims,
+                                      kernelSize));
+  }
+}
+
+template <typename T>
+struct VanHerkWorker
+{
+  T* Data;
+  int Dims[3];
+  int Axis;
+  int Radius;
+  bool Dilate;
+
+  struct Buffers
+  {
+    std::vector<T> Line;
+    std::vector<T> Forward;
+    std::vector<T> Backward;
+  };
+  vtkSMPThreadLocal<Buffers> LocalBuffers;
+
+  T Select(T a, T b) const
+  {
+    return this->Dilate ? std::max(a, b) : std::min(a, b);
+  }
+
+  void operator()(vtkIdType beginLine, vtkIdType endLine)
+  {
+    auto& b = this->LocalBuffers.Local();
+    const vtkIdType strides[3] = {1, this->Dims[0],
+                                  static_cast<vtkIdType>(this->Dims[0]) *
+                                      this->Dims[1]};
+    // The lines are numbered over the other two axes.
+    const int a0 = this->Axis == 0 ? 1 : 0;
+    const int a1 = this->Axis == 2 ? 1 : 2;
+    const int n = this->Dims[this->Axis];
+    const vtkIdType stride = strides[this->Axis];
+    const int k = 2 * this->Radius + 1;
+
+    // Pad the line with Radius values that never win at each end and round
+    // it up to a whole number of blocks of k values.
+    const int length = ((n + 2 * this->Radius + k - 1) / k) * k;
+    const T identity = this->Dilate ? std::numeric_limits<T>::lowest()
+                                    : std::numeric_limits<T>::max();
+    b.Line.assign(length, identity);
+    b.Forward.resize(length);
+    b.Backward.resize(length);
+
+    for (auto line = beginLine; line < endLine; ++line)
+    {
+      auto i0 = line % this->Dims[a0];
+      auto i1 = line / this->Dims[a0];
+      auto data = this->Data + i0 * strides[a0] + i1 * strides[a1];
+      for (int i = 0; i < n; ++i)
+      {
+        b.Line[this->Radius + i] = data[i * stride];
+      }
+
+      // Running maximum (or minimum) from the start of each block forwards,
+      // and from the end of each block backwards.
+      for (int j = 0; j < length; ++j)
+      {
+        b.Forward[j] =
+            j % k == 0 ? b.Line[j] : this->Select(b.Forward[j - 1], b.Line[j]);
+      }
+      for (int j = length - 1; j >= 0; --j)
+      {
+        b.Backward[j] = j % k == k - 1
+            ? b.Line[j]
+            : this->Select(b.Backward[j + 1], b.Line[j]);
+      }
+
+      // A window of k values spans at most two blocks: the end of one and
+      // the start of the next.
+      for (int i = 0; i < n; ++i)
+      {
+        data[i * stride] = this->Select(b.Backward[i], b.Forward[i + k - 1]);
+      }
+    }
+  }
+};
+
+struct VanHerkDispatch
+{
+  template <typename T>
+  void Execute(T* data, int dims[3], int kernelSize[3], bool dilate)
+  {
+    for (auto axis = 0; axis < 3; ++axis)
+    {
+      if (kernelSize[axis] < 2 || dims[axis] < 2)
+      {
+        continue;
+      }
+      VanHerkWorker<T> worker;
+      worker.Data = data;
+      for (auto i = 0; i < 3; ++i)
+      {
+        worker.Dims[i] = dims[i];
+      }
+      worker.Axis = axis;
+      worker.Radius = kernelSize[axis] / 2;
+      worker.Dilate = dilate;
+      auto numberOfLines =
+          static_cast<vtkIdType>(dims[0]) * dims[1] * dims[2] / dims[axis];
+      vtkSMPTools::For(0, numberOfLines, worker);
+    }
+  }
+};
+
+void VanHerkMorphology(vtkImageData* input, int kernelSize[3], bool dilate,
+                       vtkImageData* output)
+{
+  // The passes along each axis work in place on a copy of the input.
+  output->DeepCopy(input);
+  int dims[3];
+  output->GetDimensions(dims);
+  VanHerkDispatch dispatch;
+  auto data = output->GetScalarPointer();
+  switch (output->GetScalarType())
+  {
+    vtkTemplateMacro(dispatch.Execute(static_cast<VTK_TT*>(data), dims,
+                                      kernelSize, dilate));
+  }
+}
+
+vtkIdType CountDifferences(vtkImageData* a, vtkImageData* b)
+{
+  auto scalarsA = a->GetPointData()->GetScalars();
+  auto scalarsB = b->GetPointData()->GetScalars();
+  vtkIdType differences = 0;
+  for (vtkIdType i = 0; i < scalarsA->GetNumberOfTuples(); ++i)
+  {
+    if (scalarsA->GetTuple1(i) != scalarsB->GetTuple1(i))
+    {
+      ++differences;
+    }
+  }
+  return differences;
+}
+
+} // namespace
@@ -0,0 +1,520 @@
+#include <vtkCamera.h>
+#include <vtkImageActor.h>
+#include <vtkImageCast.h>
+#include <vtkImageData.h>
+#include <vtkImageExtractComponents.h>
+#include <vtkImageFFT.h>
+#include <vtkImageIdealHighPass.h>
+#include <vtkImageMapToWindowLevelColors.h>
+#include <vtkImageMapper3D.h>
+#include <vtkImageProperty.h>
+#include <vtkImageRFFT.h>
+#include <vtkImageReader2.h>
+#include <vtkImageReader2Factory.h>
+#include <vtkInteractorStyleImage.h>
+#include <vtkMath.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkTextActor.h>
+#include <vtkTextProperty.h>
+#include <vtkTimerLog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+using Complex = std::complex<float>;
+
+// Everything a transform of one length needs that does not depend on the
+// data: the bit reversed order and the twiddle factors.
+struct FFTPlan
+{
+  explicit FFTPlan(int size);
+
+  // In place, unnormalized, complex transform of Size values.
+  void Transform(Complex* data, bool inverse) const;
+
+  int Size;
+  std::vector<int> BitReverse;
+  // exp(-2 pi i j / Size) for j < Size / 2.
+  std::vector<Complex> Twiddles;
+  // exp(-2 pi i k / (2 Size)) for k <= Size, used to split a transform of
+  // 2 Size real values computed as Size complex values.
+  std::vector<Complex> RealTwiddles;
+};
+
+// Plans are built once per length and reused for every image of that shape.
+class FFTPlanCache
+{
+public:
+  FFTPlan const& Get(int size);
+
+private:
+  std::map<int, std::unique_ptr<FFTPlan>> Plans;
+};
+
+// Ideal high pass filtering of a float image in the frequency domain, with
+// real to complex transforms that only store the Width / 2 + 1 non-redundant
+// columns of the spectrum, in single precision.
+class RealFFTHighPassFilter
+{
+public:
+  RealFFTHighPassFilter(int width, int height, double xCutOff,
+                        double yCutOff);
+
+  // Filters image, of Width x Height values, in place.
+  void Filter(float* image);
+
+  size_t GetSpectrumSize() const
+  {
+    return this->Spectrum.size() * sizeof(Complex);
+  }
+
+private:
+  // Width and Height are powers of two, the image is mirrored into the
+  // padded buffer if it is smaller.
+  int ImageWidth;
+  int ImageHeight;
+  int Width;
+  int Height;
+  int Columns;
+  std::vector<float> Padded;
+  std::vector<Complex> Spectrum;
+  // Includes the normalization of the inverse transform.
+  std::vector<float> Mask;
+  FFTPlanCache Plans;
+  vtkSMPThreadLocal<std::vector<Complex>> Buffers;
+};
+
+int NextPowerOfTwo(int n);
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  // Verify input arguments.
+  if (argc < 2)
+  {
+    std::cout << "Usage: " << argv[0]
+              << " Filename [numberOfFrames] e.g. fullhead15.png 100"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  auto numberOfFrames = argc > 2 ? std::max(1, std::atoi(argv[2])) : 100;
+
+  // Read the image
+  vtkNew<vtkImageReader2Factory> readerFactory;
+  vtkSmartPointer<vtkImageReader2> reader;
+  reader.TakeReference(readerFactory->CreateImageReader2(argv[1]));
+  if (!reader)
+  {
+    std::cout << "Cannot read " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+  reader->SetFileName(argv[1]);
+
+  vtkNew<vtkImageExtractComponents> luminance;
+  luminance->SetInputConnection(reader->GetOutputPort());
+  luminance->SetComponents(0);
+
+  vtkNew<vtkImageCast> cast;
+  cast->SetInputConnection(luminance->GetOutputPort());
+  cast->SetOutputScalarTypeToFloat();
+  cast->Update();
+  auto image = cast->GetOutput();
+  int dims[3];
+  image->GetDimensions(dims);
+  if (dims[2] != 1)
+  {
+    std::cout << "Only 2D images are supported." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkNew<vtkTimerLog> timer;
+
+  // The vtk pipeline, as in the IdealHighPass example. Each frame stands in
+  // for a new video frame of the same shape.
+  vtkNew<vtkImageFFT> fft;
+  fft->SetInputData(image);
+
+  vtkNew<vtkImageIdealHighPass> idealHighPass;
+  idealHighPass->SetInputConnection(fft->GetOutputPort());
+  idealHighPass->SetXCutOff(0.1);
+  idealHighPass->SetYCutOff(0.1);
+
+  vtkNew<vtkImageRFFT> rfft;
+  rfft->SetInputConnection(idealHighPass->GetOutputPort());
+
+  vtkNew<vtkImageExtractComponents> real;
+  real->SetInputConnection(rfft->GetOutputPort());
+  real->SetComponents(0);
+
+  timer->StartTimer();
+  for (auto i = 0; i < numberOfFrames; ++i)
+  {
+    fft->Modified();
+    real->Update();
+  }
+  timer->StopTimer();
+  auto pipelineTime = timer->GetElapsedTime() / numberOfFrames;
+  auto pipelineSpectrumSize = fft->GetOutput()->GetActualMemorySize() +
+      idealHighPass->GetOutput()->GetActualMemorySize() +
+      rfft->GetOutput()->GetActualMemorySize();
+
+  // The same filter with cached plans and real to complex transforms.
+  vtkNew<vtkImageData> filtered;
+  filtered->DeepCopy(image);
+  auto pixels = static_cast<size_t>(dims[0]) * dims[1];
+  auto input = static_cast<float*>(image->GetScalarPointer());
+  auto output = static_cast<float*>(filtered->GetScalarPointer());
+
+  RealFFTHighPassFilter filter(dims[0], dims[1], 0.1, 0.1);
+  timer->StartTimer();
+  for (auto i = 0; i < numberOfFrames; ++i)
+  {
+    std::copy(input, input + pixels, output);
+    filter.Filter(output);
+  }
+  timer->StopTimer();
+  auto fastTime = timer->GetElapsedTime() / numberOfFrames;
+
+  auto pipelineResult = real->GetOutput()->GetPointData()->GetScalars();
+  double maxDifference = 0.0;
+  for (size_t i = 0; i < pixels; ++i)
+  {
+    auto difference =
+        pipelineResult->GetTuple1(static_cast<vtkIdType>(i)) - output[i];
+    maxDifference = std::max(maxDifference, std::abs(difference));
+  }
+
+  std::ostringstream pipelineReport;
+  pipelineReport << "vtkImageFFT: " << 1000.0 * pipelineTime
+                 << " ms per frame\n"
+                 << pipelineSpectrumSize / 1024.0 << " MiB of spectra";
+  std::ostringstream fastReport;
+  fastReport << "Real FFT: " << 1000.0 * fastTime << " ms per frame\n"
+             << filter.GetSpectrumSize() / (1024.0 * 1024.0)
+             << " MiB of spectrum";
+  std::cout << pipelineReport.str() << std::endl;
+  std::cout << fastReport.str() << std::endl;
+  std::cout << "Speedup: " << pipelineTime / std::max(fastTime, 1e-9)
+            << "x, maximum difference: " << maxDifference << std::endl;
+
+  // Create actors
+  vtkNew<vtkNamedColors> colors;
+
+  vtkNew<vtkImageMapToWindowLevelColors> pipelineColor;
+  pipelineColor->SetWindow(500);
+  pipelineColor->SetLevel(0);
+  pipelineColor->SetInputConnection(real->GetOutputPort());
+
+  vtkNew<vtkImageActor> pipelineActor;
+  pipelineActor->GetMapper()->SetInputConnection(
+      pipelineColor->GetOutputPort());
+  pipelineActor->GetProperty()->SetInterpolationTypeToNearest();
+
+  vtkNew<vtkImageMapToWindowLevelColors> fastColor;
+  fastColor->SetWindow(500);
+  fastColor->SetLevel(0);
+  fastColor->SetInputData(filtered);
+
+  vtkNew<vtkImageActor> fastActor;
+  fastActor->GetMapper()->SetInputConnection(fastColor->GetOutputPort());
+  fastActor->GetProperty()->SetInterpolationTypeToNearest();
+
+  vtkNew<vtkTextActor> pipelineText;
+  pipelineText->SetInput(pipelineReport.str().c_str());
+  pipelineText->GetTextProperty()->SetFontSize(14);
+  pipelineText->GetTextProperty()->SetColor(
+      colors->GetColor3d("Gold").GetData());
+  pipelineText->SetDisplayPosition(10, 10);
+
+  vtkNew<vtkTextActor> fastText;
+  fastText->SetInput(fastReport.str().c_str());
+  fastText->GetTextProperty()->SetFontSize(14);
+  fastText->GetTextProperty()->SetColor(colors->GetColor3d("Gold").GetData());
+  fastText->SetDisplayPosition(10, 10);
+
+  // Setup renderers.
+  vtkNew<vtkRenderer> pipelineRenderer;
+  pipelineRenderer->SetViewport(0.0, 0.0, 0.5, 1.0);
+  pipelineRenderer->AddActor(pipelineActor);
+  pipelineRenderer->AddViewProp(pipelineText);
+  pipelineRenderer->ResetCamera();
+  pipelineRenderer->SetBackground(colors->GetColor3d("SlateGray").GetData());
+
+  vtkNew<vtkRenderer> fastRenderer;
+  fastRenderer->SetViewport(0.5, 0.0, 1.0, 1.0);
+  fastRenderer->AddActor(fastActor);
+  fastRenderer->AddViewProp(fastText);
+  fastRenderer->SetActiveCamera(pipelineRenderer->GetActiveCamera());
+  fastRenderer->SetBackground(colors->GetColor3d("LightSlateGray").GetData());
+
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->SetSize(800, 400);
+  renderWindow->SetWindowName("RealFFTHighPass");
+  renderWindow->AddRenderer(pipelineRenderer);
+  renderWindow->AddRenderer(fastRenderer);
+
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  vtkNew<vtkInteractorStyleImage> style;
+
+  renderWindowInteractor->SetInteractorStyle(style);
+
+  renderWindowInteractor->SetRenderWindow(renderWindow);
+  pipelineRenderer->GetActiveCamera()->Dolly(1.4);
+  pipelineRenderer->ResetCameraClippingRange();
+  renderWindow->Render();
+  renderWindowInteractor->Initialize();
+
+  renderWindowInteractor->Start();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+
+FFTPlan::FFTPlan(int size) : Size(size)
+{
+  const double twoPi = 2.0 * vtkMath::Pi();
+  auto bits = 0;
+  while ((1 << bits) < size)
+  {
+    ++bits;
+  }
+  this->BitReverse.resize(size);
+  for (auto i = 0; i < size; ++i)
+  {
+    auto reversed = 0;
+    for (auto b = 0; b < bits; ++b)
+    {
+      reversed |= ((i >> b) & 1) << (bits - 1 - b);
+    }
+    this->BitReverse[i] = reversed;
+  }
+  // Computed in double precision so that the float factors are exact to
+  // the last bit.
+  for (auto j = 0; j < size / 2; ++j)
+  {
+    auto angle = -twoPi * j / size;
+    this->Twiddles.emplace_back(static_cast<float>(std::cos(angle)),
+                                static_cast<float>(std::sin(angle)));
+  }
+  for (auto k = 0; k <= size; ++k)
+  {
+    auto angle = -twoPi * k / (2 * size);
+    this->RealTwiddles.emplace_back(static_cast<float>(std::cos(angle)),
+                                    static_cast<float>(std::sin(angle)));
+  }
+}
+
+void FFTPlan::Transform(Complex* data, bool inverse) const
+{
+  for (auto i = 0; i < this->Size; ++i)
+  {
+    auto j = this->BitReverse[i];
+    if (i < j)
+    {
+      std::swap(data[i], data[j]);
+    }
+  }
+  for (auto length = 2; length <= this->Size; length <<= 1)
+  {
+    auto half = length / 2;
+    auto step = this->Size / length;
+    for (auto i = 0; i < this->Size; i += length)
+    {
+      for (auto j = 0; j < half; ++j)
+      {
+        auto w = this->Twiddles[j * step];
+        if (inverse)
+        {
+          w = std::conj(w);
+        }
+        auto u = data[i + j];
+        auto v = data[i + j + half] * w;
+        data[i + j] = u + v;
+        data[i + j + half] = u - v;
+      }
+    }
+  }
+}
+
+FFTPlan const& FFTPlanCache::Get(int size)
+{
+  auto& plan = this->Plans[size];
+  if (!plan)
+  {
+    plan.reset(new FFTPlan(size));
+  }
+  return *plan;
+}
+
+int NextPowerOfTwo(int n)
+{
+  auto p = 2;
+  while (p < n)
+  {
+    p <<= 1;
+  }
+  return p;
+}
+
+RealFFTHighPassFilter::RealFFTHighPassFilter(int width, int height,
+                                             double xCutOff, double yCutOff)
+  : ImageWidth(width), ImageHeight(height), Width(NextPowerOfTwo(width)),
+    Height(NextPowerOfTwo(height)), Columns(Width / 2 + 1)
+{
+  this->Padded.resize(static_cast<size_t>(this->Width) * this->Height);
+  this->Spectrum.resize(static_cast<size_t>(this->Columns) * this->Height);
+
+  // The same mask as vtkImageIdealHighPass, with frequencies in cycles per
+  // pixel. The unnormalized transforms scale the image by Width * Height / 2,
+  // see Filter, so that is divided out here.
+  auto scale = 2.0f / (static_cast<float>(this->Width) * this->Height);
+  this->Mask.resize(this->Spectrum.size());
+  for (auto y = 0; y < this->Height; ++y)
+  {
+    auto fy =
+        std::min(y, this->Height - y) / static_cast<double>(this->Height);
+    for (auto x = 0; x < this->Columns; ++x)
+    {
+      auto fx = x / static_cast<double>(this->Width);
+      auto sum =
+          (fx / xCutOff) * (fx / xCutOff) + (fy / yCutOff) * (fy / yCutOff);
+      this->Mask[static_cast<size_t>(y) * this->Columns + x] =
+          sum > 1.0 ? scale : 0.0f;
+    }
+  }
+
+  // Build the plans now, so that the threads only read them.
+  this->Plans.Get(this->Width / 2);
+  this->Plans.Get(this->Height);
+}
+
+void RealFFTHighPassFilter::Filter(float* image)
+{
+  const int w = this->Width;
+  const int h = this->Height;
+  const int half = w / 2;
+  const int columns = this->Columns;
+  auto const& rowPlan = this->Plans.Get(half);
+  auto const& columnPlan = this->Plans.Get(h);
+  auto padded = this->Padded.data();
+  auto spectrum = this->Spectrum.data();
+  auto& buffers = this->Buffers;
+
+  // Mirror the image into the power of two buffer.
+  const int iw = this->ImageWidth;
+  const int ih = this->ImageHeight;
+  auto mirror = [](int i, int n) {
+    i %= 2 * n;
+    return i < n ? i : 2 * n - 1 - i;
+  };
+  vtkSMPTools::For(0, h, [&](vtkIdType begin, vtkIdType end) {
+    for (auto y = static_cast<int>(begin); y < end; ++y)
+    {
+      auto in = image + static_cast<size_t>(mirror(y, ih)) * iw;
+      auto out = padded + static_cast<size_t>(y) * w;
+      for (auto x = 0; x < w; ++x)
+      {
+        out[x] = in[mirror(x, iw)];
+      }
+    }
+  });
+
+  // Rows: a transform of w real values is done as one of w / 2 complex values
+  // made of the even and odd samples, then split into the w / 2 + 1
+  // non-redundant frequencies.
+  vtkSMPTools::For(0, h, [&](vtkIdType begin, vtkIdType end) {
+    auto& z = buffers.Local();
+    z.resize(std::max(half, h));
+    for (auto y = begin; y < end; ++y)
+    {
+      auto row = padded + static_cast<size_t>(y) * w;
+      for (auto n = 0; n < half; ++n)
+      {
+        z[n] = Complex(row[2 * n], row[2 * n + 1]);
+      }
+      rowPlan.Transform(z.data(), false);
+      auto out = spectrum + static_cast<size_t>(y) * columns;
+      for (auto k = 0; k <= half; ++k)
+      {
+        auto zk = z[k % half];
+        auto zc = std::conj(z[(half - k) % half]);
+        auto even = (zk + zc) * 0.5f;
+        auto odd = (zk - zc) * Complex(0.0f, -0.5f);
+        out[k] = even + rowPlan.RealTwiddles[k] * odd;
+      }
+    }
+  });
+
+  // Columns: complex transforms, the mask and the inverse transforms in one
+  // pass so that each column is gathered only once.
+  vtkSMPTools::For(0, columns, [&](vtkIdType begin, vtkIdType end) {
+    auto& c = buffers.Local();
+    c.resize(std::max(half, h));
+    for (auto x = begin; x < end; ++x)
+    {
+      for (auto y = 0; y < h; ++y)
+      {
+        c[y] = spectrum[static_cast<size_t>(y) * columns + x];
+      }
+      columnPlan.Transform(c.data(), false);
+      for (auto y = 0; y < h; ++y)
+      {
+        c[y] *= this->Mask[static_cast<size_t>(y) * columns + x];
+      }
+      columnPlan.Transform(c.data(), true);
+      for (auto y = 0; y < h; ++y)
+      {
+        spectrum[static_cast<size_t>(y) * columns + x] = c[y];
+      }
+    }
+  });
+
+  // Rows back to real values: merge the frequencies into w / 2 complex values
+  // whose inverse transform holds the even and odd samples. This leaves the
+  // image scaled by w / 2 * h.
+  vtkSMPTools::For(0, ih, [&](vtkIdType begin, vtkIdType end) {
+    auto& z = buffers.Local();
+    z.resize(std::max(half, h));
+    for (auto y = begin; y < end; ++y)
+    {
+      auto in = spectrum + static_cast<size_t>(y) * columns;
+      for (auto k = 0; k < half; ++k)
+      {
+        auto xk = in[k];
+        auto xc = std::conj(in[half - k]);
+        auto even = (xk + xc) * 0.5f;
+        auto odd = (xk - xc) * 0.5f * std::conj(rowPlan.RealTwiddles[k]);
+        z[k] = even + Complex(0.0f, 1.0f) * odd;
+      }
+      rowPlan.Transform(z.data(), true);
+      auto row = padded + static_cast<size_t>(y) * w;
+      for (auto n = 0; n < half; ++n)
+      {
+        row[2 * n] = z[n].real();
+        row[2 * n + 1] = z[n].imag();
+      }
+      // Only the part covering the original image is copied back.
+      std::copy(row, row + iw, image + static_cast<size_t>(y) * iw);
+    }
+  });
+}
+
+} // namespace
@@ -0,0 +1,601 @@
+#include <vtkActor.h>
+#include <vtkCellArray.h>
+#include <vtkGeometryFilter.h>
+#include <vtkImageActor.h>
+#include <vtkImageCast.h>
+#include <vtkImageConstantPad.h>
+#include <vtkImageData.h>
+#include <vtkImageGaussianSmooth.h>
+#include <vtkImageGradient.h>
+#include <vtkImageLuminance.h>
+#include <vtkImageMagnitude.h>
+#include <vtkImageNonMaximumSuppression.h>
+#include <vtkImageToStructuredPoints.h>
+#include <vtkLinkEdgels.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkPNGReader.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProperty.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkStripper.h>
+#include <vtkSubPixelPositionEdgels.h>
+#include <vtkTextActor.h>
+#include <vtkTextProperty.h>
+#include <vtkThreshold.h>
+#include <vtkTimerLog.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct CannyParameters
+{
+  double StandardDeviation = 2.0;
+  // Edgels weaker than this are discarded.
+  double LowThreshold = 5.0;
+  // A chain of edgels is kept only if it contains one at least this strong.
+  double HighThreshold = 10.0;
+  // Chains with fewer edgels are discarded.
+  int MinimumLength = 5;
+};
+
+// Smoothing, gradient, gradient magnitude and non-maximum suppression in a
+// single pass over strips of image rows. Each thread works on one strip at a
+// time in small buffers that stay in cache, and only the suppressed gradient
+// magnitude is written to the full resolution output.
+// The edgels are then linked into polylines with hysteresis thresholding.
+vtkSmartPointer<vtkPolyData> FusedCanny(vtkImageData* image,
+                                        CannyParameters const& parameters);
+
+// The pipeline of the CannyEdgeDetector example, for comparison, with the
+// same standard deviation and thresholds as the fused version.
+// Returns the total size of the intermediate images in kibibytes.
+unsigned long VTKCanny(vtkPNGReader* reader, vtkPolyDataMapper* mapper,
+                       CannyParameters const& parameters);
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  vtkNew<vtkNamedColors> colors;
+
+  if (argc < 2)
+  {
+    std::cerr << "Required args: filename.png [standardDeviation] "
+                 "[lowThreshold] [highThreshold] e.g. Gourds.png 2 5 10"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  CannyParameters parameters;
+  if (argc > 2)
+  {
+    parameters.StandardDeviation = std::atof(argv[2]);
+  }
+  if (argc > 3)
+  {
+    parameters.LowThreshold = std::atof(argv[3]);
+  }
+  if (argc > 4)
+  {
+    parameters.HighThreshold = std::atof(argv[4]);
+  }
+
+  vtkNew<vtkPNGReader> imageIn;
+  imageIn->SetFileName(argv[1]);
+  imageIn->Update();
+  auto image = imageIn->GetOutput();
+  int dims[3];
+  image->GetDimensions(dims);
+  std::cout << "Image size: " << dims[0] << " x " << dims[1] << std::endl;
+
+  vtkNew<vtkTimerLog> timer;
+
+  // The pipeline of vtk filters.
+  vtkNew<vtkPolyDataMapper> pipelineMapper;
+  timer->StartTimer();
+  auto pipelineMemory = VTKCanny(imageIn, pipelineMapper, parameters);
+  timer->StopTimer();
+  auto pipelineTime = timer->GetElapsedTime();
+  auto pipelineEdges = vtkPolyData::SafeDownCast(pipelineMapper->GetInput());
+
+  // The fused version.
+  timer->StartTimer();
+  auto edges = FusedCanny(image, parameters);
+  timer->StopTimer();
+  auto fusedTime = timer->GetElapsedTime();
+  // The only full size intermediate is the image of edgels, in kibibytes as
+  // reported by vtkDataObject::GetActualMemorySize.
+  auto fusedMemory =
+      static_cast<double>(dims[0]) * dims[1] * sizeof(float) / 1024.0;
+
+  std::ostringstream pipelineReport;
+  pipelineReport << "vtk pipeline: " << pipelineTime << " s\n"
+                 << pipelineMemory / 1024.0 << " MiB in intermediate images\n"
+                 << pipelineEdges->GetNumberOfLines() << " polylines";
+  std::ostringstream fusedReport;
+  fusedReport << "Fused: " << fusedTime << " s using "
+              << vtkSMPTools::GetEstimatedNumberOfThreads() << " threads\n"
+              << fusedMemory / 1024.0 << " MiB in intermediate images\n"
+              << edges->GetNumberOfLines() << " polylines";
+  std::cout << pipelineReport.str() << std::endl;
+  std::cout << fusedReport.str() << std::endl;
+
+  // Define viewport ranges
+  // (xmin, ymin, xmax, ymax)
+  double originalViewport[4] = {0.0, 0.0, 0.333, 1.0};
+  double pipelineViewport[4] = {0.333, 0.0, 0.667, 1.0};
+  double fusedViewport[4] = {0.667, 0.0, 1.0, 1.0};
+
+  vtkNew<vtkRenderer> originalRenderer;
+  originalRenderer->SetViewport(originalViewport);
+  originalRenderer->SetBackground(colors->GetColor3d("SlateGray").GetData());
+  vtkNew<vtkRenderer> pipelineRenderer;
+  pipelineRenderer->SetViewport(pipelineViewport);
+  pipelineRenderer->SetBackground(
+      colors->GetColor3d("LightSlateGray").GetData());
+  vtkNew<vtkRenderer> fusedRenderer;
+  fusedRenderer->SetViewport(fusedViewport);
+  fusedRenderer->SetBackground(colors->GetColor3d("LightSlateGray").GetData());
+  pipelineRenderer->SetActiveCamera(originalRenderer->GetActiveCamera());
+  fusedRenderer->SetActiveCamera(originalRenderer->GetActiveCamera());
+
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->SetSize(900, 300);
+  renderWindow->SetMultiSamples(0);
+  renderWindow->AddRenderer(originalRenderer);
+  renderWindow->AddRenderer(pipelineRenderer);
+  renderWindow->AddRenderer(fusedRenderer);
+  renderWindow->SetWindowName("FusedCannyEdgeDetector");
+
+  vtkNew<vtkRenderWindowInteractor> interactor;
+  interactor->SetRenderWindow(renderWindow);
+
+  vtkNew<vtkImageActor> imageActor;
+  imageActor->SetInputData(image);
+  originalRenderer->AddActor(imageActor);
+
+  vtkNew<vtkActor> pipelineActor;
+  pipelineActor->SetMapper(pipelineMapper);
+  pipelineActor->GetProperty()->SetAmbient(1.0);
+  pipelineActor->GetProperty()->SetDiffuse(0.0);
+  pipelineActor->GetProperty()->SetColor(
+      colors->GetColor3d("GhostWhite").GetData());
+  pipelineRenderer->AddActor(pipelineActor);
+
+  vtkNew<vtkPolyDataMapper> fusedMapper;
+  fusedMapper->SetInputData(edges);
+  fusedMapper->ScalarVisibilityOff();
+  vtkNew<vtkActor> fusedActor;
+  fusedActor->SetMapper(fusedMapper);
+  fusedActor->GetProperty()->SetAmbient(1.0);
+  fusedActor->GetProperty()->SetDiffuse(0.0);
+  fusedActor->GetProperty()->SetColor(
+      colors->GetColor3d("GhostWhite").GetData());
+  fusedRenderer->AddActor(fusedActor);
+
+  vtkNew<vtkTextActor> pipelineText;
+  pipelineText->SetInput(pipelineReport.str().c_str());
+  pipelineText->GetTextProperty()->SetFontSize(12);
+  pipelineText->GetTextProperty()->SetColor(
+      colors->GetColor3d("Gold").GetData());
+  pipelineText->SetDisplayPosition(5, 5);
+  pipelineRenderer->AddViewProp(pipelineText);
+
+  vtkNew<vtkTextActor> fusedText;
+  fusedText->SetInput(fusedReport.str().c_str());
+  fusedText->GetTextProperty()->SetFontSize(12);
+  fusedText->GetTextProperty()->SetColor(colors->GetColor3d("Gold").GetData());
+  fusedText->SetDisplayPosition(5, 5);
+  fusedRenderer->AddViewProp(fusedText);
+
+  originalRenderer->ResetCamera();
+
+  // Render the image.
+  interactor->Initialize();
+  renderWindow->Render();
+
+  interactor->Start();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+
+// Rows processed together by one thread.
+constexpr int StripHeight = 32;
+
+template <typename T>
+float Luminance(const T* p, int numberOfComponents)
+{
+  // The same weights as vtkImageLuminance.
+  if (numberOfComponents >= 3)
+  {
+    return static_cast<float>(0.30 * p[0] + 0.59 * p[1] + 0.11 * p[2]);
+  }
+  return static_cast<float>(p[0]);
+}
+
+struct StripBuffers
+{
+  std::vector<float> Row;
+  std::vector<float> Luminance;
+  std::vector<float> Smoothed;
+  std::vector<float> GradientX;
+  std::vector<float> GradientY;
+  std::vector<float> Magnitude;
+};
+
+template <typename T>
+struct FusedCannyWorker
+{
+  const T* Input;
+  int NumberOfComponents;
+  int Width;
+  int Height;
+  std::vector<float> Kernel;
+  int Radius;
+  float* Edgels;
+  vtkSMPThreadLocal<StripBuffers> Buffers;
+
+  // Clamp to the image, i.e. replicate the border.
+  int ClampRow(int y) const
+  {
+    return std::min(std::max(y, 0), this->Height - 1);
+  }
+
+  void operator()(vtkIdType firstStrip, vtkIdType lastStrip)
+  {
+    auto& b = this->Buffers.Local();
+    const int w = this->Width;
+    const int r = this->Radius;
+    for (auto strip = firstStrip; strip < lastStrip; ++strip)
+    {
+      const int y0 = static_cast<int>(strip) * StripHeight;
+      const int y1 = std::min(y0 + StripHeight, this->Height);
+      // Non-maximum suppression needs the gradient one row above and below,
+      // the gradient needs the smoothed image one more row above and below
+      // and the smoothing needs Radius more rows of luminance.
+      const int gradientRows = y1 - y0 + 2;
+      const int smoothedRows = y1 - y0 + 4;
+      const int luminanceRows = smoothedRows + 2 * r;
+      b.Row.resize(w);
+      b.Luminance.resize(static_cast<size_t>(luminanceRows) * w);
+      b.Smoothed.resize(static_cast<size_t>(smoothedRows) * w);
+      b.GradientX.resize(static_cast<size_t>(gradientRows) * w);
+      b.GradientY.resize(static_cast<size_t>(gradientRows) * w);
+      b.Magnitude.resize(static_cast<size_t>(gradientRows) * w);
+
+      // Luminance smoothed along x, row i of the buffer is image row
+      // y0 - 2 - r + i.
+      for (int i = 0; i < luminanceRows; ++i)
+      {
+        auto in = this->Input +
+            static_cast<size_t>(this->ClampRow(y0 - 2 - r + i)) * w *
+                this->NumberOfComponents;
+        for (int x = 0; x < w; ++x)
+        {
+          b.Row[x] = Luminance(in + x * this->NumberOfComponents,
+                             this->NumberOfComponents);
+        }
+        auto out = &b.Luminance[static_cast<size_t>(i) * w];
+        for (int x = 0; x < w; ++x)
+        {
+          float sum = 0.0f;
+          for (int k = -r; k <= r; ++k)
+          {
+            sum += this->Kernel[k + r] *
+                b.Row[std::min(std::max(x + k, 0), w - 1)];
+          }
+          out[x] = sum;
+        }
+      }
+
+      // Smooth along y, row i of the buffer is image row y0 - 2 + i.
+      for (int i = 0; i < smoothedRows; ++i)
+      {
+        auto out = &b.Smoothed[static_cast<size_t>(i) * w];
+        std::fill(out, out + w, 0.0f);
+        for (int k = -r; k <= r; ++k)
+        {
+          auto in = &b.Luminance[static_cast<size_t>(i + r + k) * w];
+          auto weight = this->Kernel[k + r];
+          for (int x = 0; x < w; ++x)
+          {
+            out[x] += weight * in[x];
+          }
+        }
+      }
+
+      // Central difference gradient and its magnitude, row i of the buffer
+      // is image row y0 - 1 + i.
+      for (int i = 0; i < gradientRows; ++i)
+      {
+        auto above = &b.Smoothed[static_cast<size_t>(i) * w];
+        auto s = above + w;
+        auto below = s + w;
+        auto gx = &b.GradientX[static_cast<size_t>(i) * w];
+        auto gy = &b.GradientY[static_cast<size_t>(i) * w];
+        auto m = &b.Magnitude[static_cast<size_t>(i) * w];
+        for (int x = 0; x < w; ++x)
+        {
+          gx[x] = 0.5f * (s[std::min(x + 1, w - 1)] - s[std::max(x - 1, 0)]);
+          gy[x] = 0.5f * (below[x] - above[x]);
+          m[x] = std::sqrt(gx[x] * gx[x] + gy[x] * gy[x]);
+        }
+      }
+
+      // Keep the magnitude only where it is a maximum along the gradient.
+      for (int y = y0; y < y1; ++y)
+      {
+        auto i = static_cast<size_t>(y - y0 + 1) * w;
+        auto out = this->Edgels + static_cast<size_t>(y) * w;
+        for (int x = 0; x < w; ++x)
+        {
+          auto m = b.Magnitude[i + x];
+          if (m == 0.0f)
+          {
+            out[x] = 0.0f;
+            continue;
+          }
+          // Step to the neighbouring pixel closest to the gradient direction.
+          auto gx = b.GradientX[i + x] / m;
+          auto gy = b.GradientY[i + x] / m;
+          int dx = gx > 0.3827f ? 1 : (gx < -0.3827f ? -1 : 0);
+          int dy = gy > 0.3827f ? 1 : (gy < -0.3827f ? -1 : 0);
+          auto xa = std::min(std::max(x + dx, 0), w - 1);
+          auto xb = std::min(std::max(x - dx, 0), w - 1);
+          auto ahead = b.Magnitude[i + dy * w + xa];
+          auto behind = b.Magnitude[i - dy * w + xb];
+          out[x] = (m >= ahead && m > behind) ? m : 0.0f;
+        }
+      }
+    }
+  }
+};
+
+struct FusedCannyDispatch
+{
+  template <typename T>
+  void Execute(const T* input, int numberOfComponents, int width, int height,
+               std::vector<float> const& kernel, float* edgels)
+  {
+    FusedCannyWorker<T> worker;
+    worker.Input = input;
+    worker.NumberOfComponents = numberOfComponents;
+    worker.Width = width;
+    worker.Height = height;
+    worker.Kernel = kernel;
+    worker.Radius = static_cast<int>(kernel.size() / 2);
+    worker.Edgels = edgels;
+    vtkIdType numberOfStrips = (height + StripHeight - 1) / StripHeight;
+    vtkSMPTools::For(0, numberOfStrips, worker);
+  }
+};
+
+// Follow a chain of connected edgels stronger than the low threshold,
+// marking them as used.
+void TraceChain(std::vector<float> const& edgels, std::vector<char>& used,
+                int width, int height, float lowThreshold, int x, int y,
+                std::vector<std::array<int, 2>>& chain)
+{
+  static const int offsets[8][2] = {{1, 0},  {1, 1},   {0, 1},  {-1, 1},
+                                    {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+  while (true)
+  {
+    chain.push_back({x, y});
+    used[static_cast<size_t>(y) * width + x] = 1;
+    auto found = false;
+    for (auto const& o : offsets)
+    {
+      auto nx = x + o[0];
+      auto ny = y + o[1];
+      if (nx < 0 || ny < 0 || nx >= width || ny >= height)
+      {
+        continue;
+      }
+      auto n = static_cast<size_t>(ny) * width + nx;
+      if (!used[n] && edgels[n] >= lowThreshold)
+      {
+        x = nx;
+        y = ny;
+        found = true;
+        break;
+      }
+    }
+    if (!found)
+    {
+      return;
+    }
+  }
+}
+
+vtkSmartPointer<vtkPolyData> FusedCanny(vtkImageData* image,
+                                        CannyParameters const& parameters)
+{
+  int dims[3];
+  image->GetDimensions(dims);
+  const int width = dims[0];
+  const int height = dims[1];
+
+  // Gaussian kernel, the radius is one standard deviation as in the
+  // CannyEdgeDetector example.
+  auto sigma = std::max(parameters.StandardDeviation, 0.1);
+  auto radius = std::max(1, static_cast<int>(std::ceil(sigma)));
+  std::vector<float> kernel(2 * radius + 1);
+  auto sum = 0.0;
+  for (auto k = -radius; k <= radius; ++k)
+  {
+    kernel[k + radius] =
+        static_cast<float>(std::exp(-0.5 * k * k / (sigma * sigma)));
+    sum += kernel[k + radius];
+  }
+  for (auto& k : kernel)
+  {
+    k = static_cast<float>(k / sum);
+  }
+
+  std::vector<float> edgels(static_cast<size_t>(width) * height);
+  FusedCannyDispatch dispatch;
+  auto input = image->GetScalarPointer();
+  auto numberOfComponents = image->GetNumberOfScalarComponents();
+  switch (image->GetScalarType())
+  {
+    vtkTemplateMacro(dispatch.Execute(static_cast<const VTK_TT*>(input),
+                                      numberOfComponents, width, height,
+                                      kernel, edgels.data()));
+  }
+
+  // Hysteresis: start a chain at every unused strong edgel and follow the
+  // weaker ones connected to it. Trace in both directions from the start.
+  vtkNew<vtkPoints> points;
+  vtkNew<vtkCellArray> lines;
+  std::vector<char> used(edgels.size(), 0);
+  auto low = static_cast<float>(parameters.LowThreshold);
+  auto high = static_cast<float>(parameters.HighThreshold);
+  double origin[3];
+  double spacing[3];
+  image->GetOrigin(origin);
+  image->GetSpacing(spacing);
+  std::vector<std::array<int, 2>> forward;
+  std::vector<std::array<int, 2>> backward;
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x)
+    {
+      auto i = static_cast<size_t>(y) * width + x;
+      if (used[i] || edgels[i] < high)
+      {
+        continue;
+      }
+      forward.clear();
+      backward.clear();
+      TraceChain(edgels, used, width, height, low, x, y, forward);
+      used[i] = 0;
+      TraceChain(edgels, used, width, height, low, x, y, backward);
+      if (static_cast<int>(forward.size() + backward.size()) - 1 <
+          parameters.MinimumLength)
+      {
+        continue;
+      }
+      lines->InsertNextCell(
+          static_cast<vtkIdType>(forward.size() + backward.size() - 1));
+      for (auto it = backward.rbegin(); it != backward.rend(); ++it)
+      {
+        lines->InsertCellPoint(points->InsertNextPoint(
+            origin[0] + spacing[0] * (*it)[0],
+            origin[1] + spacing[1] * (*it)[1], origin[2]));
+      }
+      for (size_t j = 1; j < forward.size(); ++j)
+      {
+        lines->InsertCellPoint(points->InsertNextPoint(
+            origin[0] + spacing[0] * forward[j][0],
+            origin[1] + spacing[1] * forward[j][1], origin[2]));
+      }
+    }
+  }
+
+  auto polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->SetPoints(points);
+  polyData->SetLines(lines);
+  return polyData;
+}
+
+unsigned long VTKCanny(vtkPNGReader* imageIn, vtkPolyDataMapper* mapper,
+                       CannyParameters const& parameters)
+{
+  vtkNew<vtkImageLuminance> il;
+  il->SetInputConnection(imageIn->GetOutputPort());
+
+  vtkNew<vtkImageCast> ic;
+  ic->SetOutputScalarTypeToFloat();
+  ic->SetInputConnection(il->GetOutputPort());
+
+  vtkNew<vtkImageGaussianSmooth> gs;
+  gs->SetInputConnection(ic->GetOutputPort());
+  gs->SetDimensionality(2);
+  auto sigma = std::max(parameters.StandardDeviation, 0.1);
+  gs->SetStandardDeviations(sigma, sigma, 0);
+  gs->SetRadiusFactors(1, 1, 0);
+
+  vtkNew<vtkImageGradient> imgGradient;
+  imgGradient->SetInputConnection(gs->GetOutputPort());
+  imgGradient->SetDimensionality(2);
+
+  vtkNew<vtkImageMagnitude> imgMagnitude;
+  imgMagnitude->SetInputConnection(imgGradient->GetOutputPort());
+
+  vtkNew<vtkImageNonMaximumSuppression> nonMax;
+  imgMagnitude->Update();
+  nonMax->SetMagnitudeInputData(imgMagnitude->GetOutput());
+  imgGradient->Update();
+  nonMax->SetVectorInputData(imgGradient->GetOutput());
+  nonMax->SetDimensionality(2);
+
+  vtkNew<vtkImageConstantPad> pad;
+  pad->SetInputConnection(imgGradient->GetOutputPort());
+  pad->SetOutputNumberOfScalarComponents(3);
+  pad->SetConstant(0);
+
+  vtkNew<vtkImageToStructuredPoints> i2sp1;
+  i2sp1->SetInputConnection(nonMax->GetOutputPort());
+  pad->Update();
+  i2sp1->SetVectorInputData(pad->GetOutput());
+
+  vtkNew<vtkLinkEdgels> imgLink;
+  imgLink->SetInputConnection(i2sp1->GetOutputPort());
+  imgLink->SetGradientThreshold(parameters.LowThreshold);
+
+  vtkNew<vtkThreshold> thresholdEdges;
+  thresholdEdges->SetInputConnection(imgLink->GetOutputPort());
+  thresholdEdges->SetUpperThreshold(parameters.HighThreshold);
+  thresholdEdges->SetThresholdFunction(vtkThreshold::THRESHOLD_UPPER);
+  thresholdEdges->AllScalarsOff();
+
+  vtkNew<vtkGeometryFilter> gf;
+  gf->SetInputConnection(thresholdEdges->GetOutputPort());
+
+  vtkNew<vtkImageToStructuredPoints> i2sp;
+  i2sp->SetInputConnection(imgMagnitude->GetOutputPort());
+  i2sp->SetVectorInputData(pad->GetOutput());
+
+  vtkNew<vtkSubPixelPositionEdgels> spe;
+  spe->SetInputConnection(gf->GetOutputPort());
+  i2sp->Update();
+  spe->SetGradMapsData(i2sp->GetStructuredPointsOutput());
+
+  vtkNew<vtkStripper> strip;
+  strip->SetInputConnection(spe->GetOutputPort());
+  strip->Update();
+
+  vtkNew<vtkPolyData> edges;
+  edges->ShallowCopy(strip->GetOutput());
+  mapper->SetInputData(edges);
+  mapper->ScalarVisibilityOff();
+
+  return il->GetOutput()->GetActualMemorySize() +
+      ic->GetOutput()->GetActualMemorySize() +
+      gs->GetOutput()->GetActualMemorySize() +
+      imgGradient->GetOutput()->GetActualMemorySize() +
+      imgMagnitude->GetOutput()->GetActualMemorySize() +
+      nonMax->GetOutput()->GetActualMemorySize() +
+      pad->GetOutput()->GetActualMemorySize() +
+      i2sp1->GetOutput()->GetActualMemorySize() +
+      i2sp->GetOutput()->GetActualMemorySize();
+}
+
+} // namespace
@@ -0,0 +1,526 @@
+#include <vtkDelimitedTextReader.h>
+#include <vtkDoubleArray.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkParallelCoordinatesRepresentation.h>
+#include <vtkParallelCoordinatesView.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkStringArray.h>
+#include <vtkTable.h>
+#include <vtkTimerLog.h>
+#include <vtkTypeInt64Array.h>
+
+#include <vtksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+enum class ColumnType
+{
+  Integer,
+  Real,
+  String
+};
+
+struct Column
+{
+  std::string Name;
+  ColumnType Type = ColumnType::Integer;
+  vtkSmartPointer<vtkAbstractArray> Array;
+};
+
+// A simple, streaming CSV reader.
+// The file is read in large blocks, each block is cut at line boundaries into
+// chunks and the chunks are parsed in parallel straight into typed arrays.
+// Only the projected columns are materialised. Quoted fields containing the
+// delimiter or newlines are not supported.
+class ParallelCSVReader
+{
+public:
+  ParallelCSVReader(std::string const& fileName, char delimiter,
+                    std::vector<std::string> const& projection);
+
+  // Returns false if the file can't be read.
+  bool Read();
+
+  vtkTable* GetOutput()
+  {
+    return this->Output;
+  }
+
+  vtkIdType GetNumberOfInvalidValues() const
+  {
+    return this->NumberOfInvalidValues;
+  }
+
+private:
+  bool ReadHeader(std::ifstream& ifs);
+  void InferColumnTypes(const char* begin, const char* end);
+  void ParseBlock(const char* begin, const char* end);
+
+  std::string FileName;
+  char Delimiter;
+  std::vector<std::string> Projection;
+  std::vector<Column> Columns;
+  // Maps each field of a line to its column, or -1 if it is not projected.
+  std::vector<int> FieldToColumn;
+  std::string Leftover;
+  vtkIdType NumberOfRows = 0;
+  std::atomic<vtkIdType> NumberOfInvalidValues{0};
+  vtkNew<vtkTable> Output;
+
+  // 64 MB blocks keep the memory used by the text bounded, independent of
+  // the file size.
+  static constexpr std::streamsize BlockSize = 64 << 20;
+};
+
+std::vector<std::string> SplitLine(std::string const& line, char delimiter);
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cout << "Usage: " << argv[0]
+              << " filename.csv [-c] [column1 column2 ...] e.g. cars.csv"
+              << std::endl;
+    std::cout << "  -c also read the file with vtkDelimitedTextReader and "
+                 "compare the timings."
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::string inputFilename = argv[1];
+  auto compare = false;
+  std::vector<std::string> projection;
+  for (auto i = 2; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "-c")
+    {
+      compare = true;
+    }
+    else
+    {
+      projection.push_back(arg);
+    }
+  }
+
+  vtkNew<vtkNamedColors> colors;
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  ParallelCSVReader reader(inputFilename, ',', projection);
+  if (!reader.Read())
+  {
+    return EXIT_FAILURE;
+  }
+  timer->StopTimer();
+
+  auto table = reader.GetOutput();
+  auto megabytes = static_cast<double>(vtksys::SystemTools::FileLength(
+                       inputFilename)) /
+      (1024.0 * 1024.0);
+  std::cout << "Read " << table->GetNumberOfRows() << " rows and "
+            << table->GetNumberOfColumns() << " columns in "
+            << timer->GetElapsedTime() << " s ("
+            << megabytes / timer->GetElapsedTime() << " MB/s) using "
+            << vtkSMPTools::GetEstimatedNumberOfThreads() << " threads."
+            << std::endl;
+  if (reader.GetNumberOfInvalidValues() > 0)
+  {
+    std::cout << reader.GetNumberOfInvalidValues()
+              << " values could not be converted and were set to NaN or 0."
+              << std::endl;
+  }
+  for (vtkIdType i = 0; i < table->GetNumberOfColumns(); ++i)
+  {
+    auto column = table->GetColumn(i);
+    std::cout << i << " is " << column->GetClassName() << " named \""
+              << column->GetName() << "\"" << std::endl;
+  }
+
+  if (compare)
+  {
+    timer->StartTimer();
+    vtkNew<vtkDelimitedTextReader> delimitedTextReader;
+    delimitedTextReader->SetFileName(inputFilename.c_str());
+    delimitedTextReader->SetHaveHeaders(true);
+    delimitedTextReader->DetectNumericColumnsOn();
+    delimitedTextReader->SetFieldDelimiterCharacters(",");
+    delimitedTextReader->Update();
+    timer->StopTimer();
+    std::cout << "vtkDelimitedTextReader took " << timer->GetElapsedTime()
+              << " s." << std::endl;
+  }
+
+  // Display the numeric columns.
+  vtkNew<vtkPolyData> polydata;
+  for (vtkIdType i = 0; i < table->GetNumberOfColumns(); ++i)
+  {
+    polydata->GetPointData()->AddArray(table->GetColumn(i));
+  }
+
+  // The axes are numbered without gaps, skipping the string columns.
+  vtkNew<vtkParallelCoordinatesRepresentation> rep;
+  rep->SetInputData(polydata);
+  auto axis = 0;
+  for (vtkIdType i = 0; i < table->GetNumberOfColumns(); ++i)
+  {
+    if (vtkStringArray::SafeDownCast(table->GetColumn(i)))
+    {
+      continue;
+    }
+    rep->SetInputArrayToProcess(axis++, 0, 0, 0,
+                                table->GetColumn(i)->GetName());
+  }
+  rep->UseCurvesOn();
+  rep->SetFontSize(.5);
+  auto title = vtksys::SystemTools::GetFilenameWithoutExtension(
+      vtksys::SystemTools::GetFilenameName(inputFilename));
+  rep->SetPlotTitle(title.c_str());
+  rep->SetLineOpacity(0.5);
+  rep->SetLineColor(colors->GetColor3d("Gold").GetData());
+  rep->SetAxisColor(colors->GetColor3d("OrangeRed").GetData());
+  rep->SetAxisLabelColor(colors->GetColor3d("Yellow").GetData());
+
+  vtkNew<vtkParallelCoordinatesView> view;
+  view->SetRepresentation(rep);
+  view->SetInspectMode(1);
+  view->SetDisplayHoverText(1);
+  view->SetBrushModeToLasso();
+  view->SetBrushOperatorToReplace();
+
+  view->GetRenderWindow()->SetSize(600, 300);
+  view->GetRenderer()->SetBackground2(
+      colors->GetColor3d("MidnightBlue").GetData());
+  view->GetRenderer()->SetBackground(colors->GetColor3d("Indigo").GetData());
+  view->GetRenderWindow()->SetWindowName("ParallelCSVReader");
+  view->ResetCamera();
+  view->Render();
+
+  view->GetInteractor()->Start();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+
+ParallelCSVReader::ParallelCSVReader(std::string const& fileName,
+                                     char delimiter,
+                                     std::vector<std::string> const& projection)
+  : FileName(fileName), Delimiter(delimiter), Projection(projection)
+{
+}
+
+bool ParallelCSVReader::Read()
+{
+  std::ifstream ifs(this->FileName, std::ios::binary);
+  if (!ifs)
+  {
+    std::cerr << "Unable to open: " << this->FileName << std::endl;
+    return false;
+  }
+  if (!this->ReadHeader(ifs))
+  {
+    return false;
+  }
+
+  std::vector<char> buffer;
+  auto firstBlock = true;
+  while (ifs)
+  {
+    // Prepend the incomplete last line of the previous block.
+    buffer.assign(this->Leftover.begin(), this->Leftover.end());
+    auto leftoverSize = buffer.size();
+    buffer.resize(leftoverSize + BlockSize);
+    ifs.read(buffer.data() + leftoverSize, BlockSize);
+    buffer.resize(leftoverSize + static_cast<size_t>(ifs.gcount()));
+
+    const char* begin = buffer.data();
+    const char* end = begin + buffer.size();
+    if (ifs)
+    {
+      // Hold back the partial line, it is completed by the next block.
+      auto lastNewline = end;
+      while (lastNewline != begin && *(lastNewline - 1) != '\n')
+      {
+        --lastNewline;
+      }
+      this->Leftover.assign(lastNewline, end);
+      end = lastNewline;
+    }
+    else
+    {
+      this->Leftover.clear();
+    }
+    // The numeric parsers stop at the first character that is not part of
+    // a number, a terminating zero guarantees they stop inside the buffer.
+    auto length = end - begin;
+    buffer.insert(buffer.begin() + length, '\0');
+    begin = buffer.data();
+    end = begin + length;
+
+    if (firstBlock && begin != end)
+    {
+      this->InferColumnTypes(begin, end);
+      firstBlock = false;
+    }
+    this->ParseBlock(begin, end);
+  }
+  if (firstBlock)
+  {
+    // No data, only a header.
+    this->InferColumnTypes(nullptr, nullptr);
+  }
+
+  for (auto& column : this->Columns)
+  {
+    column.Array->Squeeze();
+    this->Output->AddColumn(column.Array);
+  }
+  return true;
+}
+
+bool ParallelCSVReader::ReadHeader(std::ifstream& ifs)
+{
+  std::string line;
+  if (!std::getline(ifs, line))
+  {
+    std::cerr << "No header in: " << this->FileName << std::endl;
+    return false;
+  }
+  auto fields = SplitLine(line, this->Delimiter);
+  this->FieldToColumn.assign(fields.size(), -1);
+  for (size_t i = 0; i < fields.size(); ++i)
+  {
+    if (!this->Projection.empty() &&
+        std::find(this->Projection.begin(), this->Projection.end(),
+                  fields[i]) == this->Projection.end())
+    {
+      continue;
+    }
+    this->FieldToColumn[i] = static_cast<int>(this->Columns.size());
+    Column column;
+    column.Name = fields[i];
+    this->Columns.push_back(column);
+  }
+  if (this->Columns.empty())
+  {
+    std::cerr << "None of the requested columns are in: " << this->FileName
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Sample the first rows, a column is an integer column if every value is an
+// integer, a real column if every value is a number and otherwise a string
+// column. Empty fields do not affect the type.
+void ParallelCSVReader::InferColumnTypes(const char* begin, const char* end)
+{
+  std::vector<bool> isInteger(this->Columns.size(), true);
+  std::vector<bool> isReal(this->Columns.size(), true);
+  auto line = begin;
+  for (auto row = 0; row < 1000 && line < end; ++row)
+  {
+    auto lineEnd = std::find(line, end, '\n');
+    auto field = line;
+    for (size_t f = 0; f < this->FieldToColumn.size() && field <= lineEnd;
+         ++f)
+    {
+      auto fieldEnd = std::find(field, lineEnd, this->Delimiter);
+      auto last = fieldEnd;
+      if (last != field && *(last - 1) == '\r')
+      {
+        --last;
+      }
+      auto c = this->FieldToColumn[f];
+      if (c >= 0 && last != field)
+      {
+        char* stop = nullptr;
+        std::strtoll(field, &stop, 10);
+        isInteger[c] = isInteger[c] && stop == last;
+        std::strtod(field, &stop);
+        isReal[c] = isReal[c] && stop == last;
+      }
+      field = fieldEnd + 1;
+    }
+    line = lineEnd + 1;
+  }
+
+  for (size_t c = 0; c < this->Columns.size(); ++c)
+  {
+    auto& column = this->Columns[c];
+    if (isInteger[c])
+    {
+      column.Type = ColumnType::Integer;
+      column.Array = vtkSmartPointer<vtkTypeInt64Array>::New();
+    }
+    else if (isReal[c])
+    {
+      column.Type = ColumnType::Real;
+      column.Array = vtkSmartPointer<vtkDoubleArray>::New();
+    }
+    else
+    {
+      column.Type = ColumnType::String;
+      column.Array = vtkSmartPointer<vtkStringArray>::New();
+    }
+    column.Array->SetName(column.Name.c_str());
+  }
+}
+
+void ParallelCSVReader::ParseBlock(const char* begin, const char* end)
+{
+  if (begin == end)
+  {
+    return;
+  }
+
+  // Cut the block into chunks at line boundaries, a few per thread so that
+  // the load stays balanced.
+  auto numberOfChunks = static_cast<vtkIdType>(
+      4 * vtkSMPTools::GetEstimatedNumberOfThreads());
+  std::vector<const char*> chunkBegin(numberOfChunks + 1, end);
+  chunkBegin[0] = begin;
+  for (vtkIdType i = 1; i < numberOfChunks; ++i)
+  {
+    auto p = std::max(chunkBegin[i - 1], begin + (end - begin) * i /
+                                             numberOfChunks);
+    p = std::find(p, end, '\n');
+    chunkBegin[i] = p == end ? end : p + 1;
+  }
+
+  // Count the rows in each chunk so that every chunk knows where its rows
+  // go in the output arrays.
+  std::vector<vtkIdType> chunkRows(numberOfChunks + 1, 0);
+  vtkSMPTools::For(0, numberOfChunks, [&](vtkIdType first, vtkIdType last) {
+    for (auto i = first; i < last; ++i)
+    {
+      auto b = chunkBegin[i];
+      auto e = chunkBegin[i + 1];
+      auto rows = static_cast<vtkIdType>(std::count(b, e, '\n'));
+      if (e != b && *(e - 1) != '\n')
+      {
+        ++rows;
+      }
+      chunkRows[i + 1] = rows;
+    }
+  });
+  chunkRows[0] = this->NumberOfRows;
+  for (vtkIdType i = 1; i <= numberOfChunks; ++i)
+  {
+    chunkRows[i] += chunkRows[i - 1];
+  }
+  this->NumberOfRows = chunkRows[numberOfChunks];
+  for (auto& column : this->Columns)
+  {
+    column.Array->SetNumberOfValues(this->NumberOfRows);
+  }
+
+  vtkSMPTools::For(0, numberOfChunks, [&](vtkIdType first, vtkIdType last) {
+    vtkIdType invalid = 0;
+    for (auto i = first; i < last; ++i)
+    {
+      auto row = chunkRows[i];
+      auto line = chunkBegin[i];
+      auto e = chunkBegin[i + 1];
+      while (line < e)
+      {
+        auto lineEnd = std::find(line, e, '\n');
+        auto field = line;
+        for (size_t f = 0; f < this->FieldToColumn.size(); ++f)
+        {
+          auto fieldEnd = field > lineEnd
+              ? lineEnd
+              : std::find(field, lineEnd, this->Delimiter);
+          auto fieldLast = fieldEnd;
+          if (fieldLast != field && *(fieldLast - 1) == '\r')
+          {
+            --fieldLast;
+          }
+          // Missing trailing fields are treated as empty.
+          auto empty = field >= fieldLast;
+          auto c = this->FieldToColumn[f];
+          if (c >= 0)
+          {
+            auto& column = this->Columns[c];
+            char* stop = nullptr;
+            switch (column.Type)
+            {
+              case ColumnType::Integer: {
+                vtkTypeInt64 value = empty ? 0 : std::strtoll(field, &stop, 10);
+                if (empty || stop != fieldLast)
+                {
+                  value = 0;
+                  ++invalid;
+                }
+                static_cast<vtkTypeInt64Array*>(column.Array.GetPointer())
+                    ->GetPointer(0)[row] = value;
+                break;
+              }
+              case ColumnType::Real: {
+                auto value = empty ? 0.0 : std::strtod(field, &stop);
+                if (empty || stop != fieldLast)
+                {
+                  value = std::numeric_limits<double>::quiet_NaN();
+                  ++invalid;
+                }
+                static_cast<vtkDoubleArray*>(column.Array.GetPointer())
+                    ->GetPointer(0)[row] = value;
+                break;
+              }
+              case ColumnType::String: {
+                static_cast<vtkStringArray*>(column.Array.GetPointer())
+                    ->GetPointer(row)
+                    ->assign(field, empty ? field : fieldLast);
+                break;
+              }
+            }
+          }
+          field = fieldEnd + 1;
+        }
+        line = lineEnd + 1;
+        ++row;
+      }
+    }
+    this->NumberOfInvalidValues += invalid;
+  });
+}
+
+std::vector<std::string> SplitLine(std::string const& line, char delimiter)
+{
+  std::vector<std::string> fields;
+  std::string field;
+  for (auto c : line)
+  {
+    if (c == delimiter)
+    {
+      fields.push_back(field);
+      field.clear();
+    }
+    else if (c != '\r' && c != '"')
+    {
+      field += c;
+    }
+  }
+  fields.push_back(field);
+  return fields;
+}
+
+} // namespace
@@ -0,0 +1,602 @@
+//
+// GenerateFacesFromLabels
+//   Usage: GenerateFacesFromLabels InputVolume StartLabel EndLabel [-m] [-c]
+//          where
+//          InputVolume is a meta file containing a 3 volume of
+//            discrete labels.
+//          StartLabel is the first label to be processed
+//          EndLabel is the last label to be processed
+//          -m merges coplanar faces with the same label into rectangles
+//          -c also runs the vtkThreshold pipeline of
+//            GenerateCubesFromLabels for comparison
+//
+#include <vtkActor.h>
+#include <vtkCamera.h>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkGeometryFilter.h>
+#include <vtkIdTypeArray.h>
+#include <vtkImageData.h>
+#include <vtkImageWrapPad.h>
+#include <vtkMetaImageReader.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkThreshold.h>
+#include <vtkTimerLog.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The exposed faces of the voxels whose label is in [startLabel, endLabel],
+// i.e. the faces between a selected voxel and an unselected one or the
+// outside of the volume, as quads with the label as cell scalars. Faces
+// share their corner points. With mergeFaces, coplanar faces with the same
+// label are merged into rectangles.
+vtkSmartPointer<vtkPolyData> ExtractVoxelFaces(vtkImageData* labels,
+                                               double startLabel,
+                                               double endLabel,
+                                               bool mergeFaces);
+
+// The pipeline of GenerateCubesFromLabels, returns the memory used by the
+// unstructured grid of selected voxels in kibibytes.
+unsigned long ThresholdPipeline(vtkMetaImageReader* reader,
+                                double startLabel, double endLabel,
+                                vtkPolyData* output);
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  vtkNew<vtkNamedColors> colors;
+
+  if (argc < 4)
+  {
+    std::cout << "Usage: " << argv[0]
+              << " InputVolume StartLabel EndLabel [-m] [-c] e.g. "
+                 "Frog/frogtissue.mhd 1 29 -m"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Define all of the variables
+  auto startLabel = std::atof(argv[2]);
+  auto endLabel = std::atof(argv[3]);
+  auto mergeFaces = false;
+  auto compare = false;
+  for (auto i = 4; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "-m")
+    {
+      mergeFaces = true;
+    }
+    else if (arg == "-c")
+    {
+      compare = true;
+    }
+  }
+
+  vtkNew<vtkMetaImageReader> reader;
+  reader->SetFileName(argv[1]);
+  reader->Update();
+  if (reader->GetOutput()->GetNumberOfScalarComponents() != 1)
+  {
+    std::cout << "The labels must have one component." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  auto faces =
+      ExtractVoxelFaces(reader->GetOutput(), startLabel, endLabel, mergeFaces);
+  timer->StopTimer();
+  std::cout << "Voxel faces: " << faces->GetNumberOfCells() << " quads, "
+            << faces->GetNumberOfPoints() << " points in "
+            << timer->GetElapsedTime() << " s, "
+            << faces->GetActualMemorySize() / 1024.0 << " MiB" << std::endl;
+
+  if (compare)
+  {
+    vtkNew<vtkPolyData> cubes;
+    timer->StartTimer();
+    auto gridMemory =
+        ThresholdPipeline(reader, startLabel, endLabel, cubes);
+    timer->StopTimer();
+    std::cout << "vtkThreshold and vtkGeometryFilter: "
+              << cubes->GetNumberOfCells() << " quads, "
+              << cubes->GetNumberOfPoints() << " points in "
+              << timer->GetElapsedTime() << " s, " << gridMemory / 1024.0
+              << " MiB in the unstructured grid" << std::endl;
+  }
+
+  vtkNew<vtkPolyDataMapper> mapper;
+  mapper->SetInputData(faces);
+  mapper->SetScalarRange(startLabel, endLabel);
+  mapper->SetScalarModeToUseCellData();
+  mapper->SetColorModeToMapScalars();
+
+  vtkNew<vtkActor> actor;
+  actor->SetMapper(mapper);
+
+  vtkNew<vtkRenderer> renderer;
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->AddRenderer(renderer);
+  renderWindow->SetSize(640, 480);
+  renderWindow->SetWindowName("GenerateFacesFromLabels");
+
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  renderWindowInteractor->SetRenderWindow(renderWindow);
+
+  renderer->AddActor(actor);
+  renderer->SetBackground(colors->GetColor3d("DarkSlateBlue").GetData());
+  renderWindow->Render();
+
+  auto camera = renderer->GetActiveCamera();
+  camera->SetPosition(42.301174, 939.893457, -124.005030);
+  camera->SetFocalPoint(224.697134, 221.301653, 146.823706);
+  camera->SetViewUp(0.262286, -0.281321, -0.923073);
+  camera->SetDistance(789.297581);
+  camera->SetClippingRange(168.744328, 1509.660206);
+
+  renderWindowInteractor->Start();
+  return EXIT_SUCCESS;
+}
+
+namespace {
+
+template <typename T>
+struct LabelVolume
+{
+  const T* Labels;
+  int Dims[3];
+  double StartLabel;
+  double EndLabel;
+
+  T Label(int const ijk[3]) const
+  {
+    auto row = static_cast<size_t>(ijk[2]) * this->Dims[1] + ijk[1];
+    return this->Labels[row * this->Dims[0] + ijk[0]];
+  }
+
+  // Voxels outside the volume are never selected.
+  bool Selected(int const ijk[3]) const
+  {
+    for (auto i = 0; i < 3; ++i)
+    {
+      if (ijk[i] < 0 || ijk[i] >= this->Dims[i])
+      {
+        return false;
+      }
+    }
+    auto label = static_cast<double>(this->Label(ijk));
+    return label >= this->StartLabel && label <= this->EndLabel;
+  }
+
+  // A lattice point, i.e. a voxel corner, is on the surface if the eight
+  // voxels around it are neither all selected nor all unselected. Then two
+  // of them that share a face through the point differ.
+  bool OnSurface(int i, int j, int k) const
+  {
+    auto selected = 0;
+    for (auto dk = -1; dk <= 0; ++dk)
+    {
+      for (auto dj = -1; dj <= 0; ++dj)
+      {
+        for (auto di = -1; di <= 0; ++di)
+        {
+          int ijk[3]{i + di, j + dj, k + dk};
+          selected += this->Selected(ijk) ? 1 : 0;
+        }
+      }
+    }
+    return selected > 0 && selected < 8;
+  }
+};
+
+// The surface lattice points, numbered row by row. Only the x index of each
+// point is kept, so the memory used grows with the surface rather than the
+// volume.
+struct SurfacePoints
+{
+  int RowsPerPlane;
+  // The id of the first point of each row of lattice points.
+  std::vector<vtkIdType> RowOffsets;
+  std::vector<int> XIndices;
+
+  vtkIdType Find(int const ijk[3]) const
+  {
+    auto row = static_cast<size_t>(ijk[2]) * this->RowsPerPlane + ijk[1];
+    auto begin = this->XIndices.begin() + this->RowOffsets[row];
+    auto end = this->XIndices.begin() + this->RowOffsets[row + 1];
+    return this->RowOffsets[row] +
+        (std::lower_bound(begin, end, ijk[0]) - begin);
+  }
+};
+
+template <typename T>
+struct Quad
+{
+  std::array<vtkIdType, 4> Ids;
+  T Label;
+};
+
+// The faces of one layer of voxels in one direction, e.g. all faces facing
+// +x of the voxels with x index Layer.
+struct FaceLayer
+{
+  int Axis;
+  int Sign;
+  int Layer;
+};
+
+template <typename T>
+struct FaceWorker
+{
+  LabelVolume<T> const* Volume;
+  SurfacePoints const* Points;
+  std::vector<FaceLayer> const* Layers;
+  std::vector<std::vector<Quad<T>>>* Quads;
+  bool MergeFaces;
+
+  struct Mask
+  {
+    std::vector<T> Labels;
+    std::vector<char> Exposed;
+  };
+  vtkSMPThreadLocal<Mask> Masks;
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    auto& mask = this->Masks.Local();
+    for (auto task = begin; task < end; ++task)
+    {
+      auto const& layer = (*this->Layers)[task];
+      auto a = layer.Axis;
+      // u, v, a is a right handed frame, so corners in the order
+      // (u0, v0), (u1, v0), (u1, v1), (u0, v1) face +a.
+      auto u = (a + 1) % 3;
+      auto v = (a + 2) % 3;
+      auto nu = this->Volume->Dims[u];
+      auto nv = this->Volume->Dims[v];
+      mask.Labels.resize(static_cast<size_t>(nu) * nv);
+      mask.Exposed.assign(static_cast<size_t>(nu) * nv, 0);
+
+      int ijk[3];
+      int neighbour[3];
+      ijk[a] = layer.Layer;
+      neighbour[a] = layer.Layer + layer.Sign;
+      for (auto iv = 0; iv < nv; ++iv)
+      {
+        ijk[v] = neighbour[v] = iv;
+        for (auto iu = 0; iu < nu; ++iu)
+        {
+          ijk[u] = neighbour[u] = iu;
+          if (this->Volume->Selected(ijk) &&
+              !this->Volume->Selected(neighbour))
+          {
+            auto m = static_cast<size_t>(iv) * nu + iu;
+            mask.Exposed[m] = 1;
+            mask.Labels[m] = this->Volume->Label(ijk);
+          }
+        }
+      }
+
+      // The lattice plane the faces lie in.
+      int corner[3];
+      corner[a] = layer.Sign > 0 ? layer.Layer + 1 : layer.Layer;
+      auto& quads = (*this->Quads)[task];
+      for (auto iv = 0; iv < nv; ++iv)
+      {
+        for (auto iu = 0; iu < nu; ++iu)
+        {
+          auto m = static_cast<size_t>(iv) * nu + iu;
+          if (!mask.Exposed[m])
+          {
+            continue;
+          }
+          auto label = mask.Labels[m];
+          auto same = [&](size_t n) {
+            return mask.Exposed[n] && mask.Labels[n] == label;
+          };
+          // Grow the rectangle along u, then along v while the whole row
+          // below it matches.
+          auto width = 1;
+          auto height = 1;
+          if (this->MergeFaces)
+          {
+            while (iu + width < nu && same(m + width))
+            {
+              ++width;
+            }
+            for (; iv + height < nv; ++height)
+            {
+              auto row = m + static_cast<size_t>(height) * nu;
+              auto w = 0;
+              while (w < width && same(row + w))
+              {
+                ++w;
+              }
+              if (w < width)
+              {
+                break;
+              }
+            }
+          }
+          for (auto h = 0; h < height; ++h)
+          {
+            std::fill_n(mask.Exposed.begin() + m + h * nu, width, 0);
+          }
+
+          auto iu1 = iu + width;
+          auto iv1 = iv + height;
+          std::array<std::array<int, 2>, 4> corners{
+              {{{iu, iv}}, {{iu1, iv}}, {{iu1, iv1}}, {{iu, iv1}}}};
+          if (layer.Sign < 0)
+          {
+            std::swap(corners[1], corners[3]);
+          }
+          Quad<T> quad;
+          for (auto c = 0; c < 4; ++c)
+          {
+            corner[u] = corners[c][0];
+            corner[v] = corners[c][1];
+            quad.Ids[c] = this->Points->Find(corner);
+          }
+          quad.Label = label;
+          quads.push_back(quad);
+        }
+      }
+    }
+  }
+};
+
+struct ExtractVoxelFacesDispatch
+{
+  template <typename T>
+  void Execute(const T* labels, vtkImageData* image, double startLabel,
+               double endLabel, bool mergeFaces, vtkPolyData* output)
+  {
+    LabelVolume<T> volume;
+    volume.Labels = labels;
+    image->GetDimensions(volume.Dims);
+    volume.StartLabel = startLabel;
+    volume.EndLabel = endLabel;
+    const int nx = volume.Dims[0];
+    const int ny = volume.Dims[1];
+    const int nz = volume.Dims[2];
+
+    // Count the surface lattice points of each row, then number them.
+    SurfacePoints points;
+    points.RowsPerPlane = ny + 1;
+    auto numberOfRows = static_cast<size_t>(ny + 1) * (nz + 1);
+    points.RowOffsets.assign(numberOfRows + 1, 0);
+    vtkSMPTools::For(0, nz + 1, [&](vtkIdType begin, vtkIdType end) {
+      for (auto k = static_cast<int>(begin); k < end; ++k)
+      {
+        for (auto j = 0; j <= ny; ++j)
+        {
+          vtkIdType count = 0;
+          for (auto i = 0; i <= nx; ++i)
+          {
+            count += volume.OnSurface(i, j, k) ? 1 : 0;
+          }
+          points.RowOffsets[static_cast<size_t>(k) * (ny + 1) + j + 1] = count;
+        }
+      }
+    });
+    for (size_t r = 0; r < numberOfRows; ++r)
+    {
+      points.RowOffsets[r + 1] += points.RowOffsets[r];
+    }
+    auto numberOfPoints = points.RowOffsets[numberOfRows];
+    points.XIndices.resize(numberOfPoints);
+
+    // Voxel i covers [i - 1/2, i + 1/2], so lattice point i is at i - 1/2.
+    double origin[3];
+    double spacing[3];
+    int extent[6];
+    image->GetOrigin(origin);
+    image->GetSpacing(spacing);
+    image->GetExtent(extent);
+    auto coordinates = vtkSmartPointer<vtkFloatArray>::New();
+    coordinates->SetNumberOfComponents(3);
+    coordinates->SetNumberOfTuples(numberOfPoints);
+    auto xyz = coordinates->GetPointer(0);
+    vtkSMPTools::For(0, nz + 1, [&](vtkIdType begin, vtkIdType end) {
+      for (auto k = static_cast<int>(begin); k < end; ++k)
+      {
+        for (auto j = 0; j <= ny; ++j)
+        {
+          auto id = points.RowOffsets[static_cast<size_t>(k) * (ny + 1) + j];
+          for (auto i = 0; i <= nx; ++i)
+          {
+            if (volume.OnSurface(i, j, k))
+            {
+              points.XIndices[id] = i;
+              xyz[3 * id] = static_cast<float>(
+                  origin[0] + spacing[0] * (extent[0] + i - 0.5));
+              xyz[3 * id + 1] = static_cast<float>(
+                  origin[1] + spacing[1] * (extent[2] + j - 0.5));
+              xyz[3 * id + 2] = static_cast<float>(
+                  origin[2] + spacing[2] * (extent[4] + k - 0.5));
+              ++id;
+            }
+          }
+        }
+      }
+    });
+
+    // The faces, one task per layer of voxels and direction.
+    std::vector<FaceLayer> layers;
+    for (auto axis = 0; axis < 3; ++axis)
+    {
+      for (auto sign : {-1, 1})
+      {
+        for (auto layer = 0; layer < volume.Dims[axis]; ++layer)
+        {
+          layers.push_back({axis, sign, layer});
+        }
+      }
+    }
+    std::vector<std::vector<Quad<T>>> quads(layers.size());
+    FaceWorker<T> worker;
+    worker.Volume = &volume;
+    worker.Points = &points;
+    worker.Layers = &layers;
+    worker.Quads = &quads;
+    worker.MergeFaces = mergeFaces;
+    vtkSMPTools::For(0, static_cast<vtkIdType>(layers.size()), worker);
+
+    // Gather the quads of all the layers into the cell array.
+    std::vector<vtkIdType> firstQuad(layers.size() + 1, 0);
+    for (size_t t = 0; t < layers.size(); ++t)
+    {
+      firstQuad[t + 1] =
+          firstQuad[t] + static_cast<vtkIdType>(quads[t].size());
+    }
+    auto numberOfQuads = firstQuad.back();
+    vtkNew<vtkIdTypeArray> offsets;
+    offsets->SetNumberOfValues(numberOfQuads + 1);
+    vtkNew<vtkIdTypeArray> connectivity;
+    connectivity->SetNumberOfValues(4 * numberOfQuads);
+    vtkSmartPointer<vtkDataArray> cellLabels;
+    cellLabels.TakeReference(vtkDataArray::CreateDataArray(
+        image->GetPointData()->GetScalars()->GetDataType()));
+    cellLabels->SetName("Labels");
+    cellLabels->SetNumberOfTuples(numberOfQuads);
+    auto offsetValues = offsets->GetPointer(0);
+    auto ids = connectivity->GetPointer(0);
+    auto quadLabels = static_cast<T*>(cellLabels->GetVoidPointer(0));
+    vtkSMPTools::For(0, static_cast<vtkIdType>(layers.size()),
+                     [&](vtkIdType begin, vtkIdType end) {
+                       for (auto t = begin; t < end; ++t)
+                       {
+                         auto q = firstQuad[t];
+                         for (auto const& quad : quads[t])
+                         {
+                           offsetValues[q] = 4 * q;
+                           std::copy(quad.Ids.begin(), quad.Ids.end(),
+                                     ids + 4 * q);
+                           quadLabels[q] = quad.Label;
+                           ++q;
+                         }
+                       }
+                     });
+    offsetValues[numberOfQuads] = 4 * numberOfQuads;
+
+    if (mergeFaces)
+    {
+      // The corners of merged faces are a subset of the surface points,
+      // drop the others.
+      std::vector<vtkIdType> newIds(numberOfPoints, 0);
+      for (vtkIdType i = 0; i < 4 * numberOfQuads; ++i)
+      {
+        newIds[ids[i]] = 1;
+      }
+      vtkIdType used = 0;
+      for (auto& id : newIds)
+      {
+        id = id ? used++ : -1;
+      }
+      auto usedCoordinates = vtkSmartPointer<vtkFloatArray>::New();
+      usedCoordinates->SetNumberOfComponents(3);
+      usedCoordinates->SetNumberOfTuples(used);
+      auto usedXYZ = usedCoordinates->GetPointer(0);
+      vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+        for (auto i = begin; i < end; ++i)
+        {
+          if (newIds[i] >= 0)
+          {
+            std::copy(xyz + 3 * i, xyz + 3 * i + 3, usedXYZ + 3 * newIds[i]);
+          }
+        }
+      });
+      vtkSMPTools::For(0, 4 * numberOfQuads,
+                       [&](vtkIdType begin, vtkIdType end) {
+                         for (auto i = begin; i < end; ++i)
+                         {
+                           ids[i] = newIds[ids[i]];
+                         }
+                       });
+      coordinates = usedCoordinates;
+    }
+
+    vtkNew<vtkPoints> outputPoints;
+    outputPoints->SetData(coordinates);
+    vtkNew<vtkCellArray> polys;
+    polys->SetData(offsets, connectivity);
+    output->SetPoints(outputPoints);
+    output->SetPolys(polys);
+    output->GetCellData()->SetScalars(cellLabels);
+  }
+};
+
+vtkSmartPointer<vtkPolyData> ExtractVoxelFaces(vtkImageData* labels,
+                                               double startLabel,
+                                               double endLabel,
+                                               bool mergeFaces)
+{
+  auto output = vtkSmartPointer<vtkPolyData>::New();
+  ExtractVoxelFacesDispatch dispatch;
+  auto scalars = labels->GetScalarPointer();
+  switch (labels->GetScalarType())
+  {
+    vtkTemplateMacro(dispatch.Execute(static_cast<const VTK_TT*>(scalars),
+                                      labels, startLabel, endLabel,
+                                      mergeFaces, output));
+  }
+  return output;
+}
+
+unsigned long ThresholdPipeline(vtkMetaImageReader* reader,
+                                double startLabel, double endLabel,
+                                vtkPolyData* output)
+{
+  // Pad the volume so that we can change the point data into cell.
+  // data.
+  int* extent = reader->GetOutput()->GetExtent();
+  vtkNew<vtkImageWrapPad> pad;
+  pad->SetInputConnection(reader->GetOutputPort());
+  pad->SetOutputWholeExtent(extent[0], extent[1] + 1, extent[2], extent[3] + 1,
+                            extent[4], extent[5] + 1);
+  pad->Update();
+
+  // Copy the scalar point data of the volume into the scalar cell data.
+  pad->GetOutput()->GetCellData()->SetScalars(
+      reader->GetOutput()->GetPointData()->GetScalars());
+
+  vtkNew<vtkThreshold> selector;
+  selector->SetInputArrayToProcess(0, 0, 0,
+                                   vtkDataObject::FIELD_ASSOCIATION_CELLS,
+                                   vtkDataSetAttributes::SCALARS);
+  selector->SetInputConnection(pad->GetOutputPort());
+  selector->SetLowerThreshold(startLabel);
+  selector->SetUpperThreshold(endLabel);
+  selector->Update();
+
+  vtkNew<vtkGeometryFilter> geometry;
+  geometry->SetInputConnection(selector->GetOutputPort());
+  geometry->Update();
+  output->ShallowCopy(geometry->GetOutput());
+  return selector->GetOutput()->GetActualMemorySize();
+}
+
+} // namespace
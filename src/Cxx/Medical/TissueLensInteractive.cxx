@@ -0,0 +1,504 @@
+#include <vtkActor.h>
+#include <vtkCallbackCommand.h>
+#include <vtkCamera.h>
+#include <vtkCellArray.h>
+#include <vtkClipPolyData.h>
+#include <vtkFloatArray.h>
+#include <vtkIdList.h>
+#include <vtkImageData.h>
+#include <vtkLookupTable.h>
+#include <vtkMetaImageReader.h>
+#include <vtkMultiBlockDataSet.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProbeFilter.h>
+#include <vtkProperty.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSMPThreadLocalObject.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphere.h>
+#include <vtkSphereSource.h>
+#include <vtkSphereWidget.h>
+#include <vtkTextActor.h>
+#include <vtkTextProperty.h>
+#include <vtkTimerLog.h>
+#include <vtkTransform.h>
+#include <vtkTransformPolyDataFilter.h>
+#include <vtkVersion.h>
+
+// vtkFlyingEdges3D was introduced in VTK >= 8.2
+#if VTK_MAJOR_VERSION >= 9 || (VTK_MAJOR_VERSION >= 8 && VTK_MINOR_VERSION >= 2)
+#define USE_FLYING_EDGES
+#else
+#undef USE_FLYING_EDGES
+#endif
+
+#ifdef USE_FLYING_EDGES
+#include <vtkFlyingEdges3D.h>
+#else
+#include <vtkMarchingCubes.h>
+#endif
+
+#ifdef VTK_VERSION_NUMBER
+#if VTK_VERSION_NUMBER >= 90020230516ULL
+#define VTK_USE_CPD 1
+#include <vtkCompositePolyDataMapper.h>
+#else
+#include <vtkCompositePolyDataMapper2.h>
+#endif
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// The skin is split into buckets on a regular grid, each bucket is a block
+// of a multiblock dataset. Moving the lens only clips the buckets that
+// overlap the bounding box of the old or the new lens, the other blocks are
+// left untouched, so the mapper does not upload them again.
+class IncrementalLens
+{
+public:
+  IncrementalLens(vtkPolyData* skin, vtkImageData* volume, double radius,
+                  int bucketsPerAxis);
+
+  void SetCenter(double const center[3]);
+
+  vtkMultiBlockDataSet* GetSkin()
+  {
+    return this->Skin;
+  }
+  vtkPolyData* GetLens()
+  {
+    return this->LensClip->GetOutput();
+  }
+  // The number of buckets clipped by the last call to SetCenter.
+  size_t GetNumberOfUpdatedBuckets() const
+  {
+    return this->NumberOfUpdatedBuckets;
+  }
+
+private:
+  void Bucket(vtkPolyData* skin, int bucketsPerAxis);
+  bool Overlaps(size_t bucket, double const center[3]) const;
+
+  double Radius;
+  std::array<double, 3> Center{{0.0, 0.0, 0.0}};
+  bool HasCenter = false;
+  size_t NumberOfUpdatedBuckets = 0;
+
+  std::vector<vtkSmartPointer<vtkPolyData>> Buckets;
+  std::vector<std::array<double, 6>> BucketBounds;
+  vtkNew<vtkMultiBlockDataSet> Skin;
+  vtkNew<vtkSphere> ClipFunction;
+  vtkSMPThreadLocalObject<vtkClipPolyData> Clippers;
+
+  // The lens geometry is built once at the origin and translated.
+  vtkNew<vtkSphereSource> LensModel;
+  vtkNew<vtkTransform> LensTransform;
+  vtkNew<vtkTransformPolyDataFilter> LensMove;
+  vtkNew<vtkProbeFilter> LensProbe;
+  vtkNew<vtkClipPolyData> LensClip;
+};
+
+struct LensState
+{
+  IncrementalLens* Lens = nullptr;
+  vtkTextActor* Text = nullptr;
+  vtkTimerLog* Timer = nullptr;
+  double TotalTime = 0.0;
+  int Updates = 0;
+};
+
+void MoveLens(vtkObject* caller, unsigned long eid, void* clientdata,
+              void* calldata);
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  vtkNew<vtkNamedColors> colors;
+
+  std::array<unsigned char, 4> skinColor{{240, 184, 160, 255}};
+  colors->SetColor("SkinColor", skinColor.data());
+  std::array<unsigned char, 4> backColor{{255, 229, 200, 255}};
+  colors->SetColor("BackfaceColor", backColor.data());
+  std::array<unsigned char, 4> bkg{{51, 77, 102, 255}};
+  colors->SetColor("BkgColor", bkg.data());
+
+  if (argc < 2)
+  {
+    std::cout << "Usage: " << argv[0]
+              << " file.mhd [bucketsPerAxis] e.g. FullHead.mhd 16"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  auto bucketsPerAxis = argc > 2 ? std::max(1, std::atoi(argv[2])) : 16;
+
+  // Read the volume data.
+  vtkNew<vtkMetaImageReader> reader;
+  reader->SetFileName(argv[1]);
+  reader->Update();
+
+  // An isosurface, or contour value of 500 is known to correspond to the
+  // skin of the patient.
+#ifdef USE_FLYING_EDGES
+  vtkNew<vtkFlyingEdges3D> skinExtractor;
+#else
+  vtkNew<vtkMarchingCubes> skinExtractor;
+#endif
+  skinExtractor->SetInputConnection(reader->GetOutputPort());
+  skinExtractor->SetValue(0, 500);
+  skinExtractor->Update();
+  std::cout << "Skin: " << skinExtractor->GetOutput()->GetNumberOfCells()
+            << " triangles in " << bucketsPerAxis << "^3 buckets."
+            << std::endl;
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  IncrementalLens lens(skinExtractor->GetOutput(), reader->GetOutput(), 50.0,
+                       bucketsPerAxis);
+  double center[3]{73, 52, 15};
+  lens.SetCenter(center);
+  timer->StopTimer();
+  std::cout << "Bucketing and first clip: " << timer->GetElapsedTime()
+            << " s" << std::endl;
+
+  // For comparison, the time to clip the whole skin once.
+  vtkNew<vtkSphere> sphere;
+  sphere->SetRadius(50);
+  sphere->SetCenter(center);
+  vtkNew<vtkClipPolyData> fullClip;
+  fullClip->SetInputConnection(skinExtractor->GetOutputPort());
+  fullClip->SetClipFunction(sphere);
+  timer->StartTimer();
+  fullClip->Update();
+  timer->StopTimer();
+  std::cout << "Clipping the whole skin: " << 1000.0 * timer->GetElapsedTime()
+            << " ms" << std::endl;
+
+#ifdef VTK_USE_CPD
+  vtkNew<vtkCompositePolyDataMapper> skinMapper;
+#else
+  vtkNew<vtkCompositePolyDataMapper2> skinMapper;
+#endif
+  skinMapper->SetInputDataObject(lens.GetSkin());
+  skinMapper->ScalarVisibilityOff();
+
+  vtkNew<vtkActor> skin;
+  skin->SetMapper(skinMapper);
+  skin->GetProperty()->SetDiffuseColor(
+      colors->GetColor3d("SkinColor").GetData());
+
+  vtkNew<vtkProperty> backProp;
+  backProp->SetDiffuseColor(colors->GetColor3d("BackfaceColor").GetData());
+  skin->SetBackfaceProperty(backProp);
+
+  // Define a suitable grayscale lut.
+  vtkNew<vtkLookupTable> bwLut;
+  bwLut->SetTableRange(0, 2048);
+  bwLut->SetSaturationRange(0, 0);
+  bwLut->SetHueRange(0, 0);
+  bwLut->SetValueRange(0.2, 1);
+  bwLut->Build();
+
+  vtkNew<vtkPolyDataMapper> lensMapper;
+  lensMapper->SetInputData(lens.GetLens());
+  lensMapper->SetScalarRange(0, 2048);
+  lensMapper->SetLookupTable(bwLut);
+
+  vtkNew<vtkActor> lensActor;
+  lensActor->SetMapper(lensMapper);
+
+  vtkNew<vtkTextActor> text;
+  text->GetTextProperty()->SetFontSize(16);
+  text->GetTextProperty()->SetColor(colors->GetColor3d("Gold").GetData());
+  text->SetDisplayPosition(10, 10);
+  text->SetInput("Drag the sphere to move the lens");
+
+  vtkNew<vtkCamera> aCamera;
+  aCamera->SetViewUp(0, 0, -1);
+  aCamera->SetPosition(0, -1, 0);
+  aCamera->SetFocalPoint(0, 0, 0);
+  aCamera->ComputeViewPlaneNormal();
+  aCamera->Azimuth(30.0);
+  aCamera->Elevation(30.0);
+
+  vtkNew<vtkRenderer> aRenderer;
+  vtkNew<vtkRenderWindow> renWin;
+  renWin->AddRenderer(aRenderer);
+
+  vtkNew<vtkRenderWindowInteractor> iren;
+  iren->SetRenderWindow(renWin);
+
+  aRenderer->AddActor(lensActor);
+  aRenderer->AddActor(skin);
+  aRenderer->AddViewProp(text);
+  aRenderer->SetActiveCamera(aCamera);
+  aRenderer->ResetCamera();
+  aCamera->Dolly(1.5);
+
+  aRenderer->SetBackground(colors->GetColor3d("BkgColor").GetData());
+  renWin->SetSize(640, 480);
+  renWin->SetWindowName("TissueLensInteractive");
+  aRenderer->ResetCameraClippingRange();
+
+  // The widget only translates, its sphere has the size of the lens.
+  vtkNew<vtkSphereWidget> sphereWidget;
+  sphereWidget->SetInteractor(iren);
+  sphereWidget->SetRepresentationToWireframe();
+  sphereWidget->SetThetaResolution(16);
+  sphereWidget->SetPhiResolution(8);
+  sphereWidget->ScaleOff();
+  sphereWidget->SetRadius(50);
+  sphereWidget->SetCenter(center);
+  sphereWidget->GetSphereProperty()->SetColor(
+      colors->GetColor3d("Gold").GetData());
+  sphereWidget->GetSphereProperty()->SetOpacity(0.3);
+
+  LensState state;
+  state.Lens = &lens;
+  state.Text = text;
+  state.Timer = timer;
+
+  vtkNew<vtkCallbackCommand> moveLens;
+  moveLens->SetCallback(MoveLens);
+  moveLens->SetClientData(&state);
+  sphereWidget->AddObserver(vtkCommand::InteractionEvent, moveLens);
+
+  renWin->Render();
+  iren->Initialize();
+  sphereWidget->On();
+  iren->Start();
+
+  if (state.Updates > 0)
+  {
+    std::cout << "Mean lens update: "
+              << 1000.0 * state.TotalTime / state.Updates
+              << " ms over " << state.Updates << " moves." << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+
+IncrementalLens::IncrementalLens(vtkPolyData* skin, vtkImageData* volume,
+                                 double radius, int bucketsPerAxis)
+  : Radius(radius)
+{
+  this->Bucket(skin, bucketsPerAxis);
+  this->Skin->SetNumberOfBlocks(
+      static_cast<unsigned int>(this->Buckets.size()));
+  this->ClipFunction->SetRadius(radius);
+
+  this->LensModel->SetRadius(radius);
+  this->LensModel->SetCenter(0, 0, 0);
+  this->LensModel->SetPhiResolution(201);
+  this->LensModel->SetThetaResolution(101);
+  this->LensMove->SetInputConnection(this->LensModel->GetOutputPort());
+  this->LensMove->SetTransform(this->LensTransform);
+
+  // Sample the input volume with the lens model geometry. The source is an
+  // image, so finding the voxel of each point is a direct index computation
+  // and no locator has to be built or rebuilt when the lens moves.
+  this->LensProbe->SetInputConnection(this->LensMove->GetOutputPort());
+  this->LensProbe->SetSourceData(volume);
+
+  // Clip the lens data with the isosurface value.
+  this->LensClip->SetInputConnection(this->LensProbe->GetOutputPort());
+  this->LensClip->SetValue(500);
+  this->LensClip->GenerateClipScalarsOff();
+}
+
+void IncrementalLens::Bucket(vtkPolyData* skin, int bucketsPerAxis)
+{
+  double bounds[6];
+  skin->GetBounds(bounds);
+  auto n = bucketsPerAxis;
+  auto numberOfBuckets = static_cast<size_t>(n) * n * n;
+
+  // Assign each triangle to the bucket holding its first point.
+  auto points = skin->GetPoints();
+  auto polys = skin->GetPolys();
+  std::vector<std::vector<vtkIdType>> bucketCells(numberOfBuckets);
+  auto bucketIndex = [&](double const p[3]) {
+    size_t index = 0;
+    for (auto i = 2; i >= 0; --i)
+    {
+      auto length = bounds[2 * i + 1] - bounds[2 * i];
+      auto b = length > 0.0
+          ? static_cast<int>(n * (p[i] - bounds[2 * i]) / length)
+          : 0;
+      index = index * n + std::min(std::max(b, 0), n - 1);
+    }
+    return index;
+  };
+  vtkIdType npts;
+  const vtkIdType* pts;
+  polys->InitTraversal();
+  for (vtkIdType cellId = 0; polys->GetNextCell(npts, pts); ++cellId)
+  {
+    double p[3];
+    points->GetPoint(pts[0], p);
+    bucketCells[bucketIndex(p)].push_back(cellId);
+  }
+
+  // Each bucket gets its own compact points and normals, so that a block
+  // holds only what it draws.
+  this->Buckets.resize(numberOfBuckets);
+  this->BucketBounds.resize(numberOfBuckets);
+  auto normals = skin->GetPointData()->GetNormals();
+  vtkSMPTools::For(0, static_cast<vtkIdType>(numberOfBuckets),
+                   [&](vtkIdType begin, vtkIdType end) {
+    std::unordered_map<vtkIdType, vtkIdType> pointMap;
+    vtkNew<vtkIdList> cellPoints;
+    for (auto b = begin; b < end; ++b)
+    {
+      if (bucketCells[b].empty())
+      {
+        continue;
+      }
+      pointMap.clear();
+      vtkNew<vtkPoints> bucketPoints;
+      vtkNew<vtkCellArray> bucketPolys;
+      vtkNew<vtkFloatArray> bucketNormals;
+      bucketNormals->SetNumberOfComponents(3);
+      bucketNormals->SetName("Normals");
+      for (auto cellId : bucketCells[b])
+      {
+        polys->GetCellAtId(cellId, cellPoints);
+        bucketPolys->InsertNextCell(cellPoints->GetNumberOfIds());
+        for (vtkIdType i = 0; i < cellPoints->GetNumberOfIds(); ++i)
+        {
+          auto id = cellPoints->GetId(i);
+          auto it = pointMap.find(id);
+          if (it == pointMap.end())
+          {
+            double p[3];
+            points->GetPoint(id, p);
+            it = pointMap.emplace(id, bucketPoints->InsertNextPoint(p)).first;
+            if (normals)
+            {
+              double normal[3];
+              normals->GetTuple(id, normal);
+              bucketNormals->InsertNextTuple(normal);
+            }
+          }
+          bucketPolys->InsertCellPoint(it->second);
+        }
+      }
+      auto bucket = vtkSmartPointer<vtkPolyData>::New();
+      bucket->SetPoints(bucketPoints);
+      bucket->SetPolys(bucketPolys);
+      if (normals)
+      {
+        bucket->GetPointData()->SetNormals(bucketNormals);
+      }
+      bucket->GetBounds(this->BucketBounds[b].data());
+      this->Buckets[b] = bucket;
+    }
+  });
+}
+
+bool IncrementalLens::Overlaps(size_t bucket, double const center[3]) const
+{
+  auto const& bounds = this->BucketBounds[bucket];
+  for (auto i = 0; i < 3; ++i)
+  {
+    if (bounds[2 * i] > center[i] + this->Radius ||
+        bounds[2 * i + 1] < center[i] - this->Radius)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void IncrementalLens::SetCenter(double const center[3])
+{
+  // The buckets touched by the old or the new lens bounding box.
+  std::vector<size_t> changed;
+  for (size_t b = 0; b < this->Buckets.size(); ++b)
+  {
+    if (!this->Buckets[b])
+    {
+      continue;
+    }
+    if (!this->HasCenter || this->Overlaps(b, this->Center.data()) ||
+        this->Overlaps(b, center))
+    {
+      changed.push_back(b);
+    }
+  }
+  std::copy(center, center + 3, this->Center.begin());
+  this->HasCenter = true;
+  this->ClipFunction->SetCenter(this->Center.data());
+
+  std::vector<vtkSmartPointer<vtkPolyData>> clipped(changed.size());
+  vtkSMPTools::For(0, static_cast<vtkIdType>(changed.size()),
+                   [&](vtkIdType begin, vtkIdType end) {
+    auto& clipper = this->Clippers.Local();
+    clipper->SetClipFunction(this->ClipFunction);
+    for (auto i = begin; i < end; ++i)
+    {
+      auto b = changed[i];
+      if (!this->Overlaps(b, this->Center.data()))
+      {
+        // Clear of the lens, the whole bucket is drawn.
+        clipped[i] = this->Buckets[b];
+        continue;
+      }
+      clipper->SetInputData(this->Buckets[b]);
+      clipper->Update();
+      auto output = vtkSmartPointer<vtkPolyData>::New();
+      output->ShallowCopy(clipper->GetOutput());
+      clipped[i] = output;
+    }
+    clipper->SetInputData(nullptr);
+  });
+  for (size_t i = 0; i < changed.size(); ++i)
+  {
+    this->Skin->SetBlock(static_cast<unsigned int>(changed[i]), clipped[i]);
+  }
+  this->NumberOfUpdatedBuckets = changed.size();
+
+  this->LensTransform->Identity();
+  this->LensTransform->Translate(this->Center.data());
+  this->LensClip->Update();
+}
+
+void MoveLens(vtkObject* caller, unsigned long vtkNotUsed(eid),
+              void* clientdata, void* vtkNotUsed(calldata))
+{
+  auto sphereWidget = static_cast<vtkSphereWidget*>(caller);
+  auto state = static_cast<LensState*>(clientdata);
+  double center[3];
+  sphereWidget->GetCenter(center);
+
+  state->Timer->StartTimer();
+  state->Lens->SetCenter(center);
+  state->Timer->StopTimer();
+  auto elapsed = state->Timer->GetElapsedTime();
+  state->TotalTime += elapsed;
+  ++state->Updates;
+
+  std::ostringstream os;
+  os << "Lens update: " << 1000.0 * elapsed << " ms, "
+     << state->Lens->GetNumberOfUpdatedBuckets() << " buckets clipped";
+  state->Text->SetInput(os.str().c_str());
+}
+
+} // namespace
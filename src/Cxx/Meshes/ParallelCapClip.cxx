@@ -0,0 +1,671 @@
+#include <vtkActor.h>
+#include <vtkCamera.h>
+#include <vtkCellArray.h>
+#include <vtkCellArrayIterator.h>
+#include <vtkCleanPolyData.h>
+#include <vtkClipClosedSurface.h>
+#include <vtkClipPolyData.h>
+#include <vtkCommand.h>
+#include <vtkContourTriangulator.h>
+#include <vtkFeatureEdges.h>
+#include <vtkIdTypeArray.h>
+#include <vtkImplicitPlaneRepresentation.h>
+#include <vtkImplicitPlaneWidget2.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkPlane.h>
+#include <vtkPlaneCollection.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProperty.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkStripper.h>
+#include <vtkSuperquadricSource.h>
+#include <vtkTextActor.h>
+#include <vtkTextProperty.h>
+#include <vtkTimerLog.h>
+#include <vtkTriangleFilter.h>
+
+// Readers
+#include <vtkBYUReader.h>
+#include <vtkOBJReader.h>
+#include <vtkPLYReader.h>
+#include <vtkPolyDataReader.h>
+#include <vtkSTLReader.h>
+#include <vtkXMLPolyDataReader.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+vtkSmartPointer<vtkPolyData> ReadPolyData(std::string const& fileName);
+
+/**
+ * Clip a closed triangle mesh with a plane and cap it in one pass.
+ *
+ * The triangles are clipped in parallel, in batches. While a triangle is
+ * clipped, the segment where the plane cuts it is recorded, oriented so
+ * that the cap faces away from the kept part. The points on the cut edges
+ * are numbered once, by the sorted list of cut edges. The segments are then
+ * stitched into loops by hashing their start points, and the loops
+ * triangulated with vtkContourTriangulator, which handles holes.
+ */
+class CappedPlaneClipper
+{
+public:
+  CappedPlaneClipper(vtkPolyData* input);
+
+  /**
+   * Keep the part of the mesh on the side of the plane the normal points
+   * to.
+   *
+   * @param plane The plane.
+   * @param clipped The kept triangles.
+   * @param cap The cap, sharing the points of the kept triangles.
+   */
+  void Clip(vtkPlane* plane, vtkPolyData* clipped, vtkPolyData* cap);
+
+  /**
+   * @return The number of cut loops that did not close in the last clip.
+   */
+  vtkIdType GetNumberOfOpenLoops() const
+  {
+    return this->OpenLoops;
+  }
+
+private:
+  static const vtkIdType BatchSize = 4096;
+
+  // A corner of a clipped triangle: a kept point, or the cut of an edge
+  // when Point is -1.
+  struct Corner
+  {
+    vtkIdType Point;
+    std::pair<vtkIdType, vtkIdType> Edge;
+  };
+
+  struct Batch
+  {
+    std::vector<Corner> Triangles;
+    std::vector<std::pair<vtkIdType, vtkIdType>> Edges;
+    // The cut segments, from the entry edge to the exit edge.
+    std::vector<std::array<std::pair<vtkIdType, vtkIdType>, 2>> Segments;
+  };
+
+  std::vector<double> Points;
+  std::vector<vtkIdType> Triangles;
+  vtkIdType OpenLoops = 0;
+};
+
+// Clip and cap again every time the plane widget moves, and show how long
+// it took.
+class PlaneCallback : public vtkCommand
+{
+public:
+  static PlaneCallback* New()
+  {
+    return new PlaneCallback;
+  }
+
+  void Execute(vtkObject* caller, unsigned long, void*) override;
+
+  /**
+   * Clip and cap with the current plane.
+   */
+  void Clip();
+
+  CappedPlaneClipper* Clipper = nullptr;
+  vtkPlane* Plane = nullptr;
+  vtkPolyData* Clipped = nullptr;
+  vtkPolyData* Cap = nullptr;
+  vtkTextActor* TimeActor = nullptr;
+};
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  auto compare = false;
+  std::string fileName;
+  for (auto i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "-c")
+    {
+      compare = true;
+    }
+    else
+    {
+      fileName = arg;
+    }
+  }
+
+  vtkNew<vtkNamedColors> colors;
+
+  vtkNew<vtkTriangleFilter> triangles;
+  triangles->SetInputData(ReadPolyData(fileName));
+  triangles->PassVertsOff();
+  triangles->PassLinesOff();
+
+  // Merge the points duplicated along seams, as those of the torus, so
+  // that the cuts on either side of a seam share their points.
+  vtkNew<vtkCleanPolyData> cleaner;
+  cleaner->SetInputConnection(triangles->GetOutputPort());
+  cleaner->SetTolerance(1.0e-6);
+  cleaner->Update();
+  auto polyData = cleaner->GetOutput();
+
+  vtkNew<vtkPlane> plane;
+  plane->SetOrigin(polyData->GetCenter());
+  plane->SetNormal(1.0, -1.0, -1.0);
+
+  vtkNew<vtkTimerLog> timer;
+  CappedPlaneClipper clipper(polyData);
+  vtkNew<vtkPolyData> clipped;
+  vtkNew<vtkPolyData> cap;
+  timer->StartTimer();
+  clipper.Clip(plane, clipped, cap);
+  timer->StopTimer();
+  std::cout << "Triangles: " << polyData->GetNumberOfCells() << std::endl;
+  std::cout << "Capped clip: " << timer->GetElapsedTime() << " s, "
+            << clipped->GetNumberOfCells() << " clipped, "
+            << cap->GetNumberOfCells() << " cap triangles" << std::endl;
+
+  if (compare)
+  {
+    // The pipeline of CapClip.
+    timer->StartTimer();
+    vtkNew<vtkClipPolyData> clipPolyData;
+    clipPolyData->SetInputData(polyData);
+    clipPolyData->SetClipFunction(plane);
+    clipPolyData->SetValue(0);
+    vtkNew<vtkFeatureEdges> boundaryEdges;
+    boundaryEdges->SetInputConnection(clipPolyData->GetOutputPort());
+    boundaryEdges->BoundaryEdgesOn();
+    boundaryEdges->FeatureEdgesOff();
+    boundaryEdges->NonManifoldEdgesOff();
+    boundaryEdges->ManifoldEdgesOff();
+    vtkNew<vtkStripper> boundaryStrips;
+    boundaryStrips->SetInputConnection(boundaryEdges->GetOutputPort());
+    boundaryStrips->Update();
+    timer->StopTimer();
+    std::cout << "vtkClipPolyData, vtkFeatureEdges, vtkStripper: "
+              << timer->GetElapsedTime() << " s" << std::endl;
+
+    vtkNew<vtkPlaneCollection> planes;
+    planes->AddItem(plane);
+    vtkNew<vtkClipClosedSurface> clipClosedSurface;
+    clipClosedSurface->SetInputData(polyData);
+    clipClosedSurface->SetClippingPlanes(planes);
+    clipClosedSurface->TriangulationErrorDisplayOn();
+    timer->StartTimer();
+    clipClosedSurface->Update();
+    timer->StopTimer();
+    std::cout << "vtkClipClosedSurface: " << timer->GetElapsedTime() << " s, "
+              << clipClosedSurface->GetOutput()->GetNumberOfCells()
+              << " polygons" << std::endl;
+  }
+
+  vtkNew<vtkPolyDataMapper> clipMapper;
+  clipMapper->SetInputData(clipped);
+
+  vtkNew<vtkActor> clipActor;
+  clipActor->SetMapper(clipMapper);
+  clipActor->GetProperty()->SetDiffuseColor(
+      colors->GetColor3d("Tomato").GetData());
+  clipActor->GetProperty()->SetInterpolationToFlat();
+
+  vtkNew<vtkPolyDataMapper> capMapper;
+  capMapper->SetInputData(cap);
+
+  vtkNew<vtkActor> capActor;
+  capActor->SetMapper(capMapper);
+  capActor->GetProperty()->SetDiffuseColor(
+      colors->GetColor3d("Banana").GetData());
+
+  vtkNew<vtkTextActor> timeActor;
+  timeActor->GetTextProperty()->SetFontSize(16);
+  timeActor->GetTextProperty()->SetColor(
+      colors->GetColor3d("White").GetData());
+  timeActor->SetPosition(10, 10);
+
+  vtkNew<vtkRenderer> renderer;
+  renderer->SetBackground(colors->GetColor3d("SteelBlue").GetData());
+  renderer->AddActor(clipActor);
+  renderer->AddActor(capActor);
+  renderer->AddViewProp(timeActor);
+
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->AddRenderer(renderer);
+  renderWindow->SetSize(640, 480);
+  renderWindow->SetWindowName("ParallelCapClip");
+
+  vtkNew<vtkRenderWindowInteractor> interactor;
+  interactor->SetRenderWindow(renderWindow);
+
+  vtkNew<PlaneCallback> callback;
+  callback->Clipper = &clipper;
+  callback->Plane = plane;
+  callback->Clipped = clipped;
+  callback->Cap = cap;
+  callback->TimeActor = timeActor;
+  callback->Clip();
+
+  vtkNew<vtkImplicitPlaneRepresentation> representation;
+  representation->SetPlaceFactor(1.25);
+  representation->PlaceWidget(polyData->GetBounds());
+  representation->SetOrigin(plane->GetOrigin());
+  representation->SetNormal(plane->GetNormal());
+  representation->OutlineTranslationOff();
+  representation->DrawPlaneOff();
+
+  vtkNew<vtkImplicitPlaneWidget2> planeWidget;
+  planeWidget->SetInteractor(interactor);
+  planeWidget->SetRepresentation(representation);
+  planeWidget->AddObserver(vtkCommand::InteractionEvent, callback);
+
+  renderer->ResetCamera();
+  renderer->GetActiveCamera()->Azimuth(30);
+  renderer->GetActiveCamera()->Elevation(30);
+  renderer->GetActiveCamera()->Dolly(1.2);
+  renderer->ResetCameraClippingRange();
+
+  interactor->Initialize();
+  renderWindow->Render();
+  planeWidget->On();
+  interactor->Start();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+CappedPlaneClipper::CappedPlaneClipper(vtkPolyData* input)
+{
+  auto numberOfPoints = input->GetNumberOfPoints();
+  this->Points.resize(3 * numberOfPoints);
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    input->GetPoint(i, this->Points.data() + 3 * i);
+  }
+  auto iter = vtk::TakeSmartPointer(input->GetPolys()->NewIterator());
+  for (iter->GoToFirstCell(); !iter->IsDoneWithTraversal();
+       iter->GoToNextCell())
+  {
+    vtkIdType npts;
+    const vtkIdType* pts;
+    iter->GetCurrentCell(npts, pts);
+    if (npts == 3)
+    {
+      this->Triangles.insert(this->Triangles.end(), pts, pts + 3);
+    }
+  }
+}
+
+void CappedPlaneClipper::Clip(vtkPlane* plane, vtkPolyData* clipped,
+                              vtkPolyData* cap)
+{
+  auto numberOfPoints = static_cast<vtkIdType>(this->Points.size() / 3);
+  auto numberOfTriangles = static_cast<vtkIdType>(this->Triangles.size() / 3);
+  double origin[3], normal[3];
+  plane->GetOrigin(origin);
+  plane->GetNormal(normal);
+
+  // The signed distances, and the ids of the kept points.
+  std::vector<double> distances(numberOfPoints);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+    for (auto i = begin; i < end; ++i)
+    {
+      auto x = this->Points.data() + 3 * i;
+      distances[i] = normal[0] * (x[0] - origin[0]) +
+          normal[1] * (x[1] - origin[1]) + normal[2] * (x[2] - origin[2]);
+    }
+  });
+  std::vector<vtkIdType> keptIds(numberOfPoints, -1);
+  vtkIdType numberOfKept = 0;
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    if (distances[i] >= 0.0)
+    {
+      keptIds[i] = numberOfKept++;
+    }
+  }
+
+  // An edge of the cut, as its end points sorted, or a vertex on the plane
+  // as (vertex, vertex).
+  auto cutEdge = [&](vtkIdType a, vtkIdType b) {
+    if (distances[a] == 0.0)
+    {
+      return std::make_pair(a, a);
+    }
+    if (distances[b] == 0.0)
+    {
+      return std::make_pair(b, b);
+    }
+    return std::make_pair(std::min(a, b), std::max(a, b));
+  };
+
+  // Clip the batches of triangles.
+  auto numberOfBatches = (numberOfTriangles + BatchSize - 1) / BatchSize;
+  std::vector<Batch> batches(numberOfBatches);
+  vtkSMPTools::For(0, numberOfBatches, [&](vtkIdType begin, vtkIdType end) {
+    for (auto b = begin; b < end; ++b)
+    {
+      auto& batch = batches[b];
+      auto last = std::min(numberOfTriangles, (b + 1) * BatchSize);
+      for (auto t = b * BatchSize; t < last; ++t)
+      {
+        auto pts = this->Triangles.data() + 3 * t;
+        bool kept[3];
+        auto numberKept = 0;
+        for (auto i = 0; i < 3; ++i)
+        {
+          kept[i] = distances[pts[i]] >= 0.0;
+          numberKept += kept[i];
+        }
+        if (numberKept == 0)
+        {
+          continue;
+        }
+        if (numberKept == 3)
+        {
+          for (auto i = 0; i < 3; ++i)
+          {
+            batch.Triangles.push_back({keptIds[pts[i]], {-1, -1}});
+          }
+          continue;
+        }
+
+        // Walk around the triangle. Leaving the kept side is the exit of
+        // the cut, coming back its entry.
+        Corner polygon[4];
+        auto size = 0;
+        // A cut at a vertex on the plane is the vertex itself: add it once.
+        auto addPoint = [&](vtkIdType point) {
+          if (size == 0 || polygon[size - 1].Point != point)
+          {
+            polygon[size++] = {point, {-1, -1}};
+          }
+        };
+        std::pair<vtkIdType, vtkIdType> entry{-1, -1}, exit{-1, -1};
+        for (auto i = 0; i < 3; ++i)
+        {
+          auto j = (i + 1) % 3;
+          if (kept[i])
+          {
+            addPoint(keptIds[pts[i]]);
+          }
+          if (kept[i] != kept[j])
+          {
+            auto edge = cutEdge(pts[i], pts[j]);
+            if (edge.first == edge.second)
+            {
+              addPoint(keptIds[edge.first]);
+            }
+            else
+            {
+              polygon[size++] = {-1, edge};
+              batch.Edges.push_back(edge);
+            }
+            (kept[i] ? exit : entry) = edge;
+          }
+        }
+        if (size > 1 && polygon[size - 1].Point >= 0 &&
+            polygon[size - 1].Point == polygon[0].Point)
+        {
+          --size;
+        }
+        for (auto i = 1; i + 1 < size; ++i)
+        {
+          batch.Triangles.push_back(polygon[0]);
+          batch.Triangles.push_back(polygon[i]);
+          batch.Triangles.push_back(polygon[i + 1]);
+        }
+        // A triangle touching the plane only at a vertex cuts nothing.
+        if (entry != exit)
+        {
+          batch.Segments.push_back({entry, exit});
+        }
+      }
+    }
+  });
+
+  // Number the points on the cut edges once, after the kept points.
+  std::vector<std::pair<vtkIdType, vtkIdType>> edges;
+  for (auto const& batch : batches)
+  {
+    edges.insert(edges.end(), batch.Edges.begin(), batch.Edges.end());
+  }
+  vtkSMPTools::Sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+  auto edgeId = [&](std::pair<vtkIdType, vtkIdType> const& edge) {
+    return numberOfKept +
+        static_cast<vtkIdType>(
+               std::lower_bound(edges.begin(), edges.end(), edge) -
+               edges.begin());
+  };
+
+  auto pointId = [&](std::pair<vtkIdType, vtkIdType> const& edge) {
+    return edge.first == edge.second ? keptIds[edge.first] : edgeId(edge);
+  };
+
+  auto numberOfEdges = static_cast<vtkIdType>(edges.size());
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(numberOfKept + numberOfEdges);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+    for (auto i = begin; i < end; ++i)
+    {
+      if (keptIds[i] >= 0)
+      {
+        points->SetPoint(keptIds[i], this->Points.data() + 3 * i);
+      }
+    }
+  });
+  vtkSMPTools::For(0, numberOfEdges, [&](vtkIdType begin, vtkIdType end) {
+    for (auto e = begin; e < end; ++e)
+    {
+      auto a = this->Points.data() + 3 * edges[e].first;
+      auto b = this->Points.data() + 3 * edges[e].second;
+      auto t = distances[edges[e].first] /
+          (distances[edges[e].first] - distances[edges[e].second]);
+      points->SetPoint(numberOfKept + e, a[0] + t * (b[0] - a[0]),
+                       a[1] + t * (b[1] - a[1]), a[2] + t * (b[2] - a[2]));
+    }
+  });
+
+  // The kept triangles, each batch copied to its place.
+  std::vector<vtkIdType> start(numberOfBatches + 1, 0);
+  for (vtkIdType b = 0; b < numberOfBatches; ++b)
+  {
+    start[b + 1] =
+        start[b] + static_cast<vtkIdType>(batches[b].Triangles.size());
+  }
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfValues(start[numberOfBatches]);
+  vtkNew<vtkIdTypeArray> offsets;
+  offsets->SetNumberOfValues(start[numberOfBatches] / 3 + 1);
+  offsets->SetValue(0, 0);
+  vtkSMPTools::For(0, numberOfBatches, [&](vtkIdType begin, vtkIdType end) {
+    for (auto b = begin; b < end; ++b)
+    {
+      auto const& corners = batches[b].Triangles;
+      for (size_t i = 0; i < corners.size(); ++i)
+      {
+        auto id = start[b] + static_cast<vtkIdType>(i);
+        connectivity->SetValue(id, corners[i].Point >= 0
+                                   ? corners[i].Point
+                                   : edgeId(corners[i].Edge));
+        if ((id + 1) % 3 == 0)
+        {
+          offsets->SetValue((id + 1) / 3, id + 1);
+        }
+      }
+    }
+  });
+  vtkNew<vtkCellArray> polys;
+  polys->SetData(offsets, connectivity);
+  clipped->Initialize();
+  clipped->SetPoints(points);
+  clipped->SetPolys(polys);
+
+  // Stitch the segments into loops: each point of the cut starts one
+  // segment.
+  std::unordered_map<vtkIdType, vtkIdType> next;
+  for (auto const& batch : batches)
+  {
+    for (auto const& segment : batch.Segments)
+    {
+      next[pointId(segment[0])] = pointId(segment[1]);
+    }
+  }
+  vtkNew<vtkCellArray> loops;
+  std::vector<vtkIdType> loop;
+  this->OpenLoops = 0;
+  while (!next.empty())
+  {
+    loop.clear();
+    auto first = next.begin()->first;
+    auto current = first;
+    auto closed = false;
+    for (;;)
+    {
+      auto found = next.find(current);
+      if (found == next.end())
+      {
+        break;
+      }
+      loop.push_back(current);
+      current = found->second;
+      next.erase(found);
+      if (current == first)
+      {
+        closed = true;
+        break;
+      }
+    }
+    if (closed && loop.size() > 2)
+    {
+      loop.push_back(first);
+      loops->InsertNextCell(static_cast<vtkIdType>(loop.size()), loop.data());
+    }
+    else
+    {
+      ++this->OpenLoops;
+    }
+  }
+
+  // The cap faces away from the kept part.
+  vtkNew<vtkPolyData> contours;
+  contours->SetPoints(points);
+  contours->SetLines(loops);
+  vtkNew<vtkCellArray> capPolys;
+  double capNormal[3]{-normal[0], -normal[1], -normal[2]};
+  vtkContourTriangulator::TriangulateContours(
+      contours, 0, loops->GetNumberOfCells(), capPolys, capNormal);
+  cap->Initialize();
+  cap->SetPoints(points);
+  cap->SetPolys(capPolys);
+}
+
+void PlaneCallback::Execute(vtkObject* caller, unsigned long, void*)
+{
+  auto planeWidget = reinterpret_cast<vtkImplicitPlaneWidget2*>(caller);
+  auto representation = reinterpret_cast<vtkImplicitPlaneRepresentation*>(
+      planeWidget->GetRepresentation());
+  representation->GetPlane(this->Plane);
+  this->Clip();
+}
+
+void PlaneCallback::Clip()
+{
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  this->Clipper->Clip(this->Plane, this->Clipped, this->Cap);
+  timer->StopTimer();
+  std::ostringstream text;
+  text << "Clip and cap: " << 1000.0 * timer->GetElapsedTime() << " ms";
+  if (this->Clipper->GetNumberOfOpenLoops() > 0)
+  {
+    text << ", " << this->Clipper->GetNumberOfOpenLoops() << " open loops";
+  }
+  this->TimeActor->SetInput(text.str().c_str());
+}
+
+vtkSmartPointer<vtkPolyData> ReadPolyData(std::string const& fileName)
+{
+  vtkSmartPointer<vtkPolyData> polyData;
+  std::string extension = "";
+  if (fileName.find_last_of(".") != std::string::npos)
+  {
+    extension = fileName.substr(fileName.find_last_of("."));
+  }
+  // Make the extension lowercase
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 ::tolower);
+  if (extension == ".ply")
+  {
+    vtkNew<vtkPLYReader> reader;
+    reader->SetFileName(fileName.c_str());
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".vtp")
+  {
+    vtkNew<vtkXMLPolyDataReader> reader;
+    reader->SetFileName(fileName.c_str());
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".obj")
+  {
+    vtkNew<vtkOBJReader> reader;
+    reader->SetFileName(fileName.c_str());
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".stl")
+  {
+    vtkNew<vtkSTLReader> reader;
+    reader->SetFileName(fileName.c_str());
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".vtk")
+  {
+    vtkNew<vtkPolyDataReader> reader;
+    reader->SetFileName(fileName.c_str());
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".g")
+  {
+    vtkNew<vtkBYUReader> reader;
+    reader->SetGeometryFileName(fileName.c_str());
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else
+  {
+    // Return a fine torus if the extension is unknown, its cuts have holes.
+    vtkNew<vtkSuperquadricSource> source;
+    source->ToroidalOn();
+    source->SetThetaResolution(800);
+    source->SetPhiResolution(400);
+    source->SetThickness(0.5);
+    source->Update();
+    polyData = source->GetOutput();
+  }
+  return polyData;
+}
+} // namespace
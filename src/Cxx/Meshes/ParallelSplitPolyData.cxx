@@ -0,0 +1,709 @@
+#include <vtkActor.h>
+#include <vtkBoundingBox.h>
+#include <vtkCamera.h>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkGeometryFilter.h>
+#include <vtkIdList.h>
+#include <vtkIdTypeArray.h>
+#include <vtkIntArray.h>
+#include <vtkLookupTable.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkOBBDicer.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProperty.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPThreadLocalObject.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkThreshold.h>
+#include <vtkTimerLog.h>
+#include <vtkXMLPolyDataWriter.h>
+
+#include <vtkBYUReader.h>
+#include <vtkOBJReader.h>
+#include <vtkPLYReader.h>
+#include <vtkPolyDataReader.h>
+#include <vtkSTLReader.h>
+#include <vtkSphereSource.h>
+#include <vtkXMLPolyDataReader.h>
+
+#include <vtksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+vtkSmartPointer<vtkPolyData> ReadPolyData(const char* fileName);
+
+/**
+ * The tiles of a regular grid over the x-y bounds of a mesh. A cell
+ * belongs to the tile that holds its centroid.
+ */
+class TileGrid
+{
+public:
+  TileGrid(double const bounds[6], int tilesX, int tilesY);
+
+  vtkIdType GetNumberOfTiles() const
+  {
+    return static_cast<vtkIdType>(this->Dimensions[0]) * this->Dimensions[1];
+  }
+
+  /**
+   * @param x, y The centroid of a cell.
+   * @return The tile of the cell.
+   */
+  vtkIdType FindTile(double x, double y) const;
+
+  /**
+   * @param prefix The prefix of the file names.
+   * @param tile The tile.
+   * @param extension The extension of the file name.
+   * @return The file name of the tile, prefix_column_row.extension.
+   */
+  std::string GetFileName(std::string const& prefix, vtkIdType tile,
+                          std::string const& extension) const;
+
+private:
+  double Origin[2];
+  double Spacing[2];
+  int Dimensions[2];
+};
+
+/**
+ * Split a mesh in memory and write its tiles concurrently.
+ *
+ * One parallel pass finds the tile of each polygon, and a counting sort
+ * groups the polygons by tile. The tiles are then built and written in
+ * parallel. Each thread maps the points of the input to the points of its
+ * tile with one array the size of the input, and resets only the entries
+ * it used before the next tile.
+ *
+ * @param input The mesh. Only its polygons are split.
+ * @param grid The tiles.
+ * @param prefix The prefix of the file names.
+ * @param tileIds Filled with the tile of each polygon.
+ * @return The number of tiles written.
+ */
+vtkIdType SplitInMemory(vtkPolyData* input, TileGrid const& grid,
+                        std::string const& prefix, vtkIntArray* tileIds);
+
+/**
+ * Split a binary STL file into tiles without reading it into memory.
+ *
+ * The file is read in chunks, twice. The first pass finds the bounds. The
+ * second finds the tile of each triangle of a chunk in parallel and keeps
+ * the triangles in a buffer per tile. When the buffers hold too many
+ * triangles, they are appended to a spill file per tile, in parallel.
+ * Finally each tile reads its spill file, welds the corners of its
+ * triangles and writes its piece, again in parallel.
+ *
+ * @param fileName The binary STL file.
+ * @param tilesX, tilesY The number of tiles along x and y.
+ * @param prefix The prefix of the file names.
+ * @return The number of tiles written, or -1 if the file is not a binary
+ * STL file.
+ */
+vtkIdType SplitStream(std::string const& fileName, int tilesX, int tilesY,
+                      std::string const& prefix);
+
+/**
+ * Split a mesh as SplitPolyData does: vtkOBBDicer, then vtkThreshold and
+ * vtkGeometryFilter once for each piece.
+ *
+ * @param input The mesh.
+ * @param pieces The number of pieces.
+ * @param prefix The prefix of the file names.
+ */
+void SplitWithDicer(vtkPolyData* input, vtkIdType pieces,
+                    std::string const& prefix);
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  auto compare = false;
+  auto stream = false;
+  std::vector<std::string> args;
+  for (auto i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "-c")
+    {
+      compare = true;
+    }
+    else if (arg == "-s")
+    {
+      stream = true;
+    }
+    else
+    {
+      args.push_back(arg);
+    }
+  }
+  if (args.size() == 2 || (stream && args.empty()))
+  {
+    std::cout << "Usage: " << argv[0]
+              << " [file [tilesX tilesY]] [-s] [-c] e.g. city.stl 64 64 -s"
+              << std::endl;
+    std::cout << "-s streams a binary STL file from disk." << std::endl;
+    std::cout << "-c also splits with vtkOBBDicer, like SplitPolyData."
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  auto tilesX = args.size() > 2 ? std::max(std::atoi(args[1].c_str()), 1) : 8;
+  auto tilesY = args.size() > 2 ? std::max(std::atoi(args[2].c_str()), 1) : 8;
+
+  std::string prefix = "sphere";
+  if (!args.empty())
+  {
+    prefix = vtksys::SystemTools::GetFilenameWithoutExtension(args[0]);
+  }
+
+  vtkNew<vtkTimerLog> timer;
+  if (stream)
+  {
+    timer->StartTimer();
+    auto pieces = SplitStream(args[0], tilesX, tilesY, prefix);
+    timer->StopTimer();
+    if (pieces < 0)
+    {
+      std::cout << "Cannot stream " << args[0]
+                << ", -s needs a binary STL file." << std::endl;
+      return EXIT_FAILURE;
+    }
+    // The mesh may not fit in memory, so it is not shown.
+    std::cout << "Streamed split: " << pieces << " pieces in "
+              << timer->GetElapsedTime() << " s" << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  auto polyData = ReadPolyData(args.empty() ? "" : args[0].c_str());
+  TileGrid grid(polyData->GetBounds(), tilesX, tilesY);
+
+  vtkNew<vtkIntArray> tileIds;
+  tileIds->SetName("TileIds");
+  timer->StartTimer();
+  auto pieces = SplitInMemory(polyData, grid, prefix, tileIds);
+  timer->StopTimer();
+  std::cout << "Polygons: " << polyData->GetNumberOfPolys() << std::endl;
+  std::cout << "Parallel split: " << pieces << " pieces in "
+            << timer->GetElapsedTime() << " s" << std::endl;
+
+  if (compare)
+  {
+    timer->StartTimer();
+    SplitWithDicer(polyData, pieces, prefix + "_dicer");
+    timer->StopTimer();
+    std::cout << "vtkOBBDicer, vtkThreshold, vtkGeometryFilter: "
+              << timer->GetElapsedTime() << " s" << std::endl;
+  }
+
+  // Color the tiles like a checkerboard.
+  vtkNew<vtkNamedColors> colors;
+
+  vtkNew<vtkLookupTable> lut;
+  lut->SetNumberOfTableValues(tilesX * tilesY);
+  lut->SetTableRange(0, tilesX * tilesY - 1);
+  lut->Build();
+  const char* checker[4]{"Gold", "Banana", "Tomato", "Wheat"};
+  for (auto tile = 0; tile < tilesX * tilesY; ++tile)
+  {
+    auto color = (tile % tilesX) % 2 + 2 * ((tile / tilesX) % 2);
+    lut->SetTableValue(tile, colors->GetColor4d(checker[color]).GetData());
+  }
+
+  vtkNew<vtkPolyData> tiles;
+  tiles->SetPoints(polyData->GetPoints());
+  tiles->SetPolys(polyData->GetPolys());
+  tiles->GetCellData()->SetScalars(tileIds);
+
+  vtkNew<vtkPolyDataMapper> mapper;
+  mapper->SetInputData(tiles);
+  mapper->SetScalarModeToUseCellData();
+  mapper->SetLookupTable(lut);
+  mapper->SetScalarRange(0, tilesX * tilesY - 1);
+
+  vtkNew<vtkActor> actor;
+  actor->SetMapper(mapper);
+
+  vtkNew<vtkRenderer> renderer;
+  renderer->SetBackground(colors->GetColor3d("NavajoWhite").GetData());
+  renderer->AddActor(actor);
+
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->AddRenderer(renderer);
+  renderWindow->SetSize(512, 512);
+  renderWindow->SetWindowName("ParallelSplitPolyData");
+
+  vtkNew<vtkRenderWindowInteractor> interactor;
+  interactor->SetRenderWindow(renderWindow);
+
+  renderer->ResetCamera();
+  renderer->GetActiveCamera()->Elevation(30);
+  renderer->ResetCameraClippingRange();
+
+  renderWindow->Render();
+  interactor->Initialize();
+  interactor->Start();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+// The number of triangles read from an STL file at once, and the number of
+// triangles kept in the buffers of the tiles before they are spilled.
+const vtkIdType ChunkSize = 1 << 20;
+const size_t SpillSize = 8 << 20;
+
+TileGrid::TileGrid(double const bounds[6], int tilesX, int tilesY)
+{
+  this->Dimensions[0] = std::max(tilesX, 1);
+  this->Dimensions[1] = std::max(tilesY, 1);
+  for (auto i = 0; i < 2; ++i)
+  {
+    this->Origin[i] = bounds[2 * i];
+    auto length = bounds[2 * i + 1] - bounds[2 * i];
+    this->Spacing[i] = length > 0.0 ? length / this->Dimensions[i] : 1.0;
+  }
+}
+
+vtkIdType TileGrid::FindTile(double x, double y) const
+{
+  auto i = static_cast<int>((x - this->Origin[0]) / this->Spacing[0]);
+  auto j = static_cast<int>((y - this->Origin[1]) / this->Spacing[1]);
+  i = std::min(std::max(i, 0), this->Dimensions[0] - 1);
+  j = std::min(std::max(j, 0), this->Dimensions[1] - 1);
+  return i + static_cast<vtkIdType>(j) * this->Dimensions[0];
+}
+
+std::string TileGrid::GetFileName(std::string const& prefix, vtkIdType tile,
+                                  std::string const& extension) const
+{
+  std::ostringstream name;
+  name << prefix << "_" << tile % this->Dimensions[0] << "_"
+       << tile / this->Dimensions[0] << extension;
+  return name.str();
+}
+
+vtkIdType SplitInMemory(vtkPolyData* input, TileGrid const& grid,
+                        std::string const& prefix, vtkIntArray* tileIds)
+{
+  auto points = input->GetPoints();
+  auto polys = input->GetPolys();
+  auto numberOfPoints = input->GetNumberOfPoints();
+  auto numberOfPolys = polys->GetNumberOfCells();
+  auto firstPoly = input->GetNumberOfVerts() + input->GetNumberOfLines();
+
+  // The tile of each polygon, in one pass.
+  tileIds->SetNumberOfValues(numberOfPolys);
+  vtkSMPThreadLocalObject<vtkIdList> localIds;
+  vtkSMPTools::For(0, numberOfPolys, [&](vtkIdType begin, vtkIdType end) {
+    auto ids = localIds.Local();
+    vtkIdType npts;
+    const vtkIdType* pts;
+    double x[3];
+    for (auto cellId = begin; cellId < end; ++cellId)
+    {
+      polys->GetCellAtId(cellId, npts, pts, ids);
+      double centroid[2]{0.0, 0.0};
+      for (vtkIdType i = 0; i < npts; ++i)
+      {
+        points->GetPoint(pts[i], x);
+        centroid[0] += x[0];
+        centroid[1] += x[1];
+      }
+      tileIds->SetValue(cellId,
+                        static_cast<int>(grid.FindTile(centroid[0] / npts,
+                                                       centroid[1] / npts)));
+    }
+  });
+
+  // Group the polygons by tile.
+  auto numberOfTiles = grid.GetNumberOfTiles();
+  std::vector<vtkIdType> start(numberOfTiles + 1, 0);
+  for (vtkIdType cellId = 0; cellId < numberOfPolys; ++cellId)
+  {
+    ++start[tileIds->GetValue(cellId) + 1];
+  }
+  std::partial_sum(start.begin(), start.end(), start.begin());
+  std::vector<vtkIdType> order(numberOfPolys);
+  auto next = start;
+  for (vtkIdType cellId = 0; cellId < numberOfPolys; ++cellId)
+  {
+    order[next[tileIds->GetValue(cellId)]++] = cellId;
+  }
+  std::vector<vtkIdType> tiles;
+  for (vtkIdType tile = 0; tile < numberOfTiles; ++tile)
+  {
+    if (start[tile + 1] > start[tile])
+    {
+      tiles.push_back(tile);
+    }
+  }
+
+  // Build and write the tiles.
+  auto numberOfTilesWritten = static_cast<vtkIdType>(tiles.size());
+  vtkSMPThreadLocal<std::vector<vtkIdType>> localMaps;
+  vtkSMPTools::For(
+      0, numberOfTilesWritten, [&](vtkIdType begin, vtkIdType end) {
+        auto& pointMap = localMaps.Local();
+        if (pointMap.empty())
+        {
+          pointMap.assign(numberOfPoints, -1);
+        }
+        auto ids = localIds.Local();
+        vtkIdType npts;
+        const vtkIdType* pts;
+        double x[3];
+        for (auto k = begin; k < end; ++k)
+        {
+          auto tile = tiles[k];
+          std::vector<vtkIdType> inputPoints;
+          vtkNew<vtkCellArray> piecePolys;
+          for (auto i = start[tile]; i < start[tile + 1]; ++i)
+          {
+            polys->GetCellAtId(order[i], npts, pts, ids);
+            piecePolys->InsertNextCell(npts);
+            for (vtkIdType j = 0; j < npts; ++j)
+            {
+              auto& id = pointMap[pts[j]];
+              if (id < 0)
+              {
+                id = static_cast<vtkIdType>(inputPoints.size());
+                inputPoints.push_back(pts[j]);
+              }
+              piecePolys->InsertCellPoint(id);
+            }
+          }
+
+          auto numberOfPiecePoints = static_cast<vtkIdType>(inputPoints.size());
+          vtkNew<vtkPoints> piecePoints;
+          piecePoints->SetDataType(points->GetDataType());
+          piecePoints->SetNumberOfPoints(numberOfPiecePoints);
+          vtkNew<vtkPolyData> piece;
+          piece->SetPoints(piecePoints);
+          piece->SetPolys(piecePolys);
+          auto pointData = piece->GetPointData();
+          pointData->CopyAllocate(input->GetPointData(), numberOfPiecePoints);
+          for (vtkIdType j = 0; j < numberOfPiecePoints; ++j)
+          {
+            points->GetPoint(inputPoints[j], x);
+            piecePoints->SetPoint(j, x);
+            pointData->CopyData(input->GetPointData(), inputPoints[j], j);
+            // Leave the map clean for the next tile.
+            pointMap[inputPoints[j]] = -1;
+          }
+          auto cellData = piece->GetCellData();
+          cellData->CopyAllocate(input->GetCellData(),
+                                 start[tile + 1] - start[tile]);
+          for (auto i = start[tile]; i < start[tile + 1]; ++i)
+          {
+            cellData->CopyData(input->GetCellData(), firstPoly + order[i],
+                               i - start[tile]);
+          }
+
+          vtkNew<vtkXMLPolyDataWriter> writer;
+          writer->SetInputData(piece);
+          writer->SetFileName(grid.GetFileName(prefix, tile, ".vtp").c_str());
+          writer->Write();
+        }
+      });
+  return numberOfTilesWritten;
+}
+
+vtkIdType SplitStream(std::string const& fileName, int tilesX, int tilesY,
+                      std::string const& prefix)
+{
+  // A binary STL file is an 80 byte header, the number of triangles, and
+  // 50 bytes for each triangle: the normal, the corners and two bytes of
+  // attributes.
+  std::ifstream file(fileName, std::ios::binary);
+  char header[80];
+  std::uint32_t numberOfTriangles = 0;
+  file.read(header, 80);
+  file.read(reinterpret_cast<char*>(&numberOfTriangles), 4);
+  file.seekg(0, std::ios::end);
+  if (!file ||
+      static_cast<std::uint64_t>(file.tellg()) !=
+          84 + 50 * static_cast<std::uint64_t>(numberOfTriangles))
+  {
+    return -1;
+  }
+
+  std::vector<char> buffer(50 * ChunkSize);
+  std::vector<float> corners(9 * ChunkSize);
+  auto readChunk = [&](vtkIdType first) {
+    auto count = std::min(ChunkSize, numberOfTriangles - first);
+    file.read(buffer.data(), 50 * count);
+    vtkSMPTools::For(0, count, [&](vtkIdType begin, vtkIdType end) {
+      for (auto i = begin; i < end; ++i)
+      {
+        std::memcpy(corners.data() + 9 * i, buffer.data() + 50 * i + 12,
+                    9 * sizeof(float));
+      }
+    });
+    return count;
+  };
+
+  // The first pass finds the bounds.
+  vtkSMPThreadLocal<vtkBoundingBox> localBoxes;
+  file.seekg(84);
+  for (vtkIdType first = 0; first < numberOfTriangles; first += ChunkSize)
+  {
+    auto count = readChunk(first);
+    vtkSMPTools::For(0, 3 * count, [&](vtkIdType begin, vtkIdType end) {
+      auto& box = localBoxes.Local();
+      for (auto i = begin; i < end; ++i)
+      {
+        auto x = corners.data() + 3 * i;
+        box.AddPoint(x[0], x[1], x[2]);
+      }
+    });
+  }
+  vtkBoundingBox box;
+  for (auto const& localBox : localBoxes)
+  {
+    box.AddBox(localBox);
+  }
+  double bounds[6];
+  box.GetBounds(bounds);
+  TileGrid grid(bounds, tilesX, tilesY);
+
+  // The second pass spills the triangles of each tile to its own file.
+  auto numberOfTiles = grid.GetNumberOfTiles();
+  std::vector<std::vector<float>> tileCorners(numberOfTiles);
+  std::vector<char> spilled(numberOfTiles, 0);
+  size_t numberBuffered = 0;
+  auto spill = [&]() {
+    // The first spill of a tile truncates what an earlier run left behind.
+    std::vector<vtkIdType> tiles;
+    std::vector<char> truncate;
+    for (vtkIdType tile = 0; tile < numberOfTiles; ++tile)
+    {
+      if (!tileCorners[tile].empty())
+      {
+        tiles.push_back(tile);
+        truncate.push_back(!spilled[tile]);
+        spilled[tile] = 1;
+      }
+    }
+    vtkSMPTools::For(0, static_cast<vtkIdType>(tiles.size()),
+                     [&](vtkIdType begin, vtkIdType end) {
+                       for (auto k = begin; k < end; ++k)
+                       {
+                         auto& values = tileCorners[tiles[k]];
+                         std::ofstream out(
+                             grid.GetFileName(prefix, tiles[k], ".spill"),
+                             std::ios::binary | (truncate[k] ? std::ios::trunc
+                                                             : std::ios::app));
+                         out.write(reinterpret_cast<char*>(values.data()),
+                                   values.size() * sizeof(float));
+                         std::vector<float>().swap(values);
+                       }
+                     });
+    numberBuffered = 0;
+  };
+
+  std::vector<vtkIdType> triangleTiles(ChunkSize);
+  file.seekg(84);
+  for (vtkIdType first = 0; first < numberOfTriangles; first += ChunkSize)
+  {
+    auto count = readChunk(first);
+    vtkSMPTools::For(0, count, [&](vtkIdType begin, vtkIdType end) {
+      for (auto i = begin; i < end; ++i)
+      {
+        auto x = corners.data() + 9 * i;
+        triangleTiles[i] = grid.FindTile((x[0] + x[3] + x[6]) / 3.0,
+                                         (x[1] + x[4] + x[7]) / 3.0);
+      }
+    });
+    for (vtkIdType i = 0; i < count; ++i)
+    {
+      auto x = corners.data() + 9 * i;
+      auto& values = tileCorners[triangleTiles[i]];
+      values.insert(values.end(), x, x + 9);
+    }
+    numberBuffered += count;
+    if (numberBuffered >= SpillSize)
+    {
+      spill();
+    }
+  }
+  spill();
+
+  // Weld the corners of each tile and write it.
+  std::vector<vtkIdType> tiles;
+  for (vtkIdType tile = 0; tile < numberOfTiles; ++tile)
+  {
+    if (spilled[tile])
+    {
+      tiles.push_back(tile);
+    }
+  }
+  vtkSMPTools::For(
+      0, static_cast<vtkIdType>(tiles.size()),
+      [&](vtkIdType begin, vtkIdType end) {
+        for (auto k = begin; k < end; ++k)
+        {
+          auto spillName = grid.GetFileName(prefix, tiles[k], ".spill");
+          std::ifstream in(spillName, std::ios::binary | std::ios::ate);
+          auto size = static_cast<size_t>(in.tellg());
+          std::vector<float> values(size / sizeof(float));
+          in.seekg(0);
+          in.read(reinterpret_cast<char*>(values.data()), size);
+          in.close();
+          std::remove(spillName.c_str());
+
+          // Corners with the same coordinates become one point.
+          auto numberOfCorners = static_cast<vtkIdType>(values.size() / 3);
+          std::vector<vtkIdType> sorted(numberOfCorners);
+          std::iota(sorted.begin(), sorted.end(), 0);
+          auto less = [&](vtkIdType a, vtkIdType b) {
+            return std::lexicographical_compare(
+                values.begin() + 3 * a, values.begin() + 3 * a + 3,
+                values.begin() + 3 * b, values.begin() + 3 * b + 3);
+          };
+          std::sort(sorted.begin(), sorted.end(), less);
+          vtkNew<vtkIdTypeArray> connectivity;
+          connectivity->SetNumberOfValues(numberOfCorners);
+          vtkNew<vtkPoints> points;
+          points->SetDataTypeToFloat();
+          vtkIdType numberOfPoints = 0;
+          for (vtkIdType i = 0; i < numberOfCorners; ++i)
+          {
+            if (i == 0 || less(sorted[i - 1], sorted[i]))
+            {
+              auto x = values.data() + 3 * sorted[i];
+              points->InsertNextPoint(x[0], x[1], x[2]);
+              ++numberOfPoints;
+            }
+            connectivity->SetValue(sorted[i], numberOfPoints - 1);
+          }
+          vtkNew<vtkIdTypeArray> offsets;
+          offsets->SetNumberOfValues(numberOfCorners / 3 + 1);
+          for (vtkIdType i = 0; i <= numberOfCorners / 3; ++i)
+          {
+            offsets->SetValue(i, 3 * i);
+          }
+          vtkNew<vtkCellArray> polys;
+          polys->SetData(offsets, connectivity);
+          vtkNew<vtkPolyData> piece;
+          piece->SetPoints(points);
+          piece->SetPolys(polys);
+
+          vtkNew<vtkXMLPolyDataWriter> writer;
+          writer->SetInputData(piece);
+          writer->SetFileName(
+              grid.GetFileName(prefix, tiles[k], ".vtp").c_str());
+          writer->Write();
+        }
+      });
+  return static_cast<vtkIdType>(tiles.size());
+}
+
+void SplitWithDicer(vtkPolyData* input, vtkIdType pieces,
+                    std::string const& prefix)
+{
+  vtkNew<vtkOBBDicer> dicer;
+  dicer->SetInputData(input);
+  dicer->SetNumberOfPieces(static_cast<int>(pieces));
+  dicer->SetDiceModeToSpecifiedNumberOfPieces();
+  dicer->Update();
+
+  vtkNew<vtkThreshold> selector;
+  selector->SetInputArrayToProcess(0, 0, 0, 0, "vtkOBBDicer_GroupIds");
+  selector->SetInputConnection(dicer->GetOutputPort());
+  selector->AllScalarsOff();
+
+  vtkNew<vtkGeometryFilter> geometry;
+  geometry->SetInputConnection(selector->GetOutputPort());
+
+  vtkNew<vtkXMLPolyDataWriter> writer;
+  writer->SetInputConnection(geometry->GetOutputPort());
+  for (int i = 0; i < dicer->GetNumberOfActualPieces(); ++i)
+  {
+    std::stringstream pieceName;
+    pieceName << prefix << "_" << i + 1 << ".vtp";
+    selector->SetLowerThreshold(i);
+    selector->SetUpperThreshold(i);
+    writer->SetFileName(pieceName.str().c_str());
+    writer->Write();
+  }
+}
+
+vtkSmartPointer<vtkPolyData> ReadPolyData(const char* fileName)
+{
+  vtkSmartPointer<vtkPolyData> polyData;
+  std::string extension =
+      vtksys::SystemTools::GetFilenameExtension(std::string(fileName));
+  if (extension == ".ply")
+  {
+    vtkNew<vtkPLYReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".vtp")
+  {
+    vtkNew<vtkXMLPolyDataReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".obj")
+  {
+    vtkNew<vtkOBJReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".stl")
+  {
+    vtkNew<vtkSTLReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".vtk")
+  {
+    vtkNew<vtkPolyDataReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".g")
+  {
+    vtkNew<vtkBYUReader> reader;
+    reader->SetGeometryFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else
+  {
+    vtkNew<vtkSphereSource> source;
+    source->SetThetaResolution(512);
+    source->SetPhiResolution(256);
+    source->Update();
+    polyData = source->GetOutput();
+  }
+
+  return polyData;
+}
+} // namespace
@@ -0,0 +1,660 @@
+#include <vtkActor.h>
+#include <vtkCamera.h>
+#include <vtkCellArray.h>
+#include <vtkDataArray.h>
+#include <vtkElevationFilter.h>
+#include <vtkIdList.h>
+#include <vtkIdTypeArray.h>
+#include <vtkLinearSubdivisionFilter.h>
+#include <vtkLoopSubdivisionFilter.h>
+#include <vtkMath.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkPolyDataNormals.h>
+#include <vtkProperty.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSMPThreadLocalObject.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+#include <vtkTimerLog.h>
+#include <vtkTriangleFilter.h>
+
+// Readers
+#include <vtkBYUReader.h>
+#include <vtkOBJReader.h>
+#include <vtkPLYReader.h>
+#include <vtkPolyDataReader.h>
+#include <vtkSTLReader.h>
+#include <vtkXMLPolyDataReader.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+vtkSmartPointer<vtkPolyData> ReadPolyData(std::string const& fileName);
+
+/**
+ * Linear or Loop subdivision of a triangle mesh, in parallel.
+ *
+ * Each level sorts the half edges of the triangles by their end points
+ * with vtkSMPTools::Sort. The runs of the sorted half edges are the unique
+ * edges, and give the new point of each edge and the triangles on both
+ * sides of it. The ends of the edges are then sorted by point, which gives
+ * the edges around each point for the Loop weights of the old points. The
+ * new points and triangles are computed in parallel.
+ *
+ * The coordinates and every point data array are refined with the same
+ * weights, as flat arrays of doubles, so point data needs no
+ * InsertNextTuple calls.
+ */
+class ParallelSubdivision
+{
+public:
+  enum Scheme
+  {
+    Linear,
+    Loop
+  };
+
+  ParallelSubdivision(Scheme scheme)
+    : SubdivisionScheme(scheme)
+  {
+  }
+
+  /**
+   * @param input The triangle mesh.
+   * @param levels The number of subdivisions.
+   * @return The subdivided mesh, with its point data.
+   */
+  vtkSmartPointer<vtkPolyData> Subdivide(vtkPolyData* input, int levels);
+
+private:
+  // A half edge of a triangle, by its end points in increasing order.
+  struct HalfEdge
+  {
+    vtkIdType A;
+    vtkIdType B;
+    vtkIdType Id;
+
+    bool operator<(HalfEdge const& other) const
+    {
+      return A < other.A || (A == other.A && B < other.B) ||
+          (A == other.A && B == other.B && Id < other.Id);
+    }
+  };
+
+  /**
+   * Build the unique edges of the triangles, and the edges around each
+   * point.
+   */
+  void BuildEdges();
+
+  /**
+   * Refine values at the points to the points of the next level: the old
+   * points, then one point for each edge.
+   *
+   * @param values The values, components per point.
+   * @param components The number of components.
+   * @return The refined values.
+   */
+  std::vector<double> Refine(std::vector<double> const& values,
+                             int components) const;
+
+  /**
+   * Split each triangle into four, on the points of its edges.
+   */
+  void SplitTriangles();
+
+  Scheme SubdivisionScheme;
+  vtkIdType NumberOfPoints = 0;
+  std::vector<vtkIdType> Triangles;
+  // The edge of each half edge, where half edge k of triangle t goes from
+  // its corner k to its corner k + 1.
+  std::vector<vtkIdType> HalfEdgeEdges;
+  // Four points for each edge: its ends, and the opposite corners of the
+  // two triangles on its sides, -1 on a boundary or nonmanifold edge.
+  std::vector<vtkIdType> EdgePoints;
+  // The edges around each point, and where they start for each point.
+  std::vector<vtkIdType> PointEdges;
+  std::vector<vtkIdType> PointEdgeOffsets;
+};
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  auto compare = false;
+  std::vector<std::string> args;
+  for (auto i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "-c")
+    {
+      compare = true;
+    }
+    else
+    {
+      args.push_back(arg);
+    }
+  }
+  auto levels = args.size() > 1 ? std::atoi(args[1].c_str()) : 3;
+  auto scheme = ParallelSubdivision::Loop;
+  if (args.size() > 2)
+  {
+    if (args[2] == "linear")
+    {
+      scheme = ParallelSubdivision::Linear;
+    }
+    else if (args[2] != "loop")
+    {
+      std::cout << "Usage: " << argv[0]
+                << " [file [levels [linear|loop]]] [-c] e.g. "
+                   "footbones.ply 3 loop"
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  vtkSmartPointer<vtkPolyData> input;
+  if (args.empty())
+  {
+    // A sphere with point data to carry through the levels.
+    vtkNew<vtkSphereSource> sphere;
+    sphere->SetThetaResolution(128);
+    sphere->SetPhiResolution(64);
+    vtkNew<vtkElevationFilter> elevation;
+    elevation->SetInputConnection(sphere->GetOutputPort());
+    elevation->SetLowPoint(0.0, 0.0, -0.5);
+    elevation->SetHighPoint(0.0, 0.0, 0.5);
+    elevation->Update();
+    input = elevation->GetPolyDataOutput();
+  }
+  else
+  {
+    input = ReadPolyData(args[0]);
+  }
+
+  // Subdivision only works on triangles.
+  vtkNew<vtkTriangleFilter> triangles;
+  triangles->SetInputData(input);
+  triangles->PassVertsOff();
+  triangles->PassLinesOff();
+  triangles->Update();
+  auto mesh = triangles->GetOutput();
+
+  vtkNew<vtkTimerLog> timer;
+  ParallelSubdivision subdivision(scheme);
+  timer->StartTimer();
+  auto subdivided = subdivision.Subdivide(mesh, levels);
+  timer->StopTimer();
+  std::cout << "Triangles: " << mesh->GetNumberOfPolys() << " -> "
+            << subdivided->GetNumberOfPolys() << std::endl;
+  std::cout << "Parallel subdivision: " << timer->GetElapsedTime() << " s"
+            << std::endl;
+
+  if (compare)
+  {
+    vtkSmartPointer<vtkPolyData> reference;
+    timer->StartTimer();
+    if (scheme == ParallelSubdivision::Linear)
+    {
+      vtkNew<vtkLinearSubdivisionFilter> filter;
+      filter->SetInputData(mesh);
+      filter->SetNumberOfSubdivisions(levels);
+      filter->Update();
+      reference = filter->GetOutput();
+    }
+    else
+    {
+      vtkNew<vtkLoopSubdivisionFilter> filter;
+      filter->SetInputData(mesh);
+      filter->SetNumberOfSubdivisions(levels);
+      filter->Update();
+      reference = filter->GetOutput();
+    }
+    timer->StopTimer();
+    std::cout << (scheme == ParallelSubdivision::Linear
+                      ? "vtkLinearSubdivisionFilter: "
+                      : "vtkLoopSubdivisionFilter: ")
+              << timer->GetElapsedTime() << " s, "
+              << reference->GetNumberOfPoints() << " points" << std::endl;
+    std::cout << "Parallel subdivision points: "
+              << subdivided->GetNumberOfPoints() << std::endl;
+  }
+
+  vtkNew<vtkNamedColors> colors;
+
+  vtkNew<vtkPolyDataNormals> normals;
+  normals->SetInputData(subdivided);
+  normals->SplittingOff();
+
+  vtkNew<vtkPolyDataMapper> mapper;
+  mapper->SetInputConnection(normals->GetOutputPort());
+  if (auto scalars = subdivided->GetPointData()->GetScalars())
+  {
+    mapper->SetScalarRange(scalars->GetRange());
+  }
+
+  vtkNew<vtkActor> actor;
+  actor->SetMapper(mapper);
+  actor->GetProperty()->SetColor(colors->GetColor3d("BurlyWood").GetData());
+
+  vtkNew<vtkRenderer> renderer;
+  renderer->AddActor(actor);
+  renderer->SetBackground(colors->GetColor3d("Gainsboro").GetData());
+
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->AddRenderer(renderer);
+  renderWindow->SetSize(640, 480);
+  renderWindow->SetWindowName("ParallelSubdivision");
+
+  vtkNew<vtkRenderWindowInteractor> interactor;
+  interactor->SetRenderWindow(renderWindow);
+
+  renderer->ResetCamera();
+  renderer->GetActiveCamera()->Elevation(30);
+  renderer->ResetCameraClippingRange();
+
+  renderWindow->Render();
+  interactor->Start();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+vtkSmartPointer<vtkPolyData> ParallelSubdivision::Subdivide(vtkPolyData* input,
+                                                            int levels)
+{
+  this->NumberOfPoints = input->GetNumberOfPoints();
+  auto polys = input->GetPolys();
+  auto numberOfTriangles = polys->GetNumberOfCells();
+  this->Triangles.resize(3 * numberOfTriangles);
+  vtkSMPThreadLocalObject<vtkIdList> localIds;
+  vtkSMPTools::For(0, numberOfTriangles, [&](vtkIdType begin, vtkIdType end) {
+    auto ids = localIds.Local();
+    vtkIdType npts;
+    const vtkIdType* pts;
+    for (auto cellId = begin; cellId < end; ++cellId)
+    {
+      polys->GetCellAtId(cellId, npts, pts, ids);
+      std::copy(pts, pts + 3, this->Triangles.data() + 3 * cellId);
+    }
+  });
+
+  // The coordinates and the point data, as flat arrays of doubles.
+  auto inputPointData = input->GetPointData();
+  std::vector<vtkDataArray*> arrays;
+  for (auto i = 0; i < inputPointData->GetNumberOfArrays(); ++i)
+  {
+    if (inputPointData->GetArray(i))
+    {
+      arrays.push_back(inputPointData->GetArray(i));
+    }
+  }
+  std::vector<std::vector<double>> values(arrays.size() + 1);
+  values[0].resize(3 * this->NumberOfPoints);
+  vtkSMPTools::For(
+      0, this->NumberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+        for (auto i = begin; i < end; ++i)
+        {
+          input->GetPoint(i, values[0].data() + 3 * i);
+        }
+      });
+  for (size_t a = 0; a < arrays.size(); ++a)
+  {
+    auto components = arrays[a]->GetNumberOfComponents();
+    values[a + 1].resize(components * this->NumberOfPoints);
+    vtkSMPTools::For(
+        0, this->NumberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+          for (auto i = begin; i < end; ++i)
+          {
+            arrays[a]->GetTuple(i, values[a + 1].data() + components * i);
+          }
+        });
+  }
+
+  for (auto level = 0; level < levels; ++level)
+  {
+    this->BuildEdges();
+    values[0] = this->Refine(values[0], 3);
+    for (size_t a = 0; a < arrays.size(); ++a)
+    {
+      values[a + 1] =
+          this->Refine(values[a + 1], arrays[a]->GetNumberOfComponents());
+    }
+    this->SplitTriangles();
+  }
+
+  // The output.
+  auto output = vtkSmartPointer<vtkPolyData>::New();
+  vtkNew<vtkPoints> points;
+  points->SetDataType(input->GetPoints()->GetDataType());
+  points->SetNumberOfPoints(this->NumberOfPoints);
+  vtkSMPTools::For(
+      0, this->NumberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+        for (auto i = begin; i < end; ++i)
+        {
+          points->SetPoint(i, values[0].data() + 3 * i);
+        }
+      });
+  output->SetPoints(points);
+
+  numberOfTriangles = static_cast<vtkIdType>(this->Triangles.size() / 3);
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfValues(3 * numberOfTriangles);
+  vtkNew<vtkIdTypeArray> offsets;
+  offsets->SetNumberOfValues(numberOfTriangles + 1);
+  vtkSMPTools::For(0, numberOfTriangles + 1,
+                   [&](vtkIdType begin, vtkIdType end) {
+                     for (auto t = begin; t < end; ++t)
+                     {
+                       offsets->SetValue(t, 3 * t);
+                     }
+                   });
+  std::copy(this->Triangles.begin(), this->Triangles.end(),
+            connectivity->GetPointer(0));
+  vtkNew<vtkCellArray> outputPolys;
+  outputPolys->SetData(offsets, connectivity);
+  output->SetPolys(outputPolys);
+
+  auto outputPointData = output->GetPointData();
+  for (size_t a = 0; a < arrays.size(); ++a)
+  {
+    auto components = arrays[a]->GetNumberOfComponents();
+    auto array = vtk::TakeSmartPointer(arrays[a]->NewInstance());
+    array->SetName(arrays[a]->GetName());
+    array->SetNumberOfComponents(components);
+    array->SetNumberOfTuples(this->NumberOfPoints);
+    vtkSMPTools::For(
+        0, this->NumberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+          for (auto i = begin; i < end; ++i)
+          {
+            array->SetTuple(i, values[a + 1].data() + components * i);
+          }
+        });
+    outputPointData->AddArray(array);
+    for (auto attribute = 0; attribute < vtkDataSetAttributes::NUM_ATTRIBUTES;
+         ++attribute)
+    {
+      if (inputPointData->GetAbstractAttribute(attribute) == arrays[a] &&
+          arrays[a]->GetName())
+      {
+        outputPointData->SetActiveAttribute(arrays[a]->GetName(), attribute);
+      }
+    }
+  }
+  return output;
+}
+
+void ParallelSubdivision::BuildEdges()
+{
+  auto numberOfHalfEdges = static_cast<vtkIdType>(this->Triangles.size());
+  std::vector<HalfEdge> halfEdges(numberOfHalfEdges);
+  vtkSMPTools::For(0, numberOfHalfEdges, [&](vtkIdType begin, vtkIdType end) {
+    for (auto h = begin; h < end; ++h)
+    {
+      auto a = this->Triangles[h];
+      auto b = this->Triangles[h % 3 == 2 ? h - 2 : h + 1];
+      halfEdges[h] = {std::min(a, b), std::max(a, b), h};
+    }
+  });
+  vtkSMPTools::Sort(halfEdges.begin(), halfEdges.end());
+
+  // Each run of equal end points is an edge.
+  std::vector<vtkIdType> runs;
+  for (vtkIdType h = 0; h < numberOfHalfEdges; ++h)
+  {
+    if (h == 0 || halfEdges[h].A != halfEdges[h - 1].A ||
+        halfEdges[h].B != halfEdges[h - 1].B)
+    {
+      runs.push_back(h);
+    }
+  }
+  auto numberOfEdges = static_cast<vtkIdType>(runs.size());
+  runs.push_back(numberOfHalfEdges);
+
+  this->HalfEdgeEdges.resize(numberOfHalfEdges);
+  this->EdgePoints.resize(4 * numberOfEdges);
+  vtkSMPTools::For(0, numberOfEdges, [&](vtkIdType begin, vtkIdType end) {
+    for (auto e = begin; e < end; ++e)
+    {
+      auto edgePoints = this->EdgePoints.data() + 4 * e;
+      edgePoints[0] = halfEdges[runs[e]].A;
+      edgePoints[1] = halfEdges[runs[e]].B;
+      edgePoints[2] = -1;
+      edgePoints[3] = -1;
+      auto interior = runs[e + 1] - runs[e] == 2;
+      for (auto h = runs[e]; h < runs[e + 1]; ++h)
+      {
+        auto id = halfEdges[h].Id;
+        this->HalfEdgeEdges[id] = e;
+        if (interior)
+        {
+          // The corner of the triangle opposite to the half edge.
+          auto opposite = id % 3 == 0 ? id + 2 : id - 1;
+          edgePoints[2 + h - runs[e]] = this->Triangles[opposite];
+        }
+      }
+    }
+  });
+
+  if (this->SubdivisionScheme == Linear)
+  {
+    return;
+  }
+
+  // The edges around each point, sorted by point.
+  std::vector<std::pair<vtkIdType, vtkIdType>> pointEdges(2 * numberOfEdges);
+  vtkSMPTools::For(0, numberOfEdges, [&](vtkIdType begin, vtkIdType end) {
+    for (auto e = begin; e < end; ++e)
+    {
+      pointEdges[2 * e] = {this->EdgePoints[4 * e], e};
+      pointEdges[2 * e + 1] = {this->EdgePoints[4 * e + 1], e};
+    }
+  });
+  vtkSMPTools::Sort(pointEdges.begin(), pointEdges.end());
+  this->PointEdges.resize(2 * numberOfEdges);
+  this->PointEdgeOffsets.resize(this->NumberOfPoints + 1);
+  vtkSMPTools::For(0, 2 * numberOfEdges, [&](vtkIdType begin, vtkIdType end) {
+    for (auto i = begin; i < end; ++i)
+    {
+      this->PointEdges[i] = pointEdges[i].second;
+    }
+  });
+  vtkSMPTools::For(
+      0, this->NumberOfPoints + 1, [&](vtkIdType begin, vtkIdType end) {
+        for (auto p = begin; p < end; ++p)
+        {
+          this->PointEdgeOffsets[p] = static_cast<vtkIdType>(
+              std::lower_bound(pointEdges.begin(), pointEdges.end(),
+                               std::make_pair(p, vtkIdType(0))) -
+              pointEdges.begin());
+        }
+      });
+}
+
+std::vector<double> ParallelSubdivision::Refine(
+    std::vector<double> const& values, int components) const
+{
+  auto numberOfEdges = static_cast<vtkIdType>(this->EdgePoints.size() / 4);
+  std::vector<double> refined(components *
+                              (this->NumberOfPoints + numberOfEdges));
+  auto loop = this->SubdivisionScheme == Loop;
+
+  // The old points.
+  vtkSMPTools::For(
+      0, this->NumberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+        for (auto p = begin; p < end; ++p)
+        {
+          auto value = values.data() + components * p;
+          auto out = refined.data() + components * p;
+          std::copy(value, value + components, out);
+          if (!loop)
+          {
+            continue;
+          }
+          auto first = this->PointEdgeOffsets[p];
+          auto last = this->PointEdgeOffsets[p + 1];
+          auto boundary = 0;
+          for (auto i = first; i < last; ++i)
+          {
+            boundary += this->EdgePoints[4 * this->PointEdges[i] + 2] < 0;
+          }
+          // Corners and nonmanifold points do not move.
+          if ((boundary != 0 && boundary != 2) || last == first)
+          {
+            continue;
+          }
+          // Interior points use the weights of Loop, boundary points those
+          // of a cubic B-spline along the boundary.
+          auto valence = last - first;
+          auto beta = 0.125;
+          if (boundary == 0)
+          {
+            auto c = 0.375 + 0.25 * std::cos(2.0 * vtkMath::Pi() / valence);
+            beta = (0.625 - c * c) / valence;
+          }
+          auto self = 1.0 - (boundary ? 2 : valence) * beta;
+          for (auto j = 0; j < components; ++j)
+          {
+            out[j] *= self;
+          }
+          for (auto i = first; i < last; ++i)
+          {
+            auto edgePoints = this->EdgePoints.data() + 4 * this->PointEdges[i];
+            if (boundary && edgePoints[2] >= 0)
+            {
+              continue;
+            }
+            auto other = edgePoints[0] == p ? edgePoints[1] : edgePoints[0];
+            for (auto j = 0; j < components; ++j)
+            {
+              out[j] += beta * values[components * other + j];
+            }
+          }
+        }
+      });
+
+  // The new points on the edges.
+  vtkSMPTools::For(0, numberOfEdges, [&](vtkIdType begin, vtkIdType end) {
+    for (auto e = begin; e < end; ++e)
+    {
+      auto edgePoints = this->EdgePoints.data() + 4 * e;
+      auto out = refined.data() + components * (this->NumberOfPoints + e);
+      auto a = values.data() + components * edgePoints[0];
+      auto b = values.data() + components * edgePoints[1];
+      if (!loop || edgePoints[2] < 0)
+      {
+        for (auto j = 0; j < components; ++j)
+        {
+          out[j] = 0.5 * (a[j] + b[j]);
+        }
+        continue;
+      }
+      auto c = values.data() + components * edgePoints[2];
+      auto d = values.data() + components * edgePoints[3];
+      for (auto j = 0; j < components; ++j)
+      {
+        out[j] = 0.375 * (a[j] + b[j]) + 0.125 * (c[j] + d[j]);
+      }
+    }
+  });
+  return refined;
+}
+
+void ParallelSubdivision::SplitTriangles()
+{
+  auto numberOfTriangles = static_cast<vtkIdType>(this->Triangles.size() / 3);
+  std::vector<vtkIdType> triangles(12 * numberOfTriangles);
+  vtkSMPTools::For(0, numberOfTriangles, [&](vtkIdType begin, vtkIdType end) {
+    for (auto t = begin; t < end; ++t)
+    {
+      auto pts = this->Triangles.data() + 3 * t;
+      // The new points on the edges 01, 12 and 20.
+      vtkIdType mid[3];
+      for (auto k = 0; k < 3; ++k)
+      {
+        mid[k] = this->NumberOfPoints + this->HalfEdgeEdges[3 * t + k];
+      }
+      vtkIdType children[12]{pts[0], mid[0], mid[2], mid[0], pts[1], mid[1],
+                             mid[2], mid[1], pts[2], mid[0], mid[1], mid[2]};
+      std::copy(children, children + 12, triangles.data() + 12 * t);
+    }
+  });
+  this->NumberOfPoints += static_cast<vtkIdType>(this->EdgePoints.size() / 4);
+  this->Triangles.swap(triangles);
+}
+
+vtkSmartPointer<vtkPolyData> ReadPolyData(std::string const& fileName)
+{
+  vtkSmartPointer<vtkPolyData> polyData;
+  std::string extension = "";
+  if (fileName.find_last_of(".") != std::string::npos)
+  {
+    extension = fileName.substr(fileName.find_last_of("."));
+  }
+  // Make the extension lowercase
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 ::tolower);
+  if (extension == ".ply")
+  {
+    vtkNew<vtkPLYReader> reader;
+    reader->SetFileName(fileName.c_str());
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".vtp")
+  {
+    vtkNew<vtkXMLPolyDataReader> reader;
+    reader->SetFileName(fileName.c_str());
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".obj")
+  {
+    vtkNew<vtkOBJReader> reader;
+    reader->SetFileName(fileName.c_str());
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".stl")
+  {
+    vtkNew<vtkSTLReader> reader;
+    reader->SetFileName(fileName.c_str());
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".vtk")
+  {
+    vtkNew<vtkPolyDataReader> reader;
+    reader->SetFileName(fileName.c_str());
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".g")
+  {
+    vtkNew<vtkBYUReader> reader;
+    reader->SetGeometryFileName(fileName.c_str());
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else
+  {
+    // Return a polydata sphere if the extension is unknown.
+    vtkNew<vtkSphereSource> source;
+    source->Update();
+    polyData = source->GetOutput();
+  }
+  return polyData;
+}
+} // namespace
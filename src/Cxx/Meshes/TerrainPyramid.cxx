@@ -0,0 +1,847 @@
+#include <vtkActor.h>
+#include <vtkAppendPolyData.h>
+#include <vtkCamera.h>
+#include <vtkCellArray.h>
+#include <vtkDEMReader.h>
+#include <vtkDataArray.h>
+#include <vtkElevationFilter.h>
+#include <vtkFitToHeightMapFilter.h>
+#include <vtkFloatArray.h>
+#include <vtkGenericCell.h>
+#include <vtkGreedyTerrainDecimation.h>
+#include <vtkIdList.h>
+#include <vtkIdTypeArray.h>
+#include <vtkImageData.h>
+#include <vtkLookupTable.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkPlaneSource.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProperty.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkStaticCellLocator.h>
+#include <vtkTimerLog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+/**
+ * The start of a tile file. The tiles follow, each as its points, three
+ * floats each, and then its triangles, three unsigned ints each, both
+ * starting on eight bytes. The directory of the tiles comes last.
+ *
+ * Nothing in the file needs to be parsed, so it may be mapped into memory
+ * as it is.
+ */
+struct FileHeader
+{
+  char Magic[8];
+  std::uint64_t DirectoryOffset;
+  double Origin[2];
+  double Spacing[2];
+  std::uint32_t Dimensions[2];
+  std::uint32_t TileSize;
+  std::uint32_t NumberOfLevels;
+  std::uint32_t NumberOfTiles;
+  std::uint32_t Reserved;
+};
+
+/**
+ * An entry of the directory. The entries are sorted by level, then by row
+ * and then by column, so that the entry of a tile is found by indexing.
+ */
+struct TileEntry
+{
+  std::uint64_t PointOffset;
+  std::uint64_t TriangleOffset;
+  std::uint32_t NumberOfPoints;
+  std::uint32_t NumberOfTriangles;
+  std::uint32_t Level;
+  std::uint32_t Column;
+  std::uint32_t Row;
+  std::uint32_t Reserved;
+  float Bounds[6];
+};
+
+static_assert(sizeof(FileHeader) == 72, "FileHeader must not be padded");
+static_assert(sizeof(TileEntry) == 64, "TileEntry must not be padded");
+
+/**
+ * A level of the pyramid. Level l takes every 2^l-th sample of the height
+ * map, and is cut into tiles of tileSize by tileSize cells.
+ */
+struct Level
+{
+  vtkIdType Stride;
+  vtkIdType Cells[2];
+  vtkIdType Tiles[2];
+  vtkIdType FirstTile;
+};
+
+/**
+ * The levels of a pyramid, from the height map up to the first level that
+ * fits in one tile.
+ *
+ * @param dimensions The number of samples of the height map along x and y.
+ * @param tileSize The number of cells along the side of a tile.
+ * @return The levels.
+ */
+std::vector<Level> MakeLevels(std::uint32_t const dimensions[2],
+                              vtkIdType tileSize);
+
+/** The points and the triangles of a tile. */
+struct Tile
+{
+  std::vector<float> Points;
+  std::vector<std::uint32_t> Triangles;
+  float Bounds[6];
+};
+
+/**
+ * Decimate a tile of a level.
+ *
+ * The samples of the tile are copied into an image and decimated with
+ * vtkGreedyTerrainDecimation, keeping every sample on the boundary of the
+ * tile. Neighboring tiles so share the same boundary vertices, and the
+ * x and y of the vertices are snapped to the samples of the level so that
+ * they are identical in both tiles.
+ *
+ * @param heightMap The height map.
+ * @param level The level.
+ * @param column, row The tile.
+ * @param tileSize The number of cells along the side of a tile.
+ * @param maxError The largest error in height allowed.
+ * @return The tile.
+ */
+Tile DecimateTile(vtkImageData* heightMap, Level const& level,
+                  vtkIdType column, vtkIdType row, vtkIdType tileSize,
+                  double maxError);
+
+/**
+ * Decimate a height map into a pyramid of tiles and write them to a file.
+ *
+ * The tiles of a level are decimated in parallel, in batches, and each
+ * batch is written before the next is decimated, so that only the height
+ * map and one batch of tiles are held in memory.
+ *
+ * @param heightMap The height map.
+ * @param tileSize The number of cells along the side of a tile.
+ * @param maxError The largest error in height allowed on the height map.
+ * It doubles on each level.
+ * @param fileName The tile file.
+ * @return The number of triangles of each level, empty if the file could
+ * not be written.
+ */
+std::vector<vtkIdType> BuildPyramid(vtkImageData* heightMap, int tileSize,
+                                    double maxError,
+                                    std::string const& fileName);
+
+/** Read the tiles of a tile file on demand. */
+class TileFile
+{
+public:
+  /**
+   * Read the header and the directory.
+   *
+   * @param fileName The tile file.
+   * @return false if the file is not a tile file.
+   */
+  bool Open(std::string const& fileName);
+
+  FileHeader const& GetHeader() const
+  {
+    return this->Header;
+  }
+
+  std::vector<Level> const& GetLevels() const
+  {
+    return this->Levels;
+  }
+
+  /**
+   * @param level The level.
+   * @param column, row The tile.
+   * @return The triangles of the tile.
+   */
+  vtkSmartPointer<vtkPolyData> ReadTile(int level, vtkIdType column,
+                                        vtkIdType row);
+
+  /**
+   * @param spacing The spacing of the points to drape.
+   * @return The coarsest level whose samples are no further apart than
+   * spacing.
+   */
+  int ChooseLevel(double spacing) const;
+
+private:
+  std::ifstream File;
+  FileHeader Header;
+  std::vector<Level> Levels;
+  std::vector<TileEntry> Directory;
+};
+
+/**
+ * Drape a polydata over a level of the pyramid.
+ *
+ * The points are sorted by tile with a counting sort. The tiles that hold
+ * points are read, and then, in parallel over the tiles, each point is
+ * located in a triangle of its tile, flattened to z = 0, with
+ * vtkStaticCellLocator. Its height is interpolated from the vertices of the
+ * triangle. A point outside the pyramid takes the height of the closest
+ * triangle.
+ *
+ * @param input The polydata.
+ * @param tileFile The pyramid.
+ * @param level The level.
+ * @return The polydata, with the z of its points set to the terrain.
+ */
+vtkSmartPointer<vtkPolyData> Drape(vtkPolyData* input, TileFile& tileFile,
+                                   int level);
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  auto compare = false;
+  std::vector<std::string> args;
+  for (auto i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "-c")
+    {
+      compare = true;
+    }
+    else
+    {
+      args.push_back(arg);
+    }
+  }
+  auto resolution = args.size() > 2 ? std::atoi(args[2].c_str()) : 128;
+  auto tileSize = args.size() > 3 ? std::atoi(args[3].c_str()) : 64;
+  auto maxError = args.size() > 4 ? std::atof(args[4].c_str()) : 0.0;
+  if (args.empty() || resolution < 1 || tileSize < 2 ||
+      (args.size() > 4 && maxError <= 0.0))
+  {
+    std::cout << "Usage: " << argv[0]
+              << " file.dem [file.tiles [resolution [tileSize [maxError]]]]"
+                 " [-c] e.g. SainteHelens.dem terrain.tiles 128 64 2"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string tileFileName = args.size() > 1 ? args[1] : "terrain.tiles";
+
+  vtkNew<vtkDEMReader> demReader;
+  demReader->SetFileName(args[0].c_str());
+  demReader->Update();
+  auto heightMap = demReader->GetOutput();
+  double lo = heightMap->GetScalarRange()[0];
+  double hi = heightMap->GetScalarRange()[1];
+  if (maxError == 0.0)
+  {
+    maxError = (hi - lo) / 1000.0;
+  }
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  auto triangles = BuildPyramid(heightMap, tileSize, maxError, tileFileName);
+  timer->StopTimer();
+  if (triangles.empty())
+  {
+    std::cout << "Cannot write " << tileFileName << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "Pyramid of " << triangles.size() << " levels built in "
+            << timer->GetElapsedTime() << " s" << std::endl;
+
+  TileFile tileFile;
+  if (!tileFile.Open(tileFileName))
+  {
+    std::cout << "Cannot read " << tileFileName << std::endl;
+    return EXIT_FAILURE;
+  }
+  auto const& levels = tileFile.GetLevels();
+  for (size_t l = 0; l < levels.size(); ++l)
+  {
+    std::cout << "  Level " << l << ": " << levels[l].Tiles[0] << " x "
+              << levels[l].Tiles[1] << " tiles, " << triangles[l]
+              << " triangles" << std::endl;
+  }
+
+  // A plane over the height map, at z = 0, to drape.
+  double bounds[6];
+  heightMap->GetBounds(bounds);
+  vtkNew<vtkPlaneSource> plane;
+  plane->SetOrigin(bounds[0], bounds[2], 0.0);
+  plane->SetPoint1(bounds[1], bounds[2], 0.0);
+  plane->SetPoint2(bounds[0], bounds[3], 0.0);
+  plane->SetResolution(resolution, resolution);
+  plane->Update();
+
+  auto spacing = std::min((bounds[1] - bounds[0]) / resolution,
+                          (bounds[3] - bounds[2]) / resolution);
+  auto level = tileFile.ChooseLevel(spacing);
+
+  timer->StartTimer();
+  auto draped = Drape(plane->GetOutput(), tileFile, level);
+  timer->StopTimer();
+  std::cout << "Draped " << draped->GetNumberOfPoints()
+            << " points over level " << level << " in "
+            << timer->GetElapsedTime() << " s" << std::endl;
+
+  if (compare)
+  {
+    // vtkFitToHeightMapFilter, against the whole height map.
+    vtkNew<vtkFitToHeightMapFilter> fit;
+    fit->SetInputConnection(plane->GetOutputPort());
+    fit->SetHeightMapConnection(demReader->GetOutputPort());
+    fit->SetFittingStrategyToPointProjection();
+    fit->UseHeightMapOffsetOff();
+    timer->StartTimer();
+    fit->Update();
+    timer->StopTimer();
+
+    auto fitted = fit->GetOutput();
+    auto maxDifference = 0.0;
+    for (vtkIdType i = 0; i < draped->GetNumberOfPoints(); ++i)
+    {
+      double x[3];
+      draped->GetPoint(i, x);
+      double y[3];
+      fitted->GetPoint(i, y);
+      maxDifference = std::max(maxDifference, std::abs(x[2] - y[2]));
+    }
+    std::cout << "vtkFitToHeightMapFilter: " << timer->GetElapsedTime()
+              << " s, largest difference in height " << maxDifference
+              << std::endl;
+  }
+
+  // Show the level draped over, and the draped plane.
+  vtkNew<vtkAppendPolyData> append;
+  for (vtkIdType row = 0; row < levels[level].Tiles[1]; ++row)
+  {
+    for (vtkIdType column = 0; column < levels[level].Tiles[0]; ++column)
+    {
+      append->AddInputData(tileFile.ReadTile(level, column, row));
+    }
+  }
+
+  vtkNew<vtkLookupTable> lut;
+  lut->SetHueRange(0.6, 0);
+  lut->SetSaturationRange(1.0, 0);
+  lut->SetValueRange(0.5, 1.0);
+
+  vtkNew<vtkElevationFilter> terrainElevation;
+  terrainElevation->SetInputConnection(append->GetOutputPort());
+  terrainElevation->SetLowPoint(0, 0, lo);
+  terrainElevation->SetHighPoint(0, 0, hi);
+  terrainElevation->SetScalarRange(lo, hi);
+
+  vtkNew<vtkPolyDataMapper> terrainMapper;
+  terrainMapper->SetInputConnection(terrainElevation->GetOutputPort());
+  terrainMapper->SetScalarRange(lo, hi);
+  terrainMapper->SetLookupTable(lut);
+
+  vtkNew<vtkNamedColors> colors;
+
+  vtkNew<vtkActor> terrainActor;
+  terrainActor->SetMapper(terrainMapper);
+  terrainActor->GetProperty()->EdgeVisibilityOn();
+  terrainActor->GetProperty()->SetEdgeColor(
+      colors->GetColor3d("SaddleBrown").GetData());
+
+  vtkNew<vtkElevationFilter> drapedElevation;
+  drapedElevation->SetInputData(draped);
+  drapedElevation->SetLowPoint(0, 0, lo);
+  drapedElevation->SetHighPoint(0, 0, hi);
+  drapedElevation->SetScalarRange(lo, hi);
+
+  vtkNew<vtkPolyDataMapper> drapedMapper;
+  drapedMapper->SetInputConnection(drapedElevation->GetOutputPort());
+  drapedMapper->SetScalarRange(lo, hi);
+  drapedMapper->SetLookupTable(lut);
+
+  vtkNew<vtkActor> drapedActor;
+  drapedActor->SetMapper(drapedMapper);
+
+  vtkNew<vtkRenderer> ren0;
+  ren0->SetViewport(0, 0, 0.5, 1);
+  ren0->SetBackground(colors->GetColor3d("Wheat").GetData());
+  ren0->AddActor(terrainActor);
+
+  vtkNew<vtkRenderer> ren1;
+  ren1->SetViewport(0.5, 0, 1, 1);
+  ren1->SetBackground(colors->GetColor3d("BurlyWood").GetData());
+  ren1->AddActor(drapedActor);
+
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->SetSize(1200, 600);
+  renderWindow->AddRenderer(ren0);
+  renderWindow->AddRenderer(ren1);
+  renderWindow->SetWindowName("TerrainPyramid");
+
+  vtkNew<vtkRenderWindowInteractor> interactor;
+  interactor->SetRenderWindow(renderWindow);
+
+  // Look down the x axis, then rotate to an oblique view.
+  ren0->GetActiveCamera()->SetPosition(1, 0, 0);
+  ren0->GetActiveCamera()->SetFocalPoint(0, 1, 0);
+  ren0->GetActiveCamera()->SetViewUp(0, 0, 1);
+  ren0->ResetCamera();
+  ren0->GetActiveCamera()->Azimuth(30.0);
+  ren0->GetActiveCamera()->Elevation(60.0);
+  ren1->SetActiveCamera(ren0->GetActiveCamera());
+
+  renderWindow->Render();
+  interactor->Start();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+std::vector<Level> MakeLevels(std::uint32_t const dimensions[2],
+                              vtkIdType tileSize)
+{
+  std::vector<Level> levels;
+  Level level;
+  level.Stride = 1;
+  level.FirstTile = 0;
+  while (true)
+  {
+    for (auto k = 0; k < 2; ++k)
+    {
+      level.Cells[k] = (static_cast<vtkIdType>(dimensions[k]) - 1) /
+          level.Stride;
+      level.Tiles[k] = (level.Cells[k] + tileSize - 1) / tileSize;
+    }
+    levels.push_back(level);
+    // Stop at one tile, or before a level would lose a whole side.
+    if ((level.Tiles[0] == 1 && level.Tiles[1] == 1) ||
+        std::min(level.Cells[0], level.Cells[1]) < 2)
+    {
+      break;
+    }
+    level.FirstTile += level.Tiles[0] * level.Tiles[1];
+    level.Stride *= 2;
+  }
+  return levels;
+}
+
+Tile DecimateTile(vtkImageData* heightMap, Level const& level,
+                  vtkIdType column, vtkIdType row, vtkIdType tileSize,
+                  double maxError)
+{
+  int dimensions[3];
+  heightMap->GetDimensions(dimensions);
+  double origin[3];
+  heightMap->GetOrigin(origin);
+  double spacing[3];
+  heightMap->GetSpacing(spacing);
+  auto heights = heightMap->GetPointData()->GetScalars();
+
+  // The samples of the tile, in samples of the level.
+  auto stride = level.Stride;
+  vtkIdType first[2]{column * tileSize, row * tileSize};
+  vtkIdType samples[2];
+  double levelSpacing[2];
+  for (auto k = 0; k < 2; ++k)
+  {
+    samples[k] = std::min(tileSize, level.Cells[k] - first[k]) + 1;
+    levelSpacing[k] = stride * spacing[k];
+  }
+
+  vtkNew<vtkImageData> image;
+  image->SetDimensions(static_cast<int>(samples[0]),
+                       static_cast<int>(samples[1]), 1);
+  image->SetOrigin(origin[0] + first[0] * levelSpacing[0],
+                   origin[1] + first[1] * levelSpacing[1], origin[2]);
+  image->SetSpacing(levelSpacing[0], levelSpacing[1], 1.0);
+  image->AllocateScalars(VTK_FLOAT, 1);
+  auto values = static_cast<float*>(image->GetScalarPointer());
+  for (vtkIdType j = 0; j < samples[1]; ++j)
+  {
+    auto sourceRow = (first[1] + j) * stride * dimensions[0];
+    for (vtkIdType i = 0; i < samples[0]; ++i)
+    {
+      values[i + j * samples[0]] = static_cast<float>(
+          heights->GetComponent(sourceRow + (first[0] + i) * stride, 0));
+    }
+  }
+
+  vtkNew<vtkGreedyTerrainDecimation> decimation;
+  decimation->SetInputData(image);
+  decimation->SetErrorMeasureToAbsoluteError();
+  decimation->SetAbsoluteError(maxError);
+  decimation->BoundaryVertexDeletionOff();
+  decimation->Update();
+  auto output = decimation->GetOutput();
+
+  Tile tile;
+  auto numberOfPoints = output->GetNumberOfPoints();
+  tile.Points.resize(3 * numberOfPoints);
+  for (auto k = 0; k < 3; ++k)
+  {
+    tile.Bounds[2 * k] = VTK_FLOAT_MAX;
+    tile.Bounds[2 * k + 1] = -VTK_FLOAT_MAX;
+  }
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    double x[3];
+    output->GetPoint(i, x);
+    for (auto k = 0; k < 2; ++k)
+    {
+      x[k] = origin[k] +
+          std::round((x[k] - origin[k]) / levelSpacing[k]) * levelSpacing[k];
+    }
+    for (auto k = 0; k < 3; ++k)
+    {
+      auto value = static_cast<float>(x[k]);
+      tile.Points[3 * i + k] = value;
+      tile.Bounds[2 * k] = std::min(tile.Bounds[2 * k], value);
+      tile.Bounds[2 * k + 1] = std::max(tile.Bounds[2 * k + 1], value);
+    }
+  }
+
+  auto polys = output->GetPolys();
+  tile.Triangles.reserve(3 * polys->GetNumberOfCells());
+  vtkNew<vtkIdList> ids;
+  for (vtkIdType id = 0; id < polys->GetNumberOfCells(); ++id)
+  {
+    vtkIdType npts;
+    vtkIdType const* pts;
+    polys->GetCellAtId(id, npts, pts, ids);
+    if (npts == 3)
+    {
+      for (auto k = 0; k < 3; ++k)
+      {
+        tile.Triangles.push_back(static_cast<std::uint32_t>(pts[k]));
+      }
+    }
+  }
+  return tile;
+}
+
+/** Write data and pad it with zeros to eight bytes. */
+void WriteAligned(std::ofstream& file, void const* data, std::size_t size)
+{
+  file.write(static_cast<char const*>(data), size);
+  char const zeros[8]{};
+  file.write(zeros, (8 - size % 8) % 8);
+}
+
+std::vector<vtkIdType> BuildPyramid(vtkImageData* heightMap, int tileSize,
+                                    double maxError,
+                                    std::string const& fileName)
+{
+  std::ofstream file(fileName, std::ios::binary);
+  if (!file)
+  {
+    return {};
+  }
+
+  int dimensions[3];
+  heightMap->GetDimensions(dimensions);
+  FileHeader header{};
+  std::memcpy(header.Magic, "VTKTERRN", 8);
+  for (auto k = 0; k < 2; ++k)
+  {
+    header.Origin[k] = heightMap->GetOrigin()[k];
+    header.Spacing[k] = heightMap->GetSpacing()[k];
+    header.Dimensions[k] = static_cast<std::uint32_t>(dimensions[k]);
+  }
+  header.TileSize = static_cast<std::uint32_t>(tileSize);
+  auto levels = MakeLevels(header.Dimensions, tileSize);
+  header.NumberOfLevels = static_cast<std::uint32_t>(levels.size());
+  WriteAligned(file, &header, sizeof(header));
+
+  std::vector<TileEntry> directory;
+  std::vector<vtkIdType> triangles(levels.size(), 0);
+  const vtkIdType batchSize = 256;
+  for (size_t l = 0; l < levels.size(); ++l)
+  {
+    auto const& level = levels[l];
+    auto numberOfTiles = level.Tiles[0] * level.Tiles[1];
+    for (vtkIdType first = 0; first < numberOfTiles; first += batchSize)
+    {
+      auto last = std::min(numberOfTiles, first + batchSize);
+      std::vector<Tile> tiles(last - first);
+      vtkSMPTools::For(first, last, [&](vtkIdType begin, vtkIdType end) {
+        for (auto t = begin; t < end; ++t)
+        {
+          tiles[t - first] =
+              DecimateTile(heightMap, level, t % level.Tiles[0],
+                           t / level.Tiles[0], tileSize,
+                           maxError * level.Stride);
+        }
+      });
+
+      for (auto t = first; t < last; ++t)
+      {
+        auto const& tile = tiles[t - first];
+        TileEntry entry{};
+        entry.NumberOfPoints =
+            static_cast<std::uint32_t>(tile.Points.size() / 3);
+        entry.NumberOfTriangles =
+            static_cast<std::uint32_t>(tile.Triangles.size() / 3);
+        entry.Level = static_cast<std::uint32_t>(l);
+        entry.Column = static_cast<std::uint32_t>(t % level.Tiles[0]);
+        entry.Row = static_cast<std::uint32_t>(t / level.Tiles[0]);
+        std::copy(tile.Bounds, tile.Bounds + 6, entry.Bounds);
+        entry.PointOffset = static_cast<std::uint64_t>(file.tellp());
+        WriteAligned(file, tile.Points.data(),
+                     tile.Points.size() * sizeof(float));
+        entry.TriangleOffset = static_cast<std::uint64_t>(file.tellp());
+        WriteAligned(file, tile.Triangles.data(),
+                     tile.Triangles.size() * sizeof(std::uint32_t));
+        directory.push_back(entry);
+        triangles[l] += entry.NumberOfTriangles;
+      }
+    }
+  }
+
+  header.DirectoryOffset = static_cast<std::uint64_t>(file.tellp());
+  header.NumberOfTiles = static_cast<std::uint32_t>(directory.size());
+  WriteAligned(file, directory.data(), directory.size() * sizeof(TileEntry));
+  file.seekp(0);
+  WriteAligned(file, &header, sizeof(header));
+  if (!file)
+  {
+    return {};
+  }
+  return triangles;
+}
+
+bool TileFile::Open(std::string const& fileName)
+{
+  this->File.open(fileName, std::ios::binary);
+  if (!this->File.read(reinterpret_cast<char*>(&this->Header),
+                       sizeof(FileHeader)) ||
+      std::memcmp(this->Header.Magic, "VTKTERRN", 8) != 0)
+  {
+    return false;
+  }
+  this->Levels = MakeLevels(this->Header.Dimensions, this->Header.TileSize);
+  if (this->Levels.size() != this->Header.NumberOfLevels)
+  {
+    return false;
+  }
+  this->Directory.resize(this->Header.NumberOfTiles);
+  this->File.seekg(this->Header.DirectoryOffset);
+  return static_cast<bool>(
+      this->File.read(reinterpret_cast<char*>(this->Directory.data()),
+                      this->Directory.size() * sizeof(TileEntry)));
+}
+
+vtkSmartPointer<vtkPolyData> TileFile::ReadTile(int level, vtkIdType column,
+                                                vtkIdType row)
+{
+  auto const& levelInfo = this->Levels[level];
+  auto const& entry = this->Directory[levelInfo.FirstTile + column +
+                                      row * levelInfo.Tiles[0]];
+
+  vtkNew<vtkFloatArray> coordinates;
+  coordinates->SetNumberOfComponents(3);
+  coordinates->SetNumberOfTuples(entry.NumberOfPoints);
+  this->File.seekg(entry.PointOffset);
+  this->File.read(reinterpret_cast<char*>(coordinates->GetPointer(0)),
+                  3 * sizeof(float) * entry.NumberOfPoints);
+  vtkNew<vtkPoints> points;
+  points->SetData(coordinates);
+
+  std::vector<std::uint32_t> triangles(3 * entry.NumberOfTriangles);
+  this->File.seekg(entry.TriangleOffset);
+  this->File.read(reinterpret_cast<char*>(triangles.data()),
+                  triangles.size() * sizeof(std::uint32_t));
+  vtkNew<vtkIdTypeArray> offsets;
+  offsets->SetNumberOfValues(entry.NumberOfTriangles + 1);
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfValues(triangles.size());
+  for (vtkIdType i = 0; i <= static_cast<vtkIdType>(entry.NumberOfTriangles);
+       ++i)
+  {
+    offsets->SetValue(i, 3 * i);
+  }
+  for (size_t i = 0; i < triangles.size(); ++i)
+  {
+    connectivity->SetValue(i, triangles[i]);
+  }
+  vtkNew<vtkCellArray> polys;
+  polys->SetData(offsets, connectivity);
+
+  auto tile = vtkSmartPointer<vtkPolyData>::New();
+  tile->SetPoints(points);
+  tile->SetPolys(polys);
+  return tile;
+}
+
+int TileFile::ChooseLevel(double spacing) const
+{
+  auto levelSpacing =
+      std::min(this->Header.Spacing[0], this->Header.Spacing[1]);
+  auto level = 0;
+  while (level + 1 < static_cast<int>(this->Levels.size()) &&
+         this->Levels[level + 1].Stride * levelSpacing <= spacing)
+  {
+    ++level;
+  }
+  return level;
+}
+
+vtkSmartPointer<vtkPolyData> Drape(vtkPolyData* input, TileFile& tileFile,
+                                   int level)
+{
+  auto const& header = tileFile.GetHeader();
+  auto const& levelInfo = tileFile.GetLevels()[level];
+  double tileWidth[2];
+  for (auto k = 0; k < 2; ++k)
+  {
+    tileWidth[k] = static_cast<double>(header.TileSize) * levelInfo.Stride *
+        header.Spacing[k];
+  }
+
+  // The tile of each point.
+  auto n = input->GetNumberOfPoints();
+  std::vector<vtkIdType> tileOf(n);
+  vtkSMPTools::For(0, n, [&](vtkIdType begin, vtkIdType end) {
+    double x[3];
+    for (auto i = begin; i < end; ++i)
+    {
+      input->GetPoint(i, x);
+      vtkIdType index[2];
+      for (auto k = 0; k < 2; ++k)
+      {
+        index[k] = static_cast<vtkIdType>(
+            std::floor((x[k] - header.Origin[k]) / tileWidth[k]));
+        index[k] = std::max(vtkIdType(0),
+                            std::min(index[k], levelInfo.Tiles[k] - 1));
+      }
+      tileOf[i] = index[0] + index[1] * levelInfo.Tiles[0];
+    }
+  });
+
+  // Group the points by tile.
+  auto numberOfTiles = levelInfo.Tiles[0] * levelInfo.Tiles[1];
+  std::vector<vtkIdType> start(numberOfTiles + 1, 0);
+  for (auto t : tileOf)
+  {
+    ++start[t + 1];
+  }
+  for (vtkIdType t = 0; t < numberOfTiles; ++t)
+  {
+    start[t + 1] += start[t];
+  }
+  std::vector<vtkIdType> order(n);
+  auto next = start;
+  for (vtkIdType i = 0; i < n; ++i)
+  {
+    order[next[tileOf[i]]++] = i;
+  }
+
+  // Read the tiles that hold points.
+  std::vector<vtkIdType> used;
+  for (vtkIdType t = 0; t < numberOfTiles; ++t)
+  {
+    if (start[t + 1] > start[t])
+    {
+      used.push_back(t);
+    }
+  }
+  std::vector<vtkSmartPointer<vtkPolyData>> tiles(used.size());
+  for (size_t k = 0; k < used.size(); ++k)
+  {
+    tiles[k] = tileFile.ReadTile(level, used[k] % levelInfo.Tiles[0],
+                                 used[k] / levelInfo.Tiles[0]);
+  }
+
+  auto tol = 1.0e-3 * levelInfo.Stride *
+      std::min(header.Spacing[0], header.Spacing[1]);
+  std::vector<double> heights(n);
+  vtkSMPTools::For(
+      0, static_cast<vtkIdType>(used.size()),
+      [&](vtkIdType begin, vtkIdType end) {
+        vtkNew<vtkGenericCell> cell;
+        for (auto k = begin; k < end; ++k)
+        {
+          auto tile = tiles[k];
+          auto tilePoints = tile->GetPoints();
+
+          // Locate the points in the tile flattened to z = 0.
+          vtkNew<vtkPoints> flatPoints;
+          flatPoints->DeepCopy(tilePoints);
+          for (vtkIdType i = 0; i < flatPoints->GetNumberOfPoints(); ++i)
+          {
+            double x[3];
+            flatPoints->GetPoint(i, x);
+            flatPoints->SetPoint(i, x[0], x[1], 0.0);
+          }
+          vtkNew<vtkPolyData> flat;
+          flat->SetPoints(flatPoints);
+          flat->SetPolys(tile->GetPolys());
+          vtkNew<vtkStaticCellLocator> locator;
+          locator->SetDataSet(flat);
+          locator->BuildLocator();
+
+          auto t = used[k];
+          for (auto q = start[t]; q < start[t + 1]; ++q)
+          {
+            auto i = order[q];
+            double x[3];
+            input->GetPoint(i, x);
+            x[2] = 0.0;
+            int subId;
+            double pcoords[3];
+            double weights[3];
+            auto cellId =
+                locator->FindCell(x, tol * tol, cell, subId, pcoords, weights);
+            if (cellId < 0)
+            {
+              double closest[3];
+              double dist2;
+              locator->FindClosestPoint(x, closest, cell, cellId, subId,
+                                        dist2);
+              flat->GetCell(cellId, cell);
+              cell->EvaluatePosition(closest, x, subId, pcoords, dist2,
+                                     weights);
+            }
+            auto height = 0.0;
+            for (auto v = 0; v < 3; ++v)
+            {
+              double vertex[3];
+              tilePoints->GetPoint(cell->GetPointId(v), vertex);
+              height += weights[v] * vertex[2];
+            }
+            heights[i] = height;
+          }
+        }
+      });
+
+  vtkNew<vtkPoints> points;
+  points->SetNumberOfPoints(n);
+  vtkSMPTools::For(0, n, [&](vtkIdType begin, vtkIdType end) {
+    double x[3];
+    for (auto i = begin; i < end; ++i)
+    {
+      input->GetPoint(i, x);
+      points->SetPoint(i, x[0], x[1], heights[i]);
+    }
+  });
+
+  auto output = vtkSmartPointer<vtkPolyData>::New();
+  output->ShallowCopy(input);
+  output->SetPoints(points);
+  return output;
+}
+} // namespace
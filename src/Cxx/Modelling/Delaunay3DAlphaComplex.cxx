@@ -0,0 +1,720 @@
+#include <vtkActor.h>
+#include <vtkActor2D.h>
+#include <vtkCamera.h>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkCellType.h>
+#include <vtkCleanPolyData.h>
+#include <vtkCommand.h>
+#include <vtkDataSetMapper.h>
+#include <vtkDelaunay3D.h>
+#include <vtkIdList.h>
+#include <vtkIdTypeArray.h>
+#include <vtkMath.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkProperty.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSMPThreadLocalObject.h>
+#include <vtkSMPTools.h>
+#include <vtkSliderRepresentation2D.h>
+#include <vtkSliderWidget.h>
+#include <vtkSmartPointer.h>
+#include <vtkTetra.h>
+#include <vtkTextMapper.h>
+#include <vtkTextProperty.h>
+#include <vtkTimerLog.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkUnstructuredGrid.h>
+
+#include <vtkBYUReader.h>
+#include <vtkOBJReader.h>
+#include <vtkPLYReader.h>
+#include <vtkPolyDataReader.h>
+#include <vtkSTLReader.h>
+#include <vtkSphereSource.h>
+#include <vtkXMLPolyDataReader.h>
+#include <vtksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+vtkSmartPointer<vtkPolyData> ReadPolyData(const char* fileName);
+
+/**
+ * Sort points for insertion into vtkDelaunay3D.
+ *
+ * The points are inserted in BRIO order: rounds of doubling size, each
+ * sorted along a Morton curve, so that the point location walk of
+ * vtkDelaunay3D stays short while the rounds keep the insertion order
+ * random enough. The keys are made and sorted in parallel.
+ *
+ * @param points The points.
+ * @return The points in insertion order.
+ */
+vtkSmartPointer<vtkPoints> SpatialSort(vtkPoints* points);
+
+/**
+ * The alpha complex of a Delaunay tetrahedralization, for every alpha.
+ *
+ * Each tetrahedron, triangle, edge and vertex of the tetrahedralization
+ * has a radius: the radius of its circumsphere, its circumcircle, half its
+ * length, and zero for a vertex. A simplex is output for an alpha at
+ * least its radius, unless a simplex that contains it is output too, as
+ * vtkDelaunay3D does. The radius of a simplex is never larger than the
+ * radius of the simplices that contain it, so that is the case when alpha
+ * is at least the smallest radius of those. Each simplex is therefore
+ * output for alpha in an interval, which is computed once, in parallel.
+ * Extracting the complex for an alpha is then a parallel threshold over
+ * the intervals.
+ */
+class AlphaComplex
+{
+public:
+  /**
+   * @param delaunay The tetrahedralization, from vtkDelaunay3D with an
+   * alpha of zero.
+   */
+  AlphaComplex(vtkUnstructuredGrid* delaunay);
+
+  /**
+   * Extract the complex for an alpha.
+   *
+   * @param alpha The alpha.
+   * @param output The tetrahedra, triangles, lines and vertices, colored
+   * by type.
+   * @param counts The number of vertices, lines, triangles and tetrahedra.
+   */
+  void Extract(double alpha, vtkUnstructuredGrid* output,
+               std::array<vtkIdType, 4>& counts) const;
+
+private:
+  // The simplices of one dimension.
+  struct Simplices
+  {
+    std::vector<vtkIdType> Points;
+    // The simplex is output for Radius <= alpha < MaxAlpha.
+    std::vector<double> Radius;
+    std::vector<double> MaxAlpha;
+  };
+
+  /**
+   * Find the faces of the simplices of one dimension, and lower their
+   * MaxAlpha to the radius of the simplex.
+   *
+   * @param dimension The dimension of the faces.
+   */
+  void BuildFaces(int dimension);
+
+  vtkSmartPointer<vtkPoints> Points;
+  Simplices Dimensions[4];
+};
+
+// Update the complex and the counts when the slider moves.
+class SliderCallbackAlpha : public vtkCommand
+{
+public:
+  static SliderCallbackAlpha* New()
+  {
+    return new SliderCallbackAlpha;
+  }
+
+  void Execute(vtkObject* caller, unsigned long, void*) override;
+
+  /**
+   * Extract the complex for an alpha and show the counts.
+   *
+   * @param alpha The alpha.
+   */
+  void Update(double alpha);
+
+  AlphaComplex* Complex = nullptr;
+  vtkUnstructuredGrid* Output = nullptr;
+  vtkTextMapper* TextMapper = nullptr;
+};
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  auto compare = false;
+  std::vector<std::string> args;
+  for (auto i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "-c")
+    {
+      compare = true;
+    }
+    else
+    {
+      args.push_back(arg);
+    }
+  }
+  if (args.empty())
+  {
+    std::cout << "Usage: " << argv[0]
+              << " filename.vtp [alpha] [-c] e.g. Bunny.vtp 0.0105"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  auto alpha = args.size() > 1 ? std::atof(args[1].c_str()) : 0.0105;
+
+  auto polyData = ReadPolyData(args[0].c_str());
+
+  // Clean the polydata. This will remove duplicate points that may be
+  // present in the input data.
+  vtkNew<vtkCleanPolyData> cleaner;
+  cleaner->SetInputData(polyData);
+  cleaner->Update();
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  vtkNew<vtkPolyData> sorted;
+  sorted->SetPoints(SpatialSort(cleaner->GetOutput()->GetPoints()));
+  timer->StopTimer();
+  auto sortTime = timer->GetElapsedTime();
+
+  // The full tetrahedralization, once.
+  timer->StartTimer();
+  vtkNew<vtkDelaunay3D> delaunay3D;
+  delaunay3D->SetInputData(sorted);
+  delaunay3D->Update();
+  timer->StopTimer();
+  auto delaunayTime = timer->GetElapsedTime();
+
+  timer->StartTimer();
+  AlphaComplex complex(delaunay3D->GetOutput());
+  timer->StopTimer();
+  std::cout << "Points: " << sorted->GetNumberOfPoints() << std::endl;
+  std::cout << "Spatial sort: " << sortTime << " s" << std::endl;
+  std::cout << "vtkDelaunay3D: " << delaunayTime << " s, "
+            << delaunay3D->GetOutput()->GetNumberOfCells() << " tetrahedra"
+            << std::endl;
+  std::cout << "Radii: " << timer->GetElapsedTime() << " s" << std::endl;
+
+  if (compare)
+  {
+    // What Delaunay3DDemo does each time alpha changes.
+    vtkNew<vtkDelaunay3D> delaunay3DAlpha;
+    delaunay3DAlpha->SetInputConnection(cleaner->GetOutputPort());
+    delaunay3DAlpha->SetAlpha(alpha);
+    timer->StartTimer();
+    delaunay3DAlpha->Update();
+    timer->StopTimer();
+    std::cout << "vtkDelaunay3D with alpha " << alpha << ": "
+              << timer->GetElapsedTime() << " s, "
+              << delaunay3DAlpha->GetOutput()->GetNumberOfCells() << " cells"
+              << std::endl;
+  }
+
+  vtkNew<vtkNamedColors> color;
+
+  vtkNew<vtkDataSetMapper> originalMapper;
+  originalMapper->SetInputData(polyData);
+  originalMapper->ScalarVisibilityOff();
+
+  vtkNew<vtkActor> originalActor;
+  originalActor->SetMapper(originalMapper);
+  originalActor->GetProperty()->SetColor(color->GetColor3d("tomato").GetData());
+  originalActor->GetProperty()->SetInterpolationToFlat();
+
+  vtkNew<vtkUnstructuredGrid> alphaComplex;
+
+  vtkNew<vtkDataSetMapper> alphaMapper;
+  alphaMapper->SetInputData(alphaComplex);
+  alphaMapper->SetScalarModeToUseCellData();
+
+  vtkNew<vtkActor> alphaActor;
+  alphaActor->SetMapper(alphaMapper);
+  alphaActor->GetProperty()->SetPointSize(5.0);
+  alphaActor->GetProperty()->SetInterpolationToFlat();
+
+  vtkNew<vtkTextProperty> textProperty;
+  textProperty->SetFontSize(16);
+  textProperty->SetColor(color->GetColor3d("Black").GetData());
+
+  vtkNew<vtkTextMapper> textMapper;
+  textMapper->SetTextProperty(textProperty);
+
+  vtkNew<vtkActor2D> textActor;
+  textActor->SetMapper(textMapper);
+  textActor->SetPosition(10, 10);
+
+  vtkNew<SliderCallbackAlpha> callback;
+  callback->Complex = &complex;
+  callback->Output = alphaComplex;
+  callback->TextMapper = textMapper;
+  callback->Update(alpha);
+
+  // Shared camera
+  vtkNew<vtkCamera> sharedCamera;
+
+  vtkNew<vtkRenderer> originalRenderer;
+  originalRenderer->SetActiveCamera(sharedCamera);
+  originalRenderer->SetViewport(0.0, 0.0, 0.5, 1.0);
+  originalRenderer->AddActor(originalActor);
+  originalRenderer->SetBackground(color->GetColor3d("Slate_Grey").GetData());
+
+  vtkNew<vtkRenderer> alphaRenderer;
+  alphaRenderer->SetActiveCamera(sharedCamera);
+  alphaRenderer->SetViewport(0.5, 0.0, 1.0, 1.0);
+  alphaRenderer->AddActor(alphaActor);
+  alphaRenderer->AddViewProp(textActor);
+  alphaRenderer->SetBackground(color->GetColor3d("Grey").GetData());
+
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->SetSize(800, 400);
+  renderWindow->SetWindowName("Delaunay3DAlphaComplex");
+  renderWindow->AddRenderer(originalRenderer);
+  renderWindow->AddRenderer(alphaRenderer);
+
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  renderWindowInteractor->SetRenderWindow(renderWindow);
+
+  // The slider goes up to a tenth of the diagonal of the points.
+  vtkNew<vtkSliderRepresentation2D> sliderRep;
+  sliderRep->SetRenderer(alphaRenderer);
+  sliderRep->SetMinimumValue(0.0);
+  sliderRep->SetMaximumValue(
+      std::max(alpha, 0.1 * sorted->GetLength()));
+  sliderRep->SetValue(alpha);
+  sliderRep->SetTitleText("Alpha");
+  sliderRep->GetPoint1Coordinate()->SetCoordinateSystemToNormalizedViewport();
+  sliderRep->GetPoint1Coordinate()->SetValue(0.1, 0.9);
+  sliderRep->GetPoint2Coordinate()->SetCoordinateSystemToNormalizedViewport();
+  sliderRep->GetPoint2Coordinate()->SetValue(0.9, 0.9);
+  sliderRep->SetTubeWidth(0.02);
+  sliderRep->SetSliderLength(0.04);
+  sliderRep->SetTitleHeight(0.04);
+  sliderRep->SetLabelHeight(0.04);
+  sliderRep->SetEndCapLength(0.03);
+  sliderRep->SetSliderWidth(0.03);
+
+  vtkNew<vtkSliderWidget> slider;
+  slider->SetInteractor(renderWindowInteractor);
+  slider->SetRepresentation(sliderRep);
+  slider->SetAnimationModeToAnimate();
+  slider->EnabledOn();
+  slider->AddObserver(vtkCommand::InteractionEvent, callback);
+
+  originalRenderer->ResetCamera();
+  renderWindow->Render();
+  renderWindowInteractor->Start();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+/**
+ * Spread the low 21 bits of an integer to every third bit.
+ */
+std::uint64_t SpreadBits(std::uint64_t x)
+{
+  x &= 0x1fffff;
+  x = (x | x << 32) & 0x1f00000000ffffull;
+  x = (x | x << 16) & 0x1f0000ff0000ffull;
+  x = (x | x << 8) & 0x100f00f00f00f00full;
+  x = (x | x << 4) & 0x10c30c30c30c30c3ull;
+  x = (x | x << 2) & 0x1249249249249249ull;
+  return x;
+}
+
+vtkSmartPointer<vtkPoints> SpatialSort(vtkPoints* points)
+{
+  auto n = points->GetNumberOfPoints();
+  double bounds[6];
+  points->GetBounds(bounds);
+  double scale[3];
+  for (auto j = 0; j < 3; ++j)
+  {
+    scale[j] = 2097151.0 / std::max(bounds[2 * j + 1] - bounds[2 * j], 1e-300);
+  }
+
+  // BRIO: a point goes in round k with probability 2^-(k+1), the rounds are
+  // inserted from the smallest to the largest. A hash of the id replaces the
+  // coin flips so that the keys can be made in parallel. The keys sort by
+  // round, then along the Morton curve.
+  const int rounds = 20;
+  std::vector<std::pair<std::pair<int, std::uint64_t>, vtkIdType>> keys(n);
+  vtkSMPTools::For(0, n, [&](vtkIdType begin, vtkIdType end) {
+    double x[3];
+    for (auto i = begin; i < end; ++i)
+    {
+      auto hash = static_cast<std::uint64_t>(i) * 0x9E3779B97F4A7C15ull;
+      hash ^= hash >> 29;
+      hash *= 0xBF58476D1CE4E5B9ull;
+      hash ^= hash >> 32;
+      auto round = 0;
+      while (round < rounds && (hash & 1))
+      {
+        hash >>= 1;
+        ++round;
+      }
+      points->GetPoint(i, x);
+      std::uint64_t morton = 0;
+      for (auto j = 0; j < 3; ++j)
+      {
+        auto q = static_cast<std::uint64_t>((x[j] - bounds[2 * j]) * scale[j]);
+        morton |= SpreadBits(q) << j;
+      }
+      keys[i] = {{rounds - round, morton}, i};
+    }
+  });
+  vtkSMPTools::Sort(keys.begin(), keys.end());
+
+  auto sorted = vtkSmartPointer<vtkPoints>::New();
+  sorted->SetDataType(points->GetDataType());
+  sorted->SetNumberOfPoints(n);
+  vtkSMPTools::For(0, n, [&](vtkIdType begin, vtkIdType end) {
+    double x[3];
+    for (auto i = begin; i < end; ++i)
+    {
+      points->GetPoint(keys[i].second, x);
+      sorted->SetPoint(i, x);
+    }
+  });
+  return sorted;
+}
+
+/**
+ * @return The radius of the circumcircle of a triangle in 3D, or
+ * VTK_DOUBLE_MAX if it is degenerate.
+ */
+double TriangleCircumradius(double const a[3], double const b[3],
+                            double const c[3])
+{
+  double ac[3], bc[3], normal[3];
+  vtkMath::Subtract(a, c, ac);
+  vtkMath::Subtract(b, c, bc);
+  vtkMath::Cross(ac, bc, normal);
+  auto twiceArea = vtkMath::Norm(normal);
+  if (twiceArea == 0.0)
+  {
+    return VTK_DOUBLE_MAX;
+  }
+  return vtkMath::Norm(ac) * vtkMath::Norm(bc) *
+      std::sqrt(vtkMath::Distance2BetweenPoints(a, b)) / (2.0 * twiceArea);
+}
+
+AlphaComplex::AlphaComplex(vtkUnstructuredGrid* delaunay)
+{
+  this->Points = delaunay->GetPoints();
+
+  // The tetrahedra, and the radius of their circumsphere.
+  auto cells = delaunay->GetCells();
+  auto numberOfTetra = cells->GetNumberOfCells();
+  auto& tetra = this->Dimensions[3];
+  tetra.Points.resize(4 * numberOfTetra);
+  tetra.Radius.resize(numberOfTetra);
+  tetra.MaxAlpha.assign(numberOfTetra, VTK_DOUBLE_MAX);
+  vtkSMPThreadLocalObject<vtkIdList> localIds;
+  vtkSMPTools::For(0, numberOfTetra, [&](vtkIdType begin, vtkIdType end) {
+    auto ids = localIds.Local();
+    vtkIdType npts;
+    const vtkIdType* pts;
+    double x[4][3], center[3];
+    for (auto t = begin; t < end; ++t)
+    {
+      cells->GetCellAtId(t, npts, pts, ids);
+      for (auto i = 0; i < 4; ++i)
+      {
+        tetra.Points[4 * t + i] = pts[i];
+        this->Points->GetPoint(pts[i], x[i]);
+      }
+      auto radius2 = vtkTetra::Circumsphere(x[0], x[1], x[2], x[3], center);
+      tetra.Radius[t] =
+          radius2 == VTK_DOUBLE_MAX ? VTK_DOUBLE_MAX : std::sqrt(radius2);
+    }
+  });
+
+  this->BuildFaces(2);
+  this->BuildFaces(1);
+  this->BuildFaces(0);
+}
+
+void AlphaComplex::BuildFaces(int dimension)
+{
+  auto const& cofaces = this->Dimensions[dimension + 1];
+  auto& faces = this->Dimensions[dimension];
+  auto size = dimension + 1;
+  auto numberOfCofaces = static_cast<vtkIdType>(cofaces.Radius.size());
+
+  // The vertices are the points themselves.
+  if (dimension == 0)
+  {
+    auto numberOfPoints = this->Points->GetNumberOfPoints();
+    faces.Points.resize(numberOfPoints);
+    faces.Radius.assign(numberOfPoints, 0.0);
+    faces.MaxAlpha.assign(numberOfPoints, VTK_DOUBLE_MAX);
+    for (vtkIdType e = 0; e < numberOfCofaces; ++e)
+    {
+      for (auto i = 0; i < 2; ++i)
+      {
+        auto& maxAlpha = faces.MaxAlpha[cofaces.Points[2 * e + i]];
+        maxAlpha = std::min(maxAlpha, cofaces.Radius[e]);
+      }
+    }
+    vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+      for (auto i = begin; i < end; ++i)
+      {
+        faces.Points[i] = i;
+      }
+    });
+    return;
+  }
+
+  // Each coface has one face without each of its points. The sorted points
+  // of a face are its key, and the runs of equal keys the unique faces.
+  using Key = std::array<vtkIdType, 3>;
+  std::vector<std::pair<Key, vtkIdType>> keys((size + 1) * numberOfCofaces);
+  vtkSMPTools::For(0, numberOfCofaces, [&](vtkIdType begin, vtkIdType end) {
+    for (auto c = begin; c < end; ++c)
+    {
+      auto pts = cofaces.Points.data() + (size + 1) * c;
+      for (auto skip = 0; skip <= size; ++skip)
+      {
+        Key key{-1, -1, -1};
+        for (auto i = 0, j = 0; i <= size; ++i)
+        {
+          if (i != skip)
+          {
+            key[j++] = pts[i];
+          }
+        }
+        std::sort(key.begin(), key.begin() + size);
+        keys[(size + 1) * c + skip] = {key, c};
+      }
+    }
+  });
+  vtkSMPTools::Sort(keys.begin(), keys.end());
+
+  std::vector<vtkIdType> runs;
+  for (size_t k = 0; k < keys.size(); ++k)
+  {
+    if (k == 0 || keys[k].first != keys[k - 1].first)
+    {
+      runs.push_back(static_cast<vtkIdType>(k));
+    }
+  }
+  auto numberOfFaces = static_cast<vtkIdType>(runs.size());
+  runs.push_back(static_cast<vtkIdType>(keys.size()));
+
+  faces.Points.resize(size * numberOfFaces);
+  faces.Radius.resize(numberOfFaces);
+  faces.MaxAlpha.resize(numberOfFaces);
+  vtkSMPTools::For(0, numberOfFaces, [&](vtkIdType begin, vtkIdType end) {
+    double x[3][3];
+    for (auto f = begin; f < end; ++f)
+    {
+      auto const& key = keys[runs[f]].first;
+      for (auto i = 0; i < size; ++i)
+      {
+        faces.Points[size * f + i] = key[i];
+        this->Points->GetPoint(key[i], x[i]);
+      }
+      faces.Radius[f] = size == 3
+          ? TriangleCircumradius(x[0], x[1], x[2])
+          : 0.5 * std::sqrt(vtkMath::Distance2BetweenPoints(x[0], x[1]));
+      faces.MaxAlpha[f] = VTK_DOUBLE_MAX;
+      for (auto k = runs[f]; k < runs[f + 1]; ++k)
+      {
+        faces.MaxAlpha[f] =
+            std::min(faces.MaxAlpha[f], cofaces.Radius[keys[k].second]);
+      }
+    }
+  });
+}
+
+void AlphaComplex::Extract(double alpha, vtkUnstructuredGrid* output,
+                           std::array<vtkIdType, 4>& counts) const
+{
+  // Keep the simplices of each dimension in blocks: count each block in
+  // parallel, then fill them in parallel from their offsets.
+  const vtkIdType blockSize = 65536;
+  std::vector<vtkIdType> kept[4];
+  for (auto d = 0; d < 4; ++d)
+  {
+    auto const& simplices = this->Dimensions[d];
+    auto n = static_cast<vtkIdType>(simplices.Radius.size());
+    auto numberOfBlocks = (n + blockSize - 1) / blockSize;
+    std::vector<vtkIdType> blockStart(numberOfBlocks + 1, 0);
+    auto inside = [&](vtkIdType i) {
+      return simplices.Radius[i] <= alpha && alpha < simplices.MaxAlpha[i];
+    };
+    vtkSMPTools::For(0, numberOfBlocks, [&](vtkIdType begin, vtkIdType end) {
+      for (auto b = begin; b < end; ++b)
+      {
+        auto last = std::min(n, (b + 1) * blockSize);
+        for (auto i = b * blockSize; i < last; ++i)
+        {
+          blockStart[b + 1] += inside(i);
+        }
+      }
+    });
+    for (vtkIdType b = 0; b < numberOfBlocks; ++b)
+    {
+      blockStart[b + 1] += blockStart[b];
+    }
+    kept[d].resize(blockStart[numberOfBlocks]);
+    vtkSMPTools::For(0, numberOfBlocks, [&](vtkIdType begin, vtkIdType end) {
+      for (auto b = begin; b < end; ++b)
+      {
+        auto next = blockStart[b];
+        auto last = std::min(n, (b + 1) * blockSize);
+        for (auto i = b * blockSize; i < last; ++i)
+        {
+          if (inside(i))
+          {
+            kept[d][next++] = i;
+          }
+        }
+      }
+    });
+    counts[d] = static_cast<vtkIdType>(kept[d].size());
+  }
+
+  // The cells, from the tetrahedra down to the vertices, as in
+  // Delaunay3DDemo.
+  const int types[4]{VTK_VERTEX, VTK_LINE, VTK_TRIANGLE, VTK_TETRA};
+  vtkNew<vtkNamedColors> namedColors;
+  const char* colorNames[4]{"Lime", "Peacock", "Tomato", "Banana"};
+  vtkIdType cellStart[5]{0, 0, 0, 0, 0};
+  vtkIdType connectivityStart[5]{0, 0, 0, 0, 0};
+  for (auto d = 3, k = 0; d >= 0; --d, ++k)
+  {
+    cellStart[k + 1] = cellStart[k] + counts[d];
+    connectivityStart[k + 1] = connectivityStart[k] + (d + 1) * counts[d];
+  }
+  vtkNew<vtkIdTypeArray> offsets;
+  offsets->SetNumberOfValues(cellStart[4] + 1);
+  offsets->SetValue(cellStart[4], connectivityStart[4]);
+  vtkNew<vtkIdTypeArray> connectivity;
+  connectivity->SetNumberOfValues(connectivityStart[4]);
+  vtkNew<vtkUnsignedCharArray> cellTypes;
+  cellTypes->SetNumberOfValues(cellStart[4]);
+  vtkNew<vtkUnsignedCharArray> colors;
+  colors->SetNumberOfComponents(3);
+  colors->SetNumberOfTuples(cellStart[4]);
+  for (auto d = 3, k = 0; d >= 0; --d, ++k)
+  {
+    auto const& simplices = this->Dimensions[d];
+    auto color = namedColors->GetColor3ub(colorNames[d]);
+    vtkSMPTools::For(0, counts[d], [&](vtkIdType begin, vtkIdType end) {
+      for (auto i = begin; i < end; ++i)
+      {
+        auto cellId = cellStart[k] + i;
+        auto start = connectivityStart[k] + (d + 1) * i;
+        offsets->SetValue(cellId, start);
+        for (auto j = 0; j <= d; ++j)
+        {
+          connectivity->SetValue(
+              start + j, simplices.Points[(d + 1) * kept[d][i] + j]);
+        }
+        cellTypes->SetValue(cellId, static_cast<unsigned char>(types[d]));
+        colors->SetTypedTuple(cellId, color.GetData());
+      }
+    });
+  }
+  vtkNew<vtkCellArray> cells;
+  cells->SetData(offsets, connectivity);
+  output->Initialize();
+  output->SetPoints(this->Points);
+  output->SetCells(cellTypes, cells);
+  output->GetCellData()->SetScalars(colors);
+}
+
+void SliderCallbackAlpha::Execute(vtkObject* caller, unsigned long, void*)
+{
+  auto sliderWidget = reinterpret_cast<vtkSliderWidget*>(caller);
+  auto value = static_cast<vtkSliderRepresentation2D*>(
+                   sliderWidget->GetRepresentation())
+                   ->GetValue();
+  this->Update(value);
+}
+
+void SliderCallbackAlpha::Update(double alpha)
+{
+  vtkNew<vtkTimerLog> timer;
+  std::array<vtkIdType, 4> counts;
+  timer->StartTimer();
+  this->Complex->Extract(alpha, this->Output, counts);
+  timer->StopTimer();
+
+  std::stringstream ss;
+  ss << "numTetras: " << counts[3] << std::endl;
+  ss << "numLines: " << counts[1] << std::endl;
+  ss << "numTris: " << counts[2] << std::endl;
+  ss << "numVerts: " << counts[0] << std::endl;
+  ss << "Extract: " << 1000.0 * timer->GetElapsedTime() << " ms";
+  this->TextMapper->SetInput(ss.str().c_str());
+}
+
+vtkSmartPointer<vtkPolyData> ReadPolyData(const char* fileName)
+{
+  vtkSmartPointer<vtkPolyData> polyData;
+  std::string extension =
+      vtksys::SystemTools::GetFilenameExtension(std::string(fileName));
+  if (extension == ".ply")
+  {
+    vtkNew<vtkPLYReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".vtp")
+  {
+    vtkNew<vtkXMLPolyDataReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".obj")
+  {
+    vtkNew<vtkOBJReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".stl")
+  {
+    vtkNew<vtkSTLReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".vtk")
+  {
+    vtkNew<vtkPolyDataReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".g")
+  {
+    vtkNew<vtkBYUReader> reader;
+    reader->SetGeometryFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else
+  {
+    vtkNew<vtkSphereSource> source;
+    source->Update();
+    polyData = source->GetOutput();
+  }
+  return polyData;
+}
+} // namespace
@@ -0,0 +1,638 @@
+#include <vtkActor.h>
+#include <vtkCellArray.h>
+#include <vtkDataArray.h>
+#include <vtkDiscreteMarchingCubes.h>
+#include <vtkIdList.h>
+#include <vtkImageData.h>
+#include <vtkImageMathematics.h>
+#include <vtkImageThreshold.h>
+#include <vtkLookupTable.h>
+#include <vtkMath.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSMPThreadLocalObject.h>
+#include <vtkSMPTools.h>
+#include <vtkSampleFunction.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphere.h>
+#include <vtkTimerLog.h>
+#include <vtkWindowedSincPolyDataFilter.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+vtkSmartPointer<vtkLookupTable> MakeColors(unsigned int n);
+
+vtkSmartPointer<vtkImageData> MakeBlob(int n, double radius, int resolution);
+
+/**
+ * Windowed sinc smoothing of the surfaces of labeled data, in parallel.
+ *
+ * This smooths like vtkWindowedSincPolyDataFilter with
+ * NonManifoldSmoothingOn, BoundarySmoothingOff and FeatureEdgeSmoothingOff,
+ * the settings of SmoothDiscreteMarchingCubes. Where labels meet, edges
+ * have more than two polygons. A point on two such edges moves along them
+ * only, which keeps the junctions of the labels as curves, and a point on
+ * more of them, or on a boundary, does not move.
+ *
+ * The neighbors of the points are found once, by sorting the edges in
+ * parallel, and stored in compressed sparse rows. The coordinates are
+ * stored as three arrays, one per axis, and each iteration of the
+ * Chebyshev recurrence updates the points in parallel. Optionally a point
+ * is frozen once it moves less than a tolerance in one iteration. It then
+ * keeps its position for the remaining iterations, and the later
+ * iterations only visit the points that are still active.
+ */
+class SparseWindowedSinc
+{
+public:
+  /**
+   * @param iterations The number of iterations.
+   * @param passBand The pass band, as for vtkWindowedSincPolyDataFilter.
+   * @param tolerance Freeze a point that moves less than this, relative to
+   * the size of the input. Zero never freezes a point.
+   */
+  SparseWindowedSinc(int iterations, double passBand, double tolerance)
+    : Iterations(iterations), PassBand(passBand), Tolerance(tolerance)
+  {
+  }
+
+  /**
+   * @param input The polygons to smooth.
+   * @return The smoothed polygons, sharing the cells and the data of the
+   * input.
+   */
+  vtkSmartPointer<vtkPolyData> Smooth(vtkPolyData* input);
+
+  /**
+   * @return The number of point updates of the last smoothing, at most the
+   * number of points times the number of iterations.
+   */
+  vtkIdType GetNumberOfUpdates() const
+  {
+    return this->NumberOfUpdates;
+  }
+
+private:
+  /**
+   * Find the points each point is smoothed with.
+   */
+  void BuildNeighbors(vtkPolyData* input);
+
+  int Iterations;
+  double PassBand;
+  double Tolerance;
+  vtkIdType NumberOfUpdates = 0;
+  std::vector<vtkIdType> Offsets;
+  std::vector<vtkIdType> Neighbors;
+};
+
+/**
+ * Keep the items for which a predicate holds, in order. Blocks of items
+ * are counted and then filled in parallel.
+ *
+ * @param n The number of items.
+ * @param keep The predicate, called twice for each item.
+ * @return The indices of the items kept.
+ */
+template <typename Predicate>
+std::vector<vtkIdType> Compact(vtkIdType n, Predicate keep);
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  auto compare = false;
+  std::vector<std::string> args;
+  for (auto i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "-c")
+    {
+      compare = true;
+    }
+    else
+    {
+      args.push_back(arg);
+    }
+  }
+  auto resolution = args.size() > 0 ? std::atoi(args[0].c_str()) : 100;
+  auto tolerance = args.size() > 1 ? std::atof(args[1].c_str()) : 1e-5;
+  if (resolution < 10)
+  {
+    std::cout << "Usage: " << argv[0]
+              << " [resolution [tolerance]] [-c] e.g. 300 1e-5" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  int n = 20;
+  double radius = 8;
+
+  vtkSmartPointer<vtkImageData> blob = MakeBlob(n, radius, resolution);
+
+  vtkNew<vtkDiscreteMarchingCubes> discrete;
+  discrete->SetInputData(blob);
+  discrete->GenerateValues(n, 1, n);
+  discrete->Update();
+
+  unsigned int smoothingIterations = 15;
+  double passBand = 0.001;
+
+  vtkNew<vtkTimerLog> timer;
+  SparseWindowedSinc smoother(smoothingIterations, passBand, tolerance);
+  timer->StartTimer();
+  auto smoothed = smoother.Smooth(discrete->GetOutput());
+  timer->StopTimer();
+  auto numberOfPoints = discrete->GetOutput()->GetNumberOfPoints();
+  std::cout << "Points: " << numberOfPoints << std::endl;
+  std::cout << "Sparse windowed sinc: " << timer->GetElapsedTime() << " s, "
+            << smoother.GetNumberOfUpdates() << " of "
+            << numberOfPoints * smoothingIterations << " point updates"
+            << std::endl;
+
+  if (compare)
+  {
+    vtkNew<vtkWindowedSincPolyDataFilter> reference;
+    reference->SetInputConnection(discrete->GetOutputPort());
+    reference->SetNumberOfIterations(smoothingIterations);
+    reference->BoundarySmoothingOff();
+    reference->FeatureEdgeSmoothingOff();
+    reference->SetPassBand(passBand);
+    reference->NonManifoldSmoothingOn();
+    reference->NormalizeCoordinatesOn();
+    timer->StartTimer();
+    reference->Update();
+    timer->StopTimer();
+
+    // The points are in the same order.
+    double difference = 0.0;
+    for (vtkIdType i = 0; i < numberOfPoints; ++i)
+    {
+      double x[3], y[3];
+      smoothed->GetPoint(i, x);
+      reference->GetOutput()->GetPoint(i, y);
+      difference =
+          std::max(difference, vtkMath::Distance2BetweenPoints(x, y));
+    }
+    std::cout << "vtkWindowedSincPolyDataFilter: " << timer->GetElapsedTime()
+              << " s, largest difference " << std::sqrt(difference)
+              << std::endl;
+  }
+
+  vtkSmartPointer<vtkLookupTable> lut = MakeColors(n);
+
+  vtkNew<vtkPolyDataMapper> mapper;
+  mapper->SetInputData(smoothed);
+  mapper->SetLookupTable(lut);
+  mapper->SetScalarRange(0, lut->GetNumberOfColors());
+
+  vtkNew<vtkRenderer> ren1;
+  vtkNew<vtkRenderWindow> renWin;
+  renWin->AddRenderer(ren1);
+  renWin->SetWindowName("SparseWindowedSinc");
+
+  vtkNew<vtkRenderWindowInteractor> iren;
+  iren->SetRenderWindow(renWin);
+
+  vtkNew<vtkActor> actor;
+  actor->SetMapper(mapper);
+
+  ren1->AddActor(actor);
+
+  vtkNew<vtkNamedColors> colors;
+  ren1->SetBackground(colors->GetColor3d("Burlywood").GetData());
+
+  renWin->Render();
+
+  iren->Start();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+template <typename Predicate>
+std::vector<vtkIdType> Compact(vtkIdType n, Predicate keep)
+{
+  const vtkIdType blockSize = 65536;
+  auto numberOfBlocks = (n + blockSize - 1) / blockSize;
+  std::vector<vtkIdType> blockStart(numberOfBlocks + 1, 0);
+  vtkSMPTools::For(0, numberOfBlocks, [&](vtkIdType begin, vtkIdType end) {
+    for (auto b = begin; b < end; ++b)
+    {
+      auto last = std::min(n, (b + 1) * blockSize);
+      for (auto i = b * blockSize; i < last; ++i)
+      {
+        blockStart[b + 1] += keep(i);
+      }
+    }
+  });
+  for (vtkIdType b = 0; b < numberOfBlocks; ++b)
+  {
+    blockStart[b + 1] += blockStart[b];
+  }
+  std::vector<vtkIdType> kept(blockStart[numberOfBlocks]);
+  vtkSMPTools::For(0, numberOfBlocks, [&](vtkIdType begin, vtkIdType end) {
+    for (auto b = begin; b < end; ++b)
+    {
+      auto next = blockStart[b];
+      auto last = std::min(n, (b + 1) * blockSize);
+      for (auto i = b * blockSize; i < last; ++i)
+      {
+        if (keep(i))
+        {
+          kept[next++] = i;
+        }
+      }
+    }
+  });
+  return kept;
+}
+
+void SparseWindowedSinc::BuildNeighbors(vtkPolyData* input)
+{
+  auto polys = input->GetPolys();
+  auto numberOfPolys = polys->GetNumberOfCells();
+  auto numberOfPoints = input->GetNumberOfPoints();
+
+  // Each polygon has as many edges as points, so the edges of a polygon
+  // start at its offset.
+  auto offsets = polys->GetOffsetsArray();
+  std::vector<std::pair<vtkIdType, vtkIdType>> edges(
+      polys->GetNumberOfConnectivityIds());
+  vtkSMPThreadLocalObject<vtkIdList> localIds;
+  vtkSMPTools::For(0, numberOfPolys, [&](vtkIdType begin, vtkIdType end) {
+    auto ids = localIds.Local();
+    vtkIdType npts;
+    const vtkIdType* pts;
+    for (auto cellId = begin; cellId < end; ++cellId)
+    {
+      polys->GetCellAtId(cellId, npts, pts, ids);
+      auto first = static_cast<vtkIdType>(offsets->GetTuple1(cellId));
+      for (vtkIdType i = 0; i < npts; ++i)
+      {
+        auto a = pts[i];
+        auto b = pts[(i + 1) % npts];
+        edges[first + i] = {std::min(a, b), std::max(a, b)};
+      }
+    }
+  });
+  vtkSMPTools::Sort(edges.begin(), edges.end());
+
+  // Each run is an edge. It is a boundary edge with one polygon, and a
+  // nonmanifold edge with more than two. Each edge is listed at both of
+  // its points, with -1 - the other point for the special edges.
+  auto runs = Compact(static_cast<vtkIdType>(edges.size()), [&](vtkIdType i) {
+    return i == 0 || edges[i] != edges[i - 1];
+  });
+  auto numberOfEdges = static_cast<vtkIdType>(runs.size());
+  runs.push_back(static_cast<vtkIdType>(edges.size()));
+  std::vector<std::pair<vtkIdType, vtkIdType>> pointEdges(2 * numberOfEdges);
+  vtkSMPTools::For(0, numberOfEdges, [&](vtkIdType begin, vtkIdType end) {
+    for (auto e = begin; e < end; ++e)
+    {
+      auto const& edge = edges[runs[e]];
+      auto uses = runs[e + 1] - runs[e];
+      auto special = uses != 2;
+      pointEdges[2 * e] = {edge.first,
+                           special ? -1 - edge.second : edge.second};
+      pointEdges[2 * e + 1] = {edge.second,
+                               special ? -1 - edge.first : edge.first};
+    }
+  });
+  vtkSMPTools::Sort(pointEdges.begin(), pointEdges.end());
+  std::vector<vtkIdType> pointStart(numberOfPoints + 1);
+  vtkSMPTools::For(0, numberOfPoints + 1, [&](vtkIdType begin, vtkIdType end) {
+    for (auto p = begin; p < end; ++p)
+    {
+      pointStart[p] = static_cast<vtkIdType>(
+          std::lower_bound(pointEdges.begin(), pointEdges.end(),
+                           std::make_pair(p, VTK_ID_MIN)) -
+          pointEdges.begin());
+    }
+  });
+
+  // A point without special edges is smoothed with all its neighbors, and
+  // a point on two nonmanifold edges along them. The others are fixed.
+  // The special edges sort first, so they start the run of a point.
+  auto type = [&](vtkIdType p) {
+    auto numberOfSpecial = 0;
+    auto boundary = false;
+    for (auto i = pointStart[p]; i < pointStart[p + 1]; ++i)
+    {
+      if (pointEdges[i].second >= 0)
+      {
+        break;
+      }
+      ++numberOfSpecial;
+      auto other = -1 - pointEdges[i].second;
+      auto edge = std::make_pair(std::min(p, other), std::max(p, other));
+      auto run = std::lower_bound(edges.begin(), edges.end(), edge);
+      boundary |= run + 1 == edges.end() || *(run + 1) != edge;
+    }
+    if (numberOfSpecial == 0)
+    {
+      return pointStart[p + 1] - pointStart[p];
+    }
+    return !boundary && numberOfSpecial == 2 ? vtkIdType(2) : vtkIdType(0);
+  };
+  this->Offsets.assign(numberOfPoints + 1, 0);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+    for (auto p = begin; p < end; ++p)
+    {
+      this->Offsets[p + 1] = type(p);
+    }
+  });
+  for (vtkIdType p = 0; p < numberOfPoints; ++p)
+  {
+    this->Offsets[p + 1] += this->Offsets[p];
+  }
+  this->Neighbors.resize(this->Offsets[numberOfPoints]);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+    for (auto p = begin; p < end; ++p)
+    {
+      auto next = this->Offsets[p];
+      for (auto i = pointStart[p]; next < this->Offsets[p + 1]; ++i)
+      {
+        auto other = pointEdges[i].second;
+        this->Neighbors[next++] = other < 0 ? -1 - other : other;
+      }
+    }
+  });
+}
+
+vtkSmartPointer<vtkPolyData> SparseWindowedSinc::Smooth(vtkPolyData* input)
+{
+  this->BuildNeighbors(input);
+  auto numberOfPoints = input->GetNumberOfPoints();
+  auto iterations = this->Iterations;
+
+  // The weights of the Chebyshev polynomials, with a Hanning window, scaled
+  // so that they add up to one, as in vtkWindowedSincPolyDataFilter.
+  std::vector<double> weights(iterations + 1);
+  auto thetaPassBand = std::acos(1.0 - 0.5 * this->PassBand);
+  auto sum = 0.0;
+  for (auto i = 0; i <= iterations; ++i)
+  {
+    auto window = 0.5 * (1.0 + std::cos(i * vtkMath::Pi() / (iterations + 1)));
+    auto chebyshev = thetaPassBand / vtkMath::Pi();
+    if (i > 0)
+    {
+      chebyshev = 2.0 * std::sin(i * thetaPassBand) / (i * vtkMath::Pi());
+    }
+    weights[i] = window * chebyshev;
+    sum += weights[i];
+  }
+  // The weight left after each iteration, for the frozen points.
+  std::vector<double> remaining(iterations + 2, 0.0);
+  for (auto i = iterations; i >= 0; --i)
+  {
+    weights[i] /= sum;
+    remaining[i] = remaining[i + 1] + weights[i];
+  }
+
+  // The coordinates, centered and scaled to a unit size, one array per
+  // axis for the previous, current and next iteration, and the sum.
+  double center[3];
+  input->GetCenter(center);
+  auto length = std::max(input->GetLength(), 1e-300);
+  std::array<std::vector<double>, 3> x[3];
+  std::array<std::vector<double>, 3> smoothed;
+  for (auto j = 0; j < 3; ++j)
+  {
+    for (auto& iteration : x)
+    {
+      iteration[j].resize(numberOfPoints);
+    }
+    smoothed[j].resize(numberOfPoints);
+  }
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+    double point[3];
+    for (auto p = begin; p < end; ++p)
+    {
+      input->GetPoint(p, point);
+      for (auto j = 0; j < 3; ++j)
+      {
+        auto value = (point[j] - center[j]) / length;
+        x[0][j][p] = value;
+        x[1][j][p] = value;
+        x[2][j][p] = value;
+        smoothed[j][p] = weights[0] * value;
+      }
+    }
+  });
+
+  auto active = Compact(numberOfPoints, [&](vtkIdType p) {
+    return this->Offsets[p + 1] > this->Offsets[p];
+  });
+  // The fixed points keep their position.
+  auto fixed = Compact(numberOfPoints, [&](vtkIdType p) {
+    return this->Offsets[p + 1] == this->Offsets[p];
+  });
+  vtkSMPTools::For(0, static_cast<vtkIdType>(fixed.size()),
+                   [&](vtkIdType begin, vtkIdType end) {
+                     for (auto k = begin; k < end; ++k)
+                     {
+                       for (auto j = 0; j < 3; ++j)
+                       {
+                         smoothed[j][fixed[k]] = x[1][j][fixed[k]];
+                       }
+                     }
+                   });
+
+  // x[previous], x[current] and x[next] rotate through the iterations.
+  auto previous = 0;
+  auto current = 1;
+  auto next = 2;
+  auto tolerance2 = this->Tolerance * this->Tolerance;
+  std::vector<char> frozen(numberOfPoints, 0);
+  this->NumberOfUpdates = 0;
+  for (auto i = 1; i <= iterations && !active.empty(); ++i)
+  {
+    auto numberActive = static_cast<vtkIdType>(active.size());
+    this->NumberOfUpdates += numberActive;
+    auto const& xPrevious = x[previous];
+    auto const& xCurrent = x[current];
+    auto& xNext = x[next];
+    vtkSMPTools::For(0, numberActive, [&](vtkIdType begin, vtkIdType end) {
+      for (auto k = begin; k < end; ++k)
+      {
+        auto p = active[k];
+        auto first = this->Offsets[p];
+        auto last = this->Offsets[p + 1];
+        double average[3]{0.0, 0.0, 0.0};
+        for (auto n = first; n < last; ++n)
+        {
+          auto q = this->Neighbors[n];
+          average[0] += xCurrent[0][q];
+          average[1] += xCurrent[1][q];
+          average[2] += xCurrent[2][q];
+        }
+        auto move2 = 0.0;
+        for (auto j = 0; j < 3; ++j)
+        {
+          auto delta = average[j] / (last - first) - xCurrent[j][p];
+          // x1 = x0 + delta / 2, then x(i+1) = 2 x(i) + delta - x(i-1).
+          auto value = i == 1 ? xCurrent[j][p] + 0.5 * delta
+                              : 2.0 * xCurrent[j][p] + delta - xPrevious[j][p];
+          xNext[j][p] = value;
+          move2 += (value - xCurrent[j][p]) * (value - xCurrent[j][p]);
+        }
+        if (move2 < tolerance2)
+        {
+          // The point keeps this position from now on.
+          frozen[p] = 1;
+          for (auto j = 0; j < 3; ++j)
+          {
+            smoothed[j][p] += remaining[i] * xNext[j][p];
+          }
+        }
+        else
+        {
+          for (auto j = 0; j < 3; ++j)
+          {
+            smoothed[j][p] += weights[i] * xNext[j][p];
+          }
+        }
+      }
+    });
+
+    auto rotated = previous;
+    previous = current;
+    current = next;
+    next = rotated;
+
+    // The frozen points get their position in every iteration, and leave
+    // the active points.
+    auto stillActive = Compact(
+        numberActive, [&](vtkIdType k) { return !frozen[active[k]]; });
+    if (static_cast<vtkIdType>(stillActive.size()) < numberActive)
+    {
+      vtkSMPTools::For(0, numberActive, [&](vtkIdType begin, vtkIdType end) {
+        for (auto k = begin; k < end; ++k)
+        {
+          auto p = active[k];
+          if (frozen[p])
+          {
+            for (auto j = 0; j < 3; ++j)
+            {
+              x[previous][j][p] = x[current][j][p];
+              x[next][j][p] = x[current][j][p];
+            }
+          }
+        }
+      });
+      for (auto& k : stillActive)
+      {
+        k = active[k];
+      }
+      active.swap(stillActive);
+    }
+  }
+
+  // The points still active at the end have all their weights.
+  auto output = vtkSmartPointer<vtkPolyData>::New();
+  output->ShallowCopy(input);
+  vtkNew<vtkPoints> points;
+  points->SetDataType(input->GetPoints()->GetDataType());
+  points->SetNumberOfPoints(numberOfPoints);
+  vtkSMPTools::For(0, numberOfPoints, [&](vtkIdType begin, vtkIdType end) {
+    for (auto p = begin; p < end; ++p)
+    {
+      points->SetPoint(p, center[0] + length * smoothed[0][p],
+                       center[1] + length * smoothed[1][p],
+                       center[2] + length * smoothed[2][p]);
+    }
+  });
+  output->SetPoints(points);
+  return output;
+}
+
+vtkSmartPointer<vtkImageData> MakeBlob(int n, double radius, int resolution)
+{
+  vtkNew<vtkImageData> blobImage;
+
+  double maxR = 50 - 2.0 * radius;
+  vtkNew<vtkMinimalStandardRandomSequence> randomSequence;
+  randomSequence->SetSeed(5071);
+  for (int i = 0; i < n; ++i)
+  {
+    vtkNew<vtkSphere> sphere;
+    sphere->SetRadius(radius);
+    auto x = randomSequence->GetRangeValue(-maxR, maxR);
+    randomSequence->Next();
+    auto y = randomSequence->GetRangeValue(-maxR, maxR);
+    randomSequence->Next();
+    auto z = randomSequence->GetRangeValue(-maxR, maxR);
+    randomSequence->Next();
+
+    sphere->SetCenter(int(x), int(y), int(z));
+
+    vtkNew<vtkSampleFunction> sampler;
+    sampler->SetImplicitFunction(sphere);
+    sampler->SetOutputScalarTypeToFloat();
+    sampler->SetSampleDimensions(resolution, resolution, resolution);
+    sampler->SetModelBounds(-50, 50, -50, 50, -50, 50);
+
+    vtkNew<vtkImageThreshold> thres;
+    thres->SetInputConnection(sampler->GetOutputPort());
+    thres->ThresholdByLower(radius * radius);
+    thres->ReplaceInOn();
+    thres->ReplaceOutOn();
+    thres->SetInValue(i + 1);
+    thres->SetOutValue(0);
+    thres->Update();
+    if (i == 0)
+    {
+      blobImage->DeepCopy(thres->GetOutput());
+    }
+
+    vtkNew<vtkImageMathematics> maxValue;
+    maxValue->SetInputData(0, blobImage);
+    maxValue->SetInputData(1, thres->GetOutput());
+    maxValue->SetOperationToMax();
+    maxValue->Modified();
+    maxValue->Update();
+
+    blobImage->DeepCopy(maxValue->GetOutput());
+  }
+  return blobImage;
+}
+
+// Generate some random colors
+vtkSmartPointer<vtkLookupTable> MakeColors(unsigned int n)
+{
+  vtkNew<vtkLookupTable> lut;
+  lut->SetNumberOfColors(n);
+  lut->SetTableRange(0, n - 1);
+  lut->SetScaleToLinear();
+  lut->Build();
+  lut->SetTableValue(0, 0, 0, 0, 1);
+
+  vtkNew<vtkMinimalStandardRandomSequence> randomSequence;
+  randomSequence->SetSeed(5071);
+  for (int i = 1; i < static_cast<int>(n); ++i)
+  {
+    auto r = randomSequence->GetRangeValue(0.4, 1);
+    randomSequence->Next();
+    auto g = randomSequence->GetRangeValue(0.4, 1);
+    randomSequence->Next();
+    auto b = randomSequence->GetRangeValue(0.4, 1);
+    randomSequence->Next();
+    lut->SetTableValue(i, r, g, b, 1.0);
+  }
+  return lut;
+}
+} // namespace
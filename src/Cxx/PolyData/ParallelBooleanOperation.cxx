@@ -0,0 +1,1058 @@
+#include <vtkActor.h>
+#include <vtkBooleanOperationPolyDataFilter.h>
+#include <vtkCamera.h>
+#include <vtkCellArray.h>
+#include <vtkCellArrayIterator.h>
+#include <vtkCleanPolyData.h>
+#include <vtkDelaunay2D.h>
+#include <vtkMassProperties.h>
+#include <vtkMath.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProperty.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPThreadLocalObject.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtkTriangleFilter.h>
+
+#include <vtkBYUReader.h>
+#include <vtkOBJReader.h>
+#include <vtkPLYReader.h>
+#include <vtkPolyDataReader.h>
+#include <vtkSTLReader.h>
+#include <vtkSphereSource.h>
+#include <vtkXMLPolyDataReader.h>
+#include <vtksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+vtkSmartPointer<vtkPolyData> ReadPolyData(const char* fileName);
+
+/**
+ * The points and triangles of a mesh, in flat arrays that the threads can
+ * read without going through the VTK API.
+ */
+struct Mesh
+{
+  std::vector<double> Points;
+  std::vector<vtkIdType> Triangles;
+  // The id of the first point of this mesh in the output.
+  vtkIdType Offset = 0;
+
+  Mesh(vtkPolyData* polyData, vtkIdType offset);
+
+  vtkIdType GetNumberOfTriangles() const
+  {
+    return static_cast<vtkIdType>(this->Triangles.size() / 3);
+  }
+
+  const double* GetPoint(vtkIdType triangle, int corner) const
+  {
+    return this->Points.data() + 3 * this->Triangles[3 * triangle + corner];
+  }
+};
+
+/**
+ * A bounding volume hierarchy over the triangles of a mesh.
+ *
+ * The triangles are sorted along a Morton curve and grouped in leaves of
+ * a few consecutive triangles. The tree above the leaves is implicit: node
+ * i of a level has nodes 2i and 2i + 1 of the level below as children. Each
+ * level is built from the one below in parallel.
+ */
+class BoundingVolumeHierarchy
+{
+public:
+  BoundingVolumeHierarchy(Mesh const& mesh);
+
+  /**
+   * Visit the triangles whose box overlaps a box.
+   *
+   * @param box xmin, xmax, ymin, ymax, zmin, zmax.
+   * @param visit Called with the id of each triangle.
+   */
+  template <typename Visitor>
+  void Query(const double box[6], Visitor&& visit) const;
+
+  /**
+   * Count the triangles that a ray crosses.
+   *
+   * @param origin The start of the ray.
+   * @param direction The direction of the ray.
+   * @return The number of crossings.
+   */
+  int CountCrossings(const double origin[3], const double direction[3]) const;
+
+private:
+  static const int LeafSize = 4;
+
+  Mesh const& Surface;
+  std::vector<vtkIdType> Order;
+  // Levels[0] holds the boxes of the leaves, the last level the root.
+  std::vector<std::vector<std::array<double, 6>>> Levels;
+};
+
+/**
+ * A segment where two triangles cross, with the ids of its end points in
+ * the output.
+ */
+struct Cut
+{
+  vtkIdType Triangle[2];
+  std::array<double, 3> Ends[2];
+  vtkIdType Ids[2];
+};
+
+/**
+ * The segment where two triangles cross. Coplanar triangles do not cross.
+ *
+ * Points on an edge are interpolated from the end of the edge with the
+ * smaller id, so that the triangles on either side of the edge compute
+ * the same point.
+ *
+ * @param meshA, a The first triangle.
+ * @param meshB, b The second triangle.
+ * @param p, q The ends of the segment.
+ * @return true if the triangles cross along a segment.
+ */
+bool IntersectTriangles(Mesh const& meshA, vtkIdType a, Mesh const& meshB,
+                        vtkIdType b, double p[3], double q[3]);
+
+/**
+ * Split the cut triangles of a mesh into pieces that follow the cuts, one
+ * triangle per task.
+ *
+ * @param mesh The mesh.
+ * @param side 0 for the first mesh of the cuts, 1 for the second.
+ * @param cuts The cuts, sorted by the triangles of this mesh.
+ * @param points All the output points.
+ * @return The uncut triangles followed by the pieces, with output point ids.
+ */
+std::vector<std::array<vtkIdType, 3>>
+SplitTriangles(Mesh const& mesh, int side, std::vector<Cut> const& cuts,
+               std::vector<double> const& points);
+
+/**
+ * Find which triangles lie inside the other mesh, by casting a ray from
+ * their centroid.
+ *
+ * @param triangles The triangles, with output point ids.
+ * @param points All the output points.
+ * @param other The hierarchy of the other mesh.
+ * @return 1 for each triangle inside, 0 otherwise.
+ */
+std::vector<char>
+Classify(std::vector<std::array<vtkIdType, 3>> const& triangles,
+         std::vector<double> const& points,
+         BoundingVolumeHierarchy const& other);
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  auto compare = false;
+  std::vector<std::string> arguments;
+  for (auto i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "-c")
+    {
+      compare = true;
+    }
+    else
+    {
+      arguments.push_back(arg);
+    }
+  }
+
+  vtkSmartPointer<vtkPolyData> input1;
+  vtkSmartPointer<vtkPolyData> input2;
+  std::string operation("intersection");
+  if (arguments.size() == 3)
+  {
+    for (auto i = 0; i < 2; ++i)
+    {
+      auto polyData = ReadPolyData(arguments[2 * i].c_str());
+      vtkNew<vtkTriangleFilter> triangles;
+      triangles->SetInputData(polyData);
+      vtkNew<vtkCleanPolyData> clean;
+      clean->SetInputConnection(triangles->GetOutputPort());
+      clean->Update();
+      (i == 0 ? input1 : input2) = clean->GetOutput();
+    }
+    operation = arguments[1];
+  }
+  else if (arguments.size() < 3)
+  {
+    auto resolution = 200;
+    if (arguments.size() > 0)
+    {
+      operation = arguments[0];
+    }
+    if (arguments.size() > 1)
+    {
+      resolution = std::atoi(arguments[1].c_str());
+    }
+    vtkNew<vtkSphereSource> sphereSource1;
+    sphereSource1->SetCenter(0.25, 0, 0);
+    sphereSource1->SetPhiResolution(resolution);
+    sphereSource1->SetThetaResolution(resolution);
+    sphereSource1->Update();
+    input1 = sphereSource1->GetOutput();
+
+    vtkNew<vtkSphereSource> sphereSource2;
+    sphereSource2->SetPhiResolution(resolution + 1);
+    sphereSource2->SetThetaResolution(resolution + 1);
+    sphereSource2->Update();
+    input2 = sphereSource2->GetOutput();
+  }
+  else
+  {
+    std::cout << "Usage: " << argv[0]
+              << " [intersection|difference|union [resolution]] [-c]"
+              << std::endl;
+    std::cout << "       " << argv[0]
+              << " input1 intersection|difference|union input2 [-c]"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (operation != "union" && operation != "intersection" &&
+      operation != "difference")
+  {
+    std::cout << "Unknown operation: " << operation << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkNew<vtkNamedColors> colors;
+
+  vtkNew<vtkTimerLog> timer;
+  Mesh meshA(input1, 0);
+  Mesh meshB(input2, input1->GetNumberOfPoints());
+  std::cout << "Triangles: " << meshA.GetNumberOfTriangles() << " and "
+            << meshB.GetNumberOfTriangles() << ", " << operation << std::endl;
+
+  // 1. A hierarchy for each input.
+  timer->StartTimer();
+  BoundingVolumeHierarchy hierarchyA(meshA);
+  BoundingVolumeHierarchy hierarchyB(meshB);
+  timer->StopTimer();
+  std::cout << "  Hierarchies:     " << timer->GetElapsedTime() << " s"
+            << std::endl;
+
+  // 2. Each triangle of the first input looks for the triangles of the
+  // second one it crosses.
+  timer->StartTimer();
+  vtkSMPThreadLocal<std::vector<Cut>> localCuts;
+  vtkSMPTools::For(
+      0, meshA.GetNumberOfTriangles(), [&](vtkIdType begin, vtkIdType end) {
+        auto& found = localCuts.Local();
+        for (auto a = begin; a < end; ++a)
+        {
+          double box[6]{VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX,
+                        VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN};
+          for (auto corner = 0; corner < 3; ++corner)
+          {
+            auto x = meshA.GetPoint(a, corner);
+            for (auto j = 0; j < 3; ++j)
+            {
+              box[2 * j] = std::min(box[2 * j], x[j]);
+              box[2 * j + 1] = std::max(box[2 * j + 1], x[j]);
+            }
+          }
+          hierarchyB.Query(box, [&](vtkIdType b) {
+            Cut cut;
+            if (IntersectTriangles(meshA, a, meshB, b, cut.Ends[0].data(),
+                                   cut.Ends[1].data()))
+            {
+              cut.Triangle[0] = a;
+              cut.Triangle[1] = b;
+              found.push_back(cut);
+            }
+          });
+        }
+      });
+  std::vector<Cut> cuts;
+  for (auto const& found : localCuts)
+  {
+    cuts.insert(cuts.end(), found.begin(), found.end());
+  }
+
+  // The ends of the cuts become output points. An end on a corner of one
+  // of its triangles is that corner, the others are numbered once.
+  auto numberOfInputPoints =
+      input1->GetNumberOfPoints() + input2->GetNumberOfPoints();
+  std::vector<double> points(3 * numberOfInputPoints);
+  std::copy(meshA.Points.begin(), meshA.Points.end(), points.begin());
+  std::copy(meshB.Points.begin(), meshB.Points.end(),
+            points.begin() + meshA.Points.size());
+  std::map<std::array<double, 3>, vtkIdType> ends;
+  for (auto& cut : cuts)
+  {
+    for (auto e = 0; e < 2; ++e)
+    {
+      cut.Ids[e] = -1;
+      for (auto side = 0; side < 2 && cut.Ids[e] < 0; ++side)
+      {
+        auto const& mesh = side == 0 ? meshA : meshB;
+        for (auto corner = 0; corner < 3; ++corner)
+        {
+          if (std::equal(cut.Ends[e].begin(), cut.Ends[e].end(),
+                         mesh.GetPoint(cut.Triangle[side], corner)))
+          {
+            cut.Ids[e] = mesh.Offset +
+                mesh.Triangles[3 * cut.Triangle[side] + corner];
+            break;
+          }
+        }
+      }
+      if (cut.Ids[e] < 0)
+      {
+        auto inserted = ends.emplace(
+            cut.Ends[e], static_cast<vtkIdType>(points.size() / 3));
+        if (inserted.second)
+        {
+          points.insert(points.end(), cut.Ends[e].begin(), cut.Ends[e].end());
+        }
+        cut.Ids[e] = inserted.first->second;
+      }
+    }
+  }
+  timer->StopTimer();
+  std::cout << "  Crossing pairs:  " << timer->GetElapsedTime() << " s, "
+            << cuts.size() << " cuts" << std::endl;
+
+  // 3. Split the cut triangles of each input along their cuts.
+  timer->StartTimer();
+  vtkSMPTools::Sort(cuts.begin(), cuts.end(), [](Cut const& x, Cut const& y) {
+    return x.Triangle[0] < y.Triangle[0];
+  });
+  auto trianglesA = SplitTriangles(meshA, 0, cuts, points);
+  vtkSMPTools::Sort(cuts.begin(), cuts.end(), [](Cut const& x, Cut const& y) {
+    return x.Triangle[1] < y.Triangle[1];
+  });
+  auto trianglesB = SplitTriangles(meshB, 1, cuts, points);
+  timer->StopTimer();
+  std::cout << "  Retriangulation: " << timer->GetElapsedTime() << " s"
+            << std::endl;
+
+  // 4. Which pieces lie inside the other input.
+  timer->StartTimer();
+  auto insideA = Classify(trianglesA, points, hierarchyB);
+  auto insideB = Classify(trianglesB, points, hierarchyA);
+  timer->StopTimer();
+  std::cout << "  Classification:  " << timer->GetElapsedTime() << " s"
+            << std::endl;
+
+  // 5. Keep the pieces of the operation. The difference turns the kept
+  // pieces of the second input inside out.
+  timer->StartTimer();
+  char keepA = operation == "intersection" ? 1 : 0;
+  char keepB = operation == "union" ? 0 : 1;
+  vtkNew<vtkCellArray> polys;
+  for (size_t i = 0; i < trianglesA.size(); ++i)
+  {
+    if (insideA[i] == keepA)
+    {
+      polys->InsertNextCell(3, trianglesA[i].data());
+    }
+  }
+  for (size_t i = 0; i < trianglesB.size(); ++i)
+  {
+    if (insideB[i] == keepB)
+    {
+      auto triangle = trianglesB[i];
+      if (operation == "difference")
+      {
+        std::swap(triangle[1], triangle[2]);
+      }
+      polys->InsertNextCell(3, triangle.data());
+    }
+  }
+  vtkNew<vtkPoints> outputPoints;
+  outputPoints->SetDataTypeToDouble();
+  outputPoints->SetNumberOfPoints(static_cast<vtkIdType>(points.size() / 3));
+  for (vtkIdType i = 0; i < outputPoints->GetNumberOfPoints(); ++i)
+  {
+    outputPoints->SetPoint(i, points.data() + 3 * i);
+  }
+  vtkNew<vtkPolyData> pieces;
+  pieces->SetPoints(outputPoints);
+  pieces->SetPolys(polys);
+
+  // Ends of cuts found from an edge of either input, where edges of both
+  // inputs meet, can differ in the last bits. Weld them, and drop the
+  // unused points.
+  vtkNew<vtkCleanPolyData> clean;
+  clean->SetInputData(pieces);
+  clean->SetTolerance(1e-10);
+  clean->ConvertPolysToLinesOff();
+  clean->Update();
+  auto result = clean->GetOutput();
+  timer->StopTimer();
+  std::cout << "  Assembly:        " << timer->GetElapsedTime() << " s, "
+            << result->GetNumberOfCells() << " triangles" << std::endl;
+
+  if (compare)
+  {
+    vtkNew<vtkBooleanOperationPolyDataFilter> booleanOperation;
+    if (operation == "union")
+    {
+      booleanOperation->SetOperationToUnion();
+    }
+    else if (operation == "intersection")
+    {
+      booleanOperation->SetOperationToIntersection();
+    }
+    else
+    {
+      booleanOperation->SetOperationToDifference();
+    }
+    booleanOperation->SetInputData(0, input1);
+    booleanOperation->SetInputData(1, input2);
+    timer->StartTimer();
+    booleanOperation->Update();
+    timer->StopTimer();
+    std::cout << "vtkBooleanOperationPolyDataFilter: "
+              << timer->GetElapsedTime() << " s, "
+              << booleanOperation->GetOutput()->GetNumberOfCells()
+              << " triangles" << std::endl;
+
+    vtkNew<vtkMassProperties> mass;
+    mass->SetInputData(result);
+    mass->Update();
+    std::cout << "  Area, volume:    " << mass->GetSurfaceArea() << ", "
+              << mass->GetVolume() << std::endl;
+    mass->SetInputConnection(booleanOperation->GetOutputPort());
+    mass->Update();
+    std::cout << "  vtkBooleanOperationPolyDataFilter: "
+              << mass->GetSurfaceArea() << ", " << mass->GetVolume()
+              << std::endl;
+  }
+
+  vtkNew<vtkPolyDataMapper> mapper;
+  mapper->SetInputData(result);
+  mapper->ScalarVisibilityOff();
+
+  vtkNew<vtkActor> actor;
+  actor->SetMapper(mapper);
+  actor->GetProperty()->SetDiffuseColor(
+      colors->GetColor3d("Banana").GetData());
+  actor->GetProperty()->SetSpecular(0.6);
+  actor->GetProperty()->SetSpecularPower(20);
+
+  vtkNew<vtkRenderer> renderer;
+  renderer->AddActor(actor);
+  renderer->SetBackground(colors->GetColor3d("Silver").GetData());
+
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->AddRenderer(renderer);
+  renderWindow->SetSize(640, 480);
+  renderWindow->SetWindowName("ParallelBooleanOperation");
+
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  renderWindowInteractor->SetRenderWindow(renderWindow);
+
+  renderer->GetActiveCamera()->SetViewUp(0.0, 0.0, 1.0);
+  renderer->GetActiveCamera()->SetPosition(0.0, -1.0, 0.0);
+  renderer->GetActiveCamera()->Azimuth(30);
+  renderer->ResetCamera();
+
+  renderWindow->Render();
+  renderWindowInteractor->Start();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+Mesh::Mesh(vtkPolyData* polyData, vtkIdType offset) : Offset(offset)
+{
+  auto numberOfPoints = polyData->GetNumberOfPoints();
+  this->Points.resize(3 * numberOfPoints);
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    polyData->GetPoint(i, this->Points.data() + 3 * i);
+  }
+  auto iter = vtk::TakeSmartPointer(polyData->GetPolys()->NewIterator());
+  for (iter->GoToFirstCell(); !iter->IsDoneWithTraversal();
+       iter->GoToNextCell())
+  {
+    vtkIdType npts;
+    const vtkIdType* pts;
+    iter->GetCurrentCell(npts, pts);
+    if (npts == 3)
+    {
+      this->Triangles.insert(this->Triangles.end(), pts, pts + 3);
+    }
+  }
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(Mesh const& mesh)
+  : Surface(mesh)
+{
+  auto n = mesh.GetNumberOfTriangles();
+  double bounds[6]{VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX,
+                   VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN};
+  for (size_t i = 0; i < mesh.Points.size(); ++i)
+  {
+    bounds[2 * (i % 3)] = std::min(bounds[2 * (i % 3)], mesh.Points[i]);
+    bounds[2 * (i % 3) + 1] = std::max(bounds[2 * (i % 3) + 1], mesh.Points[i]);
+  }
+
+  // Sort the triangles along a Morton curve through their centroids, 21
+  // bits per axis.
+  std::vector<std::pair<std::uint64_t, vtkIdType>> keys(n);
+  vtkSMPTools::For(0, n, [&](vtkIdType begin, vtkIdType end) {
+    for (auto t = begin; t < end; ++t)
+    {
+      std::uint64_t code = 0;
+      for (auto j = 0; j < 3; ++j)
+      {
+        auto centroid = (mesh.GetPoint(t, 0)[j] + mesh.GetPoint(t, 1)[j] +
+                         mesh.GetPoint(t, 2)[j]) /
+            3.0;
+        auto extent = bounds[2 * j + 1] - bounds[2 * j];
+        auto cell = static_cast<std::uint64_t>(
+            extent > 0.0 ? (centroid - bounds[2 * j]) / extent * 2097151.0
+                         : 0.0);
+        for (auto bit = 0; bit < 21; ++bit)
+        {
+          code |= ((cell >> bit) & 1) << (3 * bit + j);
+        }
+      }
+      keys[t] = {code, t};
+    }
+  });
+  vtkSMPTools::Sort(keys.begin(), keys.end());
+  this->Order.resize(n);
+  for (vtkIdType t = 0; t < n; ++t)
+  {
+    this->Order[t] = keys[t].second;
+  }
+
+  // The leaves, padded with empty boxes to a power of two.
+  vtkIdType numberOfLeaves = 1;
+  while (numberOfLeaves * LeafSize < n)
+  {
+    numberOfLeaves *= 2;
+  }
+  this->Levels.emplace_back(numberOfLeaves);
+  auto& leaves = this->Levels.back();
+  vtkSMPTools::For(0, numberOfLeaves, [&](vtkIdType begin, vtkIdType end) {
+    for (auto leaf = begin; leaf < end; ++leaf)
+    {
+      auto& box = leaves[leaf];
+      box = {VTK_DOUBLE_MAX, VTK_DOUBLE_MIN, VTK_DOUBLE_MAX,
+             VTK_DOUBLE_MIN, VTK_DOUBLE_MAX, VTK_DOUBLE_MIN};
+      auto last = std::min(n, (leaf + 1) * LeafSize);
+      for (auto i = leaf * LeafSize; i < last; ++i)
+      {
+        for (auto corner = 0; corner < 3; ++corner)
+        {
+          auto x = mesh.GetPoint(this->Order[i], corner);
+          for (auto j = 0; j < 3; ++j)
+          {
+            box[2 * j] = std::min(box[2 * j], x[j]);
+            box[2 * j + 1] = std::max(box[2 * j + 1], x[j]);
+          }
+        }
+      }
+    }
+  });
+  while (this->Levels.back().size() > 1)
+  {
+    auto& below = this->Levels.back();
+    std::vector<std::array<double, 6>> level(below.size() / 2);
+    vtkSMPTools::For(0, static_cast<vtkIdType>(level.size()),
+                     [&](vtkIdType begin, vtkIdType end) {
+                       for (auto i = begin; i < end; ++i)
+                       {
+                         for (auto j = 0; j < 3; ++j)
+                         {
+                           level[i][2 * j] = std::min(below[2 * i][2 * j],
+                                                      below[2 * i + 1][2 * j]);
+                           level[i][2 * j + 1] =
+                               std::max(below[2 * i][2 * j + 1],
+                                        below[2 * i + 1][2 * j + 1]);
+                         }
+                       }
+                     });
+    this->Levels.push_back(std::move(level));
+  }
+}
+
+template <typename Visitor>
+void BoundingVolumeHierarchy::Query(const double box[6],
+                                    Visitor&& visit) const
+{
+  auto n = static_cast<vtkIdType>(this->Order.size());
+  std::vector<std::pair<int, vtkIdType>> stack{
+      {static_cast<int>(this->Levels.size()) - 1, 0}};
+  while (!stack.empty())
+  {
+    auto node = stack.back();
+    stack.pop_back();
+    auto const& b = this->Levels[node.first][node.second];
+    if (b[0] > box[1] || b[1] < box[0] || b[2] > box[3] || b[3] < box[2] ||
+        b[4] > box[5] || b[5] < box[4])
+    {
+      continue;
+    }
+    if (node.first > 0)
+    {
+      stack.push_back({node.first - 1, 2 * node.second});
+      stack.push_back({node.first - 1, 2 * node.second + 1});
+      continue;
+    }
+    auto last = std::min(n, (node.second + 1) * LeafSize);
+    for (auto i = node.second * LeafSize; i < last; ++i)
+    {
+      visit(this->Order[i]);
+    }
+  }
+}
+
+int BoundingVolumeHierarchy::CountCrossings(const double origin[3],
+                                            const double direction[3]) const
+{
+  auto n = static_cast<vtkIdType>(this->Order.size());
+  auto crossings = 0;
+  std::vector<std::pair<int, vtkIdType>> stack{
+      {static_cast<int>(this->Levels.size()) - 1, 0}};
+  while (!stack.empty())
+  {
+    auto node = stack.back();
+    stack.pop_back();
+
+    // Slab test of the ray against the box.
+    auto const& b = this->Levels[node.first][node.second];
+    auto t0 = 0.0;
+    auto t1 = VTK_DOUBLE_MAX;
+    for (auto j = 0; j < 3 && t0 <= t1; ++j)
+    {
+      if (direction[j] == 0.0)
+      {
+        if (origin[j] < b[2 * j] || origin[j] > b[2 * j + 1])
+        {
+          t0 = 1.0;
+          t1 = 0.0;
+        }
+        continue;
+      }
+      auto ta = (b[2 * j] - origin[j]) / direction[j];
+      auto tb = (b[2 * j + 1] - origin[j]) / direction[j];
+      t0 = std::max(t0, std::min(ta, tb));
+      t1 = std::min(t1, std::max(ta, tb));
+    }
+    if (t0 > t1)
+    {
+      continue;
+    }
+    if (node.first > 0)
+    {
+      stack.push_back({node.first - 1, 2 * node.second});
+      stack.push_back({node.first - 1, 2 * node.second + 1});
+      continue;
+    }
+
+    // Moller-Trumbore against the triangles of the leaf.
+    auto last = std::min(n, (node.second + 1) * LeafSize);
+    for (auto i = node.second * LeafSize; i < last; ++i)
+    {
+      auto t = this->Order[i];
+      auto x0 = this->Surface.GetPoint(t, 0);
+      auto x1 = this->Surface.GetPoint(t, 1);
+      auto x2 = this->Surface.GetPoint(t, 2);
+      double e1[3], e2[3], s[3], p[3], q[3];
+      for (auto j = 0; j < 3; ++j)
+      {
+        e1[j] = x1[j] - x0[j];
+        e2[j] = x2[j] - x0[j];
+        s[j] = origin[j] - x0[j];
+      }
+      vtkMath::Cross(direction, e2, p);
+      auto det = vtkMath::Dot(e1, p);
+      if (det == 0.0)
+      {
+        continue;
+      }
+      auto u = vtkMath::Dot(s, p) / det;
+      if (u < 0.0 || u > 1.0)
+      {
+        continue;
+      }
+      vtkMath::Cross(s, e1, q);
+      auto v = vtkMath::Dot(direction, q) / det;
+      if (v < 0.0 || u + v > 1.0)
+      {
+        continue;
+      }
+      if (vtkMath::Dot(e2, q) / det > 0.0)
+      {
+        ++crossings;
+      }
+    }
+  }
+  return crossings;
+}
+
+/**
+ * The part of a triangle on a plane, as its extent along a line of the
+ * plane.
+ *
+ * @param mesh, triangle The triangle.
+ * @param distances The signed distances of its corners to the plane.
+ * @param direction The direction of the line.
+ * @param low, high The ends of the part along the line.
+ * @param lowPoint, highPoint The ends of the part.
+ */
+void CutByPlane(Mesh const& mesh, vtkIdType triangle, const double distances[3],
+                const double direction[3], double& low, double& high,
+                double lowPoint[3], double highPoint[3])
+{
+  low = VTK_DOUBLE_MAX;
+  high = VTK_DOUBLE_MIN;
+  auto add = [&](const double x[3]) {
+    auto s = vtkMath::Dot(direction, x);
+    if (s < low)
+    {
+      low = s;
+      std::copy(x, x + 3, lowPoint);
+    }
+    if (s > high)
+    {
+      high = s;
+      std::copy(x, x + 3, highPoint);
+    }
+  };
+  for (auto i = 0; i < 3; ++i)
+  {
+    auto j = (i + 1) % 3;
+    if (distances[i] == 0.0)
+    {
+      add(mesh.GetPoint(triangle, i));
+    }
+    if ((distances[i] < 0.0 && distances[j] > 0.0) ||
+        (distances[i] > 0.0 && distances[j] < 0.0))
+    {
+      // Start from the end with the smaller id.
+      auto u = i;
+      auto v = j;
+      if (mesh.Triangles[3 * triangle + v] < mesh.Triangles[3 * triangle + u])
+      {
+        std::swap(u, v);
+      }
+      auto t = distances[u] / (distances[u] - distances[v]);
+      auto xu = mesh.GetPoint(triangle, u);
+      auto xv = mesh.GetPoint(triangle, v);
+      double x[3];
+      for (auto k = 0; k < 3; ++k)
+      {
+        x[k] = xu[k] + t * (xv[k] - xu[k]);
+      }
+      add(x);
+    }
+  }
+}
+
+/**
+ * The signed distances of the corners of a triangle to the plane of
+ * another one, snapped to zero when tiny.
+ *
+ * @return false if all the corners lie on the same side of the plane.
+ */
+bool PlaneDistances(Mesh const& mesh, vtkIdType triangle, Mesh const& other,
+                    vtkIdType plane, double normal[3], double distances[3])
+{
+  auto x0 = other.GetPoint(plane, 0);
+  auto x1 = other.GetPoint(plane, 1);
+  auto x2 = other.GetPoint(plane, 2);
+  double e1[3], e2[3];
+  for (auto j = 0; j < 3; ++j)
+  {
+    e1[j] = x1[j] - x0[j];
+    e2[j] = x2[j] - x0[j];
+  }
+  vtkMath::Cross(e1, e2, normal);
+  auto offset = vtkMath::Dot(normal, x0);
+  auto tolerance = 1e-12 * vtkMath::Norm(normal) *
+      std::max(vtkMath::Norm(e1), vtkMath::Norm(e2));
+  auto positive = 0;
+  auto negative = 0;
+  for (auto i = 0; i < 3; ++i)
+  {
+    distances[i] = vtkMath::Dot(normal, mesh.GetPoint(triangle, i)) - offset;
+    if (std::abs(distances[i]) <= tolerance)
+    {
+      distances[i] = 0.0;
+    }
+    positive += distances[i] > 0.0;
+    negative += distances[i] < 0.0;
+  }
+  return positive < 3 && negative < 3 && (positive > 0 || negative > 0);
+}
+
+bool IntersectTriangles(Mesh const& meshA, vtkIdType a, Mesh const& meshB,
+                        vtkIdType b, double p[3], double q[3])
+{
+  double normalA[3], normalB[3], distancesA[3], distancesB[3];
+  if (!PlaneDistances(meshA, a, meshB, b, normalB, distancesA) ||
+      !PlaneDistances(meshB, b, meshA, a, normalA, distancesB))
+  {
+    return false;
+  }
+  double direction[3];
+  vtkMath::Cross(normalA, normalB, direction);
+
+  // Both triangles cut the common line of their planes; the segment is the
+  // overlap of the two cuts.
+  double lowA, highA, lowB, highB;
+  double lowPointA[3], highPointA[3], lowPointB[3], highPointB[3];
+  CutByPlane(meshA, a, distancesA, direction, lowA, highA, lowPointA,
+             highPointA);
+  CutByPlane(meshB, b, distancesB, direction, lowB, highB, lowPointB,
+             highPointB);
+  auto low = std::max(lowA, lowB);
+  auto high = std::min(highA, highB);
+  if (high - low <= 1e-12 * ((highA - lowA) + (highB - lowB)))
+  {
+    return false;
+  }
+  std::copy(lowA >= lowB ? lowPointA : lowPointB,
+            (lowA >= lowB ? lowPointA : lowPointB) + 3, p);
+  std::copy(highA <= highB ? highPointA : highPointB,
+            (highA <= highB ? highPointA : highPointB) + 3, q);
+  return true;
+}
+
+std::vector<std::array<vtkIdType, 3>>
+SplitTriangles(Mesh const& mesh, int side, std::vector<Cut> const& cuts,
+               std::vector<double> const& points)
+{
+  // The range of cuts of each cut triangle.
+  std::vector<size_t> groups;
+  std::vector<char> isCut(mesh.GetNumberOfTriangles(), 0);
+  for (size_t i = 0; i < cuts.size(); ++i)
+  {
+    if (i == 0 || cuts[i].Triangle[side] != cuts[i - 1].Triangle[side])
+    {
+      groups.push_back(i);
+      isCut[cuts[i].Triangle[side]] = 1;
+    }
+  }
+  groups.push_back(cuts.size());
+  auto numberOfGroups = static_cast<vtkIdType>(groups.size() - 1);
+
+  std::vector<std::vector<std::array<vtkIdType, 3>>> pieces(numberOfGroups);
+  vtkSMPThreadLocalObject<vtkDelaunay2D> delaunays;
+  vtkSMPTools::For(0, numberOfGroups, [&](vtkIdType begin, vtkIdType end) {
+    auto delaunay = delaunays.Local();
+    delaunay->SetTolerance(1e-10);
+    for (auto group = begin; group < end; ++group)
+    {
+      auto triangle = cuts[groups[group]].Triangle[side];
+
+      // The corners and the ends of the cuts, in the plane of the triangle.
+      std::vector<vtkIdType> ids;
+      for (auto corner = 0; corner < 3; ++corner)
+      {
+        ids.push_back(mesh.Offset + mesh.Triangles[3 * triangle + corner]);
+      }
+      vtkNew<vtkCellArray> lines;
+      for (auto i = groups[group]; i < groups[group + 1]; ++i)
+      {
+        vtkIdType line[2];
+        for (auto e = 0; e < 2; ++e)
+        {
+          auto found = std::find(ids.begin(), ids.end(), cuts[i].Ids[e]);
+          line[e] = static_cast<vtkIdType>(found - ids.begin());
+          if (found == ids.end())
+          {
+            ids.push_back(cuts[i].Ids[e]);
+          }
+        }
+        if (line[0] != line[1])
+        {
+          lines->InsertNextCell(2, line);
+        }
+      }
+
+      auto x0 = points.data() + 3 * ids[0];
+      auto x1 = points.data() + 3 * ids[1];
+      auto x2 = points.data() + 3 * ids[2];
+      double u[3], v[3], normal[3];
+      for (auto j = 0; j < 3; ++j)
+      {
+        u[j] = x1[j] - x0[j];
+        v[j] = x2[j] - x0[j];
+      }
+      vtkMath::Cross(u, v, normal);
+      vtkMath::Normalize(u);
+      vtkMath::Normalize(normal);
+      vtkMath::Cross(normal, u, v);
+      vtkNew<vtkPoints> planar;
+      planar->SetDataTypeToDouble();
+      planar->SetNumberOfPoints(static_cast<vtkIdType>(ids.size()));
+      for (size_t i = 0; i < ids.size(); ++i)
+      {
+        double d[3];
+        for (auto j = 0; j < 3; ++j)
+        {
+          d[j] = points[3 * ids[i] + j] - x0[j];
+        }
+        planar->SetPoint(static_cast<vtkIdType>(i), vtkMath::Dot(d, u),
+                         vtkMath::Dot(d, v), 0.0);
+      }
+      vtkNew<vtkPolyData> input;
+      input->SetPoints(planar);
+      vtkNew<vtkPolyData> constraints;
+      constraints->SetPoints(planar);
+      constraints->SetLines(lines);
+      delaunay->SetInputData(input);
+      delaunay->SetSourceData(constraints);
+      delaunay->Update();
+
+      // Keep the orientation of the triangle.
+      auto iter = vtk::TakeSmartPointer(
+          delaunay->GetOutput()->GetPolys()->NewIterator());
+      for (iter->GoToFirstCell(); !iter->IsDoneWithTraversal();
+           iter->GoToNextCell())
+      {
+        vtkIdType npts;
+        const vtkIdType* pts;
+        iter->GetCurrentCell(npts, pts);
+        double a[3], b[3], c[3];
+        planar->GetPoint(pts[0], a);
+        planar->GetPoint(pts[1], b);
+        planar->GetPoint(pts[2], c);
+        auto area =
+            (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+        if (area > 0.0)
+        {
+          pieces[group].push_back({ids[pts[0]], ids[pts[1]], ids[pts[2]]});
+        }
+        else if (area < 0.0)
+        {
+          pieces[group].push_back({ids[pts[0]], ids[pts[2]], ids[pts[1]]});
+        }
+      }
+    }
+  });
+
+  std::vector<std::array<vtkIdType, 3>> triangles;
+  for (vtkIdType t = 0; t < mesh.GetNumberOfTriangles(); ++t)
+  {
+    if (!isCut[t])
+    {
+      triangles.push_back({mesh.Offset + mesh.Triangles[3 * t],
+                           mesh.Offset + mesh.Triangles[3 * t + 1],
+                           mesh.Offset + mesh.Triangles[3 * t + 2]});
+    }
+  }
+  for (auto const& group : pieces)
+  {
+    triangles.insert(triangles.end(), group.begin(), group.end());
+  }
+  return triangles;
+}
+
+std::vector<char>
+Classify(std::vector<std::array<vtkIdType, 3>> const& triangles,
+         std::vector<double> const& points,
+         BoundingVolumeHierarchy const& other)
+{
+  // A direction unlikely to graze edges of meshes made on axis aligned or
+  // spherical grids.
+  double direction[3]{0.5377, 0.6188, 0.5726};
+  vtkMath::Normalize(direction);
+  std::vector<char> inside(triangles.size());
+  vtkSMPTools::For(0, static_cast<vtkIdType>(triangles.size()),
+                   [&](vtkIdType begin, vtkIdType end) {
+                     for (auto i = begin; i < end; ++i)
+                     {
+                       double centroid[3]{0.0, 0.0, 0.0};
+                       for (auto id : triangles[i])
+                       {
+                         for (auto j = 0; j < 3; ++j)
+                         {
+                           centroid[j] += points[3 * id + j] / 3.0;
+                         }
+                       }
+                       inside[i] = static_cast<char>(
+                           other.CountCrossings(centroid, direction) % 2);
+                     }
+                   });
+  return inside;
+}
+
+vtkSmartPointer<vtkPolyData> ReadPolyData(const char* fileName)
+{
+  vtkSmartPointer<vtkPolyData> polyData;
+  std::string extension =
+      vtksys::SystemTools::GetFilenameExtension(std::string(fileName));
+  if (extension == ".ply")
+  {
+    vtkNew<vtkPLYReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".vtp")
+  {
+    vtkNew<vtkXMLPolyDataReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".obj")
+  {
+    vtkNew<vtkOBJReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".stl")
+  {
+    vtkNew<vtkSTLReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".vtk")
+  {
+    vtkNew<vtkPolyDataReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".g")
+  {
+    vtkNew<vtkBYUReader> reader;
+    reader->SetGeometryFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else
+  {
+    vtkNew<vtkSphereSource> source;
+    source->Update();
+    polyData = source->GetOutput();
+  }
+  return polyData;
+}
+} // namespace
@@ -0,0 +1,703 @@
+//
+// This example compiles an arithmetic expression once into a short program
+// that works on blocks of tuples, and evaluates it in parallel over the
+// arrays. The result is compared with vtkArrayCalculator.
+//
+#include <vtkArrayCalculator.h>
+#include <vtkArrayDispatch.h>
+#include <vtkDataArrayRange.h>
+#include <vtkDoubleArray.h>
+#include <vtkFloatArray.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkNew.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+#include <vtkTable.h>
+#include <vtkTimerLog.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+// An expression compiled into instructions that each process a whole block of
+// tuples. The syntax is a subset of that of vtkFunctionParser: numbers,
+// variables, + - * / ^, parentheses and the functions abs, exp, ln, log10,
+// sqrt, sin, cos, tan, min and max.
+class CompiledExpression
+{
+public:
+  /**
+   * Compile an expression.
+   *
+   * @param expression The expression.
+   * @param variables The names of the variables, in the order of the arrays
+   * that will be passed to Evaluate().
+   * @return false if the expression has an error, see GetError().
+   */
+  bool Compile(std::string const& expression,
+               std::vector<std::string> const& variables);
+
+  std::string const& GetError() const
+  {
+    return this->Error;
+  }
+
+  // The number of instructions run for each block.
+  size_t GetNumberOfInstructions() const
+  {
+    return this->Instructions.size();
+  }
+
+  /**
+   * Evaluate the expression for every tuple of the arrays, in parallel.
+   *
+   * @param arrays One array for each variable. Their first component is used.
+   * @param result The result, resized to the number of tuples of the arrays.
+   */
+  void Evaluate(std::vector<vtkDataArray*> const& arrays,
+                vtkDoubleArray* result) const;
+
+private:
+  enum class OpCode
+  {
+    Load,
+    Add,
+    Subtract,
+    Multiply,
+    Divide,
+    Power,
+    Negate,
+    Abs,
+    Exp,
+    Ln,
+    Log10,
+    Sqrt,
+    Sin,
+    Cos,
+    Tan,
+    Min,
+    Max
+  };
+
+  // Result = A op B, where A and B are registers, or A is a variable for Load.
+  struct Instruction
+  {
+    OpCode Code;
+    int Result;
+    int A;
+    int B;
+  };
+
+  // An operand while parsing: a register, or a constant not yet in one.
+  struct Operand
+  {
+    int Register;
+    double Constant;
+
+    bool IsConstant() const
+    {
+      return this->Register < 0;
+    }
+  };
+
+  static double Apply(OpCode code, double a, double b);
+  static void ApplyToBlock(OpCode code, double* result, double const* a,
+                           double const* b, vtkIdType n);
+
+  // Recursive descent parser.
+  Operand ParseSum();
+  Operand ParseProduct();
+  Operand ParseUnary();
+  Operand ParsePower();
+  Operand ParsePrimary();
+  Operand Emit(OpCode code, Operand a, Operand b);
+  int ToRegister(Operand operand);
+  void SkipSpaces();
+  bool Fail(std::string const& message);
+
+  static constexpr vtkIdType BlockSize = 512;
+
+  std::string Text;
+  size_t Position = 0;
+  std::string Error;
+  std::vector<std::string> Variables;
+  std::map<int, int> LoadedVariables;
+  std::vector<Instruction> Instructions;
+  std::vector<std::pair<int, double>> Constants;
+  int NumberOfRegisters = 0;
+  Operand Result{-1, 0.0};
+};
+
+// Copies one component of a range of tuples into a block of doubles.
+struct LoadWorker
+{
+  template <typename ArrayT>
+  void operator()(ArrayT* array, vtkIdType begin, vtkIdType end, double* block)
+  {
+    auto const tuples = vtk::DataArrayTupleRange(array, begin, end);
+    for (auto const tuple : tuples)
+    {
+      *block++ = static_cast<double>(tuple[0]);
+    }
+  }
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  vtkIdType numberOfTuples = 1000000;
+  std::string expression = "sqrt(a*a + b*b) * exp(-c) + sin(a) / (1 + c*c)";
+  if (argc > 1)
+  {
+    numberOfTuples = std::atoll(argv[1]);
+  }
+  if (argc > 2)
+  {
+    expression = argv[2];
+  }
+  if (numberOfTuples < 1)
+  {
+    std::cout << "Usage: " << argv[0] << " [numberOfTuples] [expression]"
+              << std::endl;
+    std::cout << "  The variables a and b are float arrays and c is a double "
+                 "array."
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The input arrays, in a table for vtkArrayCalculator.
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  random->SetSeed(8775070);
+  vtkNew<vtkFloatArray> a;
+  a->SetName("a");
+  a->SetNumberOfTuples(numberOfTuples);
+  vtkNew<vtkFloatArray> b;
+  b->SetName("b");
+  b->SetNumberOfTuples(numberOfTuples);
+  vtkNew<vtkDoubleArray> c;
+  c->SetName("c");
+  c->SetNumberOfTuples(numberOfTuples);
+  for (vtkIdType i = 0; i < numberOfTuples; ++i)
+  {
+    a->SetValue(i, static_cast<float>(random->GetRangeValue(-1.0, 1.0)));
+    random->Next();
+    b->SetValue(i, static_cast<float>(random->GetRangeValue(-1.0, 1.0)));
+    random->Next();
+    c->SetValue(i, random->GetRangeValue(0.0, 2.0));
+    random->Next();
+  }
+  vtkNew<vtkTable> table;
+  table->AddColumn(a);
+  table->AddColumn(b);
+  table->AddColumn(c);
+
+  std::cout << "Expression: " << expression << std::endl;
+  std::cout << "Tuples:     " << numberOfTuples << std::endl;
+
+  vtkNew<vtkTimerLog> timer;
+
+  // The compiled expression.
+  CompiledExpression compiled;
+  if (!compiled.Compile(expression, {"a", "b", "c"}))
+  {
+    std::cout << "Cannot compile the expression: " << compiled.GetError()
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+  vtkNew<vtkDoubleArray> compiledResult;
+  timer->StartTimer();
+  compiled.Evaluate({a, b, c}, compiledResult);
+  timer->StopTimer();
+  auto compiledTime = timer->GetElapsedTime();
+
+  // The same expression with vtkArrayCalculator.
+  vtkNew<vtkArrayCalculator> calculator;
+  calculator->SetInputData(table);
+  calculator->SetAttributeTypeToRowData();
+  calculator->AddScalarArrayName("a");
+  calculator->AddScalarArrayName("b");
+  calculator->AddScalarArrayName("c");
+  calculator->SetFunction(expression.c_str());
+  calculator->SetResultArrayName("result");
+  timer->StartTimer();
+  calculator->Update();
+  timer->StopTimer();
+  auto calculatorTime = timer->GetElapsedTime();
+  auto calculatorResult = vtkTable::SafeDownCast(calculator->GetOutput())
+                              ->GetRowData()
+                              ->GetArray("result");
+
+  std::cout << "Instructions per block: " << compiled.GetNumberOfInstructions()
+            << std::endl;
+  std::cout << "vtkArrayCalculator: " << calculatorTime << " s" << std::endl;
+  std::cout << "Compiled:           " << compiledTime << " s" << std::endl;
+  if (calculatorResult == nullptr ||
+      calculatorResult->GetNumberOfTuples() != numberOfTuples)
+  {
+    std::cout << "vtkArrayCalculator did not produce a result." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  auto maxDifference = 0.0;
+  auto const expected = vtk::DataArrayValueRange<1>(calculatorResult);
+  auto const actual = vtk::DataArrayValueRange<1>(compiledResult.Get());
+  for (vtkIdType i = 0; i < numberOfTuples; ++i)
+  {
+    if (std::isnan(expected[i]) != std::isnan(actual[i]))
+    {
+      maxDifference = HUGE_VAL;
+    }
+    else if (!std::isnan(expected[i]))
+    {
+      maxDifference =
+          std::max(maxDifference, std::abs(expected[i] - actual[i]));
+    }
+  }
+  std::cout << "Largest difference: " << maxDifference << std::endl;
+
+  return maxDifference < 1e-9 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+namespace {
+
+bool CompiledExpression::Compile(std::string const& expression,
+                                 std::vector<std::string> const& variables)
+{
+  this->Text = expression;
+  this->Position = 0;
+  this->Error.clear();
+  this->Variables = variables;
+  this->LoadedVariables.clear();
+  this->Instructions.clear();
+  this->Constants.clear();
+  this->NumberOfRegisters = 0;
+
+  auto result = this->ParseSum();
+  this->SkipSpaces();
+  if (this->Error.empty() && this->Position != this->Text.size())
+  {
+    this->Fail("unexpected '" + this->Text.substr(this->Position, 1) + "'");
+  }
+  if (!this->Error.empty())
+  {
+    return false;
+  }
+  this->Result = {this->ToRegister(result), 0.0};
+  return true;
+}
+
+void CompiledExpression::Evaluate(std::vector<vtkDataArray*> const& arrays,
+                                  vtkDoubleArray* result) const
+{
+  vtkIdType numberOfTuples =
+      arrays.empty() ? 0 : arrays[0]->GetNumberOfTuples();
+  for (auto array : arrays)
+  {
+    numberOfTuples = std::min(numberOfTuples, array->GetNumberOfTuples());
+  }
+  result->SetNumberOfComponents(1);
+  result->SetNumberOfTuples(numberOfTuples);
+  auto output = result->GetPointer(0);
+
+  // Each thread has its own registers, one block of values each. The
+  // constants are filled in once, when the registers are made.
+  vtkSMPThreadLocal<std::vector<double>> localRegisters;
+  auto numberOfBlocks = (numberOfTuples + BlockSize - 1) / BlockSize;
+  vtkSMPTools::For(0, numberOfBlocks, [&](vtkIdType first, vtkIdType last) {
+    auto& registers = localRegisters.Local();
+    if (registers.empty())
+    {
+      registers.resize(static_cast<size_t>(this->NumberOfRegisters) *
+                       BlockSize);
+      for (auto const& constant : this->Constants)
+      {
+        std::fill_n(registers.begin() + constant.first * BlockSize, BlockSize,
+                    constant.second);
+      }
+    }
+    auto reg = [&registers](int index) {
+      return registers.data() + static_cast<size_t>(index) * BlockSize;
+    };
+    for (auto block = first; block < last; ++block)
+    {
+      auto begin = block * BlockSize;
+      auto end = std::min(begin + BlockSize, numberOfTuples);
+      for (auto const& instruction : this->Instructions)
+      {
+        if (instruction.Code == OpCode::Load)
+        {
+          // Type specialised access for the common array types, the
+          // vtkDataArray API for the others.
+          LoadWorker worker;
+          auto array = arrays[instruction.A];
+          if (!vtkArrayDispatch::Dispatch::Execute(array, worker, begin, end,
+                                                   reg(instruction.Result)))
+          {
+            worker(array, begin, end, reg(instruction.Result));
+          }
+        }
+        else
+        {
+          ApplyToBlock(instruction.Code, reg(instruction.Result),
+                       reg(instruction.A),
+                       instruction.B < 0 ? nullptr : reg(instruction.B),
+                       end - begin);
+        }
+      }
+      std::copy_n(reg(this->Result.Register), end - begin, output + begin);
+    }
+  });
+}
+
+double CompiledExpression::Apply(OpCode code, double a, double b)
+{
+  switch (code)
+  {
+  case OpCode::Add:
+    return a + b;
+  case OpCode::Subtract:
+    return a - b;
+  case OpCode::Multiply:
+    return a * b;
+  case OpCode::Divide:
+    return a / b;
+  case OpCode::Power:
+    return std::pow(a, b);
+  case OpCode::Negate:
+    return -a;
+  case OpCode::Abs:
+    return std::abs(a);
+  case OpCode::Exp:
+    return std::exp(a);
+  case OpCode::Ln:
+    return std::log(a);
+  case OpCode::Log10:
+    return std::log10(a);
+  case OpCode::Sqrt:
+    return std::sqrt(a);
+  case OpCode::Sin:
+    return std::sin(a);
+  case OpCode::Cos:
+    return std::cos(a);
+  case OpCode::Tan:
+    return std::tan(a);
+  case OpCode::Min:
+    return std::min(a, b);
+  case OpCode::Max:
+    return std::max(a, b);
+  default:
+    return 0.0;
+  }
+}
+
+// One loop per operation, so that each loop is simple enough for the
+// compiler to vectorise.
+template <typename F>
+void Unary(double* result, double const* a, vtkIdType n, F f)
+{
+  for (vtkIdType i = 0; i < n; ++i)
+  {
+    result[i] = f(a[i]);
+  }
+}
+
+template <typename F>
+void Binary(double* result, double const* a, double const* b, vtkIdType n,
+            F f)
+{
+  for (vtkIdType i = 0; i < n; ++i)
+  {
+    result[i] = f(a[i], b[i]);
+  }
+}
+
+void CompiledExpression::ApplyToBlock(OpCode code, double* result,
+                                      double const* a, double const* b,
+                                      vtkIdType n)
+{
+  switch (code)
+  {
+  case OpCode::Add:
+    Binary(result, a, b, n, [](double x, double y) { return x + y; });
+    break;
+  case OpCode::Subtract:
+    Binary(result, a, b, n, [](double x, double y) { return x - y; });
+    break;
+  case OpCode::Multiply:
+    Binary(result, a, b, n, [](double x, double y) { return x * y; });
+    break;
+  case OpCode::Divide:
+    Binary(result, a, b, n, [](double x, double y) { return x / y; });
+    break;
+  case OpCode::Power:
+    Binary(result, a, b, n,
+           [](double x, double y) { return std::pow(x, y); });
+    break;
+  case OpCode::Min:
+    Binary(result, a, b, n,
+           [](double x, double y) { return std::min(x, y); });
+    break;
+  case OpCode::Max:
+    Binary(result, a, b, n,
+           [](double x, double y) { return std::max(x, y); });
+    break;
+  case OpCode::Negate:
+    Unary(result, a, n, [](double x) { return -x; });
+    break;
+  case OpCode::Abs:
+    Unary(result, a, n, [](double x) { return std::abs(x); });
+    break;
+  case OpCode::Exp:
+    Unary(result, a, n, [](double x) { return std::exp(x); });
+    break;
+  case OpCode::Ln:
+    Unary(result, a, n, [](double x) { return std::log(x); });
+    break;
+  case OpCode::Log10:
+    Unary(result, a, n, [](double x) { return std::log10(x); });
+    break;
+  case OpCode::Sqrt:
+    Unary(result, a, n, [](double x) { return std::sqrt(x); });
+    break;
+  case OpCode::Sin:
+    Unary(result, a, n, [](double x) { return std::sin(x); });
+    break;
+  case OpCode::Cos:
+    Unary(result, a, n, [](double x) { return std::cos(x); });
+    break;
+  case OpCode::Tan:
+    Unary(result, a, n, [](double x) { return std::tan(x); });
+    break;
+  default:
+    break;
+  }
+}
+
+CompiledExpression::Operand CompiledExpression::ParseSum()
+{
+  auto left = this->ParseProduct();
+  for (;;)
+  {
+    this->SkipSpaces();
+    if (this->Position >= this->Text.size() ||
+        (this->Text[this->Position] != '+' &&
+         this->Text[this->Position] != '-'))
+    {
+      return left;
+    }
+    auto code = this->Text[this->Position++] == '+' ? OpCode::Add
+                                                    : OpCode::Subtract;
+    left = this->Emit(code, left, this->ParseProduct());
+  }
+}
+
+CompiledExpression::Operand CompiledExpression::ParseProduct()
+{
+  auto left = this->ParseUnary();
+  for (;;)
+  {
+    this->SkipSpaces();
+    if (this->Position >= this->Text.size() ||
+        (this->Text[this->Position] != '*' &&
+         this->Text[this->Position] != '/'))
+    {
+      return left;
+    }
+    auto code = this->Text[this->Position++] == '*' ? OpCode::Multiply
+                                                    : OpCode::Divide;
+    left = this->Emit(code, left, this->ParseUnary());
+  }
+}
+
+CompiledExpression::Operand CompiledExpression::ParseUnary()
+{
+  this->SkipSpaces();
+  if (this->Position < this->Text.size() && this->Text[this->Position] == '-')
+  {
+    ++this->Position;
+    return this->Emit(OpCode::Negate, this->ParseUnary(), {-1, 0.0});
+  }
+  if (this->Position < this->Text.size() && this->Text[this->Position] == '+')
+  {
+    ++this->Position;
+    return this->ParseUnary();
+  }
+  return this->ParsePower();
+}
+
+CompiledExpression::Operand CompiledExpression::ParsePower()
+{
+  auto base = this->ParsePrimary();
+  this->SkipSpaces();
+  if (this->Position < this->Text.size() && this->Text[this->Position] == '^')
+  {
+    ++this->Position;
+    // Right associative, and binds tighter than a unary minus on its left.
+    return this->Emit(OpCode::Power, base, this->ParseUnary());
+  }
+  return base;
+}
+
+CompiledExpression::Operand CompiledExpression::ParsePrimary()
+{
+  this->SkipSpaces();
+  if (!this->Error.empty() || this->Position >= this->Text.size())
+  {
+    this->Fail("unexpected end of the expression");
+    return {-1, 0.0};
+  }
+  auto const start = this->Position;
+  auto const ch = this->Text[start];
+  if (ch == '(')
+  {
+    ++this->Position;
+    auto value = this->ParseSum();
+    this->SkipSpaces();
+    if (this->Position >= this->Text.size() ||
+        this->Text[this->Position] != ')')
+    {
+      this->Fail("missing ')'");
+    }
+    ++this->Position;
+    return value;
+  }
+  if (std::isdigit(static_cast<unsigned char>(ch)) || ch == '.')
+  {
+    char* end = nullptr;
+    auto value = std::strtod(this->Text.c_str() + start, &end);
+    this->Position = end - this->Text.c_str();
+    return {-1, value};
+  }
+  if (!std::isalpha(static_cast<unsigned char>(ch)) && ch != '_')
+  {
+    this->Fail("unexpected '" + std::string(1, ch) + "'");
+    return {-1, 0.0};
+  }
+  auto isNameCharacter = [](char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+  };
+  while (this->Position < this->Text.size() &&
+         isNameCharacter(this->Text[this->Position]))
+  {
+    ++this->Position;
+  }
+  auto const name = this->Text.substr(start, this->Position - start);
+
+  // A variable.
+  auto variable =
+      std::find(this->Variables.begin(), this->Variables.end(), name);
+  if (variable != this->Variables.end())
+  {
+    auto index = static_cast<int>(variable - this->Variables.begin());
+    auto loaded = this->LoadedVariables.find(index);
+    if (loaded != this->LoadedVariables.end())
+    {
+      return {loaded->second, 0.0};
+    }
+    auto reg = this->NumberOfRegisters++;
+    this->Instructions.push_back({OpCode::Load, reg, index, -1});
+    this->LoadedVariables[index] = reg;
+    return {reg, 0.0};
+  }
+
+  // A function.
+  static std::map<std::string, std::pair<OpCode, int>> const functions{
+      {"abs", {OpCode::Abs, 1}},     {"exp", {OpCode::Exp, 1}},
+      {"ln", {OpCode::Ln, 1}},       {"log10", {OpCode::Log10, 1}},
+      {"sqrt", {OpCode::Sqrt, 1}},   {"sin", {OpCode::Sin, 1}},
+      {"cos", {OpCode::Cos, 1}},     {"tan", {OpCode::Tan, 1}},
+      {"min", {OpCode::Min, 2}},     {"max", {OpCode::Max, 2}}};
+  auto function = functions.find(name);
+  this->SkipSpaces();
+  if (function == functions.end() || this->Position >= this->Text.size() ||
+      this->Text[this->Position] != '(')
+  {
+    this->Fail("unknown variable or function '" + name + "'");
+    return {-1, 0.0};
+  }
+  ++this->Position;
+  Operand arguments[2]{{-1, 0.0}, {-1, 0.0}};
+  for (auto i = 0; i < function->second.second; ++i)
+  {
+    if (i > 0)
+    {
+      this->SkipSpaces();
+      if (this->Position >= this->Text.size() ||
+          this->Text[this->Position] != ',')
+      {
+        this->Fail(name + " needs two arguments");
+        return {-1, 0.0};
+      }
+      ++this->Position;
+    }
+    arguments[i] = this->ParseSum();
+  }
+  this->SkipSpaces();
+  if (this->Position >= this->Text.size() || this->Text[this->Position] != ')')
+  {
+    this->Fail("missing ')' after the arguments of " + name);
+    return {-1, 0.0};
+  }
+  ++this->Position;
+  return this->Emit(function->second.first, arguments[0], arguments[1]);
+}
+
+CompiledExpression::Operand CompiledExpression::Emit(OpCode code, Operand a,
+                                                     Operand b)
+{
+  auto const isUnary = code != OpCode::Add && code != OpCode::Subtract &&
+      code != OpCode::Multiply && code != OpCode::Divide &&
+      code != OpCode::Power && code != OpCode::Min && code != OpCode::Max;
+  if (!this->Error.empty())
+  {
+    return {-1, 0.0};
+  }
+  // Fold operations on constants.
+  if (a.IsConstant() && (isUnary || b.IsConstant()))
+  {
+    return {-1, Apply(code, a.Constant, b.Constant)};
+  }
+  auto reg = this->NumberOfRegisters++;
+  this->Instructions.push_back({code, reg, this->ToRegister(a),
+                                isUnary ? -1 : this->ToRegister(b)});
+  return {reg, 0.0};
+}
+
+int CompiledExpression::ToRegister(Operand operand)
+{
+  if (!operand.IsConstant())
+  {
+    return operand.Register;
+  }
+  auto reg = this->NumberOfRegisters++;
+  this->Constants.emplace_back(reg, operand.Constant);
+  return reg;
+}
+
+void CompiledExpression::SkipSpaces()
+{
+  while (this->Position < this->Text.size() &&
+         std::isspace(static_cast<unsigned char>(this->Text[this->Position])))
+  {
+    ++this->Position;
+  }
+}
+
+bool CompiledExpression::Fail(std::string const& message)
+{
+  if (this->Error.empty())
+  {
+    this->Error = message + " at position " + std::to_string(this->Position);
+  }
+  return false;
+}
+
+} // namespace
@@ -0,0 +1,573 @@
+#include <vtkArrayDispatch.h>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkDataArrayRange.h>
+#include <vtkFillHolesFilter.h>
+#include <vtkFloatArray.h>
+#include <vtkIdList.h>
+#include <vtkMassProperties.h>
+#include <vtkMath.h>
+#include <vtkMeshQuality.h>
+#include <vtkNew.h>
+#include <vtkPolyDataNormals.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPThreadLocalObject.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+#include <vtkTriangleFilter.h>
+
+#include <vtkBYUReader.h>
+#include <vtkOBJReader.h>
+#include <vtkPLYReader.h>
+#include <vtkPolyDataReader.h>
+#include <vtkSTLReader.h>
+#include <vtkSphereSource.h>
+#include <vtkXMLPolyDataReader.h>
+#include <vtksys/SystemTools.hxx>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+vtkSmartPointer<vtkPolyData> ReadPolyData(const char* fileName);
+
+// A sum with Kahan compensation, so that adding millions of small terms to a
+// large total loses no precision.
+struct KahanSum
+{
+  double Sum = 0.0;
+  double Compensation = 0.0;
+
+  void Add(double value)
+  {
+    auto y = value - this->Compensation;
+    auto t = this->Sum + y;
+    this->Compensation = (t - this->Sum) - y;
+    this->Sum = t;
+  }
+
+  void Add(KahanSum const& other)
+  {
+    this->Add(other.Sum);
+    this->Add(-other.Compensation);
+  }
+};
+
+// Counts of values in equal bins, with an underflow and an overflow bin.
+struct Histogram
+{
+  double Min = 0.0;
+  double Max = 1.0;
+  std::vector<vtkIdType> Counts;
+
+  Histogram() = default;
+  Histogram(double min, double max, int bins)
+    : Min(min), Max(max), Counts(bins + 2, 0)
+  {
+  }
+
+  void Add(double value)
+  {
+    auto bins = static_cast<int>(this->Counts.size()) - 2;
+    auto x = std::floor((value - this->Min) / (this->Max - this->Min) * bins);
+    // NaN goes to the underflow bin.
+    auto bin = !(x >= 0.0) ? -1 : (x >= bins ? bins : static_cast<int>(x));
+    this->Counts[bin + 1]++;
+  }
+
+  void Add(Histogram const& other)
+  {
+    for (size_t i = 0; i < this->Counts.size(); ++i)
+    {
+      this->Counts[i] += other.Counts[i];
+    }
+  }
+
+  void Print(std::string const& title) const;
+};
+
+// Everything computed in the single pass over the triangles.
+struct MeshMetrics
+{
+  KahanSum Area;
+  KahanSum Volume;
+  // First moments of the volume: integral of x, y, z.
+  std::array<KahanSum, 3> First;
+  // Second moments: integral of xx, yy, zz, xy, yz, zx.
+  std::array<KahanSum, 6> Second;
+  double MinCellArea = std::numeric_limits<double>::max();
+  double MaxCellArea = 0.0;
+  vtkIdType NumberOfTriangles = 0;
+  vtkIdType NumberOfOtherCells = 0;
+  Histogram AspectRatio{1.0, 5.0, 16};
+  Histogram MinAngle{0.0, 60.0, 12};
+
+  void Add(MeshMetrics const& other);
+};
+
+/**
+ * Compute the mass properties and the quality of the triangles of a mesh in
+ * one parallel pass over its polygons.
+ *
+ * The mesh must be closed and its triangles consistently ordered for the
+ * volume, centroid and inertia to be meaningful.
+ *
+ * @param mesh The mesh, its other cells are counted and skipped.
+ * @param aspectRatio If not null, the aspect ratio of each polygon.
+ * @param minAngle If not null, the smallest angle of each polygon in degrees.
+ * @param reference The volume integrals are computed relative to this point.
+ * @return The metrics.
+ */
+MeshMetrics ComputeMeshMetrics(vtkPolyData* mesh, vtkFloatArray* aspectRatio,
+                               vtkFloatArray* minAngle,
+                               double const reference[3]);
+
+void PrintMetrics(MeshMetrics const& metrics, double const reference[3]);
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  auto polyData = ReadPolyData(argc > 1 ? argv[1] : "");
+
+  vtkNew<vtkTimerLog> timer;
+
+  // The same preparation as in MassProperties: a closed, triangulated mesh
+  // with consistent ordering.
+  timer->StartTimer();
+  vtkNew<vtkFillHolesFilter> fillHolesFilter;
+  fillHolesFilter->SetInputData(polyData);
+  fillHolesFilter->SetHoleSize(1000.0);
+
+  vtkNew<vtkTriangleFilter> triangleFilter;
+  triangleFilter->SetInputConnection(fillHolesFilter->GetOutputPort());
+  triangleFilter->PassVertsOff();
+  triangleFilter->PassLinesOff();
+
+  vtkNew<vtkPolyDataNormals> normals;
+  normals->SetInputConnection(triangleFilter->GetOutputPort());
+  normals->ConsistencyOn();
+  normals->SplittingOff();
+  normals->ComputePointNormalsOff();
+  normals->Update();
+  timer->StopTimer();
+  auto mesh = normals->GetOutput();
+  std::cout << "Triangles: " << mesh->GetNumberOfPolys() << std::endl;
+  std::cout << "Preparation: " << timer->GetElapsedTime() << " s" << std::endl
+            << std::endl;
+
+  // One pass for everything.
+  vtkNew<vtkFloatArray> aspectRatio;
+  aspectRatio->SetName("AspectRatio");
+  vtkNew<vtkFloatArray> minAngle;
+  minAngle->SetName("MinAngle");
+  double reference[3];
+  double bounds[6];
+  mesh->GetBounds(bounds);
+  for (auto i = 0; i < 3; ++i)
+  {
+    reference[i] = 0.5 * (bounds[2 * i] + bounds[2 * i + 1]);
+  }
+  timer->StartTimer();
+  auto metrics = ComputeMeshMetrics(mesh, aspectRatio, minAngle, reference);
+  timer->StopTimer();
+  auto metricsTime = timer->GetElapsedTime();
+  mesh->GetCellData()->AddArray(aspectRatio);
+  mesh->GetCellData()->AddArray(minAngle);
+  PrintMetrics(metrics, reference);
+
+  // The same with vtkMassProperties and two runs of vtkMeshQuality.
+  timer->StartTimer();
+  vtkNew<vtkMassProperties> massProperties;
+  massProperties->SetInputData(mesh);
+  massProperties->Update();
+
+  vtkNew<vtkMeshQuality> aspectRatioQuality;
+  aspectRatioQuality->SetInputData(mesh);
+  aspectRatioQuality->SetTriangleQualityMeasureToAspectRatio();
+  aspectRatioQuality->Update();
+
+  vtkNew<vtkMeshQuality> minAngleQuality;
+  minAngleQuality->SetInputData(mesh);
+  minAngleQuality->SetTriangleQualityMeasureToMinAngle();
+  minAngleQuality->Update();
+  timer->StopTimer();
+
+  auto maxDifference = [](vtkDataArray* expected, vtkDataArray* actual) {
+    auto difference = 0.0;
+    auto const e = vtk::DataArrayValueRange<1>(expected);
+    auto const a = vtk::DataArrayValueRange<1>(actual);
+    for (vtkIdType i = 0; i < e.size(); ++i)
+    {
+      difference = std::max(difference, std::abs(e[i] - a[i]));
+    }
+    return difference;
+  };
+
+  std::cout << std::endl << "Comparison" << std::endl;
+  std::cout << "  vtkMassProperties volume: " << massProperties->GetVolume()
+            << ", area: " << massProperties->GetSurfaceArea() << std::endl;
+  std::cout << "  Largest difference in aspect ratio: "
+            << maxDifference(aspectRatioQuality->GetOutput()
+                                 ->GetCellData()
+                                 ->GetArray("Quality"),
+                             aspectRatio)
+            << ", in min angle: "
+            << maxDifference(minAngleQuality->GetOutput()
+                                 ->GetCellData()
+                                 ->GetArray("Quality"),
+                             minAngle)
+            << std::endl;
+  std::cout << "  vtkMassProperties and vtkMeshQuality: "
+            << timer->GetElapsedTime() << " s" << std::endl;
+  std::cout << "  One parallel pass:                    " << metricsTime
+            << " s" << std::endl;
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+
+void MeshMetrics::Add(MeshMetrics const& other)
+{
+  this->Area.Add(other.Area);
+  this->Volume.Add(other.Volume);
+  for (size_t i = 0; i < this->First.size(); ++i)
+  {
+    this->First[i].Add(other.First[i]);
+  }
+  for (size_t i = 0; i < this->Second.size(); ++i)
+  {
+    this->Second[i].Add(other.Second[i]);
+  }
+  this->MinCellArea = std::min(this->MinCellArea, other.MinCellArea);
+  this->MaxCellArea = std::max(this->MaxCellArea, other.MaxCellArea);
+  this->NumberOfTriangles += other.NumberOfTriangles;
+  this->NumberOfOtherCells += other.NumberOfOtherCells;
+  this->AspectRatio.Add(other.AspectRatio);
+  this->MinAngle.Add(other.MinAngle);
+}
+
+// The reduction over the polygons. Each thread accumulates its own
+// MeshMetrics, and they are added together at the end.
+template <typename PointsArray>
+struct MetricsFunctor
+{
+  PointsArray* Points;
+  vtkCellArray* Polys;
+  float* AspectRatio;
+  float* MinAngle;
+  double Reference[3];
+  vtkSMPThreadLocal<MeshMetrics> LocalMetrics;
+  vtkSMPThreadLocalObject<vtkIdList> LocalIds;
+  MeshMetrics Result;
+
+  // vtkSMPTools only calls Reduce() if there is an Initialize().
+  void Initialize()
+  {
+  }
+
+  void operator()(vtkIdType begin, vtkIdType end)
+  {
+    auto& metrics = this->LocalMetrics.Local();
+    auto ids = this->LocalIds.Local();
+    auto const points = vtk::DataArrayTupleRange<3>(this->Points);
+    vtkIdType npts;
+    const vtkIdType* pts;
+    for (vtkIdType cellId = begin; cellId < end; ++cellId)
+    {
+      this->Polys->GetCellAtId(cellId, npts, pts, ids);
+      if (npts != 3)
+      {
+        ++metrics.NumberOfOtherCells;
+        this->SetQuality(cellId, std::nan(""), std::nan(""));
+        continue;
+      }
+      // The corners relative to the reference point.
+      double p[3][3];
+      for (auto i = 0; i < 3; ++i)
+      {
+        auto const point = points[pts[i]];
+        for (auto j = 0; j < 3; ++j)
+        {
+          p[i][j] = static_cast<double>(point[j]) - this->Reference[j];
+        }
+      }
+      double e0[3];
+      double e1[3];
+      double e2[3];
+      vtkMath::Subtract(p[2], p[1], e0);
+      vtkMath::Subtract(p[0], p[2], e1);
+      vtkMath::Subtract(p[1], p[0], e2);
+      double n[3];
+      vtkMath::Cross(e2, e1, n);
+      auto area = 0.5 * vtkMath::Norm(n);
+      metrics.Area.Add(area);
+      metrics.MinCellArea = std::min(metrics.MinCellArea, area);
+      metrics.MaxCellArea = std::max(metrics.MaxCellArea, area);
+      ++metrics.NumberOfTriangles;
+
+      // The signed tetrahedron from the reference point to the triangle.
+      double cross[3];
+      vtkMath::Cross(p[1], p[2], cross);
+      auto volume = vtkMath::Dot(p[0], cross) / 6.0;
+      metrics.Volume.Add(volume);
+      double sum[3];
+      for (auto j = 0; j < 3; ++j)
+      {
+        sum[j] = p[0][j] + p[1][j] + p[2][j];
+        metrics.First[j].Add(volume * sum[j] / 4.0);
+      }
+      // Integral of x_i x_j over the tetrahedron with a corner at the origin:
+      // V / 20 (sum_k p_k,i p_k,j + sum_i sum_j).
+      static int const pairs[6][2]{{0, 0}, {1, 1}, {2, 2},
+                                   {0, 1}, {1, 2}, {2, 0}};
+      for (auto k = 0; k < 6; ++k)
+      {
+        auto a = pairs[k][0];
+        auto b = pairs[k][1];
+        auto value = p[0][a] * p[0][b] + p[1][a] * p[1][b] +
+            p[2][a] * p[2][b] + sum[a] * sum[b];
+        metrics.Second[k].Add(volume * value / 20.0);
+      }
+
+      // Quality: the aspect ratio as in vtkMeshQuality, and the smallest
+      // angle, which is opposite the shortest edge.
+      double l[3]{vtkMath::Norm(e0), vtkMath::Norm(e1), vtkMath::Norm(e2)};
+      std::sort(l, l + 3);
+      auto aspectRatio = area > 0.0
+          ? l[2] * (l[0] + l[1] + l[2]) / (4.0 * std::sqrt(3.0) * area)
+          : std::numeric_limits<double>::max();
+      auto cosine = (l[1] * l[1] + l[2] * l[2] - l[0] * l[0]) /
+          (2.0 * l[1] * l[2]);
+      auto minAngle =
+          vtkMath::DegreesFromRadians(std::acos(std::clamp(cosine, -1.0, 1.0)));
+      metrics.AspectRatio.Add(aspectRatio);
+      metrics.MinAngle.Add(minAngle);
+      this->SetQuality(cellId, aspectRatio, minAngle);
+    }
+  }
+
+  void SetQuality(vtkIdType cellId, double aspectRatio, double minAngle)
+  {
+    if (this->AspectRatio != nullptr)
+    {
+      this->AspectRatio[cellId] = static_cast<float>(aspectRatio);
+    }
+    if (this->MinAngle != nullptr)
+    {
+      this->MinAngle[cellId] = static_cast<float>(minAngle);
+    }
+  }
+
+  void Reduce()
+  {
+    for (auto const& metrics : this->LocalMetrics)
+    {
+      this->Result.Add(metrics);
+    }
+  }
+};
+
+struct MetricsWorker
+{
+  template <typename PointsArray>
+  void operator()(PointsArray* points, vtkCellArray* polys, float* aspectRatio,
+                  float* minAngle, double const reference[3],
+                  MeshMetrics& result)
+  {
+    MetricsFunctor<PointsArray> functor;
+    functor.Points = points;
+    functor.Polys = polys;
+    functor.AspectRatio = aspectRatio;
+    functor.MinAngle = minAngle;
+    std::copy(reference, reference + 3, functor.Reference);
+    vtkSMPTools::For(0, polys->GetNumberOfCells(), functor);
+    result = functor.Result;
+  }
+};
+
+MeshMetrics ComputeMeshMetrics(vtkPolyData* mesh, vtkFloatArray* aspectRatio,
+                               vtkFloatArray* minAngle,
+                               double const reference[3])
+{
+  auto polys = mesh->GetPolys();
+  // The polygons come after the vertices and lines in the cell ids. A
+  // triangulated surface has none of those, so the arrays are indexed by
+  // polygon.
+  float* aspectRatioValues = nullptr;
+  float* minAngleValues = nullptr;
+  if (aspectRatio != nullptr)
+  {
+    aspectRatio->SetNumberOfTuples(polys->GetNumberOfCells());
+    aspectRatioValues = aspectRatio->GetPointer(0);
+  }
+  if (minAngle != nullptr)
+  {
+    minAngle->SetNumberOfTuples(polys->GetNumberOfCells());
+    minAngleValues = minAngle->GetPointer(0);
+  }
+
+  MeshMetrics metrics;
+  MetricsWorker worker;
+  auto points = mesh->GetPoints()->GetData();
+  if (!vtkArrayDispatch::DispatchByValueType<vtkArrayDispatch::Reals>::Execute(
+          points, worker, polys, aspectRatioValues, minAngleValues, reference,
+          metrics))
+  {
+    worker(points, polys, aspectRatioValues, minAngleValues, reference,
+           metrics);
+  }
+  return metrics;
+}
+
+void PrintMetrics(MeshMetrics const& metrics, double const reference[3])
+{
+  // If the triangles face inwards every volume integral has the wrong sign.
+  auto sign = metrics.Volume.Sum < 0.0 ? -1.0 : 1.0;
+  auto volume = sign * metrics.Volume.Sum;
+  auto area = metrics.Area.Sum;
+  std::cout << "Volume: " << volume << std::endl;
+  std::cout << "Area:   " << area << std::endl;
+  std::cout << "    MinCellArea: " << metrics.MinCellArea << std::endl;
+  std::cout << "    MaxCellArea: " << metrics.MaxCellArea << std::endl;
+  if (volume > 0.0)
+  {
+    std::cout << "NormalizedShapeIndex: "
+              << std::sqrt(area) / std::cbrt(volume) / 2.199085233
+              << std::endl;
+  }
+  if (metrics.NumberOfOtherCells > 0)
+  {
+    std::cout << "Skipped " << metrics.NumberOfOtherCells
+              << " cells that are not triangles." << std::endl;
+  }
+  if (volume == 0.0)
+  {
+    return;
+  }
+
+  // The centroid, and the second moments about it.
+  double centroid[3];
+  double c[3];
+  for (auto i = 0; i < 3; ++i)
+  {
+    c[i] = sign * metrics.First[i].Sum / volume;
+    centroid[i] = c[i] + reference[i];
+  }
+  auto xx = sign * metrics.Second[0].Sum - volume * c[0] * c[0];
+  auto yy = sign * metrics.Second[1].Sum - volume * c[1] * c[1];
+  auto zz = sign * metrics.Second[2].Sum - volume * c[2] * c[2];
+  auto xy = sign * metrics.Second[3].Sum - volume * c[0] * c[1];
+  auto yz = sign * metrics.Second[4].Sum - volume * c[1] * c[2];
+  auto zx = sign * metrics.Second[5].Sum - volume * c[2] * c[0];
+
+  // The inertia tensor of the solid with unit density.
+  double inertia[3][3]{{yy + zz, -xy, -zx}, {-xy, zz + xx, -yz},
+                       {-zx, -yz, xx + yy}};
+  std::cout << "Centroid: " << centroid[0] << ", " << centroid[1] << ", "
+            << centroid[2] << std::endl;
+  std::cout << "Inertia tensor about the centroid:" << std::endl;
+  for (auto const& row : inertia)
+  {
+    std::cout << "    " << std::setw(14) << row[0] << std::setw(14) << row[1]
+              << std::setw(14) << row[2] << std::endl;
+  }
+  double a0[3]{inertia[0][0], inertia[0][1], inertia[0][2]};
+  double a1[3]{inertia[1][0], inertia[1][1], inertia[1][2]};
+  double a2[3]{inertia[2][0], inertia[2][1], inertia[2][2]};
+  double* a[3]{a0, a1, a2};
+  double principal[3];
+  double v0[3];
+  double v1[3];
+  double v2[3];
+  double* v[3]{v0, v1, v2};
+  vtkMath::Jacobi(a, principal, v);
+  std::cout << "Principal moments: " << principal[0] << ", " << principal[1]
+            << ", " << principal[2] << std::endl;
+
+  metrics.AspectRatio.Print("Aspect ratio");
+  metrics.MinAngle.Print("Min angle");
+}
+
+void Histogram::Print(std::string const& title) const
+{
+  std::cout << title << std::endl;
+  auto bins = static_cast<int>(this->Counts.size()) - 2;
+  auto width = (this->Max - this->Min) / bins;
+  std::cout << "    " << std::setw(16) << "< " + std::to_string(this->Min)
+            << std::setw(10) << this->Counts[0] << std::endl;
+  for (auto i = 0; i < bins; ++i)
+  {
+    std::cout << "    " << std::setw(7) << this->Min + i * width << " - "
+              << std::setw(6) << this->Min + (i + 1) * width << std::setw(10)
+              << this->Counts[i + 1] << std::endl;
+  }
+  std::cout << "    " << std::setw(16) << ">= " + std::to_string(this->Max)
+            << std::setw(10) << this->Counts[bins + 1] << std::endl;
+}
+
+vtkSmartPointer<vtkPolyData> ReadPolyData(const char* fileName)
+{
+  vtkSmartPointer<vtkPolyData> polyData;
+  std::string extension =
+      vtksys::SystemTools::GetFilenameExtension(std::string(fileName));
+  if (extension == ".ply")
+  {
+    vtkNew<vtkPLYReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".vtp")
+  {
+    vtkNew<vtkXMLPolyDataReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".obj")
+  {
+    vtkNew<vtkOBJReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".stl")
+  {
+    vtkNew<vtkSTLReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".vtk")
+  {
+    vtkNew<vtkPolyDataReader> reader;
+    reader->SetFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else if (extension == ".g")
+  {
+    vtkNew<vtkBYUReader> reader;
+    reader->SetGeometryFileName(fileName);
+    reader->Update();
+    polyData = reader->GetOutput();
+  }
+  else
+  {
+    vtkNew<vtkSphereSource> source;
+    source->SetPhiResolution(501);
+    source->SetThetaResolution(501);
+    source->Update();
+    polyData = source->GetOutput();
+  }
+  return polyData;
+}
+} // namespace
@@ -0,0 +1,675 @@
+//
+// This example keeps a journal of the changes to a scene. Each snapshot
+// records only the cameras, actors, properties and points whose modified
+// time has changed since the previous one, with a full checkpoint every few
+// snapshots, and any snapshot can be restored for undo and redo.
+//
+#include <vtkActor.h>
+#include <vtkActorCollection.h>
+#include <vtkCallbackCommand.h>
+#include <vtkCamera.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkPlaneSource.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProperty.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSmartPointer.h>
+#include <vtkSphereSource.h>
+#include <vtkTimerLog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+// A binary journal of the state of the camera, actors, properties and
+// polydata points of a renderer.
+//
+// Each snapshot is a record made of entries, one for each object that has
+// changed. Every CheckpointInterval snapshots the record is a checkpoint
+// holding every object, so that restoring a snapshot only replays the
+// records since the checkpoint before it.
+class SceneJournal
+{
+public:
+  // The objects tracked are those in the renderer when the journal is made.
+  SceneJournal(vtkRenderer* renderer, std::string const& fileName,
+               int checkpointInterval);
+
+  /**
+   * Record the objects that have changed since the last snapshot.
+   *
+   * If the current snapshot is not the last one, because of Restore(), the
+   * later snapshots are discarded first.
+   *
+   * @return The number of bytes written, zero if nothing has changed.
+   */
+  size_t Snapshot();
+
+  /**
+   * Bring the scene back to the state it had at a snapshot.
+   *
+   * @param snapshot The number of the snapshot, starting from 0.
+   * @return false if there is no such snapshot.
+   */
+  bool Restore(int snapshot);
+
+  // false if the journal file could not be opened.
+  bool IsOpen() const
+  {
+    return this->File.is_open();
+  }
+
+  int GetNumberOfSnapshots() const
+  {
+    return static_cast<int>(this->Records.size());
+  }
+
+  int GetCurrentSnapshot() const
+  {
+    return this->Current;
+  }
+
+  std::uintmax_t GetFileSize() const
+  {
+    return this->End;
+  }
+
+private:
+  enum class Kind : uint8_t
+  {
+    Camera,
+    Actor,
+    Property,
+    Points
+  };
+
+  struct Record
+  {
+    std::streamoff Offset;
+    bool IsCheckpoint;
+  };
+
+  // An object of the scene, the modified time it had when last recorded and,
+  // except for points, the state that was recorded. Rendering resets the
+  // clipping range of the camera, which modifies it, so the state is compared
+  // too. The clipping range itself is not recorded.
+  struct Tracked
+  {
+    Kind What;
+    vtkObject* Object;
+    vtkMTimeType Recorded;
+    std::vector<char> Last;
+  };
+
+  vtkMTimeType GetMTime(Tracked const& tracked) const;
+  void Serialize(Tracked const& tracked, std::vector<char>& bytes) const;
+  void Apply(Tracked const& tracked, char const* bytes, size_t size) const;
+  void ReadRecord(size_t record);
+
+  std::string FileName;
+  std::fstream File;
+  int CheckpointInterval;
+  std::vector<Tracked> Objects;
+  std::vector<Record> Records;
+  int Current = -1;
+  std::streamoff End = 0;
+};
+
+// Undo, redo and autosave.
+struct JournalState
+{
+  SceneJournal* Journal;
+  vtkRenderWindow* RenderWindow;
+};
+
+void KeyPressCallback(vtkObject* caller, long unsigned int eventId,
+                      void* clientData, void* callData);
+
+void AutosaveCallback(vtkObject* caller, long unsigned int eventId,
+                      void* clientData, void* callData);
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cout << "Usage: " << argv[0]
+              << " journalFile [numberOfActors] [checkpointInterval]"
+              << std::endl;
+    std::cout << "e.g. SceneJournal scene.journal 1000 20" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string fileName = argv[1];
+  auto numberOfActors = argc > 2 ? std::max(1, std::atoi(argv[2])) : 1000;
+  auto checkpointInterval = argc > 3 ? std::max(1, std::atoi(argv[3])) : 20;
+
+  vtkNew<vtkNamedColors> colors;
+
+  // A grid of spheres sharing one polydata, and a surface that is deformed.
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetThetaResolution(12);
+  sphere->SetPhiResolution(12);
+  sphere->SetRadius(0.4);
+
+  vtkNew<vtkPolyDataMapper> sphereMapper;
+  sphereMapper->SetInputConnection(sphere->GetOutputPort());
+
+  vtkNew<vtkRenderer> renderer;
+  renderer->SetBackground(colors->GetColor3d("Silver").GetData());
+
+  auto side = static_cast<int>(std::ceil(std::sqrt(numberOfActors)));
+  std::vector<vtkSmartPointer<vtkActor>> actors;
+  for (auto i = 0; i < numberOfActors; ++i)
+  {
+    auto actor = vtkSmartPointer<vtkActor>::New();
+    actor->SetMapper(sphereMapper);
+    actor->SetPosition(i % side, i / side, 0.0);
+    actor->GetProperty()->SetDiffuseColor(
+        colors->GetColor3d("Crimson").GetData());
+    actor->GetProperty()->SetSpecular(0.6);
+    actor->GetProperty()->SetSpecularPower(30);
+    renderer->AddActor(actor);
+    actors.push_back(actor);
+  }
+
+  vtkNew<vtkPlaneSource> plane;
+  plane->SetOrigin(-1.0, -1.0, -1.0);
+  plane->SetPoint1(side, -1.0, -1.0);
+  plane->SetPoint2(-1.0, side, -1.0);
+  plane->SetResolution(100, 100);
+  plane->Update();
+  vtkNew<vtkPolyData> surface;
+  surface->DeepCopy(plane->GetOutput());
+
+  vtkNew<vtkPolyDataMapper> surfaceMapper;
+  surfaceMapper->SetInputData(surface);
+
+  vtkNew<vtkActor> surfaceActor;
+  surfaceActor->SetMapper(surfaceMapper);
+  surfaceActor->GetProperty()->SetDiffuseColor(
+      colors->GetColor3d("Wheat").GetData());
+  renderer->AddActor(surfaceActor);
+  renderer->ResetCamera();
+
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->AddRenderer(renderer);
+  renderWindow->SetSize(640, 480);
+  renderWindow->SetWindowName("SceneJournal");
+
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  renderWindowInteractor->SetRenderWindow(renderWindow);
+  renderWindow->Render();
+
+  SceneJournal journal(renderer, fileName, checkpointInterval);
+  if (!journal.IsOpen())
+  {
+    std::cerr << "Cannot open " << fileName << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The first snapshot is a checkpoint holding the whole scene.
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  auto checkpointBytes = journal.Snapshot();
+  timer->StopTimer();
+  auto checkpointTime = timer->GetElapsedTime();
+
+  // An editing session: each step moves and recolors a few actors and the
+  // camera, and every tenth step deforms the surface.
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  random->SetSeed(8775070);
+  auto const numberOfSteps = 100;
+  size_t deltaBytes = 0;
+  auto deltaTime = 0.0;
+  auto const checkedStep = numberOfSteps / 2;
+  double checkedPosition[3];
+  double checkedColor[3];
+  for (auto step = 1; step <= numberOfSteps; ++step)
+  {
+    for (auto j = 0; j < 3; ++j)
+    {
+      auto index = static_cast<int>(random->GetValue() * numberOfActors) %
+          numberOfActors;
+      random->Next();
+      auto actor = actors[index];
+      actor->AddPosition(0.0, 0.0, random->GetRangeValue(-0.5, 0.5));
+      random->Next();
+      actor->GetProperty()->SetDiffuseColor(random->GetValue(), 0.3, 0.3);
+      random->Next();
+    }
+    renderer->GetActiveCamera()->Azimuth(1.0);
+    if (step % 10 == 0)
+    {
+      auto points = surface->GetPoints();
+      for (vtkIdType i = 0; i < points->GetNumberOfPoints(); ++i)
+      {
+        double x[3];
+        points->GetPoint(i, x);
+        x[2] = -1.0 + 0.5 * std::sin(0.3 * x[0] + 0.1 * step) *
+                std::cos(0.3 * x[1]);
+        points->SetPoint(i, x);
+      }
+      points->Modified();
+    }
+    timer->StartTimer();
+    auto bytes = journal.Snapshot();
+    timer->StopTimer();
+    if (step % checkpointInterval != 0)
+    {
+      deltaBytes += bytes;
+      deltaTime += timer->GetElapsedTime();
+    }
+    if (step == checkedStep)
+    {
+      renderer->GetActiveCamera()->GetPosition(checkedPosition);
+      actors[0]->GetProperty()->GetDiffuseColor(checkedColor);
+    }
+  }
+  auto numberOfDeltas = numberOfSteps - numberOfSteps / checkpointInterval;
+
+  std::cout << "Actors: " << numberOfActors + 1
+            << ", snapshots: " << journal.GetNumberOfSnapshots()
+            << ", journal: " << journal.GetFileSize() << " bytes" << std::endl;
+  std::cout << "Checkpoint:          " << checkpointBytes << " bytes, "
+            << checkpointTime << " s" << std::endl;
+  if (numberOfDeltas > 0)
+  {
+    std::cout << "Changes (mean):      " << deltaBytes / numberOfDeltas
+              << " bytes, " << deltaTime / numberOfDeltas << " s" << std::endl;
+  }
+
+  // Undo back to the middle of the session, and check the scene.
+  timer->StartTimer();
+  journal.Restore(checkedStep);
+  timer->StopTimer();
+  double position[3];
+  double color[3];
+  renderer->GetActiveCamera()->GetPosition(position);
+  actors[0]->GetProperty()->GetDiffuseColor(color);
+  auto restored = true;
+  for (auto i = 0; i < 3; ++i)
+  {
+    restored &=
+        position[i] == checkedPosition[i] && color[i] == checkedColor[i];
+  }
+  std::cout << "Restore snapshot " << checkedStep << ": "
+            << timer->GetElapsedTime() << " s, "
+            << (restored ? "the scene matches" : "the scene does not match")
+            << std::endl;
+
+  std::cout << "Press z to undo and y to redo. The scene is saved every two "
+               "seconds if it has changed."
+            << std::endl;
+
+  JournalState state{&journal, renderWindow};
+  vtkNew<vtkCallbackCommand> keyPressCallback;
+  keyPressCallback->SetCallback(KeyPressCallback);
+  keyPressCallback->SetClientData(&state);
+  renderWindowInteractor->AddObserver(vtkCommand::KeyPressEvent,
+                                      keyPressCallback);
+
+  vtkNew<vtkCallbackCommand> autosaveCallback;
+  autosaveCallback->SetCallback(AutosaveCallback);
+  autosaveCallback->SetClientData(&state);
+  renderWindowInteractor->AddObserver(vtkCommand::TimerEvent,
+                                      autosaveCallback);
+  renderWindowInteractor->Initialize();
+  renderWindowInteractor->CreateRepeatingTimer(2000);
+
+  renderer->ResetCameraClippingRange();
+  renderWindow->Render();
+  renderWindowInteractor->Start();
+
+  return restored ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+namespace {
+
+SceneJournal::SceneJournal(vtkRenderer* renderer, std::string const& fileName,
+                           int checkpointInterval)
+  : FileName(fileName), CheckpointInterval(checkpointInterval)
+{
+  this->File.open(fileName, std::ios::in | std::ios::out | std::ios::binary |
+                      std::ios::trunc);
+  this->Objects.push_back({Kind::Camera, renderer->GetActiveCamera(), 0, {}});
+  std::map<vtkObject*, bool> seen;
+  auto actors = renderer->GetActors();
+  actors->InitTraversal();
+  for (auto actor = actors->GetNextActor(); actor != nullptr;
+       actor = actors->GetNextActor())
+  {
+    this->Objects.push_back({Kind::Actor, actor, 0, {}});
+    this->Objects.push_back({Kind::Property, actor->GetProperty(), 0, {}});
+    // Data shared by several actors is recorded once.
+    auto polyData = vtkPolyData::SafeDownCast(
+        actor->GetMapper() ? actor->GetMapper()->GetInputDataObject(0, 0)
+                           : nullptr);
+    if (polyData != nullptr && polyData->GetPoints() != nullptr &&
+        !seen[polyData->GetPoints()])
+    {
+      seen[polyData->GetPoints()] = true;
+      this->Objects.push_back({Kind::Points, polyData->GetPoints(), 0, {}});
+    }
+  }
+}
+
+size_t SceneJournal::Snapshot()
+{
+  auto checkpoint = this->Records.empty();
+  if (!checkpoint)
+  {
+    // Snapshots since the last checkpoint.
+    auto count = 0;
+    for (auto i = this->Current; i >= 0 && !this->Records[i].IsCheckpoint;
+         --i)
+    {
+      ++count;
+    }
+    checkpoint = count + 1 >= this->CheckpointInterval;
+  }
+
+  // The entries: kind, object index, size and the serialized state.
+  std::vector<char> entries;
+  std::vector<char> bytes;
+  uint32_t numberOfEntries = 0;
+  for (size_t i = 0; i < this->Objects.size(); ++i)
+  {
+    auto& tracked = this->Objects[i];
+    auto mtime = this->GetMTime(tracked);
+    if (!checkpoint && mtime == tracked.Recorded)
+    {
+      continue;
+    }
+    tracked.Recorded = mtime;
+    this->Serialize(tracked, bytes);
+    if (tracked.What != Kind::Points)
+    {
+      if (!checkpoint && bytes == tracked.Last)
+      {
+        continue;
+      }
+      tracked.Last = bytes;
+    }
+    auto index = static_cast<uint32_t>(i);
+    auto size = static_cast<uint32_t>(bytes.size());
+    entries.push_back(static_cast<char>(tracked.What));
+    entries.insert(entries.end(), reinterpret_cast<char*>(&index),
+                   reinterpret_cast<char*>(&index) + sizeof(index));
+    entries.insert(entries.end(), reinterpret_cast<char*>(&size),
+                   reinterpret_cast<char*>(&size) + sizeof(size));
+    entries.insert(entries.end(), bytes.begin(), bytes.end());
+    ++numberOfEntries;
+  }
+  if (numberOfEntries == 0)
+  {
+    return 0;
+  }
+
+  // Discard the snapshots after the current one.
+  if (this->Current + 1 < static_cast<int>(this->Records.size()))
+  {
+    this->End = this->Records[this->Current + 1].Offset;
+    this->Records.resize(this->Current + 1);
+    this->File.flush();
+    std::filesystem::resize_file(this->FileName, this->End);
+  }
+
+  // The record: checkpoint flag, number of entries and their size.
+  auto isCheckpoint = static_cast<char>(checkpoint);
+  auto size = static_cast<uint32_t>(entries.size());
+  this->File.seekp(this->End);
+  this->File.write(&isCheckpoint, 1);
+  this->File.write(reinterpret_cast<char*>(&numberOfEntries),
+                   sizeof(numberOfEntries));
+  this->File.write(reinterpret_cast<char*>(&size), sizeof(size));
+  this->File.write(entries.data(), entries.size());
+  this->File.flush();
+
+  this->Records.push_back({this->End, checkpoint});
+  auto written = 1 + sizeof(numberOfEntries) + sizeof(size) + entries.size();
+  this->End += written;
+  this->Current = static_cast<int>(this->Records.size()) - 1;
+  return written;
+}
+
+bool SceneJournal::Restore(int snapshot)
+{
+  if (snapshot < 0 || snapshot >= static_cast<int>(this->Records.size()))
+  {
+    return false;
+  }
+  auto first = snapshot;
+  while (!this->Records[first].IsCheckpoint)
+  {
+    --first;
+  }
+  for (auto i = first; i <= snapshot; ++i)
+  {
+    this->ReadRecord(i);
+  }
+  // Setting the state modifies the objects, that is not a change to record.
+  for (auto& tracked : this->Objects)
+  {
+    tracked.Recorded = this->GetMTime(tracked);
+    if (tracked.What != Kind::Points)
+    {
+      this->Serialize(tracked, tracked.Last);
+    }
+  }
+  this->Current = snapshot;
+  return true;
+}
+
+void SceneJournal::ReadRecord(size_t record)
+{
+  char isCheckpoint;
+  uint32_t numberOfEntries;
+  uint32_t size;
+  this->File.seekg(this->Records[record].Offset);
+  this->File.read(&isCheckpoint, 1);
+  this->File.read(reinterpret_cast<char*>(&numberOfEntries),
+                  sizeof(numberOfEntries));
+  this->File.read(reinterpret_cast<char*>(&size), sizeof(size));
+  std::vector<char> entries(size);
+  this->File.read(entries.data(), size);
+
+  size_t position = 0;
+  for (uint32_t e = 0; e < numberOfEntries; ++e)
+  {
+    uint32_t index;
+    uint32_t length;
+    std::memcpy(&index, entries.data() + position + 1, sizeof(index));
+    std::memcpy(&length, entries.data() + position + 1 + sizeof(index),
+                sizeof(length));
+    position += 1 + sizeof(index) + sizeof(length);
+    this->Apply(this->Objects[index], entries.data() + position, length);
+    position += length;
+  }
+}
+
+vtkMTimeType SceneJournal::GetMTime(Tracked const& tracked) const
+{
+  switch (tracked.What)
+  {
+  case Kind::Actor:
+    // The modified time of vtkActor includes its property, which is
+    // recorded separately.
+    return static_cast<vtkActor*>(tracked.Object)->vtkProp3D::GetMTime();
+  case Kind::Points:
+    return static_cast<vtkPoints*>(tracked.Object)->GetData()->GetMTime();
+  default:
+    return tracked.Object->GetMTime();
+  }
+}
+
+void SceneJournal::Serialize(Tracked const& tracked,
+                             std::vector<char>& bytes) const
+{
+  std::vector<double> values;
+  auto add = [&values](double const* v, int n) {
+    values.insert(values.end(), v, v + n);
+  };
+  switch (tracked.What)
+  {
+  case Kind::Camera: {
+    auto camera = static_cast<vtkCamera*>(tracked.Object);
+    add(camera->GetPosition(), 3);
+    add(camera->GetFocalPoint(), 3);
+    add(camera->GetViewUp(), 3);
+    values.push_back(camera->GetViewAngle());
+    values.push_back(camera->GetParallelScale());
+    values.push_back(camera->GetParallelProjection());
+    break;
+  }
+  case Kind::Actor: {
+    auto actor = static_cast<vtkActor*>(tracked.Object);
+    add(actor->GetPosition(), 3);
+    add(actor->GetOrientation(), 3);
+    add(actor->GetOrigin(), 3);
+    add(actor->GetScale(), 3);
+    values.push_back(actor->GetVisibility());
+    values.push_back(actor->GetPickable());
+    break;
+  }
+  case Kind::Property: {
+    auto property = static_cast<vtkProperty*>(tracked.Object);
+    add(property->GetAmbientColor(), 3);
+    add(property->GetDiffuseColor(), 3);
+    add(property->GetSpecularColor(), 3);
+    values.push_back(property->GetAmbient());
+    values.push_back(property->GetDiffuse());
+    values.push_back(property->GetSpecular());
+    values.push_back(property->GetSpecularPower());
+    values.push_back(property->GetOpacity());
+    values.push_back(property->GetRepresentation());
+    values.push_back(property->GetEdgeVisibility());
+    values.push_back(property->GetPointSize());
+    values.push_back(property->GetLineWidth());
+    break;
+  }
+  case Kind::Points: {
+    // The raw coordinates, in the type of the points.
+    auto data = static_cast<vtkPoints*>(tracked.Object)->GetData();
+    auto size = static_cast<size_t>(data->GetNumberOfValues()) *
+        data->GetDataTypeSize();
+    auto begin = static_cast<char const*>(data->GetVoidPointer(0));
+    bytes.assign(begin, begin + size);
+    return;
+  }
+  }
+  auto begin = reinterpret_cast<char const*>(values.data());
+  bytes.assign(begin, begin + values.size() * sizeof(double));
+}
+
+void SceneJournal::Apply(Tracked const& tracked, char const* bytes,
+                         size_t size) const
+{
+  std::vector<double> values(size / sizeof(double));
+  std::memcpy(values.data(), bytes, values.size() * sizeof(double));
+  auto v = values.data();
+  switch (tracked.What)
+  {
+  case Kind::Camera: {
+    auto camera = static_cast<vtkCamera*>(tracked.Object);
+    camera->SetPosition(v);
+    camera->SetFocalPoint(v + 3);
+    camera->SetViewUp(v + 6);
+    camera->SetViewAngle(v[9]);
+    camera->SetParallelScale(v[10]);
+    camera->SetParallelProjection(static_cast<vtkTypeBool>(v[11]));
+    break;
+  }
+  case Kind::Actor: {
+    auto actor = static_cast<vtkActor*>(tracked.Object);
+    actor->SetPosition(v);
+    actor->SetOrientation(v + 3);
+    actor->SetOrigin(v + 6);
+    actor->SetScale(v + 9);
+    actor->SetVisibility(static_cast<vtkTypeBool>(v[12]));
+    actor->SetPickable(static_cast<vtkTypeBool>(v[13]));
+    break;
+  }
+  case Kind::Property: {
+    auto property = static_cast<vtkProperty*>(tracked.Object);
+    property->SetAmbientColor(v);
+    property->SetDiffuseColor(v + 3);
+    property->SetSpecularColor(v + 6);
+    property->SetAmbient(v[9]);
+    property->SetDiffuse(v[10]);
+    property->SetSpecular(v[11]);
+    property->SetSpecularPower(v[12]);
+    property->SetOpacity(v[13]);
+    property->SetRepresentation(static_cast<int>(v[14]));
+    property->SetEdgeVisibility(static_cast<vtkTypeBool>(v[15]));
+    property->SetPointSize(static_cast<float>(v[16]));
+    property->SetLineWidth(static_cast<float>(v[17]));
+    break;
+  }
+  case Kind::Points: {
+    auto points = static_cast<vtkPoints*>(tracked.Object);
+    auto data = points->GetData();
+    auto expected = static_cast<size_t>(data->GetNumberOfValues()) *
+        data->GetDataTypeSize();
+    if (expected == size)
+    {
+      std::memcpy(data->GetVoidPointer(0), bytes, size);
+      data->Modified();
+      points->Modified();
+    }
+    break;
+  }
+  }
+}
+
+void KeyPressCallback(vtkObject* caller, long unsigned int vtkNotUsed(eventId),
+                      void* clientData, void* vtkNotUsed(callData))
+{
+  auto interactor = static_cast<vtkRenderWindowInteractor*>(caller);
+  auto state = static_cast<JournalState*>(clientData);
+  std::string key = interactor->GetKeySym();
+  auto journal = state->Journal;
+  if (key == "z" || key == "y")
+  {
+    // Record any change not yet saved, so that redo can come back to it.
+    journal->Snapshot();
+    auto snapshot = journal->GetCurrentSnapshot() + (key == "z" ? -1 : 1);
+    if (journal->Restore(snapshot))
+    {
+      std::cout << "Snapshot " << snapshot << " of "
+                << journal->GetNumberOfSnapshots() - 1 << std::endl;
+      state->RenderWindow->Render();
+    }
+  }
+}
+
+void AutosaveCallback(vtkObject* vtkNotUsed(caller),
+                      long unsigned int vtkNotUsed(eventId), void* clientData,
+                      void* vtkNotUsed(callData))
+{
+  auto state = static_cast<JournalState*>(clientData);
+  auto bytes = state->Journal->Snapshot();
+  if (bytes > 0)
+  {
+    std::cout << "Saved snapshot " << state->Journal->GetCurrentSnapshot()
+              << ": " << bytes << " bytes" << std::endl;
+  }
+}
+
+} // namespace
@@ -0,0 +1,396 @@
+#include <vtkActor.h>
+#include <vtkArrowSource.h>
+#include <vtkCamera.h>
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+#include <vtkGlyph3D.h>
+#include <vtkGlyph3DMapper.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkStructuredPoints.h>
+#include <vtkStructuredPointsReader.h>
+#include <vtkThresholdPoints.h>
+#include <vtkTimerLog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+/**
+ * Make waves over a square grid of points.
+ *
+ * @param numberOfPoints About the number of points.
+ * @return The points, with the height as scalars and the normals of the
+ * waves, longer on the crests, as vectors.
+ */
+vtkSmartPointer<vtkPolyData> MakeWaves(vtkIdType numberOfPoints);
+
+/**
+ * Keep one point in onRatio, with its point data, in parallel.
+ *
+ * Like vtkMaskPoints, either every onRatio-th point is kept, or each point
+ * is kept with probability 1 / onRatio. A hash of the point id replaces the
+ * random numbers, so that the points are chosen in parallel and the same
+ * points are chosen for any number of threads.
+ *
+ * @param input The points.
+ * @param onRatio Keep one point in onRatio.
+ * @param random Choose the points at random.
+ * @return The points kept.
+ */
+vtkSmartPointer<vtkPolyData> MaskPoints(vtkDataSet* input, vtkIdType onRatio,
+                                        bool random);
+
+/**
+ * Render frames while the camera turns around.
+ *
+ * @param renderWindow The window.
+ * @param renderer The renderer whose camera turns.
+ * @param frames The number of frames.
+ * @return The seconds per frame.
+ */
+double TimeFrames(vtkRenderWindow* renderWindow, vtkRenderer* renderer,
+                  int frames);
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  auto compare = false;
+  std::vector<std::string> args;
+  for (auto i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "-c")
+    {
+      compare = true;
+    }
+    else
+    {
+      args.push_back(arg);
+    }
+  }
+  vtkIdType onRatio = args.size() > 1 ? std::atoi(args[1].c_str()) : 1;
+  auto random = args.size() > 2 && args[2] == "random";
+  if (onRatio < 1 || (args.size() > 2 && !random && args[2] != "stride"))
+  {
+    std::cout << "Usage: " << argv[0]
+              << " [numberOfPoints|carotid.vtk [onRatio [stride|random]]] [-c]"
+                 " e.g. 1000000 1"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The points to glyph: a file of structured points like carotid.vtk, as
+  // in CarotidFlowGlyphs, or waves.
+  vtkSmartPointer<vtkDataSet> points;
+  auto scaleFactor = 0.0;
+  if (!args.empty() && args[0].find(".vtk") != std::string::npos)
+  {
+    vtkNew<vtkStructuredPointsReader> reader;
+    reader->SetFileName(args[0].c_str());
+    vtkNew<vtkThresholdPoints> threshold;
+    threshold->SetInputConnection(reader->GetOutputPort());
+    threshold->ThresholdByUpper(200);
+    threshold->Update();
+    points = threshold->GetOutput();
+    // The same scale as the cones of CarotidFlowGlyphs.
+    scaleFactor = 0.4;
+  }
+  else
+  {
+    vtkIdType numberOfPoints =
+        args.empty() ? 1000000 : std::atoll(args[0].c_str());
+    points = MakeWaves(std::max(numberOfPoints, vtkIdType(4)));
+    // Scale by the points actually made, as the count is clamped and rounded.
+    scaleFactor =
+        1.0 / std::sqrt(static_cast<double>(points->GetNumberOfPoints()));
+  }
+
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  auto masked = MaskPoints(points, onRatio, random);
+  timer->StopTimer();
+  std::cout << "Points: " << points->GetNumberOfPoints() << ", "
+            << masked->GetNumberOfPoints() << " kept in "
+            << timer->GetElapsedTime() << " s" << std::endl;
+
+  double range[2];
+  masked->GetPointData()->GetScalars()->GetRange(range);
+
+  vtkNew<vtkArrowSource> arrow;
+  arrow->SetTipResolution(12);
+  arrow->SetShaftResolution(12);
+
+  // The instanced path: the mapper reads the orientation and the scale from
+  // the vectors, and draws one instance of the arrow for each point.
+  vtkNew<vtkGlyph3DMapper> instancedMapper;
+  instancedMapper->SetInputData(masked);
+  instancedMapper->SetSourceConnection(arrow->GetOutputPort());
+  instancedMapper->SetOrientationArray(vtkDataSetAttributes::VECTORS);
+  instancedMapper->SetOrientationModeToDirection();
+  instancedMapper->SetScaleArray(vtkDataSetAttributes::VECTORS);
+  instancedMapper->SetScaleModeToScaleByMagnitude();
+  instancedMapper->SetScaleFactor(scaleFactor);
+  instancedMapper->SetScalarRange(range);
+
+  vtkNew<vtkActor> instancedActor;
+  instancedActor->SetMapper(instancedMapper);
+
+  vtkNew<vtkNamedColors> colors;
+
+  vtkNew<vtkCamera> camera;
+
+  vtkNew<vtkRenderer> instancedRenderer;
+  instancedRenderer->SetActiveCamera(camera);
+  instancedRenderer->AddActor(instancedActor);
+  instancedRenderer->SetBackground(colors->GetColor3d("SlateGray").GetData());
+
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->SetSize(640, 480);
+  renderWindow->AddRenderer(instancedRenderer);
+  renderWindow->SetWindowName("InstancedGlyphs");
+
+  vtkNew<vtkRenderWindowInteractor> interactor;
+  interactor->SetRenderWindow(renderWindow);
+
+  instancedRenderer->ResetCamera();
+  camera->Elevation(-45);
+  instancedRenderer->ResetCameraClippingRange();
+
+  const auto frames = 36;
+  timer->StartTimer();
+  renderWindow->Render();
+  timer->StopTimer();
+  auto firstFrame = timer->GetElapsedTime();
+  auto frameTime = TimeFrames(renderWindow, instancedRenderer, frames);
+  std::cout << "vtkGlyph3DMapper: "
+            << masked->GetActualMemorySize() / 1024.0 << " MiB of points, "
+            << "first frame " << firstFrame << " s, " << 1000.0 * frameTime
+            << " ms per frame" << std::endl;
+
+  if (compare)
+  {
+    // The path of vtkGlyph3D: a copy of the arrow for each point, in one
+    // polydata, colored by the same scalars.
+    vtkNew<vtkGlyph3D> glyph3D;
+    glyph3D->SetInputData(masked);
+    glyph3D->SetSourceConnection(arrow->GetOutputPort());
+    glyph3D->SetVectorModeToUseVector();
+    glyph3D->SetScaleModeToScaleByVector();
+    glyph3D->SetColorModeToColorByScalar();
+    glyph3D->SetScaleFactor(scaleFactor);
+
+    vtkNew<vtkPolyDataMapper> glyphMapper;
+    glyphMapper->SetInputConnection(glyph3D->GetOutputPort());
+    glyphMapper->SetScalarRange(range);
+
+    vtkNew<vtkActor> glyphActor;
+    glyphActor->SetMapper(glyphMapper);
+
+    // Side by side, the instances on the right.
+    vtkNew<vtkRenderer> glyphRenderer;
+    glyphRenderer->SetActiveCamera(camera);
+    glyphRenderer->AddActor(glyphActor);
+    glyphRenderer->SetBackground(colors->GetColor3d("DarkSlateGray").GetData());
+    glyphRenderer->SetViewport(0.0, 0.0, 0.5, 1.0);
+    instancedRenderer->SetViewport(0.5, 0.0, 1.0, 1.0);
+    renderWindow->AddRenderer(glyphRenderer);
+    renderWindow->SetSize(1280, 480);
+
+    instancedRenderer->DrawOff();
+    timer->StartTimer();
+    renderWindow->Render();
+    timer->StopTimer();
+    firstFrame = timer->GetElapsedTime();
+    frameTime = TimeFrames(renderWindow, glyphRenderer, frames);
+    std::cout << "vtkGlyph3D: "
+              << glyph3D->GetOutput()->GetActualMemorySize() / 1024.0
+              << " MiB of glyphs, first frame " << firstFrame << " s, "
+              << 1000.0 * frameTime << " ms per frame" << std::endl;
+    instancedRenderer->DrawOn();
+    renderWindow->Render();
+    interactor->Start();
+    return EXIT_SUCCESS;
+  }
+
+  renderWindow->Render();
+  interactor->Start();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+vtkSmartPointer<vtkPolyData> MakeWaves(vtkIdType numberOfPoints)
+{
+  auto side = static_cast<vtkIdType>(
+      std::sqrt(static_cast<double>(numberOfPoints)));
+  auto n = side * side;
+  vtkNew<vtkPoints> points;
+  points->SetNumberOfPoints(n);
+  vtkNew<vtkFloatArray> heights;
+  heights->SetName("Height");
+  heights->SetNumberOfValues(n);
+  vtkNew<vtkFloatArray> vectors;
+  vectors->SetName("Vectors");
+  vectors->SetNumberOfComponents(3);
+  vectors->SetNumberOfTuples(n);
+
+  const double amplitude = 0.1;
+  const double frequency = 6.0;
+  vtkSMPTools::For(0, n, [&](vtkIdType begin, vtkIdType end) {
+    for (auto i = begin; i < end; ++i)
+    {
+      auto x = -1.0 + 2.0 * (i % side) / (side - 1);
+      auto y = -1.0 + 2.0 * (i / side) / (side - 1);
+      auto z = amplitude * std::sin(frequency * x) * std::cos(frequency * y);
+      double normal[3]{
+          -amplitude * frequency * std::cos(frequency * x) *
+              std::cos(frequency * y),
+          amplitude * frequency * std::sin(frequency * x) *
+              std::sin(frequency * y),
+          1.0};
+      auto length = (1.0 + std::abs(z) / amplitude) /
+          std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + 1.0);
+      points->SetPoint(i, x, y, z);
+      heights->SetValue(i, static_cast<float>(z));
+      vectors->SetTuple3(i, length * normal[0], length * normal[1], length);
+    }
+  });
+
+  auto waves = vtkSmartPointer<vtkPolyData>::New();
+  waves->SetPoints(points);
+  waves->GetPointData()->SetScalars(heights);
+  waves->GetPointData()->SetVectors(vectors);
+  return waves;
+}
+
+vtkSmartPointer<vtkPolyData> MaskPoints(vtkDataSet* input, vtkIdType onRatio,
+                                        bool random)
+{
+  auto n = input->GetNumberOfPoints();
+  auto keep = [&](vtkIdType i) {
+    if (!random)
+    {
+      return i % onRatio == 0;
+    }
+    auto hash = static_cast<std::uint64_t>(i) * 0x9E3779B97F4A7C15ull;
+    hash ^= hash >> 29;
+    hash *= 0xBF58476D1CE4E5B9ull;
+    hash ^= hash >> 32;
+    return hash % static_cast<std::uint64_t>(onRatio) == 0;
+  };
+
+  // Count the points kept in blocks, then fill the blocks from their
+  // offsets.
+  const vtkIdType blockSize = 65536;
+  auto numberOfBlocks = (n + blockSize - 1) / blockSize;
+  std::vector<vtkIdType> blockStart(numberOfBlocks + 1, 0);
+  vtkSMPTools::For(0, numberOfBlocks, [&](vtkIdType begin, vtkIdType end) {
+    for (auto b = begin; b < end; ++b)
+    {
+      auto last = std::min(n, (b + 1) * blockSize);
+      for (auto i = b * blockSize; i < last; ++i)
+      {
+        blockStart[b + 1] += keep(i);
+      }
+    }
+  });
+  for (vtkIdType b = 0; b < numberOfBlocks; ++b)
+  {
+    blockStart[b + 1] += blockStart[b];
+  }
+  std::vector<vtkIdType> kept(blockStart[numberOfBlocks]);
+  vtkSMPTools::For(0, numberOfBlocks, [&](vtkIdType begin, vtkIdType end) {
+    for (auto b = begin; b < end; ++b)
+    {
+      auto next = blockStart[b];
+      auto last = std::min(n, (b + 1) * blockSize);
+      for (auto i = b * blockSize; i < last; ++i)
+      {
+        if (keep(i))
+        {
+          kept[next++] = i;
+        }
+      }
+    }
+  });
+
+  // The points and every point data array.
+  auto numberKept = static_cast<vtkIdType>(kept.size());
+  auto output = vtkSmartPointer<vtkPolyData>::New();
+  vtkNew<vtkPoints> points;
+  points->SetNumberOfPoints(numberKept);
+  vtkSMPTools::For(0, numberKept, [&](vtkIdType begin, vtkIdType end) {
+    double x[3];
+    for (auto i = begin; i < end; ++i)
+    {
+      input->GetPoint(kept[i], x);
+      points->SetPoint(i, x);
+    }
+  });
+  output->SetPoints(points);
+
+  auto inputPointData = input->GetPointData();
+  auto outputPointData = output->GetPointData();
+  for (auto a = 0; a < inputPointData->GetNumberOfArrays(); ++a)
+  {
+    auto array = inputPointData->GetArray(a);
+    if (!array)
+    {
+      continue;
+    }
+    auto components = array->GetNumberOfComponents();
+    auto copy = vtk::TakeSmartPointer(array->NewInstance());
+    copy->SetName(array->GetName());
+    copy->SetNumberOfComponents(components);
+    copy->SetNumberOfTuples(numberKept);
+    vtkSMPTools::For(0, numberKept, [&](vtkIdType begin, vtkIdType end) {
+      std::vector<double> tuple(components);
+      for (auto i = begin; i < end; ++i)
+      {
+        array->GetTuple(kept[i], tuple.data());
+        copy->SetTuple(i, tuple.data());
+      }
+    });
+    outputPointData->AddArray(copy);
+    for (auto attribute = 0; attribute < vtkDataSetAttributes::NUM_ATTRIBUTES;
+         ++attribute)
+    {
+      if (inputPointData->GetAbstractAttribute(attribute) == array &&
+          array->GetName())
+      {
+        outputPointData->SetActiveAttribute(array->GetName(), attribute);
+      }
+    }
+  }
+  return output;
+}
+
+double TimeFrames(vtkRenderWindow* renderWindow, vtkRenderer* renderer,
+                  int frames)
+{
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (auto i = 0; i < frames; ++i)
+  {
+    renderer->GetActiveCamera()->Azimuth(360.0 / frames);
+    renderWindow->Render();
+  }
+  timer->StopTimer();
+  return timer->GetElapsedTime() / frames;
+}
+} // namespace
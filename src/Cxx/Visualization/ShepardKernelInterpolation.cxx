@@ -0,0 +1,249 @@
+#include <vtkActor.h>
+#include <vtkCamera.h>
+#include <vtkContourFilter.h>
+#include <vtkFloatArray.h>
+#include <vtkImageData.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkNamedColors.h>
+#include <vtkNew.h>
+#include <vtkOutlineFilter.h>
+#include <vtkPointData.h>
+#include <vtkPointInterpolator.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkProperty.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+#include <vtkRenderer.h>
+#include <vtkShepardKernel.h>
+#include <vtkShepardMethod.h>
+#include <vtkSmartPointer.h>
+#include <vtkStaticPointLocator.h>
+#include <vtkTimerLog.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+/**
+ * Make a scattered survey: random sample points with the values of a smooth
+ * field.
+ *
+ * @param numberOfPoints The number of samples.
+ * @param bounds The box the samples are taken in.
+ * @return The samples, with their values as float point scalars.
+ */
+vtkSmartPointer<vtkPolyData> MakeSurvey(vtkIdType numberOfPoints,
+                                        double bounds[6]);
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  vtkIdType numberOfPoints = 200000;
+  auto resolution = 100;
+  auto numberOfNeighbours = 8;
+  auto compare = false;
+  auto position = 0;
+  for (auto i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    if (arg == "-c")
+    {
+      compare = true;
+    }
+    else if (position == 0)
+    {
+      numberOfPoints = std::atoll(argv[i]);
+      ++position;
+    }
+    else if (position == 1)
+    {
+      resolution = std::atoi(argv[i]);
+      ++position;
+    }
+    else if (position == 2)
+    {
+      numberOfNeighbours = std::atoi(argv[i]);
+      ++position;
+    }
+    else
+    {
+      std::cout << "Usage: " << argv[0]
+                << " [numberOfPoints] [resolution] [numberOfNeighbours] [-c]"
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (numberOfPoints < 1 || resolution < 2 || numberOfNeighbours < 1)
+  {
+    std::cout << "numberOfPoints, resolution and numberOfNeighbours must be "
+                 "positive, and resolution at least 2."
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkNew<vtkNamedColors> colors;
+
+  double bounds[6]{0.0, 100.0, 0.0, 100.0, 0.0, 50.0};
+  auto survey = MakeSurvey(numberOfPoints, bounds);
+
+  // The grid to interpolate onto. It only has geometry, the interpolator
+  // adds the float values of the survey to it.
+  vtkNew<vtkImageData> grid;
+  grid->SetDimensions(resolution, resolution, resolution);
+  grid->SetOrigin(bounds[0], bounds[2], bounds[4]);
+  grid->SetSpacing((bounds[1] - bounds[0]) / (resolution - 1),
+                   (bounds[3] - bounds[2]) / (resolution - 1),
+                   (bounds[5] - bounds[4]) / (resolution - 1));
+
+  // Bin the samples once. The locator sorts the points into buckets in
+  // parallel, and can then be queried from many threads at once.
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  vtkNew<vtkStaticPointLocator> locator;
+  locator->SetDataSet(survey);
+  locator->BuildLocator();
+  timer->StopTimer();
+  auto locatorTime = timer->GetElapsedTime();
+
+  // Each voxel gathers its nearest samples and weights them by the inverse
+  // square of their distance. The voxels are processed in parallel.
+  vtkNew<vtkShepardKernel> kernel;
+  kernel->SetPowerParameter(2.0);
+  kernel->SetKernelFootprintToNClosest();
+  kernel->SetNumberOfPoints(numberOfNeighbours);
+
+  vtkNew<vtkPointInterpolator> interpolator;
+  interpolator->SetInputData(grid);
+  interpolator->SetSourceData(survey);
+  interpolator->SetLocator(locator);
+  interpolator->SetKernel(kernel);
+  timer->StartTimer();
+  interpolator->Update();
+  timer->StopTimer();
+  auto interpolated = interpolator->GetOutput();
+  auto values = interpolated->GetPointData()->GetArray("Values");
+
+  std::cout << "Samples: " << numberOfPoints << ", grid: " << resolution << "^3"
+            << std::endl;
+  std::cout << "Gather (" << numberOfNeighbours << " nearest)" << std::endl;
+  std::cout << "  Locator:       " << locatorTime << " s" << std::endl;
+  std::cout << "  Interpolation: " << timer->GetElapsedTime() << " s"
+            << std::endl;
+  std::cout << "  Values:        " << values->GetClassName() << ", range "
+            << values->GetRange()[0] << ", " << values->GetRange()[1]
+            << std::endl;
+
+  if (compare)
+  {
+    // Every sample splats into every voxel within the maximum distance.
+    vtkNew<vtkShepardMethod> shepard;
+    shepard->SetInputData(survey);
+    shepard->SetModelBounds(bounds);
+    shepard->SetSampleDimensions(resolution, resolution, resolution);
+    shepard->SetMaximumDistance(0.1);
+    timer->StartTimer();
+    shepard->Update();
+    timer->StopTimer();
+    std::cout << "vtkShepardMethod (maximum distance 0.1)" << std::endl;
+    std::cout << "  Interpolation: " << timer->GetElapsedTime() << " s"
+              << std::endl;
+    std::cout << "  Values:        range "
+              << shepard->GetOutput()->GetScalarRange()[0] << ", "
+              << shepard->GetOutput()->GetScalarRange()[1] << std::endl;
+  }
+
+  // Show some isosurfaces of the interpolated field.
+  interpolated->GetPointData()->SetActiveScalars("Values");
+  double range[2];
+  values->GetRange(range);
+
+  vtkNew<vtkContourFilter> contours;
+  contours->SetInputData(interpolated);
+  contours->GenerateValues(5, range[0] + 0.1 * (range[1] - range[0]),
+                           range[1] - 0.1 * (range[1] - range[0]));
+
+  vtkNew<vtkPolyDataMapper> contourMapper;
+  contourMapper->SetInputConnection(contours->GetOutputPort());
+  contourMapper->SetScalarRange(range);
+
+  vtkNew<vtkActor> contourActor;
+  contourActor->SetMapper(contourMapper);
+
+  vtkNew<vtkOutlineFilter> outline;
+  outline->SetInputData(interpolated);
+
+  vtkNew<vtkPolyDataMapper> outlineMapper;
+  outlineMapper->SetInputConnection(outline->GetOutputPort());
+
+  vtkNew<vtkActor> outlineActor;
+  outlineActor->SetMapper(outlineMapper);
+  outlineActor->GetProperty()->SetColor(colors->GetColor3d("Black").GetData());
+
+  vtkNew<vtkRenderer> renderer;
+  renderer->AddActor(contourActor);
+  renderer->AddActor(outlineActor);
+  renderer->SetBackground(colors->GetColor3d("Wheat").GetData());
+
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->AddRenderer(renderer);
+  renderWindow->SetSize(640, 480);
+  renderWindow->SetWindowName("ShepardKernelInterpolation");
+
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  renderWindowInteractor->SetRenderWindow(renderWindow);
+
+  renderer->ResetCamera();
+  renderer->GetActiveCamera()->Elevation(-60);
+  renderer->GetActiveCamera()->Azimuth(30);
+  renderer->ResetCameraClippingRange();
+
+  renderWindow->Render();
+  renderWindowInteractor->Start();
+
+  return EXIT_SUCCESS;
+}
+
+namespace {
+vtkSmartPointer<vtkPolyData> MakeSurvey(vtkIdType numberOfPoints,
+                                        double bounds[6])
+{
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  random->SetSeed(8775070);
+
+  vtkNew<vtkPoints> points;
+  points->SetDataTypeToFloat();
+  points->SetNumberOfPoints(numberOfPoints);
+
+  vtkNew<vtkFloatArray> values;
+  values->SetName("Values");
+  values->SetNumberOfTuples(numberOfPoints);
+
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    double x[3];
+    for (auto j = 0; j < 3; ++j)
+    {
+      x[j] = random->GetRangeValue(bounds[2 * j], bounds[2 * j + 1]);
+      random->Next();
+    }
+    points->SetPoint(i, x);
+    // A layered field with a dome in the middle.
+    auto dx = (x[0] - 50.0) / 25.0;
+    auto dy = (x[1] - 50.0) / 25.0;
+    auto dome = 15.0 * std::exp(-(dx * dx + dy * dy));
+    values->SetValue(i,
+                     static_cast<float>(
+                         std::sin((x[2] + dome) / 6.0) +
+                         0.2 * std::cos(x[0] / 10.0) * std::sin(x[1] / 15.0)));
+  }
+
+  auto survey = vtkSmartPointer<vtkPolyData>::New();
+  survey->SetPoints(points);
+  survey->GetPointData()->SetScalars(values);
+  return survey;
+}
+} // namespace